@@ -363,6 +363,47 @@ function(quassel_add_test _target)
     )
 endfunction()
 
+###################################################################################################
+# Adds a benchmark
+#
+# quassel_add_benchmark(BenchmarkName
+#                       [LIBRARIES lib1 lib2...]
+# )
+#
+# Works like quassel_add_test(), but the benchmark provides its own main function and is not
+# registered with CTest, since benchmarks usually run for a long time and need to be interpreted
+# by a human. The benchmark is automatically linked against Qt5::Network and Quassel::Common.
+#
+# The compiled benchmark binary is located in the bench/ directory in the build directory.
+#
+function(quassel_add_benchmark _target)
+    set(options )
+    set(oneValueArgs )
+    set(multiValueArgs LIBRARIES)
+    cmake_parse_arguments(ARG "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+    string(TOLOWER ${_target} lower_target)
+    set(srcfile ${lower_target}.cpp)
+
+    list(APPEND ARG_LIBRARIES
+        Qt5::Network
+        Quassel::Common
+    )
+
+    if (WIN32)
+        set(output_dir "${CMAKE_RUNTIME_OUTPUT_DIRECTORY}")
+    else()
+        set(output_dir "${CMAKE_BINARY_DIR}/bench")
+    endif()
+
+    add_executable(${_target} ${srcfile})
+    set_target_properties(${_target} PROPERTIES
+        OUTPUT_NAME ${_target}
+        RUNTIME_OUTPUT_DIRECTORY "${output_dir}"
+    )
+    target_link_libraries(${_target} PUBLIC ${ARG_LIBRARIES})
+endfunction()
+
 ###################################################################################################
 # target_link_if_exists(Target
 #                       [PUBLIC dep1 dep2...]
@@ -91,6 +91,7 @@ Client::Client(std::unique_ptr<AbstractUi> ui, QObject* parent)
 
     p->attachSlot(SIGNAL(displayMsg(Message)), this, &Client::recvMessage);
     p->attachSlot(SIGNAL(displayStatusMsg(QString,QString)), this, &Client::recvStatusMsg);
+    p->attachSlot(SIGNAL(backlogAvailable(BufferId,MsgId,MsgId)), this, &Client::recvBacklogAvailable);
 
     p->attachSlot(SIGNAL(bufferInfoUpdated(BufferInfo)), _networkModel, &NetworkModel::bufferUpdated);
     p->attachSignal(inputHandler(), &ClientUserInputHandler::sendInput);
@@ -552,6 +553,12 @@ void Client::recvMessage(const Message& msg)
     messageProcessor()->process(msg_);
 }
 
+void Client::recvBacklogAvailable(BufferId bufferId, MsgId first, MsgId last)
+{
+    // The core withheld these messages while we couldn't keep up, so fetch them now
+    backlogManager()->requestBacklog(bufferId, first, last);
+}
+
 void Client::setBufferLastSeenMsg(BufferId id, const MsgId& msgId)
 {
     if (bufferSyncer())
@@ -279,6 +279,7 @@ private slots:
 
     void recvMessage(const Message& message);
     void recvStatusMsg(QString network, QString message);
+    void recvBacklogAvailable(BufferId bufferId, MsgId first, MsgId last);
 
     void networkDestroyed();
     void coreIdentityCreated(const Identity&);
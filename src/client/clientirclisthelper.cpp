@@ -33,24 +33,35 @@ QVariantList ClientIrcListHelper::requestChannelList(const NetworkId& netId, con
 
 void ClientIrcListHelper::receiveChannelList(const NetworkId& netId, const QStringList& channelFilters, const QVariantList& channels)
 {
-    QVariantList::const_iterator iter = channels.constBegin();
-    QVariantList::const_iterator iterEnd = channels.constEnd();
-
-    QList<ChannelDescription> channelList;
-    while (iter != iterEnd) {
-        QVariantList channelVar = iter->toList();
-        ChannelDescription channelDescription(channelVar[0].toString(), channelVar[1].toUInt(), channelVar[2].toString());
-        channelList << channelDescription;
-        ++iter;
-    }
+    emit channelListReceived(netId, channelFilters, toChannelList(channels));
+}
 
-    emit channelListReceived(netId, channelFilters, channelList);
+void ClientIrcListHelper::receiveChannelListPage(const NetworkId& netId, const QVariantMap& query, const QVariantMap& result)
+{
+    emit channelListPageReceived(netId,
+                                 query,
+                                 result["total"].toInt(),
+                                 result["offset"].toInt(),
+                                 toChannelList(result["channels"].toList()));
 }
 
 void ClientIrcListHelper::reportFinishedList(const NetworkId& netId)
 {
     if (_netId == netId) {
-        requestChannelList(netId, QStringList());
+        // With paging, the list stays on the core and is queried through requestChannelListPage()
+        if (!Client::isCoreFeatureEnabled(Quassel::Feature::PagedChannelList))
+            requestChannelList(netId, QStringList());
         emit finishedListReported(netId);
     }
 }
+
+QList<IrcListHelper::ChannelDescription> ClientIrcListHelper::toChannelList(const QVariantList& channels)
+{
+    QList<ChannelDescription> channelList;
+    channelList.reserve(channels.count());
+    for (const QVariant& channel : channels) {
+        QVariantList channelVar = channel.toList();
+        channelList << ChannelDescription(channelVar[0].toString(), channelVar[1].toUInt(), channelVar[2].toString());
+    }
+    return channelList;
+}
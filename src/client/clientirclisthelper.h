@@ -35,6 +35,11 @@ public:
 public slots:
     QVariantList requestChannelList(const NetworkId& netId, const QStringList& channelFilters) override;
     void receiveChannelList(const NetworkId& netId, const QStringList& channelFilters, const QVariantList& channels) override;
+    void receiveChannelListPage(const NetworkId& netId, const QVariantMap& query, const QVariantMap& result) override;
+    inline void reportChannelListProgress(const NetworkId& netId, int receivedCount) override
+    {
+        emit channelListProgressReported(netId, receivedCount);
+    }
     void reportFinishedList(const NetworkId& netId) override;
     inline void reportError(const QString& error) override { emit errorReported(error); }
 
@@ -42,9 +47,17 @@ signals:
     void channelListReceived(const NetworkId& netId,
                              const QStringList& channelFilters,
                              const QList<IrcListHelper::ChannelDescription>& channelList);
+    void channelListPageReceived(const NetworkId& netId,
+                                 const QVariantMap& query,
+                                 int total,
+                                 int offset,
+                                 const QList<IrcListHelper::ChannelDescription>& channelList);
+    void channelListProgressReported(const NetworkId& netId, int receivedCount);
     void finishedListReported(const NetworkId& netId);
     void errorReported(const QString& error);
 
 private:
+    static QList<ChannelDescription> toChannelList(const QVariantList& channels);
+
     NetworkId _netId;
 };
@@ -22,6 +22,8 @@
 
 #include <QFile>
 
+#include "client.h"
+
 ClientTransfer::ClientTransfer(const QUuid& uuid, QObject* parent)
     : Transfer(uuid, parent)
     , _file(nullptr)
@@ -56,6 +58,11 @@ void ClientTransfer::accept(const QString& savePath) const
     _savePath = savePath;
     PeerPtr ptr = nullptr;
     REQUEST_OTHER(requestAccepted, ARG(ptr));
+    if (Client::isCoreFeatureEnabled(Quassel::Feature::SpooledTransfers)) {
+        // Spooling cores only start sending once we ask for the data
+        quint64 offset = 0;
+        REQUEST_OTHER(requestData, ARG(ptr), ARG(offset));
+    }
     emit accepted();
 }
 
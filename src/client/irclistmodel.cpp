@@ -22,6 +22,12 @@
 
 #include <QStringList>
 
+#include "client.h"
+#include "clientirclisthelper.h"
+
+// Rows requested at once in paged mode
+constexpr auto kPageSize = 500;
+
 IrcListModel::IrcListModel(QObject* parent)
     : QAbstractItemModel(parent)
 {}
@@ -77,6 +83,10 @@ QModelIndex IrcListModel::index(int row, int column, const QModelIndex& parent)
 
 void IrcListModel::setChannelList(const QList<IrcListHelper::ChannelDescription>& channelList)
 {
+    _netId = NetworkId();
+    _total = 0;
+    _fetching = false;
+
     if (rowCount() > 0) {
         beginRemoveRows(QModelIndex(), 0, _channelList.count() - 1);
         _channelList.clear();
@@ -89,3 +99,116 @@ void IrcListModel::setChannelList(const QList<IrcListHelper::ChannelDescription>
         endInsertRows();
     }
 }
+
+void IrcListModel::setPagedNetwork(const NetworkId& netId)
+{
+    ClientIrcListHelper* helper = Client::ircListHelper();
+    connect(helper, &ClientIrcListHelper::channelListPageReceived, this, &IrcListModel::receiveChannelListPage, Qt::UniqueConnection);
+    connect(helper, &ClientIrcListHelper::channelListProgressReported, this, &IrcListModel::channelListProgress, Qt::UniqueConnection);
+    connect(helper, &ClientIrcListHelper::finishedListReported, this, &IrcListModel::finishedListReported, Qt::UniqueConnection);
+
+    beginResetModel();
+    _channelList.clear();
+    _netId = netId;
+    _total = 0;
+    endResetModel();
+    refresh();
+}
+
+void IrcListModel::setFilterString(const QString& filter)
+{
+    if (_filter == filter)
+        return;
+
+    _filter = filter;
+    if (isPaged())
+        refresh();
+}
+
+void IrcListModel::sort(int column, Qt::SortOrder order)
+{
+    if (_sortColumn == column && _sortOrder == order)
+        return;
+
+    _sortColumn = column;
+    _sortOrder = order;
+    if (isPaged())
+        refresh();
+}
+
+bool IrcListModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && isPaged() && !_fetching && rowCount() < _total;
+}
+
+void IrcListModel::fetchMore(const QModelIndex& parent)
+{
+    if (canFetchMore(parent))
+        requestPage(rowCount());
+}
+
+void IrcListModel::refresh()
+{
+    ++_serial;
+    requestPage(0);
+}
+
+void IrcListModel::requestPage(int offset)
+{
+    QVariantMap query;
+    query["serial"] = _serial;
+    if (!_filter.isEmpty()) {
+        query["namePrefix"] = _filter;
+        query["topicContains"] = _filter;
+        query["matchAny"] = true;
+    }
+    // The topic can't be sorted by on the core, so fall back to the channel name
+    query["sortColumn"] = _sortColumn == 1 ? 1 : 0;
+    query["sortOrder"] = _sortOrder;
+    query["offset"] = offset;
+    query["limit"] = kPageSize;
+
+    _fetching = true;
+    Client::ircListHelper()->requestChannelListPage(_netId, query);
+}
+
+void IrcListModel::receiveChannelListPage(const NetworkId& netId,
+                                          const QVariantMap& query,
+                                          int total,
+                                          int offset,
+                                          const QList<IrcListHelper::ChannelDescription>& channelList)
+{
+    if (netId != _netId || query["serial"].toInt() != _serial)
+        return;
+
+    _fetching = false;
+    _total = total;
+    if (offset == 0) {
+        beginResetModel();
+        _channelList = channelList;
+        endResetModel();
+    }
+    else if (offset == rowCount() && !channelList.isEmpty()) {
+        beginInsertRows(QModelIndex(), offset, offset + channelList.count() - 1);
+        _channelList.append(channelList);
+        endInsertRows();
+    }
+}
+
+void IrcListModel::channelListProgress(const NetworkId& netId, int receivedCount)
+{
+    Q_UNUSED(receivedCount)
+    if (netId != _netId || _fetching)
+        return;
+
+    // Keep the first page current while the list is still coming in. Everything else is refreshed
+    // once the list is complete, so rows don't jump around while the user scrolls.
+    if (rowCount() < kPageSize)
+        refresh();
+}
+
+void IrcListModel::finishedListReported(const NetworkId& netId)
+{
+    if (netId == _netId)
+        refresh();
+}
@@ -25,7 +25,15 @@
 #include <QAbstractItemModel>
 
 #include "irclisthelper.h"
+#include "types.h"
 
+/**
+ * Model for the channel list of a network.
+ *
+ * The model either shows a complete list handed to setChannelList(), or, for cores supporting
+ * Quassel::Feature::PagedChannelList, works on a list kept on the core. In the latter mode, filtering
+ * and sorting are done by the core and rows are fetched page by page as the view scrolls.
+ */
 class CLIENT_EXPORT IrcListModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -45,9 +53,50 @@ public:
     inline int rowCount(const QModelIndex& parent = QModelIndex()) const override { Q_UNUSED(parent) return _channelList.count(); }
     inline int columnCount(const QModelIndex& parent = QModelIndex()) const override { Q_UNUSED(parent) return 3; }
 
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    inline bool isPaged() const { return _netId.isValid(); }
+
 public slots:
     void setChannelList(const QList<IrcListHelper::ChannelDescription>& channelList = QList<IrcListHelper::ChannelDescription>());
 
+    /**
+     * Shows the channel list the core keeps for the given network, fetching it page by page
+     *
+     * @param netId The network whose channel list to show
+     */
+    void setPagedNetwork(const NetworkId& netId);
+
+    /**
+     * Shows only channels whose name starts with, or whose topic contains, the given text
+     *
+     * Only has an effect in paged mode.
+     */
+    void setFilterString(const QString& filter);
+
+private slots:
+    void receiveChannelListPage(const NetworkId& netId,
+                                const QVariantMap& query,
+                                int total,
+                                int offset,
+                                const QList<IrcListHelper::ChannelDescription>& channelList);
+    void channelListProgress(const NetworkId& netId, int receivedCount);
+    void finishedListReported(const NetworkId& netId);
+
 private:
+    /// Requests the first page again, replacing all rows once it arrives
+    void refresh();
+    void requestPage(int offset);
+
     QList<IrcListHelper::ChannelDescription> _channelList;
+
+    NetworkId _netId;
+    QString _filter;
+    int _sortColumn{0};
+    Qt::SortOrder _sortOrder{Qt::AscendingOrder};
+    int _serial{0};  ///< Identifies the current query, so replies to outdated ones can be dropped
+    int _total{0};
+    bool _fetching{false};
 };
@@ -22,22 +22,12 @@
 
 #include <algorithm>
 
-#include <QEvent>
-
 #include "backlogsettings.h"
 #include "client.h"
 #include "clientbacklogmanager.h"
 #include "message.h"
 #include "networkmodel.h"
 
-class ProcessBufferEvent : public QEvent
-{
-public:
-    inline ProcessBufferEvent()
-        : QEvent(QEvent::User)
-    {}
-};
-
 MessageModel::MessageModel(QObject* parent)
     : QAbstractItemModel(parent)
 {
@@ -78,8 +68,11 @@ bool MessageModel::setData(const QModelIndex& index, const QVariant& value, int
     return false;
 }
 
-bool MessageModel::insertMessage(const Message& msg, bool fakeMsg)
+bool MessageModel::insertMessage(const Message& message, bool fakeMsg)
 {
+    Message msg = message;
+    compactMessage(msg);
+
     MsgId id = msg.msgId();
     int idx = indexForId(id);
     if (!fakeMsg && idx < messageCount()) {  // check for duplicate
@@ -96,25 +89,38 @@ void MessageModel::insertMessages(const QList<Message>& msglist)
     if (msglist.isEmpty())
         return;
 
-    if (_messageBuffer.isEmpty()) {
-        int processedMsgs = insertMessagesGracefully(msglist);
-        int remainingMsgs = msglist.count() - processedMsgs;
-        if (remainingMsgs > 0) {
-            if (msglist.first().msgId() < msglist.last().msgId()) {
-                // in Order - we have just successfully processed "processedMsg" messages from the end of the list
-                _messageBuffer = msglist.mid(0, remainingMsgs);
-            }
-            else {
-                _messageBuffer = msglist.mid(processedMsgs);
-            }
-            std::sort(_messageBuffer.begin(), _messageBuffer.end());
-            QCoreApplication::postEvent(this, new ProcessBufferEvent());
-        }
+    QList<Message> compacted = msglist;
+    for (Message& msg : compacted) {
+        compactMessage(msg);
     }
-    else {
-        _messageBuffer << msglist;
-        std::sort(_messageBuffer.begin(), _messageBuffer.end());
+    // Strings of messages that have been removed from the model meanwhile are only held by the pool
+    if (_stringPool.size() > _stringPoolPruneSize) {
+        _stringPool.prune();
+        _stringPoolPruneSize = qMax(2 * _stringPool.size(), static_cast<int>(MinStringPoolPruneSize));
     }
+
+    prepareMessages(compacted);
+}
+
+void MessageModel::compactMessage(Message& msg)
+{
+    auto it = _bufferInfos.find(msg.bufferId());
+    if (it == _bufferInfos.end() || !it->isIdenticalTo(msg.bufferInfo()))
+        _bufferInfos.insert(msg.bufferId(), msg.bufferInfo());
+    else
+        msg.setBufferInfo(*it);
+
+    msg.shareStrings(_stringPool);
+}
+
+void MessageModel::prepareMessages(const QList<Message>& msglist)
+{
+    insertPreparedMessages(msglist);
+}
+
+void MessageModel::insertPreparedMessages(const QList<Message>& msglist)
+{
+    insertMessagesGracefully(msglist);
 }
 
 void MessageModel::insertMessageGroup(const QList<Message>& msglist)
@@ -183,148 +189,68 @@ void MessageModel::insertMessageGroup(const QList<Message>& msglist)
     Q_ASSERT(end + 1 == messageCount() || messageItemAt(end)->msgId() < messageItemAt(end + 1)->msgId());
 }
 
-int MessageModel::insertMessagesGracefully(const QList<Message>& msglist)
+void MessageModel::insertMessagesGracefully(const QList<Message>& msglist)
 {
     /* short description:
-     * 1) first we check where the message with the highest msgId from msglist would be inserted
-     * 2) check that position for dupe
-     * 3) determine the messageId of the preceding msg
-     * 4) insert as many msgs from msglist with with msgId larger then the just determined id
-     *    those messages are automatically less then the msg of the position we just determined in 1)
+     * 1) sort the incoming messages once, so we can merge them with the (sorted) model in a single pass
+     * 2) consecutive messages that fall between the same two existing messages form a group, which is inserted
+     *    with a single beginInsertRows()/endInsertRows() pair by insertMessageGroup()
+     * 3) we only need to search for the position in the model when a new group starts
      */
-    bool inOrder = (msglist.first().msgId() < msglist.last().msgId());
-    // depending on the order we have to traverse from the front to the back or vice versa
+    QList<Message> sorted = msglist;
+    if (!std::is_sorted(sorted.constBegin(), sorted.constEnd()))
+        std::sort(sorted.begin(), sorted.end());
 
     QList<Message> grouplist;
-    MsgId minId;
-    MsgId dupeId;
-    int processedMsgs = 1;  // we know the list isn't empty, so we at least process one message
-    int idx;
-    bool fastForward = false;
-    QList<Message>::const_iterator iter;
-    if (inOrder) {
-        iter = msglist.constEnd();
-        --iter;  // this op is safe as we've already passed an empty check
-    }
-    else {
-        iter = msglist.constBegin();
-    }
-
-    idx = indexForId((*iter).msgId());
-    if (idx < messageCount())
-        dupeId = messageItemAt(idx)->msgId();
-
-    // we always compare to the previous entry...
-    // if there isn't, we can fastforward to the top
-    if (idx - 1 >= 0)
-        minId = messageItemAt(idx - 1)->msgId();
-    else
-        fastForward = true;
-
-    if ((*iter).msgId() != dupeId) {
-        grouplist << *iter;
-        dupeId = (*iter).msgId();
-    }
-
-    if (!inOrder)
-        ++iter;
-
-    if (inOrder) {
-        while (iter != msglist.constBegin()) {
-            --iter;
-
-            if (!fastForward && (*iter).msgId() <= minId)
-                break;
-            processedMsgs++;
-
-            if (grouplist.isEmpty()) {  // as long as we don't have a starting point, we have to update the dupeId
-                idx = indexForId((*iter).msgId());
-                if (idx >= 0 && !messagesIsEmpty())
-                    dupeId = messageItemAt(idx)->msgId();
-            }
-            if ((*iter).msgId() != dupeId) {
-                if (!grouplist.isEmpty()) {
-                    QDateTime nextTs = grouplist.value(0).timestamp();
-                    QDateTime prevTs = (*iter).timestamp();
-                    nextTs.setTimeSpec(Qt::UTC);
-                    prevTs.setTimeSpec(Qt::UTC);
-                    qint64 nextDay = nextTs.toMSecsSinceEpoch() / DAY_IN_MSECS;
-                    qint64 prevDay = prevTs.toMSecsSinceEpoch() / DAY_IN_MSECS;
-                    if (nextDay != prevDay) {
-                        nextTs.setMSecsSinceEpoch(nextDay * DAY_IN_MSECS);
-                        nextTs.setTimeSpec(Qt::LocalTime);
-                        Message dayChangeMsg = Message::ChangeOfDay(nextTs);
-                        dayChangeMsg.setMsgId((*iter).msgId());
-                        grouplist.prepend(dayChangeMsg);
-                    }
-                }
-                dupeId = (*iter).msgId();
-                grouplist.prepend(*iter);
+    MsgId prevId;   // id of the last regular message in grouplist
+    MsgId limitId;  // id of the existing message following the current group, invalid if the group goes at the end
+    for (const Message& msg : sorted) {
+        MsgId id = msg.msgId();
+        if (!grouplist.isEmpty()) {
+            if (id == prevId)
+                continue;  // dupe within the incoming list
+            if (limitId.isValid() && id >= limitId) {
+                insertMessageGroup(grouplist);
+                grouplist.clear();
             }
         }
-    }
-    else {
-        while (iter != msglist.constEnd()) {
-            if (!fastForward && (*iter).msgId() <= minId)
-                break;
-            processedMsgs++;
-
-            if (grouplist.isEmpty()) {  // as long as we don't have a starting point, we have to update the dupeId
-                idx = indexForId((*iter).msgId());
-                if (idx >= 0 && !messagesIsEmpty())
-                    dupeId = messageItemAt(idx)->msgId();
-            }
-            if ((*iter).msgId() != dupeId) {
-                if (!grouplist.isEmpty()) {
-                    QDateTime nextTs = grouplist.value(0).timestamp();
-                    QDateTime prevTs = (*iter).timestamp();
-                    nextTs.setTimeSpec(Qt::UTC);
-                    prevTs.setTimeSpec(Qt::UTC);
-                    qint64 nextDay = nextTs.toMSecsSinceEpoch() / DAY_IN_MSECS;
-                    qint64 prevDay = prevTs.toMSecsSinceEpoch() / DAY_IN_MSECS;
-                    if (nextDay != prevDay) {
-                        nextTs.setMSecsSinceEpoch(nextDay * DAY_IN_MSECS);
-                        nextTs.setTimeSpec(Qt::LocalTime);
-                        Message dayChangeMsg = Message::ChangeOfDay(nextTs);
-                        dayChangeMsg.setMsgId((*iter).msgId());
-                        grouplist.prepend(dayChangeMsg);
-                    }
-                }
-                dupeId = (*iter).msgId();
-                grouplist.prepend(*iter);
+
+        if (grouplist.isEmpty()) {
+            int idx = indexForId(id);
+            limitId = idx < messageCount() ? messageItemAt(idx)->msgId() : MsgId();
+            if (id == limitId)
+                continue;  // dupe of a message we already have
+        }
+        else {
+            // grouplist.last() is always a regular message here, day change messages are only added right before one
+            QDateTime nextTs = msg.timestamp();
+            QDateTime prevTs = grouplist.last().timestamp();
+            nextTs.setTimeSpec(Qt::UTC);
+            prevTs.setTimeSpec(Qt::UTC);
+            qint64 nextDay = nextTs.toMSecsSinceEpoch() / DAY_IN_MSECS;
+            qint64 prevDay = prevTs.toMSecsSinceEpoch() / DAY_IN_MSECS;
+            if (nextDay != prevDay) {
+                nextTs.setMSecsSinceEpoch(nextDay * DAY_IN_MSECS);
+                nextTs.setTimeSpec(Qt::LocalTime);
+                Message dayChangeMsg = Message::ChangeOfDay(nextTs);
+                dayChangeMsg.setMsgId(prevId);
+                grouplist << dayChangeMsg;
             }
-            ++iter;
         }
+        grouplist << msg;
+        prevId = id;
     }
 
     if (!grouplist.isEmpty())
         insertMessageGroup(grouplist);
-    return processedMsgs;
-}
-
-void MessageModel::customEvent(QEvent* event)
-{
-    if (event->type() != QEvent::User)
-        return;
-
-    event->accept();
-
-    if (_messageBuffer.isEmpty())
-        return;
-
-    int processedMsgs = insertMessagesGracefully(_messageBuffer);
-    int remainingMsgs = _messageBuffer.count() - processedMsgs;
-
-    QList<Message>::iterator removeStart = _messageBuffer.begin() + remainingMsgs;
-    QList<Message>::iterator removeEnd = _messageBuffer.end();
-    _messageBuffer.erase(removeStart, removeEnd);
-    if (!_messageBuffer.isEmpty())
-        QCoreApplication::postEvent(this, new ProcessBufferEvent());
 }
 
 void MessageModel::clear()
 {
     _messagesWaiting.clear();
+    discardPreparedMessages();
+    _stringPool.clear();
+    _bufferInfos.clear();
     if (rowCount() > 0) {
         beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
         removeAllMessages();
@@ -27,6 +27,7 @@
 #include <QTimer>
 
 #include "message.h"
+#include "stringpool.h"
 #include "types.h"
 
 class MessageModelItem;
@@ -105,22 +106,38 @@ protected:
     virtual void removeAllMessages() = 0;
     virtual Message takeMessageAt(int i) = 0;
 
-    void customEvent(QEvent* event) override;
+    /**
+     * Hands a list of messages to the model for preparation before insertion.
+     *
+     * The default implementation inserts the messages right away. Subclasses may do expensive per-message work
+     * elsewhere first, and must then call insertPreparedMessages() with the same list once they're done.
+     */
+    virtual void prepareMessages(const QList<Message>& msglist);
+    //! Drops any messages handed to prepareMessages() that have not been inserted yet
+    virtual void discardPreparedMessages() {}
+    void insertPreparedMessages(const QList<Message>& msglist);
 
 private slots:
     void changeOfDay();
 
 private:
     void insertMessageGroup(const QList<Message>&);
-    int insertMessagesGracefully(const QList<Message>&);  // inserts as many contiguous msgs as possible. returns number of inserted msgs.
+    void insertMessagesGracefully(const QList<Message>&);  // merges msgs into the model, one row insertion per contiguous group
     int indexForId(MsgId);
+    //! Makes the message share its buffer info and sender strings with the messages already in the model
+    void compactMessage(Message& msg);
 
     //  QList<MessageModelItem *> _messageList;
-    QList<Message> _messageBuffer;
     QTimer _dayChangeTimer;
     QDateTime _nextDayChange;
     QHash<BufferId, int> _messagesWaiting;
 
+    StringPool _stringPool;
+    int _stringPoolPruneSize{MinStringPoolPruneSize};
+    QHash<BufferId, BufferInfo> _bufferInfos;  ///< The BufferInfo instance shared by all messages of a buffer
+
+    static const int MinStringPoolPruneSize = 4096;
+
     /// Period of time for one day in milliseconds
     /// 24 hours * 60 minutes * 60 seconds * 1000 milliseconds
     const qint64 DAY_IN_MSECS = 24 * 60 * 60 * 1000;
@@ -25,6 +25,7 @@
 
 #include <QAbstractItemView>
 #include <QMimeData>
+#include <QTimer>
 
 #include "buffermodel.h"
 #include "buffersettings.h"
@@ -791,6 +792,7 @@ void ChannelBufferItem::ircChannelParted()
     disconnect(_ircChannel, nullptr, this, nullptr);
     _ircChannel = nullptr;
     emit dataChanged();
+    _pendingUserItemRemovals.clear();
     removeAllChilds();
 }
 
@@ -799,10 +801,54 @@ void ChannelBufferItem::ircChannelDestroyed()
     if (_ircChannel) {
         _ircChannel = nullptr;
         emit dataChanged();
+        _pendingUserItemRemovals.clear();
         removeAllChilds();
     }
 }
 
+void ChannelBufferItem::removeUserItemLater(IrcUserItem* userItem)
+{
+    if (_pendingUserItemRemovals.isEmpty())
+        QTimer::singleShot(0, this, &ChannelBufferItem::removePendingUserItems);
+    _pendingUserItemRemovals.insert(userItem, userItem);
+}
+
+void ChannelBufferItem::removePendingUserItems()
+{
+    if (_pendingUserItemRemovals.isEmpty())
+        return;
+
+    QHash<UserCategoryItem*, QList<IrcUserItem*>> categories;
+    for (const QPointer<IrcUserItem>& userItem : _pendingUserItemRemovals) {
+        if (!userItem)
+            continue;
+        auto* categoryItem = qobject_cast<UserCategoryItem*>(userItem->parent());
+        if (categoryItem)
+            categories[categoryItem] << userItem.data();
+    }
+    _pendingUserItemRemovals.clear();
+
+    for (auto catIter = categories.constBegin(); catIter != categories.constEnd(); ++catIter) {
+        UserCategoryItem* categoryItem = catIter.key();
+        categoryItem->removeUsers(catIter.value());
+        if (categoryItem->childCount() == 0)
+            removeChild(categoryItem);
+    }
+}
+
+IrcUserItem* ChannelBufferItem::findIrcUserItem(IrcUser* ircUser)
+{
+    for (int i = 0; i < childCount(); i++) {
+        auto* categoryItem = qobject_cast<UserCategoryItem*>(child(i));
+        if (!categoryItem)
+            continue;
+        IrcUserItem* userItem = categoryItem->findIrcUser(ircUser);
+        if (userItem)
+            return userItem;
+    }
+    return nullptr;
+}
+
 void ChannelBufferItem::join(const QList<IrcUser*>& ircUsers)
 {
     addUsersToCategory(ircUsers);
@@ -832,6 +878,9 @@ void ChannelBufferItem::addUsersToCategory(const QList<IrcUser*>& ircUsers)
 {
     Q_ASSERT(_ircChannel);
 
+    // A user might rejoin before their part has been processed
+    removePendingUserItems();
+
     QHash<UserCategoryItem*, QList<IrcUser*>> categories;
 
     int categoryId = -1;
@@ -863,7 +912,11 @@ void ChannelBufferItem::part(IrcUser* ircUser)
     }
 
     disconnect(ircUser, nullptr, this, nullptr);
-    removeUserFromCategory(ircUser);
+    if (_ircChannel) {
+        IrcUserItem* userItem = findIrcUserItem(ircUser);
+        if (userItem)
+            removeUserItemLater(userItem);
+    }
     emit dataChanged(2);
 }
 
@@ -876,6 +929,8 @@ void ChannelBufferItem::removeUserFromCategory(IrcUser* ircUser)
         return;
     }
 
+    removePendingUserItems();
+
     UserCategoryItem* categoryItem = nullptr;
     for (int i = 0; i < childCount(); i++) {
         categoryItem = qobject_cast<UserCategoryItem*>(child(i));
@@ -891,6 +946,9 @@ void ChannelBufferItem::userModeChanged(IrcUser* ircUser)
 {
     Q_ASSERT(_ircChannel);
 
+    // Row moves must not race with queued removals
+    removePendingUserItems();
+
     int categoryId = UserCategoryItem::categoryFromModes(_ircChannel->userModes(ircUser));
     UserCategoryItem* categoryItem = findCategoryItem(categoryId);
 
@@ -905,16 +963,7 @@ void ChannelBufferItem::userModeChanged(IrcUser* ircUser)
     }
 
     // find the item that needs reparenting
-    IrcUserItem* ircUserItem = nullptr;
-    for (int i = 0; i < childCount(); i++) {
-        auto* oldCategoryItem = qobject_cast<UserCategoryItem*>(child(i));
-        Q_ASSERT(oldCategoryItem);
-        IrcUserItem* userItem = oldCategoryItem->findIrcUser(ircUser);
-        if (userItem) {
-            ircUserItem = userItem;
-            break;
-        }
-    }
+    IrcUserItem* ircUserItem = findIrcUserItem(ircUser);
 
     if (!ircUserItem) {
         qWarning() << "ChannelBufferItem::userModeChanged(IrcUser *): unable to determine old category of" << ircUser;
@@ -999,6 +1048,16 @@ bool UserCategoryItem::removeUser(IrcUser* ircUser)
     return success;
 }
 
+void UserCategoryItem::removeUsers(const QList<IrcUserItem*>& userItems)
+{
+    QList<AbstractTreeItem*> items;
+    items.reserve(userItems.count());
+    for (IrcUserItem* userItem : userItems)
+        items << userItem;
+    if (removeChilds(items))
+        emit dataChanged(0);
+}
+
 int UserCategoryItem::categoryFromModes(const QString& modes)
 {
     for (int i = 0; i < categories.count(); i++) {
@@ -1041,6 +1100,16 @@ IrcUserItem::IrcUserItem(IrcUser* ircUser, AbstractTreeItem* parent)
     connect(ircUser, &IrcUser::awaySet, this, [this]() { emit dataChanged(); });
 }
 
+void IrcUserItem::ircUserQuited()
+{
+    // Quits usually come in bulk, let the channel remove them together
+    auto* channelItem = qobject_cast<ChannelBufferItem*>(parent()->parent());
+    if (channelItem)
+        channelItem->removeUserItemLater(this);
+    else
+        parent()->removeChild(this);
+}
+
 QStringList IrcUserItem::propertyOrder() const
 {
     static QStringList order{"nickName"};
@@ -1083,6 +1152,11 @@ QString IrcUserItem::toolTip(int column) const
 
     // Use bufferName() for QueryBufferItem, nickName() for IrcUserItem
     tooltip << "<p class='bold' align='center'>" << NetworkItem::escapeHTML(nickName(), true);
+    if (!_ircUser) {
+        // The user is already gone, but the item is still waiting to be removed along with the other parted users
+        tooltip << "</p><p class='italic' align='center'>" << tr("No information available") << "</p></qt>";
+        return strTooltip;
+    }
     if (_ircUser->userModes() != "") {
         // TODO: Translate user Modes and add them to the table below and in QueryBufferItem::toolTip
         tooltip << " (" << _ircUser->userModes() << ")";
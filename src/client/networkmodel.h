@@ -198,6 +198,7 @@ private:
 /*****************************************
  *  ChannelBufferItem
  *****************************************/
+class IrcUserItem;
 class UserCategoryItem;
 
 class ChannelBufferItem : public BufferItem
@@ -216,6 +217,17 @@ public:
 
     void attachIrcChannel(IrcChannel* ircChannel);
 
+    /**
+     * Queues a user item for removal
+     *
+     * Parting and quitting users are removed together on the next event loop iteration, so a
+     * netsplit results in a few row removals instead of one per user.  Any other change to the
+     * user list removes the queued items first.
+     *
+     * @param userItem User item that belongs to this channel
+     */
+    void removeUserItemLater(IrcUserItem* userItem);
+
     /**
      * Gets the list of channel modes for a given nick.
      *
@@ -237,9 +249,13 @@ public slots:
 private slots:
     void ircChannelParted();
     void ircChannelDestroyed();
+    void removePendingUserItems();
 
 private:
+    IrcUserItem* findIrcUserItem(IrcUser* ircUser);
+
     IrcChannel* _ircChannel;
+    QHash<IrcUserItem*, QPointer<IrcUserItem>> _pendingUserItemRemovals;
 };
 
 /*****************************************
@@ -264,6 +280,7 @@ public:
     IrcUserItem* findIrcUser(IrcUser* ircUser);
     void addUsers(const QList<IrcUser*>& ircUser);
     bool removeUser(IrcUser* ircUser);
+    void removeUsers(const QList<IrcUserItem*>& userItems);
 
     static int categoryFromModes(const QString& modes);
 
@@ -301,7 +318,7 @@ public:
     QString channelModes() const;
 
 private slots:
-    inline void ircUserQuited() { parent()->removeChild(this); }
+    void ircUserQuited();
 
 private:
     QPointer<IrcUser> _ircUser;
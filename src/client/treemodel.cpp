@@ -24,6 +24,7 @@
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QSet>
 
 #include "quassel.h"
 
@@ -87,6 +88,45 @@ bool AbstractTreeItem::removeChild(int row)
     return true;
 }
 
+bool AbstractTreeItem::removeChilds(const QList<AbstractTreeItem*>& items)
+{
+    QSet<AbstractTreeItem*> itemSet;
+    for (AbstractTreeItem* item : items)
+        itemSet.insert(item);
+
+    QList<int> rows;
+    for (int i = 0; i < _childItems.count(); i++) {
+        if (itemSet.contains(_childItems.at(i)))
+            rows << i;
+    }
+    if (rows.isEmpty())
+        return false;
+
+    // Remove contiguous runs of rows back to front, so rows of the remaining runs stay valid
+    int last = rows.count() - 1;
+    while (last >= 0) {
+        int first = last;
+        while (first > 0 && rows.at(first - 1) == rows.at(first) - 1)
+            --first;
+
+        int firstRow = rows.at(first);
+        int lastRow = rows.at(last);
+        for (int row = firstRow; row <= lastRow; row++)
+            child(row)->removeAllChilds();
+
+        emit beginRemoveChilds(firstRow, lastRow);
+        for (int row = lastRow; row >= firstRow; row--)
+            delete _childItems.takeAt(row);
+        emit endRemoveChilds();
+
+        last = first - 1;
+    }
+
+    checkForDeletion();
+
+    return true;
+}
+
 void AbstractTreeItem::removeAllChilds()
 {
     const int numChilds = childCount();
@@ -302,6 +342,10 @@ TreeModel::TreeModel(const QList<QVariant>& data, QObject* parent)
     rootItem = new SimpleTreeItem(data, nullptr);
     connectItem(rootItem);
 
+    _dataChangedTimer.setSingleShot(true);
+    _dataChangedTimer.setInterval(0);
+    connect(&_dataChangedTimer, &QTimer::timeout, this, &TreeModel::flushDataChanged);
+
     if (Quassel::isOptionSet("debugmodel")) {
         connect(this, &QAbstractItemModel::rowsAboutToBeInserted, this, &TreeModel::debug_rowsAboutToBeInserted);
         connect(this, &QAbstractItemModel::rowsAboutToBeRemoved, this, &TreeModel::debug_rowsAboutToBeRemoved);
@@ -313,6 +357,7 @@ TreeModel::TreeModel(const QList<QVariant>& data, QObject* parent)
 
 TreeModel::~TreeModel()
 {
+    _pendingDataChanges.clear();
     delete rootItem;
 }
 
@@ -440,21 +485,70 @@ QVariant TreeModel::headerData(int section, Qt::Orientation orientation, int rol
 void TreeModel::itemDataChanged(int column)
 {
     auto* item = qobject_cast<AbstractTreeItem*>(sender());
-    QModelIndex leftIndex, rightIndex;
 
     if (item == rootItem)
         return;
 
+    ColumnRange columns;
     if (column == -1) {
-        leftIndex = createIndex(item->row(), 0, item);
-        rightIndex = createIndex(item->row(), item->columnCount() - 1, item);
+        columns = {0, item->columnCount() - 1};
     }
     else {
-        leftIndex = createIndex(item->row(), column, item);
-        rightIndex = leftIndex;
+        columns = {column, column};
     }
 
-    emit dataChanged(leftIndex, rightIndex);
+    auto it = _pendingDataChanges.find(item);
+    if (it != _pendingDataChanges.end()) {
+        it->first = qMin(it->first, columns.first);
+        it->last = qMax(it->last, columns.last);
+    }
+    else {
+        _pendingDataChanges.insert(item, columns);
+        if (!_dataChangedTimer.isActive())
+            _dataChangedTimer.start();
+    }
+}
+
+void TreeModel::flushDataChanged()
+{
+    _dataChangedTimer.stop();
+    if (_pendingDataChanges.isEmpty())
+        return;
+
+    struct Range
+    {
+        int firstRow;
+        int lastRow;
+        ColumnRange columns;
+    };
+    QHash<AbstractTreeItem*, Range> ranges;
+
+    for (auto it = _pendingDataChanges.constBegin(); it != _pendingDataChanges.constEnd(); ++it) {
+        AbstractTreeItem* parentItem = it.key()->parent();
+        if (!parentItem)
+            continue;
+        int row = it.key()->row();
+        if (row == -1)
+            continue;
+
+        auto rangeIt = ranges.find(parentItem);
+        if (rangeIt == ranges.end()) {
+            ranges.insert(parentItem, {row, row, it.value()});
+        }
+        else {
+            rangeIt->firstRow = qMin(rangeIt->firstRow, row);
+            rangeIt->lastRow = qMax(rangeIt->lastRow, row);
+            rangeIt->columns.first = qMin(rangeIt->columns.first, it->first);
+            rangeIt->columns.last = qMax(rangeIt->columns.last, it->last);
+        }
+    }
+    _pendingDataChanges.clear();
+
+    for (auto it = ranges.constBegin(); it != ranges.constEnd(); ++it) {
+        const Range& range = it.value();
+        emit dataChanged(createIndex(range.firstRow, range.columns.first, it.key()->child(range.firstRow)),
+                         createIndex(range.lastRow, range.columns.last, it.key()->child(range.lastRow)));
+    }
 }
 
 void TreeModel::connectItem(AbstractTreeItem* item)
@@ -476,6 +570,9 @@ void TreeModel::beginAppendChilds(int firstRow, int lastRow)
         return;
     }
 
+    // Row numbers of pending changes must refer to the current layout
+    flushDataChanged();
+
     QModelIndex parent = indexByItem(parentItem);
     Q_ASSERT(!_aboutToRemoveOrInsert);
 
@@ -513,6 +610,9 @@ void TreeModel::beginRemoveChilds(int firstRow, int lastRow)
         return;
     }
 
+    // Pending changes may refer to the items that are about to be deleted
+    flushDataChanged();
+
     for (int i = firstRow; i <= lastRow; i++) {
         disconnect(parentItem->child(i), nullptr, this, nullptr);
     }
@@ -23,9 +23,11 @@
 #include "client-export.h"
 
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QLinkedList>  // needed for debug
 #include <QList>
 #include <QStringList>
+#include <QTimer>
 #include <QVariant>
 
 /*****************************************
@@ -50,6 +52,7 @@ public:
 
     bool removeChild(int row);
     inline bool removeChild(AbstractTreeItem* child) { return removeChild(child->row()); }
+    bool removeChilds(const QList<AbstractTreeItem*>& items);
     void removeAllChilds();
 
     bool reParent(AbstractTreeItem* newParent);
@@ -173,6 +176,7 @@ public:
 
 private slots:
     void itemDataChanged(int column = -1);
+    void flushDataChanged();
 
     void beginAppendChilds(int firstRow, int lastRow);
     void endAppendChilds();
@@ -201,6 +205,16 @@ private:
     ChildStatus _childStatus;
     int _aboutToRemoveOrInsert;
 
+    // Item changes are collected and emitted as one dataChanged range per parent on the next
+    // event loop iteration, or right before the next row insertion or removal
+    struct ColumnRange
+    {
+        int first;
+        int last;
+    };
+    QHash<AbstractTreeItem*, ColumnRange> _pendingDataChanges;
+    QTimer _dataChangedTimer;
+
 private slots:
     void debug_rowsAboutToBeInserted(const QModelIndex& parent, int start, int end);
     void debug_rowsAboutToBeRemoved(const QModelIndex& parent, int start, int end);
@@ -56,6 +56,12 @@ QString BufferInfo::bufferName() const
         return nickFromMask(_bufferName);  // FIXME get rid of global functions and use the Network stuff instead!
 }
 
+bool BufferInfo::isIdenticalTo(const BufferInfo& other) const
+{
+    return _bufferId == other._bufferId && _netid == other._netid && _type == other._type && _groupId == other._groupId
+           && _bufferName == other._bufferName;
+}
+
 bool BufferInfo::acceptsRegularMessages() const
 {
     if (_type == StatusBuffer || _type == InvalidBuffer)
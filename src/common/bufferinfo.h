@@ -65,6 +65,8 @@ public:
     bool acceptsRegularMessages() const;
 
     inline bool operator==(const BufferInfo& other) const { return _bufferId == other._bufferId; }
+    //! Unlike operator==, also compares the network, type, group and name
+    bool isIdenticalTo(const BufferInfo& other) const;
 
 private:
     BufferId _bufferId;
@@ -105,6 +105,11 @@ qint64 Compressor::bytesAvailable() const
     return _readBuffer.size();
 }
 
+qint64 Compressor::bytesToWrite() const
+{
+    return _writeBuffer.size();
+}
+
 qint64 Compressor::read(char* data, qint64 maxSize)
 {
     if (maxSize <= 0)
@@ -248,10 +253,17 @@ void Compressor::writeData()
     // qDebug() << "deflate in:" << _deflater->total_in << "out:" << _deflater->total_out << "ratio:" << (double)_deflater->total_out/_deflater->total_in;
 }
 
+// Writes out everything that has been accumulated using NoFlush writes. With compression enabled, the whole batch
+// is deflated in one pass and ends in a single partial flush, rather than one per message.
 void Compressor::flush()
 {
-    if (compressionLevel() == NoCompression && _socket->state() == QAbstractSocket::ConnectedState)
-        _socket->flush();
+    if (_writeBuffer.isEmpty())
+        return;
+
+    if (_socket->state() != QAbstractSocket::ConnectedState) {
+        _writeBuffer.clear();
+        return;
+    }
 
-    // FIXME: missing impl for enabled compression; but then we're not using this method yet
+    writeData();
 }
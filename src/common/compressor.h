@@ -58,6 +58,7 @@ public:
     CompressionLevel compressionLevel() const { return _level; }
 
     qint64 bytesAvailable() const;
+    qint64 bytesToWrite() const;
 
     qint64 read(char* data, qint64 maxSize);
     qint64 write(const char* data, qint64 count, WriteBufferHint flush = Flush);
@@ -99,6 +99,7 @@ void HighlightRuleManager::initSetHighlightRuleList(const QVariantMap& highlight
     }
 
     _highlightRuleList.clear();
+    _compiledRulesInvalid = true;
     for (int i = 0; i < name.count(); i++) {
         _highlightRuleList << HighlightRule(id[i].toInt(),
                                             name[i],
@@ -120,6 +121,7 @@ void HighlightRuleManager::addHighlightRule(
 
     HighlightRule newItem = HighlightRule(id, name, isRegEx, isCaseSensitive, isActive, isInverse, sender, channel);
     _highlightRuleList << newItem;
+    _compiledRulesInvalid = true;
 
     SYNC(ARG(id), ARG(name), ARG(isRegEx), ARG(isCaseSensitive), ARG(isActive), ARG(isInverse), ARG(sender), ARG(channel))
 }
@@ -137,12 +139,17 @@ bool HighlightRuleManager::match(const NetworkId& netId,
         return false;
     }
 
+    if (_compiledRulesInvalid) {
+        compileRules();
+    }
+
+    // Strip formatting once instead of for every rule
+    const QString plainContents = stripFormatCodes(msgContents);
+
     bool matches = false;
 
-    for (int i = 0; i < _highlightRuleList.count(); i++) {
+    for (int i : _individualRules) {
         auto& rule = _highlightRuleList.at(i);
-        if (!rule.isEnabled())
-            continue;
 
         // Skip if channel name doesn't match and channel rule is not empty
         //
@@ -157,7 +164,7 @@ bool HighlightRuleManager::match(const NetworkId& netId,
         }
 
         // Check message according to specified rule, allowing empty rules to match
-        bool contentsMatch = rule.contentsMatcher().match(stripFormatCodes(msgContents), true);
+        bool contentsMatch = rule.contentsMatcher().match(plainContents, true);
 
         // Check sender according to specified rule, allowing empty rules to match
         bool senderMatch = rule.senderMatcher().match(msgSender, true);
@@ -176,11 +183,16 @@ bool HighlightRuleManager::match(const NetworkId& netId,
     if (matches)
         return true;
 
+    // All inverse rules have been checked above, so any combined phrase match is a highlight.
+    // Empty combined expressions never match here.
+    if (_phraseRulesMatch.match(plainContents) || _casePhraseRulesMatch.match(plainContents))
+        return true;
+
     // Check nicknames
     if (_highlightNick != HighlightNickType::NoNick && !currentNick.isEmpty()) {
         // Nickname matching allowed and current nickname is known
         // Run the nickname matcher on the unformatted string
-        if (_nickMatcher.match(stripFormatCodes(msgContents), netId, currentNick, identityNicks)) {
+        if (_nickMatcher.match(plainContents, netId, currentNick, identityNicks)) {
             return true;
         }
     }
@@ -188,6 +200,39 @@ bool HighlightRuleManager::match(const NetworkId& netId,
     return false;
 }
 
+void HighlightRuleManager::compileRules()
+{
+    _individualRules.clear();
+    QStringList phrases;
+    QStringList casePhrases;
+
+    for (int i = 0; i < _highlightRuleList.count(); i++) {
+        const HighlightRule& rule = _highlightRuleList.at(i);
+        if (!rule.isEnabled())
+            continue;
+
+        // Phrases containing newlines can't be expressed as part of a multi-phrase rule, and empty
+        // phrases match everything, so leave those to the individual checks
+        if (!rule.isInverse() && !rule.isRegEx() && !rule.contents().isEmpty() && !rule.contents().contains('\n')
+            && rule.senderMatcher().isEmpty() && rule.chanNameMatcher().isEmpty()) {
+            if (rule.isCaseSensitive())
+                casePhrases << rule.contents();
+            else
+                phrases << rule.contents();
+        }
+        else {
+            _individualRules << i;
+        }
+    }
+
+    // Multi-phrase matching is equivalent to checking each phrase on its own, as the regular
+    // expression engine tries every alternative at every position
+    _phraseRulesMatch = ExpressionMatch(phrases.join('\n'), ExpressionMatch::MatchMode::MatchMultiPhrase, false);
+    _casePhraseRulesMatch = ExpressionMatch(casePhrases.join('\n'), ExpressionMatch::MatchMode::MatchMultiPhrase, true);
+
+    _compiledRulesInvalid = false;
+}
+
 void HighlightRuleManager::removeHighlightRule(int highlightRule)
 {
     removeAt(indexOf(highlightRule));
@@ -200,6 +245,7 @@ void HighlightRuleManager::toggleHighlightRule(int highlightRule)
     if (idx == -1)
         return;
     _highlightRuleList[idx].setIsEnabled(!_highlightRuleList[idx].isEnabled());
+    _compiledRulesInvalid = true;
     SYNC(ARG(highlightRule))
 }
 
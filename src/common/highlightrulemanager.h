@@ -239,7 +239,7 @@ public:
          *
          * @return Expression matcher to compare with message contents
          */
-        inline ExpressionMatch contentsMatcher() const
+        inline const ExpressionMatch& contentsMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -252,7 +252,7 @@ public:
          *
          * @return Expression matcher to compare with message sender
          */
-        inline ExpressionMatch senderMatcher() const
+        inline const ExpressionMatch& senderMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -265,7 +265,7 @@ public:
          *
          * @return Expression matcher to compare with channel name
          */
-        inline ExpressionMatch chanNameMatcher() const
+        inline const ExpressionMatch& chanNameMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -304,9 +304,22 @@ public:
     inline bool contains(int rule) const { return indexOf(rule) != -1; }
     inline bool isEmpty() const { return _highlightRuleList.isEmpty(); }
     inline int count() const { return _highlightRuleList.count(); }
-    inline void removeAt(int index) { _highlightRuleList.removeAt(index); }
-    inline void clear() { _highlightRuleList.clear(); }
-    inline HighlightRule& operator[](int i) { return _highlightRuleList[i]; }
+    inline void removeAt(int index)
+    {
+        _highlightRuleList.removeAt(index);
+        _compiledRulesInvalid = true;
+    }
+    inline void clear()
+    {
+        _highlightRuleList.clear();
+        _compiledRulesInvalid = true;
+    }
+    inline HighlightRule& operator[](int i)
+    {
+        // The caller may modify the rule through the returned reference
+        _compiledRulesInvalid = true;
+        return _highlightRuleList[i];
+    }
     inline const HighlightRule& operator[](int i) const { return _highlightRuleList.at(i); }
     inline const HighlightRuleList& highlightRuleList() const { return _highlightRuleList; }
 
@@ -403,7 +416,11 @@ public slots:
     }
 
 protected:
-    void setHighlightRuleList(const QList<HighlightRule>& HighlightRuleList) { _highlightRuleList = HighlightRuleList; }
+    void setHighlightRuleList(const QList<HighlightRule>& HighlightRuleList)
+    {
+        _highlightRuleList = HighlightRuleList;
+        _compiledRulesInvalid = true;
+    }
 
     bool match(const NetworkId& netId,
                const QString& msgContents,
@@ -418,8 +435,22 @@ signals:
     void ruleAdded(QString name, bool isRegEx, bool isCaseSensitive, bool isEnabled, bool isInverse, QString sender, QString chanName);
 
 private:
-    HighlightRuleList _highlightRuleList = {};  ///< Custom highlight rule list
-    NickHighlightMatcher _nickMatcher = {};     ///< Nickname highlight matcher
+    /**
+     * Rebuild the compiled form of the highlight rule list
+     *
+     * Enabled, non-inverse phrase rules without a sender or channel restriction only need to be
+     * found anywhere in the message, so they are folded into one multi-phrase expression per
+     * case-sensitivity and checked with a single scan.  All other enabled rules still get checked
+     * one by one.
+     */
+    void compileRules();
+
+    HighlightRuleList _highlightRuleList = {};   ///< Custom highlight rule list
+    bool _compiledRulesInvalid = true;           ///< If true, compiled rules need to be rebuilt
+    QList<int> _individualRules = {};            ///< Indexes of enabled rules checked one by one
+    ExpressionMatch _phraseRulesMatch = {};      ///< Combined case-insensitive phrase rules
+    ExpressionMatch _casePhraseRulesMatch = {};  ///< Combined case-sensitive phrase rules
+    NickHighlightMatcher _nickMatcher = {};      ///< Nickname highlight matcher
 
     /// Nickname highlighting mode
     HighlightNickType _highlightNick = HighlightNickType::CurrentNick;
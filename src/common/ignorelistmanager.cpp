@@ -83,6 +83,7 @@ void IgnoreListManager::initSetIgnoreList(const QVariantMap& ignoreList)
     }
 
     _ignoreList.clear();
+    _compiledRulesInvalid = true;
     for (int i = 0; i < ignoreRule.count(); i++) {
         _ignoreList << IgnoreListItem(static_cast<IgnoreType>(ignoreType[i].toInt()),
                                       ignoreRule[i],
@@ -114,6 +115,7 @@ void IgnoreListManager::addIgnoreListItem(
                                             scopeRule,
                                             isActive);
     _ignoreList << newItem;
+    _compiledRulesInvalid = true;
 
     SYNC(ARG(type), ARG(ignoreRule), ARG(isRegEx), ARG(strictness), ARG(scope), ARG(scopeRule), ARG(isActive))
 }
@@ -127,30 +129,99 @@ IgnoreListManager::StrictnessType IgnoreListManager::_match(
     if (!(msgType & (Message::Plain | Message::Notice | Message::Action)))
         return UnmatchedStrictness;
 
-    foreach (IgnoreListItem item, _ignoreList) {
-        if (!item.isEnabled() || item.type() == CtcpIgnore)
+    if (_compiledRulesInvalid) {
+        compileRules();
+    }
+
+    const QString scopeKey = network + '\n' + bufferName;
+    const QVector<int>& rules = rulesForScope(scopeKey, network, bufferName);
+    if (rules.isEmpty())
+        return UnmatchedStrictness;
+
+    // The first matching rule in list order wins.  Sender rules only depend on the sender, so their
+    // result can be cached; message rules only need checking up to the first matching sender rule.
+    int senderMatch = firstSenderMatch(rules, scopeKey, msgSender);
+
+    QString contents;
+    bool contentsStripped = false;
+    for (int i : rules) {
+        if (senderMatch != -1 && i > senderMatch)
+            break;
+        const IgnoreListItem& item = _ignoreList.at(i);
+        if (item.type() != MessageIgnore)
             continue;
+        if (!contentsStripped) {
+            // TODO: Make this configurable?  Pre-0.14, format codes were not removed
+            contents = stripFormatCodes(msgContents);
+            contentsStripped = true;
+        }
+        if (item.contentsMatcher().match(contents)) {
+            return item.strictness();
+        }
+    }
+
+    if (senderMatch != -1)
+        return _ignoreList.at(senderMatch).strictness();
+
+    return UnmatchedStrictness;
+}
+
+void IgnoreListManager::compileRules()
+{
+    _enabledRules.clear();
+    for (int i = 0; i < _ignoreList.count(); i++) {
+        const IgnoreListItem& item = _ignoreList.at(i);
+        if (item.isEnabled() && item.type() != CtcpIgnore)
+            _enabledRules << i;
+    }
+    _scopeCache.clear();
+    _senderCache.clear();
+    _compiledRulesInvalid = false;
+}
+
+const QVector<int>& IgnoreListManager::rulesForScope(const QString& scopeKey, const QString& network, const QString& bufferName)
+{
+    auto it = _scopeCache.constFind(scopeKey);
+    if (it != _scopeCache.constEnd())
+        return *it;
+
+    QVector<int> rules;
+    for (int i : _enabledRules) {
+        const IgnoreListItem& item = _ignoreList.at(i);
         if (item.scope() == GlobalScope || (item.scope() == NetworkScope && item.scopeRuleMatcher().match(network))
             || (item.scope() == ChannelScope && item.scopeRuleMatcher().match(bufferName))) {
-            QString str;
-            if (item.type() == MessageIgnore) {
-                // TODO: Make this configurable?  Pre-0.14, format codes were not removed
-                str = stripFormatCodes(msgContents);
-            } else {
-                str = msgSender;
-            }
+            rules << i;
+        }
+    }
 
-            //      qDebug() << "IgnoreListManager::match: ";
-            //      qDebug() << "string: " << str;
-            //      qDebug() << "pattern: " << ruleRx.pattern();
-            //      qDebug() << "scopeRule: " << item.scopeRule;
-            //      qDebug() << "now testing";
-            if (item.contentsMatcher().match(str)) {
-                return item.strictness();
-            }
+    if (_scopeCache.size() >= MaxMatchCacheSize) {
+        // Cached sender results refer to the scope keys, so drop them along with the scopes
+        _scopeCache.clear();
+        _senderCache.clear();
+    }
+    return *_scopeCache.insert(scopeKey, rules);
+}
+
+int IgnoreListManager::firstSenderMatch(const QVector<int>& rules, const QString& scopeKey, const QString& msgSender)
+{
+    const QString key = scopeKey + '\n' + msgSender;
+    auto it = _senderCache.constFind(key);
+    if (it != _senderCache.constEnd())
+        return *it;
+
+    int result = -1;
+    for (int i : rules) {
+        const IgnoreListItem& item = _ignoreList.at(i);
+        if (item.type() == SenderIgnore && item.contentsMatcher().match(msgSender)) {
+            result = i;
+            break;
         }
     }
-    return UnmatchedStrictness;
+
+    if (_senderCache.size() >= MaxMatchCacheSize)
+        _senderCache.clear();
+    _senderCache.insert(key, result);
+    return result;
 }
 
 void IgnoreListManager::removeIgnoreListItem(const QString& ignoreRule)
@@ -165,12 +236,13 @@ void IgnoreListManager::toggleIgnoreRule(const QString& ignoreRule)
     if (idx == -1)
         return;
     _ignoreList[idx].setIsEnabled(!_ignoreList[idx].isEnabled());
+    _compiledRulesInvalid = true;
     SYNC(ARG(ignoreRule))
 }
 
 bool IgnoreListManager::ctcpMatch(const QString sender, const QString& network, const QString& type)
 {
-    foreach (IgnoreListItem item, _ignoreList) {
+    for (const IgnoreListItem& item : _ignoreList) {
         if (!item.isEnabled())
             continue;
         if (item.scope() == GlobalScope || (item.scope() == NetworkScope && item.scopeRuleMatcher().match(network))) {
@@ -24,9 +24,11 @@
 
 #include <utility>
 
+#include <QHash>
 #include <QRegExp>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
 #include "expressionmatch.h"
 #include "message.h"
@@ -269,7 +271,7 @@ public:
          *
          * @return Expression matcher to compare with message contents
          */
-        inline ExpressionMatch contentsMatcher() const
+        inline const ExpressionMatch& contentsMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -282,7 +284,7 @@ public:
          *
          * @return Expression matcher to compare with scope
          */
-        inline ExpressionMatch scopeRuleMatcher() const
+        inline const ExpressionMatch& scopeRuleMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -295,7 +297,7 @@ public:
          *
          * @return Expression matcher to compare with message contents
          */
-        inline ExpressionMatch senderCTCPMatcher() const
+        inline const ExpressionMatch& senderCTCPMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -336,8 +338,17 @@ public:
     inline bool contains(const QString& ignore) const { return indexOf(ignore) != -1; }
     inline bool isEmpty() const { return _ignoreList.isEmpty(); }
     inline int count() const { return _ignoreList.count(); }
-    inline void removeAt(int index) { _ignoreList.removeAt(index); }
-    inline IgnoreListItem& operator[](int i) { return _ignoreList[i]; }
+    inline void removeAt(int index)
+    {
+        _ignoreList.removeAt(index);
+        _compiledRulesInvalid = true;
+    }
+    inline IgnoreListItem& operator[](int i)
+    {
+        // The caller may modify the rule through the returned reference
+        _compiledRulesInvalid = true;
+        return _ignoreList[i];
+    }
     inline const IgnoreListItem& operator[](int i) const { return _ignoreList.at(i); }
     inline const IgnoreList& ignoreList() const { return _ignoreList; }
 
@@ -396,7 +407,11 @@ public slots:
         int type, const QString& ignoreRule, bool isRegEx, int strictness, int scope, const QString& scopeRule, bool isActive);
 
 protected:
-    void setIgnoreList(const QList<IgnoreListItem>& ignoreList) { _ignoreList = ignoreList; }
+    void setIgnoreList(const QList<IgnoreListItem>& ignoreList)
+    {
+        _ignoreList = ignoreList;
+        _compiledRulesInvalid = true;
+    }
 
     StrictnessType _match(
         const QString& msgContents, const QString& msgSender, Message::Type msgType, const QString& network, const QString& bufferName);
@@ -411,5 +426,43 @@ signals:
                      bool isActive);
 
 private:
+    /**
+     * Rebuild the compiled form of the ignore list, dropping all cached match results
+     */
+    void compileRules();
+
+    /**
+     * Gets the enabled message and sender rules that apply to the given network and buffer
+     *
+     * Scope rules are only evaluated once per network and buffer name until the ignore list
+     * changes.
+     *
+     * @param scopeKey    Cache key identifying the network and buffer name
+     * @param network     Network name
+     * @param bufferName  Buffer name
+     * @return Indexes of the applicable rules, in ignore list order
+     */
+    const QVector<int>& rulesForScope(const QString& scopeKey, const QString& network, const QString& bufferName);
+
+    /**
+     * Finds the first sender rule out of the given rules that matches the sender
+     *
+     * Results are cached per scope and sender until the ignore list changes.
+     *
+     * @param rules      Applicable rules as returned by rulesForScope()
+     * @param scopeKey   Cache key identifying the network and buffer name
+     * @param msgSender  Message sender
+     * @return Index of the first matching sender rule, or -1 if none matches
+     */
+    int firstSenderMatch(const QVector<int>& rules, const QString& scopeKey, const QString& msgSender);
+
     IgnoreList _ignoreList;
+
+    bool _compiledRulesInvalid = true;         ///< If true, compiled rules need to be rebuilt
+    QVector<int> _enabledRules;                ///< Indexes of enabled message and sender rules
+    QHash<QString, QVector<int>> _scopeCache;  ///< Applicable rules per network and buffer name
+    QHash<QString, int> _senderCache;          ///< First matching sender rule per scope and sender
+
+    /// Number of cached entries after which a match cache is dropped and started over
+    static const int MaxMatchCacheSize = 4096;
 };
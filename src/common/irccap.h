@@ -48,6 +48,13 @@ namespace IrcCap {
      */
     const uint ACCOUNT_NOTIFY_WHOX_NUM = 369;
 
+    /**
+     * Magic number for WHOX sent by periodic automatic WHOs of channels whose users are known
+     *
+     * These only ask for the channel, nickname, flags and, without account-notify, the account.
+     */
+    const uint AUTOWHO_REFRESH_WHOX_NUM = 370;
+
     /**
      * Send account information as a tag with all commands sent by a user.
      *
@@ -72,8 +72,9 @@ bool IrcChannel::isValidChannelUserMode(const QString& mode) const
 
 QString IrcChannel::userModes(IrcUser* ircuser) const
 {
-    if (_userModes.contains(ircuser))
-        return _userModes[ircuser];
+    auto it = _userModes.constFind(ircuser);
+    if (it != _userModes.constEnd())
+        return network()->userModesFromBits(*it);
     else
         return QString();
 }
@@ -123,7 +124,7 @@ QByteArray IrcChannel::encodeString(const QString& string) const
 // ====================
 void IrcChannel::setTopic(const QString& topic)
 {
-    _topic = topic;
+    _topic = network()->internString(topic);
     SYNC(ARG(topic))
     emit topicSet(topic);
 }
@@ -177,7 +178,7 @@ void IrcChannel::joinIrcUsers(const QList<IrcUser*>& users, const QStringList& m
             continue;
         }
 
-        _userModes[ircuser] = sortedModes[i];
+        _userModes[ircuser] = network()->userModeBits(sortedModes[i]);
         ircuser->joinChannel(this, true);
         connect(ircuser, &IrcUser::nickSet, this, selectOverload<QString>(&IrcChannel::ircUserNickSet));
 
@@ -248,8 +249,7 @@ void IrcChannel::part(const QString& nick)
 void IrcChannel::setUserModes(IrcUser* ircuser, const QString& modes)
 {
     if (isKnownUser(ircuser)) {
-        // Keep user modes sorted
-        _userModes[ircuser] = network()->sortPrefixModes(modes);
+        _userModes[ircuser] = network()->userModeBits(modes);
         QString nick = ircuser->nick();
         SYNC_OTHER(setUserModes, ARG(nick), ARG(modes))
         emit ircUserModesSet(ircuser, modes);
@@ -267,9 +267,9 @@ void IrcChannel::addUserMode(IrcUser* ircuser, const QString& mode)
     if (!isKnownUser(ircuser) || !isValidChannelUserMode(mode))
         return;
 
-    if (!_userModes[ircuser].contains(mode)) {
-        // Keep user modes sorted
-        _userModes[ircuser] = network()->sortPrefixModes(_userModes[ircuser] + mode);
+    quint32 bit = network()->userModeBits(mode);
+    if (bit && !(_userModes[ircuser] & bit)) {
+        _userModes[ircuser] |= bit;
         QString nick = ircuser->nick();
         SYNC_OTHER(addUserMode, ARG(nick), ARG(mode))
         emit ircUserModeAdded(ircuser, mode);
@@ -287,9 +287,9 @@ void IrcChannel::removeUserMode(IrcUser* ircuser, const QString& mode)
     if (!isKnownUser(ircuser) || !isValidChannelUserMode(mode))
         return;
 
-    if (_userModes[ircuser].contains(mode)) {
-        // Removing modes shouldn't mess up ordering
-        _userModes[ircuser].remove(mode);
+    quint32 bit = network()->userModeBits(mode);
+    if (_userModes[ircuser] & bit) {
+        _userModes[ircuser] &= ~bit;
         QString nick = ircuser->nick();
         SYNC_OTHER(removeUserMode, ARG(nick), ARG(mode));
         emit ircUserModeRemoved(ircuser, mode);
@@ -305,9 +305,9 @@ void IrcChannel::removeUserMode(const QString& nick, const QString& mode)
 QVariantMap IrcChannel::initUserModes() const
 {
     QVariantMap usermodes;
-    QHash<IrcUser*, QString>::const_iterator iter = _userModes.constBegin();
+    QHash<IrcUser*, quint32>::const_iterator iter = _userModes.constBegin();
     while (iter != _userModes.constEnd()) {
-        usermodes[iter.key()->nick()] = iter.value();
+        usermodes[iter.key()->nick()] = network()->userModesFromBits(iter.value());
         ++iter;
     }
     return usermodes;
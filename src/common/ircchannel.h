@@ -138,7 +138,7 @@ private:
     QString _password;
     bool _encrypted;
 
-    QHash<IrcUser*, QString> _userModes;
+    QHash<IrcUser*, quint32> _userModes;  ///< Channel user modes as bitsets, see Network::userModeBits()
 
     Network* _network;
 
@@ -34,6 +34,13 @@
  *  2.) RPL_LIST fills on the core the list of available channels
  *      when RPL_LISTEND is received the clients will be informed, that they can pull the data
  *  3.) client pulls the data by calling requestChannelList again. receiving the data in receiveChannelList
+ *
+ * With Quassel::Feature::PagedChannelList, step 3 is replaced: the core keeps the list and reports its
+ * growth with reportChannelListProgress() while RPL_LIST arrives, and the client fetches filtered and
+ * sorted pages of it with requestChannelListPage(). The query map understands the keys namePrefix,
+ * topicContains, matchAny (OR the two text filters instead of AND), minUsers, sortColumn (0: name,
+ * 1: users), sortOrder (a Qt::SortOrder), offset and limit. The query is passed back to receiveChannelListPage()
+ * along with a result map holding the page in "channels", plus "total", "offset", "received" and "finished".
  */
 class COMMON_EXPORT IrcListHelper : public SyncableObject
 {
@@ -65,6 +72,13 @@ public slots:
         return QVariantList();
     }
     inline virtual void receiveChannelList(const NetworkId&, const QStringList&, const QVariantList&){};
+    inline virtual QVariantMap requestChannelListPage(const NetworkId& netId, const QVariantMap& query)
+    {
+        REQUEST(ARG(netId), ARG(query));
+        return QVariantMap();
+    }
+    inline virtual void receiveChannelListPage(const NetworkId&, const QVariantMap&, const QVariantMap&){};
+    inline virtual void reportChannelListProgress(const NetworkId& netId, int receivedCount) { SYNC(ARG(netId), ARG(receivedCount)) }
     inline virtual void reportFinishedList(const NetworkId& netId) { SYNC(ARG(netId)) }
     inline virtual void reportError(const QString& error) { SYNC(ARG(error)) }
 };
@@ -32,17 +32,13 @@ IrcUser::IrcUser(const QString& hostmask, Network* network)
     : SyncableObject(network)
     , _initialized(false)
     , _nick(nickFromMask(hostmask))
-    , _user(userFromMask(hostmask))
-    , _host(hostFromMask(hostmask))
+    , _user(network->internString(userFromMask(hostmask)))
+    , _host(network->internString(hostFromMask(hostmask)))
     , _realName()
     , _awayMessage()
     , _away(false)
     , _server()
-    ,
-    // _idleTime(QDateTime::currentDateTime()),
-    _ircOperator()
     , _lastAwayMessageTime()
-    , _whoisServiceReply()
     , _encrypted(false)
     , _network(network)
     , _codecForEncoding(nullptr)
@@ -64,12 +60,22 @@ QString IrcUser::hostmask() const
 
 QDateTime IrcUser::idleTime()
 {
-    if ((QDateTime::currentDateTime().toMSecsSinceEpoch() - _idleTimeSet.toMSecsSinceEpoch()) > 1200000) {
+    if (!_whoisDetails)
+        return QDateTime();
+
+    if ((QDateTime::currentDateTime().toMSecsSinceEpoch() - _whoisDetails->idleTimeSet.toMSecsSinceEpoch()) > 1200000) {
         // 20 * 60 * 1000 = 1200000
         // 20 minutes have elapsed, clear the known idle time as it's likely inaccurate by now
-        _idleTime = QDateTime();
+        _whoisDetails->idleTime = QDateTime();
     }
-    return _idleTime;
+    return _whoisDetails->idleTime;
+}
+
+IrcUser::WhoisDetails& IrcUser::whoisDetails()
+{
+    if (!_whoisDetails)
+        _whoisDetails.reset(new WhoisDetails);
+    return *_whoisDetails;
 }
 
 QStringList IrcUser::channels() const
@@ -123,7 +129,7 @@ QByteArray IrcUser::encodeString(const QString& string) const
 void IrcUser::setUser(const QString& user)
 {
     if (!user.isEmpty() && _user != user) {
-        _user = user;
+        _user = network()->internString(user);
         SYNC(ARG(user));
     }
 }
@@ -131,7 +137,7 @@ void IrcUser::setUser(const QString& user)
 void IrcUser::setRealName(const QString& realName)
 {
     if (!realName.isEmpty() && _realName != realName) {
-        _realName = realName;
+        _realName = network()->internString(realName);
         SYNC(ARG(realName))
     }
 }
@@ -139,7 +145,7 @@ void IrcUser::setRealName(const QString& realName)
 void IrcUser::setAccount(const QString& account)
 {
     if (_account != account) {
-        _account = account;
+        _account = network()->internString(account);
         SYNC(ARG(account))
     }
 }
@@ -165,17 +171,17 @@ void IrcUser::setAwayMessage(const QString& awayMessage)
 
 void IrcUser::setIdleTime(const QDateTime& idleTime)
 {
-    if (idleTime.isValid() && _idleTime != idleTime) {
-        _idleTime = idleTime;
-        _idleTimeSet = QDateTime::currentDateTime();
+    if (idleTime.isValid() && this->idleTime() != idleTime) {
+        whoisDetails().idleTime = idleTime;
+        whoisDetails().idleTimeSet = QDateTime::currentDateTime();
         SYNC(ARG(idleTime))
     }
 }
 
 void IrcUser::setLoginTime(const QDateTime& loginTime)
 {
-    if (loginTime.isValid() && _loginTime != loginTime) {
-        _loginTime = loginTime;
+    if (loginTime.isValid() && this->loginTime() != loginTime) {
+        whoisDetails().loginTime = loginTime;
         SYNC(ARG(loginTime))
     }
 }
@@ -183,15 +189,15 @@ void IrcUser::setLoginTime(const QDateTime& loginTime)
 void IrcUser::setServer(const QString& server)
 {
     if (!server.isEmpty() && _server != server) {
-        _server = server;
+        _server = network()->internString(server);
         SYNC(ARG(server))
     }
 }
 
 void IrcUser::setIrcOperator(const QString& ircOperator)
 {
-    if (!ircOperator.isEmpty() && _ircOperator != ircOperator) {
-        _ircOperator = ircOperator;
+    if (!ircOperator.isEmpty() && this->ircOperator() != ircOperator) {
+        whoisDetails().ircOperator = network()->internString(ircOperator);
         SYNC(ARG(ircOperator))
     }
 }
@@ -222,7 +228,7 @@ void IrcUser::setLastAwayMessageTime(const QDateTime& lastAwayMessageTime)
 void IrcUser::setHost(const QString& host)
 {
     if (!host.isEmpty() && _host != host) {
-        _host = host;
+        _host = network()->internString(host);
         SYNC(ARG(host))
     }
 }
@@ -239,16 +245,16 @@ void IrcUser::setNick(const QString& nick)
 
 void IrcUser::setWhoisServiceReply(const QString& whoisServiceReply)
 {
-    if (!whoisServiceReply.isEmpty() && whoisServiceReply != _whoisServiceReply) {
-        _whoisServiceReply = whoisServiceReply;
+    if (!whoisServiceReply.isEmpty() && whoisServiceReply != this->whoisServiceReply()) {
+        whoisDetails().whoisServiceReply = whoisServiceReply;
         SYNC(ARG(whoisServiceReply))
     }
 }
 
 void IrcUser::setSuserHost(const QString& suserHost)
 {
-    if (!suserHost.isEmpty() && suserHost != _suserHost) {
-        _suserHost = suserHost;
+    if (!suserHost.isEmpty() && suserHost != this->suserHost()) {
+        whoisDetails().suserHost = suserHost;
         SYNC(ARG(suserHost))
     }
 }
@@ -22,6 +22,8 @@
 
 #include "common-export.h"
 
+#include <memory>
+
 #include <QDateTime>
 #include <QSet>
 #include <QString>
@@ -76,12 +78,12 @@ public:
     inline bool isAway() const { return _away; }
     inline QString awayMessage() const { return _awayMessage; }
     QDateTime idleTime();
-    inline QDateTime loginTime() const { return _loginTime; }
+    inline QDateTime loginTime() const { return _whoisDetails ? _whoisDetails->loginTime : QDateTime(); }
     inline QString server() const { return _server; }
-    inline QString ircOperator() const { return _ircOperator; }
+    inline QString ircOperator() const { return _whoisDetails ? _whoisDetails->ircOperator : QString(); }
     inline QDateTime lastAwayMessageTime() const { return _lastAwayMessageTime; }
-    inline QString whoisServiceReply() const { return _whoisServiceReply; }
-    inline QString suserHost() const { return _suserHost; }
+    inline QString whoisServiceReply() const { return _whoisDetails ? _whoisDetails->whoisServiceReply : QString(); }
+    inline QString suserHost() const { return _whoisDetails ? _whoisDetails->suserHost : QString(); }
     inline bool encrypted() const { return _encrypted; }
     inline Network* network() const { return _network; }
 
@@ -219,6 +221,26 @@ private:
      */
     inline void markAwayChanged() { _awayChanged = true; }
 
+    /**
+     * Details only known after a WHOIS, which most users never get one for
+     *
+     * Kept out of line so users without them don't pay for the empty members.
+     */
+    struct WhoisDetails
+    {
+        QDateTime idleTime;
+        QDateTime idleTimeSet;
+        QDateTime loginTime;
+        QString ircOperator;
+        QString whoisServiceReply;
+        QString suserHost;
+    };
+
+    /**
+     * Gets the WHOIS details for modification, creating them if needed
+     */
+    WhoisDetails& whoisDetails();
+
     bool _initialized;
 
     QString _nick;
@@ -229,14 +251,9 @@ private:
     QString _awayMessage;
     bool _away;
     QString _server;
-    QDateTime _idleTime;
-    QDateTime _idleTimeSet;
-    QDateTime _loginTime;
-    QString _ircOperator;
     QDateTime _lastAwayMessageTime;
-    QString _whoisServiceReply;
-    QString _suserHost;
     bool _encrypted;
+    std::unique_ptr<WhoisDetails> _whoisDetails;
 
     // QSet<QString> _channels;
     QSet<IrcChannel*> _channels;
@@ -21,10 +21,12 @@
 #include <utility>
 
 #include <QDataStream>
+#include <QVarLengthArray>
 
 #include "message.h"
 #include "peer.h"
 #include "signalproxy.h"
+#include "stringpool.h"
 #include "util.h"
 
 Message::Message(BufferInfo bufferInfo,
@@ -66,89 +68,188 @@ Message::Message(QDateTime ts,
     , _flags(flags)
 {}
 
-QDataStream& operator<<(QDataStream& out, const Message& msg)
+namespace {
+
+// Messages rarely exceed this, so encoding and decoding their strings usually doesn't need a heap allocation
+using Utf8Buffer = QVarLengthArray<char, 1024>;
+
+// Same as out << str.toUtf8(), but without creating a QByteArray
+void writeUtf8(QDataStream& out, const QString& str)
 {
-    Q_ASSERT(SignalProxy::current());
-    Q_ASSERT(SignalProxy::current()->targetPeer());
+    if (str.isNull()) {
+        out << (quint32)0xffffffff;
+        return;
+    }
+
+    Utf8Buffer utf8(str.size() * 3);
+    auto* dst = reinterpret_cast<uchar*>(utf8.data());
+    const ushort* src = str.utf16();
+    const ushort* end = src + str.size();
+    while (src < end) {
+        uint c = *src++;
+        if (c < 0x80) {
+            *dst++ = c;
+            continue;
+        }
+        if (c < 0x800) {
+            *dst++ = 0xc0 | (c >> 6);
+        }
+        else {
+            if (QChar::isHighSurrogate(c) && src < end && QChar::isLowSurrogate(*src)) {
+                c = QChar::surrogateToUcs4(c, *src++);
+                *dst++ = 0xf0 | (c >> 18);
+                *dst++ = 0x80 | ((c >> 12) & 0x3f);
+            }
+            else if (QChar::isSurrogate(c)) {
+                // Like QString::toUtf8(), which writes '?' for lone surrogates
+                *dst++ = '?';
+                continue;
+            }
+            else {
+                *dst++ = 0xe0 | (c >> 12);
+            }
+            *dst++ = 0x80 | ((c >> 6) & 0x3f);
+        }
+        *dst++ = 0x80 | (c & 0x3f);
+    }
+
+    auto size = static_cast<int>(dst - reinterpret_cast<uchar*>(utf8.data()));
+    out << (quint32)size;
+    out.writeRawData(utf8.constData(), size);
+}
+
+// Same as reading a QByteArray and converting it with QString::fromUtf8(), but without the intermediate QByteArray
+QString readUtf8(QDataStream& in)
+{
+    quint32 size;
+    in >> size;
+    if (in.status() != QDataStream::Ok || size == 0xffffffff)
+        return {};
 
-    out << msg.msgId();
+    // Peers limit the size of a whole protocol message to 64 MB
+    if (size > 64 * 1024 * 1024) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return {};
+    }
+
+    Utf8Buffer utf8(size);
+    if (in.readRawData(utf8.data(), size) != static_cast<int>(size)) {
+        in.setStatus(QDataStream::ReadPastEnd);
+        return {};
+    }
+    return QString::fromUtf8(utf8.constData(), size);
+}
+
+}  // namespace
+
+void Message::shareStrings(StringPool& pool)
+{
+    _sender = pool.intern(_sender);
+    _senderPrefixes = pool.intern(_senderPrefixes);
+    _realName = pool.intern(_realName);
+    _avatarUrl = pool.intern(_avatarUrl);
+}
+
+void Message::serialize(QDataStream& out, const Quassel::Features& features) const
+{
+    if (features.isEnabled(Quassel::Feature::LongMessageId))
+        out << _msgId.toQint64();
+    else
+        out << (qint32)_msgId.toQint64();
 
-    if (SignalProxy::current()->targetPeer()->hasFeature(Quassel::Feature::LongTime)) {
+    if (features.isEnabled(Quassel::Feature::LongTime)) {
         // toMSecs returns a qint64, signed rather than unsigned
-        out << (qint64) msg.timestamp().toMSecsSinceEpoch();
+        out << (qint64)_timestamp.toMSecsSinceEpoch();
     }
     else {
-        out << (quint32) msg.timestamp().toTime_t();
+        out << (quint32)_timestamp.toTime_t();
     }
 
-    out << (quint32) msg.type()
-        << (quint8) msg.flags()
-        << msg.bufferInfo()
-        << msg.sender().toUtf8();
+    out << (quint32)_type << (quint8)_flags;
+
+    out << _bufferInfo.bufferId().toInt() << _bufferInfo.networkId().toInt() << (qint16)_bufferInfo.type() << (quint32)_bufferInfo.groupId();
+    writeUtf8(out, _bufferInfo.bufferName());
+
+    writeUtf8(out, _sender);
 
-    if (SignalProxy::current()->targetPeer()->hasFeature(Quassel::Feature::SenderPrefixes))
-        out << msg.senderPrefixes().toUtf8();
+    if (features.isEnabled(Quassel::Feature::SenderPrefixes))
+        writeUtf8(out, _senderPrefixes);
 
-    if (SignalProxy::current()->targetPeer()->hasFeature(Quassel::Feature::RichMessages)) {
-        out << msg.realName().toUtf8();
-        out << msg.avatarUrl().toUtf8();
+    if (features.isEnabled(Quassel::Feature::RichMessages)) {
+        writeUtf8(out, _realName);
+        writeUtf8(out, _avatarUrl);
     }
 
-    out << msg.contents().toUtf8();
-    return out;
+    writeUtf8(out, _contents);
 }
 
-QDataStream& operator>>(QDataStream& in, Message& msg)
+void Message::deserialize(QDataStream& in, const Quassel::Features& features)
 {
-    Q_ASSERT(SignalProxy::current());
-    Q_ASSERT(SignalProxy::current()->sourcePeer());
-
-    in >> msg._msgId;
+    if (features.isEnabled(Quassel::Feature::LongMessageId)) {
+        qint64 msgId;
+        in >> msgId;
+        _msgId = msgId;
+    }
+    else {
+        qint32 msgId;
+        in >> msgId;
+        _msgId = msgId;
+    }
 
-    if (SignalProxy::current()->sourcePeer()->hasFeature(Quassel::Feature::LongTime)) {
+    if (features.isEnabled(Quassel::Feature::LongTime)) {
         // timestamp is a qint64, signed rather than unsigned
         qint64 timeStamp;
         in >> timeStamp;
-        msg._timestamp = QDateTime::fromMSecsSinceEpoch(timeStamp);
+        _timestamp = QDateTime::fromMSecsSinceEpoch(timeStamp);
     }
     else {
         quint32 timeStamp;
         in >> timeStamp;
-        msg._timestamp = QDateTime::fromTime_t(timeStamp);
+        _timestamp = QDateTime::fromTime_t(timeStamp);
     }
 
     quint32 type;
-    in >> type;
-    msg._type = Message::Type(type);
-
     quint8 flags;
-    in >> flags;
-    msg._flags = Message::Flags(flags);
+    in >> type >> flags;
+    _type = Message::Type(type);
+    _flags = Message::Flags(flags);
 
-    in >> msg._bufferInfo;
+    qint32 bufferId;
+    qint32 networkId;
+    qint16 bufferType;
+    quint32 groupId;
+    in >> bufferId >> networkId >> bufferType >> groupId;
+    QString bufferName = readUtf8(in);
+    _bufferInfo = BufferInfo(bufferId, networkId, (BufferInfo::Type)bufferType, groupId, std::move(bufferName));
 
-    QByteArray sender;
-    in >> sender;
-    msg._sender = QString::fromUtf8(sender);
+    _sender = readUtf8(in);
+    _senderPrefixes = features.isEnabled(Quassel::Feature::SenderPrefixes) ? readUtf8(in) : QString();
+    if (features.isEnabled(Quassel::Feature::RichMessages)) {
+        _realName = readUtf8(in);
+        _avatarUrl = readUtf8(in);
+    }
+    else {
+        _realName.clear();
+        _avatarUrl.clear();
+    }
+    _contents = readUtf8(in);
+}
 
-    QByteArray senderPrefixes;
-    if (SignalProxy::current()->sourcePeer()->hasFeature(Quassel::Feature::SenderPrefixes))
-        in >> senderPrefixes;
-    msg._senderPrefixes = QString::fromUtf8(senderPrefixes);
+QDataStream& operator<<(QDataStream& out, const Message& msg)
+{
+    Q_ASSERT(SignalProxy::current());
+    Q_ASSERT(SignalProxy::current()->targetPeer());
 
-    QByteArray realName;
-    QByteArray avatarUrl;
-    if (SignalProxy::current()->sourcePeer()->hasFeature(Quassel::Feature::RichMessages)) {
-        in >> realName;
-        in >> avatarUrl;
-    }
-    msg._realName = QString::fromUtf8(realName);
-    msg._avatarUrl = QString::fromUtf8(avatarUrl);
+    msg.serialize(out, SignalProxy::current()->targetPeer()->features());
+    return out;
+}
 
-    QByteArray contents;
-    in >> contents;
-    msg._contents = QString::fromUtf8(contents);
+QDataStream& operator>>(QDataStream& in, Message& msg)
+{
+    Q_ASSERT(SignalProxy::current());
+    Q_ASSERT(SignalProxy::current()->sourcePeer());
 
+    msg.deserialize(in, SignalProxy::current()->sourcePeer()->features());
     return in;
 }
 
@@ -26,8 +26,11 @@
 #include <QDateTime>
 
 #include "bufferinfo.h"
+#include "quassel.h"
 #include "types.h"
 
+class StringPool;
+
 class COMMON_EXPORT Message
 {
     Q_DECLARE_TR_FUNCTIONS(Message)
@@ -94,6 +97,7 @@ public:
     inline void setMsgId(MsgId id) { _msgId = id; }
 
     inline const BufferInfo& bufferInfo() const { return _bufferInfo; }
+    inline void setBufferInfo(const BufferInfo& info) { _bufferInfo = info; }
     inline const BufferId& bufferId() const { return _bufferInfo.bufferId(); }
     inline void setBufferId(BufferId id) { _bufferInfo.setBufferId(id); }
     inline const QString& contents() const { return _contents; }
@@ -110,6 +114,28 @@ public:
 
     inline bool operator<(const Message& other) const { return _msgId < other._msgId; }
 
+    /**
+     * Replaces the sender related strings with pooled copies, so they share memory with equal strings of other messages.
+     *
+     * @param pool The pool to take the strings from
+     */
+    void shareStrings(StringPool& pool);
+
+    /**
+     * Serializes the message in the wire format expected by a peer with the given features.
+     *
+     * This produces the same output as operator<<, but writes the fields directly without relying on
+     * SignalProxy::current() or creating temporary byte arrays, which matters for large backlog replies.
+     */
+    void serialize(QDataStream& out, const Quassel::Features& features) const;
+
+    /**
+     * Deserializes a message sent by a peer with the given features.
+     *
+     * Counterpart to serialize(). Check the stream status afterwards for errors.
+     */
+    void deserialize(QDataStream& in, const Quassel::Features& features);
+
 private:
     QDateTime _timestamp;
     MsgId _msgId;
@@ -122,7 +148,6 @@ private:
     Type _type;
     Flags _flags;
 
-    friend QDataStream& operator>>(QDataStream& in, Message& msg);
 };
 
 using MessageList = QList<Message>;
@@ -0,0 +1,212 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "metrics.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <QMutexLocker>
+
+namespace Metrics {
+
+int currentShard()
+{
+    static std::atomic<int> nextShard{0};
+    static thread_local int shard = nextShard.fetch_add(1, std::memory_order_relaxed) % ShardCount;
+    return shard;
+}
+
+qint64 monotonicMicroseconds()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ========================================
+//  Counter
+// ========================================
+void Counter::add(quint64 value)
+{
+    _shards[currentShard()].value.fetch_add(value, std::memory_order_relaxed);
+}
+
+quint64 Counter::value() const
+{
+    quint64 total = 0;
+    for (auto&& shard : _shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// ========================================
+//  Histogram
+// ========================================
+Histogram::Histogram(std::vector<qint64> bounds)
+    : _bounds(std::move(bounds))
+{
+    Q_ASSERT(std::is_sorted(_bounds.begin(), _bounds.end()));
+    for (auto&& shard : _shards) {
+        // One more bucket than bounds, for values above the last bound
+        shard.buckets.reset(new std::atomic<quint64>[_bounds.size() + 1]);
+        for (size_t i = 0; i <= _bounds.size(); ++i) {
+            shard.buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Histogram::observe(qint64 value)
+{
+    auto bucket = std::lower_bound(_bounds.begin(), _bounds.end(), value) - _bounds.begin();
+    auto& shard = _shards[currentShard()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.bounds = _bounds;
+    snapshot.buckets.resize(_bounds.size() + 1, 0);
+    for (auto&& shard : _shards) {
+        for (size_t i = 0; i <= _bounds.size(); ++i) {
+            snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    // Shards are read without synchronization, so derive the count from the buckets to keep the snapshot consistent
+    for (size_t i = 1; i < snapshot.buckets.size(); ++i) {
+        snapshot.buckets[i] += snapshot.buckets[i - 1];
+    }
+    snapshot.count = snapshot.buckets.back();
+    return snapshot;
+}
+
+std::vector<qint64> Histogram::exponentialBounds(qint64 start, int factor, int count)
+{
+    std::vector<qint64> bounds;
+    bounds.reserve(count);
+    for (qint64 bound = start; count > 0; --count, bound *= factor) {
+        bounds.push_back(bound);
+    }
+    return bounds;
+}
+
+// ========================================
+//  Registry
+// ========================================
+Registry& Registry::instance()
+{
+    static Registry registry;
+    return registry;
+}
+
+bool Registry::isEnabled() const
+{
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+void Registry::setEnabled(bool enabled)
+{
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+Counter* Registry::counter(const QString& name, const QString& help, const Labels& labels)
+{
+    if (!isEnabled())
+        return nullptr;
+
+    QMutexLocker locker(&_mutex);
+    auto& e = entry({name, help, Family::Type::Counter}, {}, labels);
+    if (!e.counter)
+        e.counter.reset(new Counter);
+    return e.counter.get();
+}
+
+Histogram* Registry::histogram(const QString& name,
+                               const QString& help,
+                               const std::vector<qint64>& bounds,
+                               double scale,
+                               const Labels& labels)
+{
+    if (!isEnabled())
+        return nullptr;
+
+    QMutexLocker locker(&_mutex);
+    auto& e = entry({name, help, Family::Type::Histogram, scale}, bounds, labels);
+    if (!e.histogram)
+        e.histogram.reset(new Histogram(bounds));
+    return e.histogram.get();
+}
+
+Registry::Entry& Registry::entry(const Family& family, const std::vector<qint64>& bounds, const Labels& labels)
+{
+    auto familyIt = std::find_if(_families.begin(), _families.end(), [&](const FamilyEntry& f) {
+        return f.family.name == family.name;
+    });
+    if (familyIt == _families.end()) {
+        _families.push_back({family, bounds, {}});
+        familyIt = std::prev(_families.end());
+    }
+    Q_ASSERT(familyIt->family.type == family.type);
+    Q_ASSERT(familyIt->bounds == bounds);
+
+    auto& entries = familyIt->entries;
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const Entry& e) { return e.labels == labels; });
+    if (it == entries.end()) {
+        entries.push_back({labels, {}, {}});
+        it = std::prev(entries.end());
+    }
+    return *it;
+}
+
+void Registry::collect(Exporter& exporter) const
+{
+    QMutexLocker locker(&_mutex);
+    for (auto&& f : _families) {
+        exporter.beginFamily(f.family);
+        for (auto&& e : f.entries) {
+            if (e.counter)
+                exporter.addCounter(f.family, e.labels, e.counter->value());
+            else if (e.histogram)
+                exporter.addHistogram(f.family, e.labels, e.histogram->snapshot());
+        }
+    }
+}
+
+// ========================================
+//  ScopedTimer
+// ========================================
+ScopedTimer::ScopedTimer(Histogram* histogram)
+    : _histogram(histogram)
+{
+    if (_histogram)
+        _start = monotonicMicroseconds();
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    if (_histogram)
+        _histogram->observe(monotonicMicroseconds() - _start);
+}
+
+}  // namespace Metrics
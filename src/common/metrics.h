@@ -0,0 +1,230 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common-export.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QMutex>
+#include <QString>
+
+/**
+ * Lightweight in-process metrics.
+ *
+ * Counters and histograms may be updated from any thread without locking. Every metric keeps a few shards of atomic
+ * accumulators and each thread sticks to one of them, so threads recording into the same metric rarely contend for the
+ * same cache line. Reading a metric sums up its shards, which only happens when metrics are exported.
+ *
+ * Metrics are created through the Registry, which hands out pointers that stay valid for the lifetime of the process.
+ * Callers are expected to look up their metrics once and keep the pointers around.
+ */
+namespace Metrics {
+
+using Labels = std::vector<std::pair<QString, QString>>;
+
+static constexpr int ShardCount = 8;
+
+/// Returns the index of the accumulator shard used by the calling thread
+COMMON_EXPORT int currentShard();
+
+/**
+ * A monotonically increasing counter.
+ */
+class COMMON_EXPORT Counter
+{
+public:
+    void add(quint64 value = 1);
+    quint64 value() const;
+
+private:
+    struct Shard
+    {
+        std::atomic<quint64> value{0};
+        char padding[64 - sizeof(std::atomic<quint64>)];  ///< Keeps shards on separate cache lines
+    };
+    std::array<Shard, ShardCount> _shards{};
+};
+
+/**
+ * A histogram with fixed bucket bounds.
+ *
+ * Values are integers in the metric's base unit (e.g. microseconds or bytes), the Registry's scale converts them for
+ * exporting.
+ */
+class COMMON_EXPORT Histogram
+{
+public:
+    struct Snapshot
+    {
+        std::vector<qint64> bounds;    ///< Inclusive upper bounds of the buckets, the +Inf bucket is implicit
+        std::vector<quint64> buckets;  ///< Cumulative counts per bucket, the last entry being the +Inf bucket
+        qint64 sum{0};
+        quint64 count{0};
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param bounds Inclusive upper bounds of the buckets in ascending order
+     */
+    explicit Histogram(std::vector<qint64> bounds);
+
+    void observe(qint64 value);
+    Snapshot snapshot() const;
+
+    /**
+     * Creates bucket bounds growing by a constant factor.
+     *
+     * @param start  Upper bound of the first bucket
+     * @param factor Factor between the bounds of consecutive buckets
+     * @param count  Number of buckets, not counting the +Inf bucket
+     */
+    static std::vector<qint64> exponentialBounds(qint64 start, int factor, int count);
+
+private:
+    struct Shard
+    {
+        std::unique_ptr<std::atomic<quint64>[]> buckets;
+        std::atomic<qint64> sum{0};
+        std::atomic<quint64> count{0};
+        char padding[64];  ///< Keeps the shard's totals away from the next shard's
+    };
+
+    std::vector<qint64> _bounds;
+    std::array<Shard, ShardCount> _shards;
+};
+
+/**
+ * Describes a metric and all its labelled instances.
+ */
+struct Family
+{
+    enum class Type {
+        Counter,
+        Histogram
+    };
+
+    QString name;
+    QString help;
+    Type type;
+    double scale{1};  ///< Factor applied to recorded values when exporting them
+};
+
+/**
+ * Interface for writing out the registered metrics in some format.
+ */
+class COMMON_EXPORT Exporter
+{
+public:
+    virtual ~Exporter() = default;
+
+    virtual void beginFamily(const Family& family) = 0;
+    virtual void addCounter(const Family& family, const Labels& labels, quint64 value) = 0;
+    virtual void addHistogram(const Family& family, const Labels& labels, const Histogram::Snapshot& snapshot) = 0;
+};
+
+/**
+ * Process-wide registry of metrics.
+ *
+ * The registry is disabled by default, in which case no metrics are created and callers get a nullptr instead, so
+ * recording costs nothing more than a null check.
+ */
+class COMMON_EXPORT Registry
+{
+public:
+    static Registry& instance();
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    /**
+     * Returns the counter with the given name and labels, creating it if needed.
+     *
+     * @returns The counter, or nullptr if the registry is disabled
+     */
+    Counter* counter(const QString& name, const QString& help, const Labels& labels = {});
+
+    /**
+     * Returns the histogram with the given name and labels, creating it if needed.
+     *
+     * All histograms of a family share the bounds and scale given when the family was first registered.
+     *
+     * @returns The histogram, or nullptr if the registry is disabled
+     */
+    Histogram* histogram(const QString& name,
+                         const QString& help,
+                         const std::vector<qint64>& bounds,
+                         double scale,
+                         const Labels& labels = {});
+
+    /// Passes all registered metrics to the given exporter, in order of registration
+    void collect(Exporter& exporter) const;
+
+private:
+    struct Entry
+    {
+        Labels labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    struct FamilyEntry
+    {
+        Family family;
+        std::vector<qint64> bounds;
+        std::vector<Entry> entries;
+    };
+
+    Entry& entry(const Family& family, const std::vector<qint64>& bounds, const Labels& labels);
+
+    std::atomic<bool> _enabled{false};
+    mutable QMutex _mutex;
+    std::vector<FamilyEntry> _families;
+};
+
+/**
+ * Records the time spent in a scope into a histogram, in microseconds.
+ *
+ * Does nothing if no histogram is given.
+ */
+class COMMON_EXPORT ScopedTimer
+{
+public:
+    explicit ScopedTimer(Histogram* histogram);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram* _histogram;
+    qint64 _start{0};
+};
+
+/// Returns a monotonic timestamp in microseconds, for measuring durations recorded into histograms
+COMMON_EXPORT qint64 monotonicMicroseconds();
+
+}  // namespace Metrics
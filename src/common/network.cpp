@@ -231,6 +231,48 @@ QString Network::sortPrefixModes(const QString& modes) const
     return sortedModes;
 }
 
+quint32 Network::userModeBits(const QString& modes) const
+{
+    if (_userModeAlphabet.isEmpty())
+        _userModeAlphabet = prefixModes();
+
+    quint32 bits = 0;
+    for (const QChar& mode : modes) {
+        int index = _userModeAlphabet.indexOf(mode);
+        if (index < 0) {
+            if (_userModeAlphabet.size() >= 32) {
+                qWarning() << "Network" << networkId() << "has too many channel user modes, dropping" << mode;
+                continue;
+            }
+            index = _userModeAlphabet.size();
+            _userModeAlphabet += mode;
+        }
+        bits |= 1u << index;
+    }
+    return bits;
+}
+
+QString Network::userModesFromBits(quint32 bits) const
+{
+    QString modes;
+    for (int index = 0; bits; ++index, bits >>= 1) {
+        if (bits & 1)
+            modes += _userModeAlphabet[index];
+    }
+    // Bits are assigned in PREFIX order, unless modes were seen before PREFIX was known
+    return modes.size() > 1 ? sortPrefixModes(modes) : modes;
+}
+
+QString Network::internString(const QString& str)
+{
+    // Strings of users that have left meanwhile are only held by the pool
+    if (_stringPool.size() > _stringPoolPruneSize) {
+        _stringPool.prune();
+        _stringPoolPruneSize = qMax(2 * _stringPool.size(), static_cast<int>(MinStringPoolPruneSize));
+    }
+    return _stringPool.intern(str);
+}
+
 QStringList Network::nicks() const
 {
     // we don't use _ircUsers.keys() since the keys may be
@@ -37,6 +37,7 @@
 #include "ircchannel.h"
 #include "ircuser.h"
 #include "signalproxy.h"
+#include "stringpool.h"
 #include "syncableobject.h"
 #include "types.h"
 #include "util.h"
@@ -256,6 +257,35 @@ public:
     }
     /**@}*/
 
+    /**
+     * Gets the bits representing the given channel user modes
+     *
+     * Each mode gets a bit assigned the first time it is seen, starting with the modes from PREFIX in
+     * their order of priority. Modes beyond the 32nd distinct one cannot be represented and are dropped.
+     *
+     * @param modes User channelmodes
+     * @return Bitset of the user channelmodes
+     */
+    quint32 userModeBits(const QString& modes) const;
+
+    /**
+     * Converts a bitset from userModeBits() back into user channelmodes
+     *
+     * @param bits Bitset of user channelmodes
+     * @return Priority-sorted user channelmodes
+     */
+    QString userModesFromBits(quint32 bits) const;
+
+    /**
+     * Returns a copy of the string that shares its data with all equal strings interned before
+     *
+     * Used for IrcUser properties that repeat across many users, like servers and hosts.
+     *
+     * @param str The string to intern
+     * @return The shared copy of the string
+     */
+    virtual QString internString(const QString& str);
+
     ChannelModeType channelModeType(const QString& mode);
     inline ChannelModeType channelModeType(const QCharRef& mode) { return channelModeType(QString(mode)); }
 
@@ -735,6 +765,11 @@ private:
 
     mutable QString _prefixes;
     mutable QString _prefixModes;
+    mutable QString _userModeAlphabet;  ///< User channelmodes in the order of their bits, see userModeBits()
+
+    StringPool _stringPool;
+    int _stringPoolPruneSize{MinStringPoolPruneSize};
+    static const int MinStringPoolPruneSize = 1024;
 
     QHash<QString, IrcUser*> _ircUsers;        // stores all known nicks for the server
     QHash<QString, IrcChannel*> _ircChannels;  // stores all known channels
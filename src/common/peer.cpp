@@ -25,6 +25,14 @@ Peer::Peer(AuthHandler* authHandler, QObject* parent)
     , _authHandler(authHandler)
 {}
 
+// Peer types without native support for batches just send the contained sync calls individually
+void Peer::dispatch(const Protocol::SyncBatch& msg)
+{
+    for (auto&& syncMessage : msg.syncMessages) {
+        dispatch(syncMessage);
+    }
+}
+
 AuthHandler* Peer::authHandler() const
 {
     return _authHandler;
@@ -65,7 +73,7 @@ bool Peer::hasFeature(Quassel::Feature feature) const
     return _features.isEnabled(feature);
 }
 
-Quassel::Features Peer::features() const
+const Quassel::Features& Peer::features() const
 {
     return _features;
 }
@@ -75,6 +83,11 @@ void Peer::setFeatures(Quassel::Features features)
     _features = std::move(features);
 }
 
+bool Peer::isCongested() const
+{
+    return false;
+}
+
 int Peer::id() const
 {
     return _id;
@@ -85,6 +98,22 @@ void Peer::setId(int id)
     _id = id;
 }
 
+void Peer::setDispatchMetrics(Metrics::Histogram* dispatchTime, Metrics::Histogram* messageSize)
+{
+    _dispatchTimeMetric = dispatchTime;
+    _messageSizeMetric = messageSize;
+}
+
+Metrics::Histogram* Peer::dispatchTimeMetric() const
+{
+    return _dispatchTimeMetric;
+}
+
+Metrics::Histogram* Peer::messageSizeMetric() const
+{
+    return _messageSizeMetric;
+}
+
 // PeerPtr is used in RPC signatures for enabling receivers to send replies
 // to a particular peer rather than broadcast to all connected ones.
 // To enable this, the SignalProxy transparently replaces the bogus value
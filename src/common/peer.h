@@ -31,6 +31,10 @@
 #include "quassel.h"
 #include "signalproxy.h"
 
+namespace Metrics {
+class Histogram;
+}
+
 class COMMON_EXPORT Peer : public QObject
 {
     Q_OBJECT
@@ -54,7 +58,7 @@ public:
     void setClientVersion(const QString& clientVersion);
 
     bool hasFeature(Quassel::Feature feature) const;
-    Quassel::Features features() const;
+    const Quassel::Features& features() const;
     void setFeatures(Quassel::Features features);
 
     int id() const;
@@ -68,9 +72,28 @@ public:
 
     virtual int lag() const = 0;
 
+    /**
+     * Whether the peer currently can't keep up with the data sent to it.
+     *
+     * While a peer is congested, SignalProxy applies the congestion policies configured for it, e.g. coalescing
+     * superseded sync calls.
+     *
+     * @returns true if the peer is congested
+     */
+    virtual bool isCongested() const;
+
     virtual QString address() const = 0;
     virtual quint16 port() const = 0;
 
+    /**
+     * Sets the histograms recording how long dispatching a message to this peer takes, and how large it is.
+     *
+     * Either may be nullptr to skip recording.
+     */
+    void setDispatchMetrics(Metrics::Histogram* dispatchTime, Metrics::Histogram* messageSize);
+    Metrics::Histogram* dispatchTimeMetric() const;
+    Metrics::Histogram* messageSizeMetric() const;
+
 public slots:
     /* Handshake messages */
     virtual void dispatch(const Protocol::RegisterClient&) = 0;
@@ -86,6 +109,7 @@ public slots:
 
     /* Sigproxy messages */
     virtual void dispatch(const Protocol::SyncMessage&) = 0;
+    virtual void dispatch(const Protocol::SyncBatch&);
     virtual void dispatch(const Protocol::RpcCall&) = 0;
     virtual void dispatch(const Protocol::InitRequest&) = 0;
     virtual void dispatch(const Protocol::InitData&) = 0;
@@ -96,6 +120,7 @@ signals:
     void disconnected();
     void secureStateChanged(bool secure = true);
     void lagUpdated(int msecs);
+    void congestionChanged(bool congested);
 
 protected:
     template<typename T>
@@ -111,6 +136,9 @@ private:
     Quassel::Features _features;
 
     int _id = -1;
+
+    Metrics::Histogram* _dispatchTimeMetric{nullptr};
+    Metrics::Histogram* _messageSizeMetric{nullptr};
 };
 
 // We need to special-case Peer* in attached signals/slots, so typedef it for the meta type system
@@ -205,6 +205,21 @@ struct SyncMessage : public SignalProxyMessage
     QVariantList params;
 };
 
+/**
+ * Sync calls collected during a single event loop iteration, to be applied in order by the receiver.
+ *
+ * Only sent to peers supporting Quassel::Feature::SyncBatching.
+ */
+struct SyncBatch : public SignalProxyMessage
+{
+    SyncBatch() = default;
+    SyncBatch(QList<SyncMessage> syncMessages)
+        : syncMessages(std::move(syncMessages))
+    {}
+
+    QList<SyncMessage> syncMessages;
+};
+
 struct RpcCall : public SignalProxyMessage
 {
     RpcCall() = default;
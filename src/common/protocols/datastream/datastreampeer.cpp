@@ -31,6 +31,12 @@
 
 using namespace Protocol;
 
+namespace {
+// Outgoing messages are serialized into a buffer that keeps its capacity between messages, unless it grew beyond this
+const int maxRetainedSerializeBufferSize = 1024 * 1024;
+const int initialSerializeBufferSize = 4 * 1024;
+}  // namespace
+
 DataStreamPeer::DataStreamPeer(
     ::AuthHandler* authHandler, QTcpSocket* socket, quint16 features, Compressor::CompressionLevel level, QObject* parent)
     : RemotePeer(authHandler, socket, level, parent)
@@ -87,12 +93,20 @@ void DataStreamPeer::writeMessage(const QVariantMap& handshakeMsg)
 
 void DataStreamPeer::writeMessage(const QVariantList& sigProxyMsg)
 {
-    QByteArray data;
-    QDataStream msgStream(&data, QIODevice::WriteOnly);
-    msgStream.setVersion(QDataStream::Qt_4_2);
-    msgStream << sigProxyMsg;
+    // resize() keeps the allocation, since the capacity has been reserved explicitly
+    if (_serializeBuffer.capacity() < initialSerializeBufferSize)
+        _serializeBuffer.reserve(initialSerializeBufferSize);
+    _serializeBuffer.resize(0);
+    {
+        QDataStream msgStream(&_serializeBuffer, QIODevice::WriteOnly);
+        msgStream.setVersion(QDataStream::Qt_4_2);
+        msgStream << sigProxyMsg;
+    }
+
+    writeMessage(_serializeBuffer);
 
-    writeMessage(data);
+    if (_serializeBuffer.capacity() > maxRetainedSerializeBufferSize)
+        _serializeBuffer = QByteArray();
 }
 
 /*** Handshake messages ***/
@@ -323,6 +337,23 @@ void DataStreamPeer::handlePackedFunc(const QVariantList& packedFunc)
         handle(Protocol::SyncMessage(className, objectName, slotName, params));
         break;
     }
+    case SyncBatch: {
+        // Each sync call is transmitted as className, objectName, slotName and the list of parameters
+        if (params.isEmpty() || params.count() % 4 != 0) {
+            qWarning() << Q_FUNC_INFO << "Received invalid sync batch:" << params;
+            return;
+        }
+        QList<Protocol::SyncMessage> syncMessages;
+        syncMessages.reserve(params.count() / 4);
+        for (int i = 0; i < params.count(); i += 4) {
+            syncMessages.append(Protocol::SyncMessage(params[i].toByteArray(),
+                                                      QString::fromUtf8(params[i + 1].toByteArray()),
+                                                      params[i + 2].toByteArray(),
+                                                      params[i + 3].toList()));
+        }
+        handle(Protocol::SyncBatch(std::move(syncMessages)));
+        break;
+    }
     case RpcCall: {
         if (params.empty()) {
             qWarning() << Q_FUNC_INFO << "Received empty RPC call!";
@@ -381,6 +412,17 @@ void DataStreamPeer::dispatch(const Protocol::SyncMessage& msg)
     dispatchPackedFunc(QVariantList() << (qint16)Sync << msg.className << msg.objectName.toUtf8() << msg.slotName << msg.params);
 }
 
+void DataStreamPeer::dispatch(const Protocol::SyncBatch& msg)
+{
+    QVariantList packedFunc;
+    packedFunc.reserve(1 + 4 * msg.syncMessages.size());
+    packedFunc << (qint16)SyncBatch;
+    for (auto&& syncMessage : msg.syncMessages) {
+        packedFunc << syncMessage.className << syncMessage.objectName.toUtf8() << syncMessage.slotName << QVariant(syncMessage.params);
+    }
+    dispatchPackedFunc(packedFunc);
+}
+
 void DataStreamPeer::dispatch(const Protocol::RpcCall& msg)
 {
     dispatchPackedFunc(QVariantList() << (qint16)RpcCall << msg.signalName << msg.params);
@@ -21,11 +21,13 @@
 #ifndef DATASTREAMPEER_H
 #define DATASTREAMPEER_H
 
+#include "common-export.h"
+
 #include "../../remotepeer.h"
 
 class QDataStream;
 
-class DataStreamPeer : public RemotePeer
+class COMMON_EXPORT DataStreamPeer : public RemotePeer
 {
     Q_OBJECT
 
@@ -37,7 +39,8 @@ public:
         InitRequest,
         InitData,
         HeartBeat,
-        HeartBeatReply
+        HeartBeatReply,
+        SyncBatch
     };
 
     DataStreamPeer(AuthHandler* authHandler, QTcpSocket* socket, quint16 features, Compressor::CompressionLevel level, QObject* parent = nullptr);
@@ -61,6 +64,7 @@ public:
     void dispatch(const Protocol::SessionState& msg) override;
 
     void dispatch(const Protocol::SyncMessage& msg) override;
+    void dispatch(const Protocol::SyncBatch& msg) override;
     void dispatch(const Protocol::RpcCall& msg) override;
     void dispatch(const Protocol::InitRequest& msg) override;
     void dispatch(const Protocol::InitData& msg) override;
@@ -80,6 +84,8 @@ private:
     void handleHandshakeMessage(const QVariantList& mapData);
     void handlePackedFunc(const QVariantList& packedFunc);
     void dispatchPackedFunc(const QVariantList& packedFunc);
+
+    QByteArray _serializeBuffer;  ///< Reused for serializing outgoing messages, to avoid reallocating it for each one
 };
 
 #endif
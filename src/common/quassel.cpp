@@ -347,6 +347,10 @@ void Quassel::setupCliParser()
             {"listen", tr("The address(es) quasselcore will listen on."), tr("<address>[,<address>[,...]]"), "::,0.0.0.0"},
             {{"p", "port"}, tr("The port quasselcore will listen at."), tr("port"), "4242"},
             {{"n", "norestore"}, tr("Don't restore last core's state.")},
+            {"restore-parallel",
+             tr("How many user sessions to restore in parallel on startup. The default of 0 restores one per CPU core."),
+             tr("count"),
+             "0"},
             {"config-from-environment", tr("Load configuration from environment variables.")},
             {"select-backend", tr("Switch storage backend (migrating data if possible)."), tr("backendidentifier")},
             {"select-authenticator", tr("Select authentication backend."), tr("authidentifier")},
@@ -354,6 +358,21 @@ void Quassel::setupCliParser()
             {"change-userpass",
              tr("Starts an interactive session to change the password of the user identified by <username>."),
              tr("username")},
+            {"password-hash-cost",
+             tr("Cost of hashing passwords as a power of two, between 10 and 20. Each step doubles the time and memory "
+                "needed; the default of 14 uses 16 MiB per hash. Existing passwords are rehashed on the next login."),
+             tr("cost"),
+             "14"},
+            {"auth-threads", tr("How many client logins to check in parallel."), tr("count"), "2"},
+            {"client-buffer-size",
+             tr("How much data may be queued for a client before it is considered congested, in KiB. Messages are "
+                "withheld from congested clients until the queue has drained to 1/16 of this size."),
+             tr("size"),
+             "8192"},
+            {"dcc-spool-size",
+             tr("Disk space each user's received DCC files may take up on the core until clients have fetched them, in MiB."),
+             tr("size"),
+             "1024"},
             {"strict-ident", tr("Use users' quasselcore username as ident reply. Ignores each user's configured ident setting.")},
             {"ident-daemon", tr("Enable internal ident daemon.")},
             {"ident-port",
@@ -363,6 +382,7 @@ void Quassel::setupCliParser()
             {"ident-listen", tr("The address(es) quasselcore will listen on for ident requests. Same format as --listen."), tr("<address>[,...]"), "::1,127.0.0.1"},
             {"oidentd", tr("Enable oidentd integration. In most cases you should also enable --strict-ident.")},
             {"oidentd-conffile", tr("Set path to oidentd configuration file."), tr("file")},
+            {"share-network-state", tr("Share IRC state like hosts and topics between users connected to the same network, to save memory.")},
             {"proxy-cidr", tr("Set IP range from which proxy protocol definitions are allowed"), tr("<address>[,...]"), "::1,127.0.0.1"},
             {"require-ssl", tr("Require SSL for remote (non-loopback) client connections.")},
             {"ssl-cert", tr("Specify the path to the SSL certificate."), tr("path"), "configdir/quasselCert.pem"},
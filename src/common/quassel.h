@@ -144,6 +144,10 @@ public:
         SyncedCoreInfo,       ///< CoreInfo dynamically updated using signals
         LoadBacklogForwards,  ///< Allow loading backlog in ascending order, old to new
         SkipIrcCaps,          ///< Control what IRCv3 capabilities are skipped during negotiation
+        SyncBatching,         ///< Multiple sync calls can be sent as a single SyncBatch message
+        BacklogAvailableNotices,  ///< Messages withheld from a congested client are announced for fetching from the backlog
+        SpooledTransfers,         ///< DCC receives are spooled on the core and fetched by the client from a given offset
+        PagedChannelList,         ///< Channel lists are kept on the core and queried by the client page by page
     };
     Q_ENUMS(Feature)
 
@@ -26,6 +26,7 @@
 #include <QSslSocket>
 #include <QTimer>
 
+#include "metrics.h"
 #include "proxyline.h"
 #include "remotepeer.h"
 #include "util.h"
@@ -34,6 +35,9 @@ using namespace Protocol;
 
 const quint32 maxMessageSize = 64 * 1024
                                * 1024;  // This is uncompressed size. 64 MB should be enough for any sort of initData or backlog chunk
+const qint64 maxWriteBatchSize = 64 * 1024;  // Write out a batch early once it exceeds this size, so large messages aren't delayed
+const qint64 defaultLowWatermark = 512 * 1024;
+const qint64 defaultHighWatermark = 8 * 1024 * 1024;
 
 RemotePeer::RemotePeer(::AuthHandler* authHandler, QTcpSocket* socket, Compressor::CompressionLevel level, QObject* parent)
     : Peer(authHandler, parent)
@@ -46,11 +50,15 @@ RemotePeer::RemotePeer(::AuthHandler* authHandler, QTcpSocket* socket, Compresso
     , _heartBeatCount(0)
     , _lag(0)
     , _msgSize(0)
+    , _writeBatchTimer(new QTimer(this))
+    , _lowWatermark(defaultLowWatermark)
+    , _highWatermark(defaultHighWatermark)
 {
     socket->setParent(this);
     connect(socket, &QAbstractSocket::stateChanged, this, &RemotePeer::onSocketStateChanged);
     connect(socket, selectOverload<QAbstractSocket::SocketError>(&QAbstractSocket::error), this, &RemotePeer::onSocketError);
     connect(socket, &QAbstractSocket::disconnected, this, &Peer::disconnected);
+    connect(socket, &QIODevice::bytesWritten, this, &RemotePeer::checkCongestion);
 
     auto* sslSocket = qobject_cast<QSslSocket*>(socket);
     if (sslSocket) {
@@ -61,6 +69,12 @@ RemotePeer::RemotePeer(::AuthHandler* authHandler, QTcpSocket* socket, Compresso
     connect(_compressor, &Compressor::error, this, &RemotePeer::onCompressionError);
 
     connect(_heartBeatTimer, &QTimer::timeout, this, &RemotePeer::sendHeartBeat);
+
+    // A zero-interval single-shot timer fires as soon as control returns to the event loop, which bounds the
+    // latency added by batching to the processing time of the current event loop iteration
+    _writeBatchTimer->setSingleShot(true);
+    _writeBatchTimer->setInterval(0);
+    connect(_writeBatchTimer, &QTimer::timeout, this, &RemotePeer::flushWriteBatch);
 }
 
 void RemotePeer::onSocketStateChanged(QAbstractSocket::SocketState state)
@@ -132,6 +146,7 @@ void RemotePeer::setSignalProxy(::SignalProxy* proxy)
 
     if (!proxy) {
         _heartBeatTimer->stop();
+        setWriteBatchingEnabled(false);
         disconnect(signalProxy(), nullptr, this, nullptr);
         _signalProxy = nullptr;
         if (isOpen())
@@ -146,6 +161,7 @@ void RemotePeer::setSignalProxy(::SignalProxy* proxy)
         connect(proxy, &SignalProxy::heartBeatIntervalChanged, this, &RemotePeer::changeHeartBeatInterval);
         _heartBeatTimer->setInterval(proxy->heartBeatInterval() * 1000);
         _heartBeatTimer->start();
+        setWriteBatchingEnabled(true);
     }
 }
 
@@ -169,6 +185,68 @@ QTcpSocket* RemotePeer::socket() const
     return _socket;
 }
 
+bool RemotePeer::isCongested() const
+{
+    return _congested;
+}
+
+qint64 RemotePeer::outputBufferSize() const
+{
+    qint64 size = _compressor->bytesToWrite();
+    if (socket())
+        size += socket()->bytesToWrite();
+    return size;
+}
+
+void RemotePeer::setOutputBufferWatermarks(qint64 low, qint64 high)
+{
+    _lowWatermark = low;
+    _highWatermark = qMax(low, high);
+    checkCongestion();
+}
+
+void RemotePeer::checkCongestion()
+{
+    qint64 size = outputBufferSize();
+    emit outputBufferSizeChanged(size);
+
+    if (!_congested && size > _highWatermark) {
+        _congested = true;
+        qWarning().nospace() << "Peer " << description() << " can't keep up, " << size << " bytes waiting to be sent";
+        emit congestionChanged(true);
+    }
+    else if (_congested && size < _lowWatermark) {
+        _congested = false;
+        qInfo().nospace() << "Peer " << description() << " is no longer congested";
+        emit congestionChanged(false);
+    }
+}
+
+bool RemotePeer::writeBatchingEnabled() const
+{
+    return _writeBatchingEnabled;
+}
+
+void RemotePeer::setWriteBatchingEnabled(bool enabled)
+{
+    if (enabled == _writeBatchingEnabled)
+        return;
+
+    _writeBatchingEnabled = enabled;
+    if (!enabled)
+        flushWriteBatch();
+}
+
+quint64 RemotePeer::framesWritten() const
+{
+    return _framesWritten;
+}
+
+quint64 RemotePeer::socketWrites() const
+{
+    return _socketWrites;
+}
+
 bool RemotePeer::isSecure() const
 {
     if (socket()) {
@@ -198,6 +276,9 @@ void RemotePeer::close(const QString& reason)
         qWarning() << "Disconnecting:" << reason;
     }
 
+    // Make sure queued messages (e.g. a ClientDenied explaining the disconnect) reach the peer
+    flushWriteBatch();
+
     if (socket() && socket()->state() != QTcpSocket::UnconnectedState) {
         socket()->disconnectFromHost();
     }
@@ -258,7 +339,36 @@ void RemotePeer::writeMessage(const QByteArray& msg)
 {
     auto size = qToBigEndian<quint32>(msg.size());
     _compressor->write((const char*)&size, 4, Compressor::NoFlush);
-    _compressor->write(msg.constData(), msg.size());
+    _compressor->write(msg.constData(), msg.size(), Compressor::NoFlush);
+    ++_batchFrames;
+    if (messageSizeMetric())
+        messageSizeMetric()->observe(msg.size() + 4);
+
+    if (!_writeBatchingEnabled || _compressor->bytesToWrite() >= maxWriteBatchSize) {
+        flushWriteBatch();
+        return;
+    }
+
+    if (!_writeBatchTimer->isActive())
+        _writeBatchTimer->start();
+}
+
+void RemotePeer::flushWriteBatch()
+{
+    _writeBatchTimer->stop();
+    if (!_batchFrames)
+        return;
+
+    qint64 bytes = _compressor->bytesToWrite();
+    int frames = _batchFrames;
+    _batchFrames = 0;
+    _compressor->flush();
+
+    _framesWritten += frames;
+    ++_socketWrites;
+    emit messagesWritten(frames, bytes);
+
+    checkCongestion();
 }
 
 void RemotePeer::handle(const HeartBeat& heartBeat)
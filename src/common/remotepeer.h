@@ -63,11 +63,40 @@ public:
 
     int lag() const override;
 
+    bool isCongested() const override;
+
+    /// Amount of data written to this peer, but not yet sent over the network
+    qint64 outputBufferSize() const;
+
+    /**
+     * Sets the output buffer watermarks for congestion detection.
+     *
+     * The peer becomes congested once its output buffer exceeds the high watermark, and recovers once the
+     * buffer has drained below the low watermark.
+     */
+    void setOutputBufferWatermarks(qint64 low, qint64 high);
+
     bool compressionEnabled() const;
     void setCompressionEnabled(bool enabled);
 
     QTcpSocket* socket() const;
 
+    /**
+     * Enables coalescing of outgoing messages.
+     *
+     * While enabled, messages written in the same event loop iteration are collected and sent as a single
+     * compressed block with a single socket write, either when control returns to the event loop or when the
+     * pending data exceeds the maximum batch size. Batching is enabled automatically once a SignalProxy is set,
+     * i.e. after the handshake phase (during which writes must hit the socket immediately, e.g. before STARTTLS).
+     */
+    bool writeBatchingEnabled() const;
+    void setWriteBatchingEnabled(bool enabled);
+
+    /// Total number of messages written to this peer
+    quint64 framesWritten() const;
+    /// Total number of (batched) writes to the socket
+    quint64 socketWrites() const;
+
 public slots:
     void close(const QString& reason = QString()) override;
 
@@ -76,6 +105,17 @@ signals:
     void socketError(QAbstractSocket::SocketError error, const QString& errorString);
     void statusMessage(const QString& msg);
 
+    /**
+     * Emitted whenever a batch of messages has been written to the socket.
+     *
+     * @param frames Number of messages contained in the batch
+     * @param bytes  Uncompressed size of the batch, including the length headers
+     */
+    void messagesWritten(int frames, qint64 bytes);
+
+    /// Emitted whenever data was added to or sent from the output buffer
+    void outputBufferSizeChanged(qint64 size);
+
     // Only used by LegacyPeer
     void protocolVersionMismatch(int actual, int expected);
 
@@ -102,6 +142,9 @@ private slots:
     void sendHeartBeat();
     void changeHeartBeatInterval(int secs);
 
+    void flushWriteBatch();
+    void checkCongestion();
+
 private:
     bool readMessage(QByteArray& msg);
 
@@ -115,4 +158,14 @@ private:
     int _heartBeatCount;
     int _lag;
     quint32 _msgSize;
+
+    bool _writeBatchingEnabled{false};
+    QTimer* _writeBatchTimer;
+    int _batchFrames{0};
+    quint64 _framesWritten{0};
+    quint64 _socketWrites{0};
+
+    qint64 _lowWatermark;
+    qint64 _highWatermark;
+    bool _congested{false};
 };
@@ -20,10 +20,14 @@
 
 #include "serializers.h"
 
+#include <algorithm>
+
+#include <QVarLengthArray>
+
 namespace {
 
 template<typename T>
-bool toVariant(QDataStream& stream, Quassel::Features features, QVariant& data)
+bool toVariant(QDataStream& stream, const Quassel::Features& features, QVariant& data)
 {
     T content;
     if (!Serializers::deserialize(stream, features, content)) {
@@ -54,6 +58,8 @@ bool Serializers::deserialize(QDataStream& stream, const Quassel::Features& feat
         qWarning() << "Peer sent too large QVariantList: " << size;
         return false;
     }
+    // Don't trust the size for allocating too much up front, the stream might be shorter
+    data.reserve(data.size() + static_cast<int>(std::min<uint32_t>(size, 4096)));
     for (uint32_t i = 0; i < size; i++) {
         QVariant element;
         if (!deserialize(stream, features, element))
@@ -93,11 +99,25 @@ bool Serializers::deserialize(QDataStream& stream, const Quassel::Features& feat
     if (!deserialize(stream, features, isNull))
         return false;
     if (type == Types::VariantType::UserType) {
-        QByteArray name;
-        if (!deserialize(stream, features, name))
+        // Type names are short, so read them into a stack buffer rather than allocating a QByteArray for every element
+        uint32_t length;
+        if (!deserialize(stream, features, length))
             return false;
-        while (name.length() > 0 && name.at(name.length() - 1) == 0)
-            name.chop(1);
+        QVarLengthArray<char, 32> rawName;
+        if (length != 0xffffffff) {
+            if (length > 1024) {
+                qWarning() << "Peer sent too large type name: " << length;
+                return false;
+            }
+            rawName.resize(length);
+            if (stream.readRawData(rawName.data(), length) != static_cast<int>(length)) {
+                qWarning() << "BufferUnderFlow while reading type name";
+                return false;
+            }
+        }
+        while (rawName.size() > 0 && rawName.at(rawName.size() - 1) == 0)
+            rawName.resize(rawName.size() - 1);
+        QByteArray name = QByteArray::fromRawData(rawName.constData(), rawName.size());
         if (!deserialize(stream, features, data, Types::fromName(name)))
             return false;
     }
@@ -468,8 +488,8 @@ bool Serializers::deserialize(QDataStream& stream, const Quassel::Features& feat
 
 bool Serializers::deserialize(QDataStream& stream, const Quassel::Features& features, Message& data)
 {
-    Q_UNUSED(features);
-    stream >> data;
+    // Backlog replies consist of little else, so don't go through operator>>, which looks up the peer's features for every field
+    data.deserialize(stream, features);
     return checkStreamValid(stream);
 }
 
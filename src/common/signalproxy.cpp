@@ -22,12 +22,14 @@
 #include <utility>
 
 #include <QCoreApplication>
+#include <QDataStream>
 #include <QHostAddress>
 #include <QMetaMethod>
 #include <QMetaProperty>
 #include <QSslSocket>
 #include <QThread>
 
+#include "metrics.h"
 #include "peer.h"
 #include "protocol.h"
 #include "signalproxy.h"
@@ -37,6 +39,16 @@
 
 using namespace Protocol;
 
+namespace {
+// Upper bound for the number of sync calls in a single SyncBatch; larger batches are sent early
+const int maxSyncBatchSize = 512;
+
+QByteArray syncCallName(const QByteArray& className, const QByteArray& slotName)
+{
+    return className + "::" + slotName;
+}
+}  // namespace
+
 class RemovePeerEvent : public QEvent
 {
 public:
@@ -167,6 +179,7 @@ bool SignalProxy::addPeer(Peer* peer)
 
     connect(peer, &Peer::disconnected, this, &SignalProxy::removePeerBySender);
     connect(peer, &Peer::secureStateChanged, this, &SignalProxy::updateSecureState);
+    connect(peer, &Peer::congestionChanged, this, [this, peer](bool congested) { onPeerCongestionChanged(peer, congested); });
 
     if (!peer->parent())
         peer->setParent(this);
@@ -214,7 +227,13 @@ void SignalProxy::removePeer(Peer* peer)
         return;
     }
 
+    // A peer that's still open (e.g. one being handed over after the handshake) gets its pending sync calls; for a
+    // closed one there's nobody left to send them to
+    if (peer->isOpen())
+        flushSyncBatch(peer);
     disconnect(peer, nullptr, this, nullptr);
+    _pendingSyncMessages.remove(peer);
+    _coalescedSyncCalls.remove(peer);
     peer->setSignalProxy(nullptr);
 
     _peerMap.remove(peer->id());
@@ -243,6 +262,11 @@ void SignalProxy::renameObject(const SyncableObject* obj, const QString& newname
     const QByteArray className(meta->className());
     objectRenamed(className, newname, oldname);
 
+    // Held calls refer to the old name, so they need to go out before the rename
+    for (auto&& peer : _coalescedSyncCalls.keys()) {
+        releaseCoalescedSyncCalls(peer, className, oldname);
+    }
+
     dispatch(RpcCall("__objectRenamed__", QVariantList() << className << newname << oldname));
 }
 
@@ -341,13 +365,25 @@ void SignalProxy::stopSynchronize(SyncableObject* obj)
 void SignalProxy::dispatchSignal(QByteArray sigName, QVariantList params)
 {
     RpcCall rpcCall{std::move(sigName), std::move(params)};
-    if (_restrictMessageTarget) {
-        for (auto&& peer : _restrictedTargets) {
-            dispatch(peer, rpcCall);
+    auto withheldIt = _withheldSignals.constFind(rpcCall.signalName);
+    if (withheldIt == _withheldSignals.constEnd()) {
+        if (_restrictMessageTarget) {
+            for (auto&& peer : _restrictedTargets) {
+                dispatch(peer, rpcCall);
+            }
+        }
+        else {
+            dispatch(rpcCall);
         }
+        return;
     }
-    else {
-        dispatch(rpcCall);
+
+    const auto peers = _restrictMessageTarget ? _restrictedTargets.values() : _peerMap.values();
+    for (auto&& peer : peers) {
+        if (peer && peer->isCongested() && peer->hasFeature(withheldIt.value()))
+            emit signalWithheld(peer, rpcCall.signalName, rpcCall.params);
+        else
+            dispatch(peer, rpcCall);
     }
 }
 
@@ -362,16 +398,158 @@ void SignalProxy::dispatch(const T& protoMessage)
 template<class T>
 void SignalProxy::dispatch(Peer* peer, const T& protoMessage)
 {
+    // Make sure that pending sync calls are not overtaken by this message
+    flushSyncBatch(peer);
+
     _targetPeer = peer;
 
-    if (peer && peer->isOpen())
+    if (peer && peer->isOpen()) {
+        Metrics::ScopedTimer timer{peer->dispatchTimeMetric()};
         peer->dispatch(protoMessage);
+    }
     else
         QCoreApplication::postEvent(this, new ::RemovePeerEvent(peer));
 
     _targetPeer = nullptr;
 }
 
+void SignalProxy::queueSyncMessage(Peer* peer, SyncMessage syncMessage)
+{
+    auto& pending = _pendingSyncMessages[peer];
+    pending.append(std::move(syncMessage));
+    if (pending.size() >= maxSyncBatchSize) {
+        flushSyncBatch(peer);
+        return;
+    }
+
+    if (!_syncBatchFlushScheduled) {
+        _syncBatchFlushScheduled = true;
+        QCoreApplication::postEvent(this, new QEvent(QEvent::Type(FlushSyncBatchesEvent)));
+    }
+}
+
+void SignalProxy::flushSyncBatch(Peer* peer)
+{
+    auto it = _pendingSyncMessages.find(peer);
+    if (it == _pendingSyncMessages.end())
+        return;
+
+    SyncBatch syncBatch{std::move(it.value())};
+    _pendingSyncMessages.erase(it);
+
+    if (syncBatch.syncMessages.isEmpty())
+        return;
+
+    _targetPeer = peer;
+    if (!peer->isOpen()) {
+        QCoreApplication::postEvent(this, new ::RemovePeerEvent(peer));
+    }
+    else {
+        Metrics::ScopedTimer timer{peer->dispatchTimeMetric()};
+        if (syncBatch.syncMessages.size() == 1)
+            peer->dispatch(syncBatch.syncMessages.first());
+        else
+            peer->dispatch(syncBatch);
+    }
+    _targetPeer = nullptr;
+}
+
+void SignalProxy::dispatchSyncMessage(Peer* peer, const SyncMessage& syncMessage)
+{
+    if (peer->isCongested() && _coalescableSyncCalls.contains(syncCallName(syncMessage.className, syncMessage.slotName))) {
+        // Identify the call by everything but its last argument, which carries the superseding value
+        QByteArray key;
+        {
+            _targetPeer = peer;
+            QDataStream out(&key, QIODevice::WriteOnly);
+            out << syncMessage.className << syncMessage.objectName << syncMessage.slotName;
+            for (int i = 0; i < syncMessage.params.size() - 1; ++i) {
+                out << syncMessage.params[i];
+            }
+            _targetPeer = nullptr;
+        }
+        auto& coalesced = _coalescedSyncCalls[peer];
+        auto indexIt = coalesced.indexByKey.constFind(key);
+        if (indexIt != coalesced.indexByKey.constEnd()) {
+            coalesced.syncMessages[indexIt.value()] = syncMessage;
+        }
+        else {
+            coalesced.append(key, syncMessage);
+        }
+        return;
+    }
+
+    // Held calls for this object must not be overtaken
+    if (_coalescedSyncCalls.contains(peer))
+        releaseCoalescedSyncCalls(peer, syncMessage.className, syncMessage.objectName);
+
+    if (peer->hasFeature(Quassel::Feature::SyncBatching))
+        queueSyncMessage(peer, syncMessage);
+    else
+        dispatch(peer, syncMessage);
+}
+
+void SignalProxy::releaseCoalescedSyncCalls(Peer* peer, const QByteArray& className, const QString& objectName)
+{
+    auto it = _coalescedSyncCalls.find(peer);
+    if (it == _coalescedSyncCalls.end())
+        return;
+
+    QList<SyncMessage> released;
+    if (className.isEmpty()) {
+        released = std::move(it->syncMessages);
+        _coalescedSyncCalls.erase(it);
+    }
+    else {
+        CoalescedSyncCalls remaining;
+        for (int i = 0; i < it->syncMessages.size(); ++i) {
+            const auto& syncMessage = it->syncMessages[i];
+            if (syncMessage.className == className && syncMessage.objectName == objectName)
+                released.append(syncMessage);
+            else
+                remaining.append(it->keys[i], syncMessage);
+        }
+        if (released.isEmpty())
+            return;
+        if (remaining.syncMessages.isEmpty())
+            _coalescedSyncCalls.erase(it);
+        else
+            it.value() = std::move(remaining);
+    }
+
+    for (auto&& syncMessage : released) {
+        if (peer->hasFeature(Quassel::Feature::SyncBatching))
+            queueSyncMessage(peer, syncMessage);
+        else
+            dispatch(peer, syncMessage);
+    }
+}
+
+void SignalProxy::onPeerCongestionChanged(Peer* peer, bool congested)
+{
+    if (!congested)
+        releaseCoalescedSyncCalls(peer);
+    emit peerCongestionChanged(peer, congested);
+}
+
+void SignalProxy::setCoalescableSyncCall(const QByteArray& className, const QByteArray& slotName)
+{
+    _coalescableSyncCalls.insert(syncCallName(className, slotName));
+}
+
+void SignalProxy::setWithheldWhenCongested(const QByteArray& signalName, Quassel::Feature requiredFeature)
+{
+    _withheldSignals[QMetaObject::normalizedSignature(signalName.constData())] = requiredFeature;
+}
+
+void SignalProxy::flushSyncBatches()
+{
+    _syncBatchFlushScheduled = false;
+    for (auto&& peer : _pendingSyncMessages.keys()) {
+        flushSyncBatch(peer);
+    }
+}
+
 void SignalProxy::handle(Peer* peer, const SyncMessage& syncMessage)
 {
     if (!_syncSlave.contains(syncMessage.className) || !_syncSlave[syncMessage.className].contains(syncMessage.objectName)) {
@@ -413,8 +591,12 @@ void SignalProxy::handle(Peer* peer, const SyncMessage& syncMessage)
         if (eMeta->argTypes(receiverId).count() > 1)
             returnParams << syncMessage.params;
         returnParams << returnValue;
+        flushSyncBatch(peer);
         _targetPeer = peer;
-        peer->dispatch(SyncMessage(syncMessage.className, syncMessage.objectName, eMeta->methodName(receiverId), returnParams));
+        {
+            Metrics::ScopedTimer timer{peer->dispatchTimeMetric()};
+            peer->dispatch(SyncMessage(syncMessage.className, syncMessage.objectName, eMeta->methodName(receiverId), returnParams));
+        }
         _targetPeer = nullptr;
     }
 
@@ -422,6 +604,13 @@ void SignalProxy::handle(Peer* peer, const SyncMessage& syncMessage)
     invokeSlot(receiver, eMeta->updatedRemotelyId());
 }
 
+void SignalProxy::handle(Peer* peer, const SyncBatch& syncBatch)
+{
+    for (auto&& syncMessage : syncBatch.syncMessages) {
+        handle(peer, syncMessage);
+    }
+}
+
 void SignalProxy::handle(Peer* peer, const RpcCall& rpcCall)
 {
     Q_UNUSED(peer)
@@ -448,8 +637,12 @@ void SignalProxy::handle(Peer* peer, const InitRequest& initRequest)
     }
 
     SyncableObject* obj = _syncSlave[initRequest.className][initRequest.objectName];
+    flushSyncBatch(peer);
     _targetPeer = peer;
-    peer->dispatch(InitData(initRequest.className, initRequest.objectName, initData(obj)));
+    {
+        Metrics::ScopedTimer timer{peer->dispatchTimeMetric()};
+        peer->dispatch(InitData(initRequest.className, initRequest.objectName, initData(obj)));
+    }
     _targetPeer = nullptr;
 }
 
@@ -569,6 +762,11 @@ void SignalProxy::customEvent(QEvent* event)
         break;
     }
 
+    case FlushSyncBatchesEvent:
+        flushSyncBatches();
+        event->accept();
+        break;
+
     default:
         qWarning() << Q_FUNC_INFO << "Received unknown custom event:" << event->type();
         return;
@@ -597,14 +795,19 @@ void SignalProxy::sync_call__(const SyncableObject* obj, SignalProxy::ProxyMode
         params << QVariant(argTypes[i], va_arg(ap, void*));
     }
 
+    SyncMessage syncMessage{eMeta->metaObject()->className(), obj->objectName(), QByteArray(funcname), params};
+
     if (_restrictMessageTarget) {
         for (auto peer : _restrictedTargets) {
             if (peer != nullptr)
-                dispatch(peer, SyncMessage(eMeta->metaObject()->className(), obj->objectName(), QByteArray(funcname), params));
+                dispatchSyncMessage(peer, syncMessage);
+        }
+    }
+    else {
+        for (auto&& peer : _peerMap.values()) {
+            dispatchSyncMessage(peer, syncMessage);
         }
     }
-    else
-        dispatch(SyncMessage(eMeta->metaObject()->className(), obj->objectName(), QByteArray(funcname), params));
 }
 
 void SignalProxy::disconnectDevice(QIODevice* dev, const QString& reason)
@@ -37,6 +37,7 @@
 
 #include "funchelpers.h"
 #include "protocol.h"
+#include "quassel.h"
 #include "types.h"
 
 struct QMetaObject;
@@ -62,7 +63,8 @@ public:
 
     enum EventType
     {
-        RemovePeerEvent = QEvent::User
+        RemovePeerEvent = QEvent::User,
+        FlushSyncBatchesEvent
     };
 
     SignalProxy(QObject* parent);
@@ -142,6 +144,29 @@ public:
     void synchronize(SyncableObject* obj);
     void stopSynchronize(SyncableObject* obj);
 
+    /**
+     * Marks a sync call as coalescable for congested peers.
+     *
+     * While a peer is congested, calls to the given slot are held back instead of being sent right away. A later call for the
+     * same object and with the same leading arguments replaces a held one, so only the most recent value is sent once the
+     * peer has recovered. This is meant for slots whose last argument supersedes any previous value, e.g. a latency update.
+     *
+     * @param className Class name of the synced object
+     * @param slotName  Name of the sync slot
+     */
+    void setCoalescableSyncCall(const QByteArray& className, const QByteArray& slotName);
+
+    /**
+     * Withholds a signal from congested peers.
+     *
+     * Rather than sending an RpcCall for the given signal to a congested peer supporting the required feature, signalWithheld()
+     * is emitted. This allows for informing the peer about the data it missed once it has caught up.
+     *
+     * @param signalName      Name of the signal as stored in the RpcCall message (e.g. using the SIGNAL() macro)
+     * @param requiredFeature Feature the peer needs to support in order to be able to handle the missed data
+     */
+    void setWithheldWhenCongested(const QByteArray& signalName, Quassel::Feature requiredFeature);
+
     class ExtendedMetaObject;
     ExtendedMetaObject* extendedMetaObject(const QMetaObject* meta) const;
     ExtendedMetaObject* createExtendedMetaObject(const QMetaObject* meta, bool checkConflicts = false);
@@ -216,6 +241,8 @@ signals:
     void maxHeartBeatCountChanged(int max);
     void lagUpdated(int lag);
     void secureStateChanged(bool);
+    void peerCongestionChanged(Peer* peer, bool congested);
+    void signalWithheld(Peer* peer, const QByteArray& signalName, const QVariantList& params);
 
 private:
     template<class T>
@@ -261,6 +288,7 @@ private:
     void dispatch(Peer* peer, const T& protoMessage);
 
     void handle(Peer* peer, const Protocol::SyncMessage& syncMessage);
+    void handle(Peer* peer, const Protocol::SyncBatch& syncBatch);
     void handle(Peer* peer, const Protocol::RpcCall& rpcCall);
     void handle(Peer* peer, const Protocol::InitRequest& initRequest);
     void handle(Peer* peer, const Protocol::InitData& initData);
@@ -271,6 +299,30 @@ private:
         Q_ASSERT(0);
     }
 
+    /**
+     * Queues a sync call for the given peer.
+     *
+     * Sync calls are collected until control returns to the event loop, and then sent as a single SyncBatch message.
+     * Any other message dispatched to the peer in the meantime causes the pending calls to be sent first, so ordering
+     * is preserved.
+     */
+    void queueSyncMessage(Peer* peer, Protocol::SyncMessage syncMessage);
+    void flushSyncBatch(Peer* peer);
+    void flushSyncBatches();
+
+    /**
+     * Sends a sync call to the given peer, applying the congestion policy if needed.
+     */
+    void dispatchSyncMessage(Peer* peer, const Protocol::SyncMessage& syncMessage);
+
+    /**
+     * Sends held sync calls to the given peer.
+     *
+     * If className and objectName are given, only calls for that particular object are released.
+     */
+    void releaseCoalescedSyncCalls(Peer* peer, const QByteArray& className = {}, const QString& objectName = {});
+    void onPeerCongestionChanged(Peer* peer, bool congested);
+
     bool invokeSlot(QObject* receiver, int methodId, const QVariantList& params, QVariant& returnValue, Peer* peer = nullptr);
     bool invokeSlot(QObject* receiver, int methodId, const QVariantList& params = QVariantList(), Peer* peer = nullptr);
 
@@ -306,6 +358,27 @@ private:
     Peer* _sourcePeer = nullptr;
     Peer* _targetPeer = nullptr;
 
+    QHash<Peer*, QList<Protocol::SyncMessage>> _pendingSyncMessages;
+    bool _syncBatchFlushScheduled = false;
+
+    /// Sync calls held back for a congested peer, in order of first occurrence
+    struct CoalescedSyncCalls
+    {
+        QList<QByteArray> keys;
+        QList<Protocol::SyncMessage> syncMessages;
+        QHash<QByteArray, int> indexByKey;
+
+        void append(const QByteArray& key, const Protocol::SyncMessage& syncMessage)
+        {
+            indexByKey.insert(key, keys.size());
+            keys.append(key);
+            syncMessages.append(syncMessage);
+        }
+    };
+    QHash<Peer*, CoalescedSyncCalls> _coalescedSyncCalls;
+    QSet<QByteArray> _coalescableSyncCalls;  ///< className::slotName
+    QHash<QByteArray, Quassel::Feature> _withheldSignals;
+
     friend class SyncableObject;
     friend class Peer;
 };
@@ -18,31 +18,31 @@
  *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
  ***************************************************************************/
 
-#pragma once
+#include "stringpool.h"
 
-#include "uisupport-export.h"
-
-#include <QSortFilterProxyModel>
-
-#include "types.h"
-
-class NetworkModel;
-
-// This is proxymodel is purely for the sorting right now
-class UISUPPORT_EXPORT NickViewFilter : public QSortFilterProxyModel
+QString StringPool::intern(const QString& str)
 {
-    Q_OBJECT
+    // Null and empty strings don't own any data worth sharing
+    if (str.isEmpty())
+        return str;
 
-public:
-    NickViewFilter(const BufferId& bufferId, NetworkModel* parent = nullptr);
+    auto it = _strings.constFind(str);
+    if (it != _strings.constEnd())
+        return *it;
+    return *_strings.insert(str);
+}
 
-    QVariant data(const QModelIndex& index, int role) const override;
-    QVariant icon(const QModelIndex& index) const;
-
-protected:
-    bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const override;
-    QVariant styleData(const QModelIndex& index, int role) const;
-
-private:
-    BufferId _bufferId;
-};
+int StringPool::prune()
+{
+    int removed = 0;
+    auto it = _strings.begin();
+    while (it != _strings.end()) {
+        if (it->isDetached()) {
+            it = _strings.erase(it);
+            ++removed;
+        }
+        else
+            ++it;
+    }
+    return removed;
+}
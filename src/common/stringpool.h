@@ -0,0 +1,58 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common-export.h"
+
+#include <QSet>
+#include <QString>
+
+/**
+ * Deduplicates strings, so that equal values share a single implicitly shared buffer.
+ *
+ * Useful for values that repeat a lot across many long-lived objects, like the senders of messages. The pool keeps
+ * a reference to every string it has handed out; call prune() every now and then to release the ones no longer
+ * used anywhere else.
+ */
+class COMMON_EXPORT StringPool
+{
+public:
+    /**
+     * Returns a string equal to the given one that shares its data with all other equal strings from this pool.
+     *
+     * @param str The string to look up
+     * @returns The pooled copy of the string
+     */
+    QString intern(const QString& str);
+
+    /**
+     * Removes strings that are only referenced by the pool itself.
+     *
+     * @returns The number of strings removed
+     */
+    int prune();
+
+    inline int size() const { return _strings.size(); }
+    inline void clear() { _strings.clear(); }
+
+private:
+    QSet<QString> _strings;
+};
@@ -0,0 +1,305 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "timerwheel.h"
+
+#include <limits>
+
+#include <QThreadStorage>
+
+constexpr int TimerWheel::DefaultTickMs;
+constexpr int TimerWheel::SlotBits;
+constexpr int TimerWheel::SlotCount;
+constexpr int TimerWheel::SlotMask;
+constexpr int TimerWheel::LevelCount;
+
+TimerWheel::TimerWheel(int tickMs, QObject* parent)
+    : QObject(parent)
+    , _tickMs{qMax(tickMs, 1)}
+{
+    _elapsed.start();
+    _wakeupTimer.setSingleShot(true);
+    connect(&_wakeupTimer, &QTimer::timeout, this, &TimerWheel::processDue);
+}
+
+TimerWheel* TimerWheel::forCurrentThread()
+{
+    static QThreadStorage<TimerWheel*> wheels;
+    if (!wheels.hasLocalData()) {
+        wheels.setLocalData(new TimerWheel);
+    }
+    return wheels.localData();
+}
+
+TimerWheel::TimerId TimerWheel::schedule(int delayMs, std::function<void()> callback)
+{
+    TimerId id = _nextId++;
+    Timer& timer = _timers[id];
+    timer.deadline = deadlineFor(delayMs);
+    timer.callback = std::move(callback);
+    file(id, timer);
+    if (_wakeupTick < 0 || timer.deadline < _wakeupTick) {
+        updateWakeup();
+    }
+    return id;
+}
+
+bool TimerWheel::reschedule(TimerId id, int delayMs)
+{
+    auto it = _timers.find(id);
+    if (it == _timers.end())
+        return false;
+
+    qint64 deadline = deadlineFor(delayMs);
+    bool earlier = deadline < it->deadline;
+    it->deadline = deadline;
+    // Pushing a timeout back is the common case, e.g. for timeouts restarted on activity. The timeout stays where it
+    // is and is refiled once its slot comes up, so this costs nothing.
+    if (earlier) {
+        unfile(*it);
+        file(id, *it);
+        if (deadline < _wakeupTick) {
+            updateWakeup();
+        }
+    }
+    return true;
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+    auto it = _timers.find(id);
+    if (it == _timers.end())
+        return false;
+
+    unfile(*it);
+    _timers.erase(it);
+    if (_timers.isEmpty()) {
+        updateWakeup();
+    }
+    return true;
+}
+
+int TimerWheel::remainingTime(TimerId id) const
+{
+    auto it = _timers.constFind(id);
+    if (it == _timers.constEnd())
+        return -1;
+    return int(qBound<qint64>(0, it->deadline * _tickMs - now(), std::numeric_limits<int>::max()));
+}
+
+void TimerWheel::setClock(std::function<qint64()> clock)
+{
+    _clock = std::move(clock);
+    _tick = now() / _tickMs;
+}
+
+void TimerWheel::processDue()
+{
+    advanceTo(now() / _tickMs);
+    updateWakeup();
+}
+
+qint64 TimerWheel::now() const
+{
+    return _clock ? _clock() : _elapsed.elapsed();
+}
+
+qint64 TimerWheel::deadlineFor(int delayMs) const
+{
+    qint64 deadline = (now() + qMax(delayMs, 0) + _tickMs - 1) / _tickMs;
+    return qMax(deadline, _tick + 1);
+}
+
+void TimerWheel::file(TimerId id, Timer& timer)
+{
+    // Each level covers SlotCount times the span of the one below. A timeout goes into the lowest level whose span
+    // reaches its deadline, and is moved down a level whenever its slot comes up.
+    qint64 deadline = timer.deadline;
+    qint64 delta = deadline - _tick;
+    int level = 0;
+    while (level < LevelCount - 1 && delta >= (qint64{1} << (SlotBits * (level + 1)))) {
+        ++level;
+    }
+    qint64 maxDelta = (qint64{1} << (SlotBits * LevelCount)) - 1;
+    if (delta > maxDelta) {
+        // Beyond the wheel's range; park it in the furthest slot, it gets refiled from there
+        deadline = _tick + maxDelta;
+    }
+
+    timer.level = level;
+    timer.slot = int((deadline >> (SlotBits * level)) & SlotMask);
+    _slots[level][timer.slot].push_back(id);
+    ++_levelCounts[level];
+}
+
+void TimerWheel::unfile(Timer& timer)
+{
+    if (timer.level >= 0) {
+        --_levelCounts[timer.level];
+    }
+    timer.level = -1;
+    timer.slot = -1;
+}
+
+void TimerWheel::advanceTo(qint64 tick)
+{
+    while (_tick < tick) {
+        if (_timers.isEmpty()) {
+            _tick = tick;
+            break;
+        }
+
+        // Skip ahead over levels without pending timeouts; their slots only hold leftover ids
+        int emptyLevels = 0;
+        while (emptyLevels < LevelCount - 1 && _levelCounts[emptyLevels] == 0) {
+            for (auto&& ids : _slots[emptyLevels]) {
+                ids.clear();
+            }
+            ++emptyLevels;
+        }
+        if (emptyLevels > 0) {
+            qint64 skipTo = _tick | ((qint64{1} << (SlotBits * emptyLevels)) - 1);
+            if (skipTo >= tick) {
+                _tick = tick;
+                break;
+            }
+            _tick = skipTo;
+        }
+
+        ++_tick;
+        // Move timeouts down from the higher levels first, so they end up in slots that are yet to come up
+        for (int level = LevelCount - 1; level > 0; --level) {
+            if ((_tick & ((qint64{1} << (SlotBits * level)) - 1)) == 0) {
+                runSlot(level, int((_tick >> (SlotBits * level)) & SlotMask));
+            }
+        }
+        runSlot(0, int(_tick & SlotMask));
+    }
+}
+
+void TimerWheel::runSlot(int level, int slot)
+{
+    std::vector<TimerId> ids;
+    ids.swap(_slots[level][slot]);
+    for (TimerId id : ids) {
+        // Look the timeout up again every time, as callbacks may have scheduled or cancelled others
+        auto it = _timers.find(id);
+        if (it == _timers.end() || it->level != level || it->slot != slot)
+            continue;
+
+        unfile(*it);
+        if (it->deadline > _tick) {
+            file(id, *it);
+            continue;
+        }
+        std::function<void()> callback = std::move(it->callback);
+        _timers.erase(it);
+        callback();
+    }
+}
+
+void TimerWheel::updateWakeup()
+{
+    if (_timers.isEmpty()) {
+        _wakeupTick = -1;
+        _wakeupTimer.stop();
+        return;
+    }
+
+    // Wake up for the next slot holding anything in any level
+    qint64 wakeupTick = std::numeric_limits<qint64>::max();
+    for (int level = 0; level < LevelCount; ++level) {
+        if (_levelCounts[level] == 0)
+            continue;
+        int shift = SlotBits * level;
+        for (qint64 slotTick = (_tick >> shift) + 1; slotTick <= (_tick >> shift) + SlotCount; ++slotTick) {
+            if (!_slots[level][slotTick & SlotMask].empty()) {
+                wakeupTick = qMin(wakeupTick, slotTick << shift);
+                break;
+            }
+        }
+    }
+
+    if (wakeupTick != _wakeupTick || !_wakeupTimer.isActive()) {
+        _wakeupTick = wakeupTick;
+        _wakeupTimer.start(int(qBound<qint64>(0, wakeupTick * _tickMs - now(), std::numeric_limits<int>::max())));
+    }
+}
+
+WheelTimer::WheelTimer(std::function<void()> callback)
+    : _callback{std::move(callback)}
+{}
+
+WheelTimer::~WheelTimer()
+{
+    stop();
+}
+
+void WheelTimer::setInterval(int msec)
+{
+    _interval = msec;
+    if (isActive())
+        start();
+}
+
+void WheelTimer::start()
+{
+    if (!_wheel) {
+        _wheel = TimerWheel::forCurrentThread();
+    }
+    if (_id && _wheel->reschedule(_id, _interval))
+        return;
+    _id = _wheel->schedule(_interval, [this]() { onTimeout(); });
+}
+
+void WheelTimer::start(int msec)
+{
+    _interval = msec;
+    start();
+}
+
+void WheelTimer::stop()
+{
+    if (_id && _wheel) {
+        _wheel->cancel(_id);
+    }
+    _id = 0;
+}
+
+bool WheelTimer::isActive() const
+{
+    return _id && _wheel && _wheel->isScheduled(_id);
+}
+
+int WheelTimer::remainingTime() const
+{
+    return isActive() ? _wheel->remainingTime(_id) : -1;
+}
+
+void WheelTimer::onTimeout()
+{
+    _id = 0;
+    if (!_singleShot) {
+        _id = _wheel->schedule(_interval, [this]() { onTimeout(); });
+    }
+    if (_callback) {
+        _callback();
+    }
+}
@@ -0,0 +1,202 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common-export.h"
+
+#include <array>
+#include <functional>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+/**
+ * Runs many coarse timeouts of a thread off a single QTimer.
+ *
+ * Timeouts are filed into a hierarchical wheel of slots, so scheduling, restarting and cancelling them is cheap no
+ * matter how many are pending. Expirations are rounded up to the wheel's tick and handled in batches, and the wheel
+ * only wakes up when a slot holding timeouts is due. Nothing runs at all while no timeouts are pending.
+ *
+ * Each thread has its own wheel, see forCurrentThread(). A wheel must only be used from the thread it belongs to.
+ * Most code should use WheelTimer rather than the wheel itself.
+ */
+class COMMON_EXPORT TimerWheel : public QObject
+{
+    Q_OBJECT
+
+public:
+    using TimerId = quint64;
+
+    static constexpr int DefaultTickMs = 50;
+
+    explicit TimerWheel(int tickMs = DefaultTickMs, QObject* parent = nullptr);
+
+    /**
+     * Returns the wheel of the calling thread, creating it if needed.
+     *
+     * The wheel is deleted when the thread finishes.
+     */
+    static TimerWheel* forCurrentThread();
+
+    /**
+     * Schedules a callback to run once after the given delay.
+     *
+     * @param delayMs  Delay in milliseconds, rounded up to the next tick
+     * @param callback The function to run
+     * @returns An id for rescheduling or cancelling the timeout, never 0
+     */
+    TimerId schedule(int delayMs, std::function<void()> callback);
+
+    /**
+     * Moves a pending timeout to expire after the given delay from now.
+     *
+     * @returns False if the timeout already ran or was cancelled
+     */
+    bool reschedule(TimerId id, int delayMs);
+
+    /**
+     * Cancels a pending timeout.
+     *
+     * @returns False if the timeout already ran or was cancelled
+     */
+    bool cancel(TimerId id);
+
+    inline bool isScheduled(TimerId id) const { return _timers.contains(id); }
+
+    /**
+     * Returns the time left until a timeout expires, or -1 if it isn't pending.
+     */
+    int remainingTime(TimerId id) const;
+
+    inline int count() const { return _timers.size(); }
+    inline int tickInterval() const { return _tickMs; }
+
+    /**
+     * Replaces the clock the wheel reads the current time from.
+     *
+     * Meant for tests, which can then drive the wheel by calling processDue() themselves.
+     *
+     * @param clock Returns the current time in milliseconds; must never go backwards
+     */
+    void setClock(std::function<qint64()> clock);
+
+public slots:
+    /**
+     * Runs all timeouts that are due by now.
+     *
+     * Called by the wheel itself when the next slot is due.
+     */
+    void processDue();
+
+private:
+    static constexpr int SlotBits = 6;
+    static constexpr int SlotCount = 1 << SlotBits;
+    static constexpr int SlotMask = SlotCount - 1;
+    static constexpr int LevelCount = 4;
+
+    struct Timer
+    {
+        qint64 deadline;  ///< Tick the timeout expires at
+        int level{-1};    ///< Level and slot the timeout is filed in
+        int slot{-1};
+        std::function<void()> callback;
+    };
+
+    qint64 now() const;
+    qint64 deadlineFor(int delayMs) const;
+    void file(TimerId id, Timer& timer);
+    void unfile(Timer& timer);
+    void advanceTo(qint64 tick);
+    void runSlot(int level, int slot);
+    void updateWakeup();
+
+    int _tickMs;
+    qint64 _tick{0};  ///< Last tick processed
+    qint64 _wakeupTick{-1};
+    TimerId _nextId{1};
+
+    QHash<TimerId, Timer> _timers;
+    /// Ids filed in each slot. Ids of timeouts that were cancelled or refiled elsewhere are skipped, and dropped
+    /// when their slot comes up.
+    std::array<std::array<std::vector<TimerId>, SlotCount>, LevelCount> _slots;
+    std::array<int, LevelCount> _levelCounts{};  ///< Pending timeouts filed in each level
+
+    QElapsedTimer _elapsed;
+    std::function<qint64()> _clock;
+    QTimer _wakeupTimer;
+};
+
+/**
+ * A timer driven by the current thread's TimerWheel.
+ *
+ * Offers the parts of the QTimer API needed for timeouts that are restarted a lot but don't need to be precise, like
+ * ping and reconnect timers. Instead of emitting a signal, it calls the callback it was given.
+ *
+ * Must be started and stopped from a single thread.
+ */
+class COMMON_EXPORT WheelTimer
+{
+public:
+    explicit WheelTimer(std::function<void()> callback = {});
+    ~WheelTimer();
+
+    WheelTimer(const WheelTimer&) = delete;
+    WheelTimer& operator=(const WheelTimer&) = delete;
+
+    inline void setCallback(std::function<void()> callback) { _callback = std::move(callback); }
+
+    /**
+     * Sets the interval. Like with QTimer, an active timer is restarted with the new interval.
+     */
+    void setInterval(int msec);
+    inline int interval() const { return _interval; }
+
+    inline void setSingleShot(bool singleShot) { _singleShot = singleShot; }
+    inline bool isSingleShot() const { return _singleShot; }
+
+    /**
+     * Starts or restarts the timer with its current interval.
+     */
+    void start();
+
+    /**
+     * Starts or restarts the timer, setting its interval to the given value.
+     */
+    void start(int msec);
+
+    void stop();
+
+    bool isActive() const;
+    int remainingTime() const;
+
+private:
+    void onTimeout();
+
+    QPointer<TimerWheel> _wheel;
+    TimerWheel::TimerId _id{0};
+    int _interval{0};
+    bool _singleShot{false};
+    std::function<void()> _callback;
+};
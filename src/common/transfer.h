@@ -92,6 +92,11 @@ public slots:
     // called on the core side through sync calls
     virtual void requestAccepted(PeerPtr peer) { Q_UNUSED(peer); }
     virtual void requestRejected(PeerPtr peer) { Q_UNUSED(peer); }
+    virtual void requestData(PeerPtr peer, quint64 offset)
+    {
+        Q_UNUSED(peer);
+        Q_UNUSED(offset);
+    }
 
 signals:
     void statusChanged(Transfer::Status state);
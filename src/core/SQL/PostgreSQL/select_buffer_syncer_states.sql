@@ -0,0 +1,2 @@
+SELECT userid, bufferid, lastmsgid, lastseenmsgid, markerlinemsgid, bufferactivity, highlightcount
+FROM buffer
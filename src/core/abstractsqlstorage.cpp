@@ -23,12 +23,15 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QMutexLocker>
+#include <QReadLocker>
 #include <QSqlDriver>
 #include <QSqlError>
 #include <QSqlField>
 #include <QSqlQuery>
 #include <QThread>
+#include <QWriteLocker>
 
+#include "metricsserver.h"
 #include "quassel.h"
 
 int AbstractSqlStorage::_nextConnectionId = 0;
@@ -177,10 +180,31 @@ QString AbstractSqlStorage::queryString(const QString& queryName, int version)
     QFile queryFile(queryInfo.filePath());
     if (!queryFile.open(QIODevice::ReadOnly | QIODevice::Text))
         return QString();
-    QString query = QTextStream(&queryFile).readAll();
+    QString query = QTextStream(&queryFile).readAll().trimmed();
     queryFile.close();
 
-    return query.trimmed();
+    return query;
+}
+
+Metrics::Histogram* AbstractSqlStorage::queryDurationMetric(const QString& queryName)
+{
+    if (!Metrics::Registry::instance().isEnabled())
+        return nullptr;
+
+    QString label = queryName.isEmpty() ? QStringLiteral("other") : queryName;
+    {
+        QReadLocker locker(&_queryMetricsLock);
+        auto it = _queryMetrics.constFind(label);
+        if (it != _queryMetrics.constEnd())
+            return it.value();
+    }
+    QWriteLocker locker(&_queryMetricsLock);
+    auto& histogram = _queryMetrics[label];
+    if (!histogram)
+        histogram = MetricsServer::latencyHistogram("quassel_storage_query_seconds",
+                                                    "Time taken to execute SQL queries",
+                                                    {{"query", label}});
+    return histogram;
 }
 
 std::vector<AbstractSqlStorage::SqlQueryResource> AbstractSqlStorage::setupQueries()
@@ -25,10 +25,12 @@
 
 #include <QHash>
 #include <QMutex>
+#include <QReadWriteLock>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
 
+#include "metrics.h"
 #include "storage.h"
 
 class QThread;
@@ -91,6 +93,17 @@ protected:
      */
     QString queryString(const QString& queryName, int version = 0);
 
+    /**
+     * Returns the histogram recording the durations of the given query, if metrics are enabled
+     *
+     * Queries are identified by the name of their query file, as passed to queryString(). Queries
+     * without a name are recorded as "other".
+     *
+     * @param[in] queryName  Name of the query file, or an empty string
+     * @return The histogram, or nullptr if metrics are disabled
+     */
+    Metrics::Histogram* queryDurationMetric(const QString& queryName);
+
     /**
      * Gets the collection of SQL setup queries and filenames to create a new database
      *
@@ -172,6 +185,9 @@ private:
     // which allows us thread safe termination of a connection
     class Connection;
     QHash<QThread*, Connection*> _connectionPool;
+
+    QReadWriteLock _queryMetricsLock;
+    QHash<QString, Metrics::Histogram*> _queryMetrics;  ///< Query durations by query name
 };
 
 struct SenderData
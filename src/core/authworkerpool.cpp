@@ -0,0 +1,102 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "authworkerpool.h"
+
+#include <utility>
+
+#include <QRunnable>
+
+#include "core.h"
+
+namespace {
+
+/// Logins queued per worker thread before further ones are rejected
+constexpr int kMaxPendingPerThread = 32;
+
+}  // namespace
+
+/**
+ * Checks a single login and reports back to the pool
+ */
+class AuthWorkerPool::Task : public QRunnable
+{
+public:
+    Task(AuthWorkerPool* pool, quint64 requestId, QString userName, QString password)
+        : _pool(pool)
+        , _requestId(requestId)
+        , _userName(std::move(userName))
+        , _password(std::move(password))
+    {}
+
+    void run() override
+    {
+        UserId uid = Core::authenticateLogin(_userName, _password);
+        // The pool waits for its tasks before being destroyed, so it's still alive here
+        QMetaObject::invokeMethod(_pool, "onAuthenticated", Qt::QueuedConnection, Q_ARG(quint64, _requestId), Q_ARG(UserId, uid));
+    }
+
+private:
+    AuthWorkerPool* _pool;
+    quint64 _requestId;
+    QString _userName;
+    QString _password;
+};
+
+AuthWorkerPool::AuthWorkerPool(int threadCount, QObject* parent)
+    : QObject(parent)
+{
+    _threadPool.setMaxThreadCount(qMax(1, threadCount));
+}
+
+AuthWorkerPool::~AuthWorkerPool()
+{
+    waitForDone();
+}
+
+bool AuthWorkerPool::authenticate(const QString& userName, const QString& password, QObject* context, Callback callback)
+{
+    if (_pendingRequests.size() >= _threadPool.maxThreadCount() * kMaxPendingPerThread)
+        return false;
+
+    quint64 requestId = ++_nextRequestId;
+    _pendingRequests.insert(requestId, {context, std::move(callback)});
+    _threadPool.start(new Task(this, requestId, userName, password));
+    return true;
+}
+
+void AuthWorkerPool::waitForDone()
+{
+    _threadPool.clear();
+    _threadPool.waitForDone();
+    _pendingRequests.clear();
+}
+
+void AuthWorkerPool::onAuthenticated(quint64 requestId, UserId uid)
+{
+    auto it = _pendingRequests.find(requestId);
+    if (it == _pendingRequests.end())
+        return;
+
+    Request request = std::move(it.value());
+    _pendingRequests.erase(it);
+    if (request.context)
+        request.callback(uid);
+}
@@ -0,0 +1,88 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <functional>
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QThreadPool>
+
+#include "types.h"
+
+/**
+ * Checks login credentials on a bounded pool of worker threads.
+ *
+ * Hashing passwords and binding to LDAP can take a while, so doing it on the main thread would stall accepting new
+ * connections (and everything else) during a burst of logins. Logins beyond what the pool can queue are rejected
+ * right away instead of piling up.
+ */
+class AuthWorkerPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Callback = std::function<void(UserId)>;
+
+    /**
+     * Constructor.
+     *
+     * @param threadCount Number of logins checked in parallel
+     * @param parent      The parent object
+     */
+    explicit AuthWorkerPool(int threadCount, QObject* parent = nullptr);
+    ~AuthWorkerPool() override;
+
+    /**
+     * Checks the given credentials on a worker thread.
+     *
+     * Must be called from the pool's thread. The callback is run on that thread once the check is done, unless the
+     * context object has been destroyed by then.
+     *
+     * @param userName The user's login name
+     * @param password The user's password
+     * @param context  Object the callback belongs to
+     * @param callback Receives the user's ID if the credentials are valid, 0 otherwise
+     * @returns False if too many logins are pending already, in which case the callback is never run
+     */
+    bool authenticate(const QString& userName, const QString& password, QObject* context, Callback callback);
+
+    /// Waits for all running checks to finish, dropping their results
+    void waitForDone();
+
+private slots:
+    void onAuthenticated(quint64 requestId, UserId uid);
+
+private:
+    class Task;
+
+    struct Request
+    {
+        QPointer<QObject> context;
+        Callback callback;
+    };
+
+    QThreadPool _threadPool;
+    quint64 _nextRequestId{0};
+    QHash<quint64, Request> _pendingRequests;
+};
@@ -0,0 +1,143 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "channellistindex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+constexpr int kDefaultPageSize = 500;
+constexpr int kMaxPageSize = 5000;
+
+}  // namespace
+
+void ChannelListIndex::append(ChannelDescription channel)
+{
+    _channels << std::move(channel);
+}
+
+void ChannelListIndex::ensureIndexed()
+{
+    const int oldCount = _indexedCount;
+    const int newCount = _channels.count();
+    if (oldCount == newCount)
+        return;
+
+    for (int i = oldCount; i < newCount; ++i) {
+        _nameKeys << nameKey(_channels[i].channelName);
+        _byName << i;
+        _byUsers << i;
+    }
+
+    // Sort only the new entries and merge them into the already sorted part
+    const QVector<QString>& keys = _nameKeys;
+    const QList<ChannelDescription>& channels = _channels;
+    auto nameLess = [&](int a, int b) { return keys[a] < keys[b]; };
+    auto usersLess = [&](int a, int b) {
+        if (channels[a].userCount != channels[b].userCount)
+            return channels[a].userCount < channels[b].userCount;
+        return keys[a] < keys[b];
+    };
+    auto mergeNew = [oldCount](QVector<int>& order, auto less) {
+        auto middle = order.begin() + oldCount;
+        std::sort(middle, order.end(), less);
+        std::inplace_merge(order.begin(), middle, order.end(), less);
+    };
+    mergeNew(_byName, nameLess);
+    mergeNew(_byUsers, usersLess);
+    _indexedCount = newCount;
+}
+
+QVariantMap ChannelListIndex::query(const QVariantMap& query)
+{
+    ensureIndexed();
+
+    const int offset = qMax(0, query.value("offset").toInt());
+    const QString namePrefix = nameKey(query.value("namePrefix").toString());
+    const QString topicFilter = query.value("topicContains").toString();
+    const bool matchAny = query.value("matchAny").toBool() && !namePrefix.isEmpty() && !topicFilter.isEmpty();
+    const quint32 minUsers = query.value("minUsers").toUInt();
+    const bool sortByUsers = query.value("sortColumn").toInt() == 1;
+    const bool descending = query.value("sortOrder").toInt() == Qt::DescendingOrder;
+    const int limit = qBound(0, query.value("limit", kDefaultPageSize).toInt(), kMaxPageSize);
+
+    const QVector<QString>& keys = _nameKeys;
+    const QVector<int>& order = sortByUsers ? _byUsers : _byName;
+    auto begin = order.constBegin();
+    auto end = order.constEnd();
+
+    // Narrow the range using the index the result is sorted by; remaining filters are checked per entry
+    if (sortByUsers && minUsers > 0) {
+        begin = std::partition_point(begin, end, [&](int i) { return _channels[i].userCount < minUsers; });
+    }
+    else if (!sortByUsers && !namePrefix.isEmpty() && !matchAny) {
+        begin = std::partition_point(begin, end, [&](int i) { return keys[i] < namePrefix; });
+        end = std::partition_point(begin, end, [&](int i) { return keys[i].startsWith(namePrefix); });
+    }
+
+    auto matches = [&](int i) {
+        const ChannelDescription& channel = _channels[i];
+        if (channel.userCount < minUsers)
+            return false;
+        bool nameMatches = namePrefix.isEmpty() || keys[i].startsWith(namePrefix);
+        bool topicMatches = topicFilter.isEmpty() || channel.topic.contains(topicFilter, Qt::CaseInsensitive);
+        return matchAny ? nameMatches || topicMatches : nameMatches && topicMatches;
+    };
+
+    QVariantList channels;
+    int total = 0;
+    auto collect = [&](int i) {
+        if (!matches(i))
+            return;
+        if (total >= offset && channels.count() < limit)
+            channels << toVariant(_channels[i]);
+        ++total;
+    };
+    if (descending)
+        std::for_each(std::reverse_iterator<QVector<int>::const_iterator>(end),
+                      std::reverse_iterator<QVector<int>::const_iterator>(begin),
+                      collect);
+    else
+        std::for_each(begin, end, collect);
+
+    QVariantMap result;
+    result["offset"] = offset;
+    result["total"] = total;
+    result["channels"] = channels;
+    return result;
+}
+
+QString ChannelListIndex::nameKey(const QString& channelName)
+{
+    int start = 0;
+    while (start < channelName.length() && QString("#&+!").contains(channelName[start]))
+        ++start;
+    return channelName.mid(start).toCaseFolded();
+}
+
+QVariant ChannelListIndex::toVariant(const ChannelDescription& channel)
+{
+    QVariantList channelVariant;
+    channelVariant << channel.channelName << channel.userCount << channel.topic;
+    return QVariant::fromValue<QVariant>(channelVariant);
+}
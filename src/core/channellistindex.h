@@ -0,0 +1,79 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "core-export.h"
+
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#include "irclisthelper.h"
+
+/**
+ * A channel list as received from the IRC server, together with the sort indices needed to answer page queries.
+ *
+ * The indices hold positions into channels(). They only cover the first indexedCount() entries and are extended by
+ * ensureIndexed(), which query() calls before answering.
+ */
+class CORE_EXPORT ChannelListIndex
+{
+public:
+    using ChannelDescription = IrcListHelper::ChannelDescription;
+
+    inline const QList<ChannelDescription>& channels() const { return _channels; }
+    inline int count() const { return _channels.count(); }
+    inline int indexedCount() const { return _indexedCount; }
+
+    /// Positions into channels(), ascending by casefolded name without channel type prefix
+    inline const QVector<int>& byName() const { return _byName; }
+    /// Positions into channels(), ascending by user count, ties by name
+    inline const QVector<int>& byUsers() const { return _byUsers; }
+
+    void append(ChannelDescription channel);
+
+    /**
+     * Adds the channels appended since the last call to the sort indices.
+     *
+     * Only the new entries are sorted; they are then merged into the already sorted part.
+     */
+    void ensureIndexed();
+
+    /**
+     * Answers a page query as described in IrcListHelper.
+     *
+     * @param query Query map holding the filter, sort and paging parameters
+     * @return Result map holding the page in "channels", plus "total" and "offset"
+     */
+    QVariantMap query(const QVariantMap& query);
+
+    static QVariant toVariant(const ChannelDescription& channel);
+
+private:
+    static QString nameKey(const QString& channelName);
+
+    QList<ChannelDescription> _channels;
+    QVector<QString> _nameKeys;  ///< Casefolded channel names without channel type prefix
+    QVector<int> _byName;
+    QVector<int> _byUsers;
+    int _indexedCount{0};
+};
@@ -23,6 +23,8 @@
 #include <algorithm>
 
 #include <QCoreApplication>
+#include <QMutexLocker>
+#include <QThread>
 
 #include "coreauthhandler.h"
 #include "coresession.h"
@@ -49,6 +51,9 @@
 #    include <unistd.h>
 #endif /* Q_OS_WIN */
 
+// Minimum time between connections to the same IRC server while restoring sessions
+constexpr auto kRestoreConnectIntervalMs = 2000;
+
 // ==============================
 //  Custom Events
 // ==============================
@@ -84,6 +89,9 @@ Core::Core()
 
 Core::~Core()
 {
+    // Logins still being checked use the storage and authenticator
+    if (_authWorkerPool)
+        _authWorkerPool->waitForDone();
     qDeleteAll(_connectingClients);
     qDeleteAll(_sessions);
     syncStorage();
@@ -100,6 +108,8 @@ void Core::init()
         throw ExitException{EXIT_FAILURE, tr("Invalid core settings version!")};
     }
 
+    _authWorkerPool = new AuthWorkerPool(Quassel::optionValue("auth-threads").toInt(), this);
+
     // Set up storage and authentication backends
     registerStorageBackends();
     registerAuthenticators();
@@ -205,6 +215,15 @@ void Core::init()
             cacheSysIdent();
         }
 
+        if (Quassel::isOptionSet("share-network-state")) {
+            _sharedNetworkState.reset(new SharedNetworkState);
+        }
+
+        _maxParallelRestores = Quassel::optionValue("restore-parallel").toInt();
+        if (_maxParallelRestores <= 0) {
+            _maxParallelRestores = qMax(QThread::idealThreadCount(), 1);
+        }
+
         if (Quassel::isOptionSet("oidentd")) {
             _oidentdConfigGenerator = new OidentdConfigGenerator(this);
         }
@@ -267,6 +286,7 @@ void Core::shutdown()
     qInfo() << "Core shutting down...";
 
     saveState();
+    _pendingRestores.clear();
 
     for (auto&& client : _connectingClients) {
         client->deleteLater();
@@ -301,6 +321,9 @@ void Core::saveState()
         QVariantList activeSessions;
         for (auto&& user : instance()->_sessions.keys())
             activeSessions << QVariant::fromValue(user);
+        // Sessions still waiting to be restored remain active
+        for (auto&& user : instance()->_pendingRestores)
+            activeSessions << QVariant::fromValue(user);
         _storage->setCoreState(activeSessions);
     }
 }
@@ -330,13 +353,77 @@ void Core::restoreState()
 
     if (activeSessions.count() > 0) {
         qInfo() << "Restoring previous core state...";
+        QSet<UserId> users;
         for (auto&& v : activeSessions) {
             UserId user = v.value<UserId>();
-            sessionForUser(user, true);
+            if (!users.contains(user)) {
+                users.insert(user);
+                _pendingRestores << user;
+            }
+        }
+
+        // Load the buffer state of all sessions at once rather than user by user in each session thread
+        auto bufferSyncerStates = _storage->bufferSyncerStates(users);
+        for (auto&& user : users) {
+            bufferSyncerStates[user];  // users without buffers still shouldn't query on their own
+        }
+        {
+            QMutexLocker locker(&_restoreMutex);
+            _restoredBufferSyncerStates = std::move(bufferSyncerStates);
         }
+
+        startPendingRestores();
+    }
+}
+
+void Core::startPendingRestores()
+{
+    // Each session loads identities and networks and starts connecting while initializing, so only bring up a few at a time
+    while (!_pendingRestores.isEmpty() && _restoringSessions.count() < _maxParallelRestores) {
+        UserId user = _pendingRestores.takeFirst();
+        _restoringSessions.insert(user);
+        SessionThread* session = sessionForUser(user, true);
+        connect(session, &SessionThread::initialized, this, [this, user]() {
+            _restoringSessions.remove(user);
+            if (_pendingRestores.isEmpty() && _restoringSessions.isEmpty()) {
+                qInfo() << "Core state restored.";
+            }
+            startPendingRestores();
+        });
     }
 }
 
+Storage::BufferSyncerState Core::bufferSyncerState(UserId user)
+{
+    {
+        QMutexLocker locker(&instance()->_restoreMutex);
+        auto it = instance()->_restoredBufferSyncerStates.find(user);
+        if (it != instance()->_restoredBufferSyncerStates.end()) {
+            Storage::BufferSyncerState state = std::move(*it);
+            instance()->_restoredBufferSyncerStates.erase(it);
+            return state;
+        }
+    }
+
+    Storage::BufferSyncerState state;
+    state.lastMsgIds = bufferLastMsgIds(user);
+    state.lastSeenMsgIds = bufferLastSeenMsgIds(user);
+    state.markerLineMsgIds = bufferMarkerLineMsgIds(user);
+    state.activities = bufferActivities(user);
+    state.highlightCounts = highlightCounts(user);
+    return state;
+}
+
+int Core::restoreConnectDelay(const QString& serverHost)
+{
+    QMutexLocker locker(&instance()->_restoreMutex);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64& next = instance()->_nextRestoreConnect[serverHost.toLower()];
+    const qint64 start = qMax(now, next);
+    next = start + kRestoreConnectIntervalMs;
+    return static_cast<int>(start - now);
+}
+
 /*** Core Setup ***/
 
 QString Core::setup(const QString& adminUser,
@@ -827,6 +914,10 @@ SessionThread* Core::sessionForUser(UserId uid, bool restore)
     if (_sessions.contains(uid))
         return _sessions[uid];
 
+    // A client logging in while its session is still waiting to be restored lets it skip the queue
+    if (_pendingRestores.removeOne(uid))
+        restore = true;
+
     return (_sessions[uid] = new SessionThread(uid, restore, strictIdentEnabled(), this));
 }
 
@@ -1112,6 +1203,26 @@ bool Core::changeUserPassword(UserId userId, const QString& password)
     return instance()->_storage->updateUser(userId, password);
 }
 
+UserId Core::authenticateLogin(const QString& userName, const QString& password)
+{
+    // First attempt local auth using the real username and password.
+    // If that fails, move onto the auth provider.
+
+    // Check to see if the user has the "Database" authenticator configured.
+    UserId uid = 0;
+    if (getUserAuthenticator(userName) == "Database") {
+        uid = validateUser(userName, password);
+    }
+
+    // If they did not, *or* if the database login fails, try to use a different authenticator.
+    // Right now a core can only have one authenticator configured; this might be something
+    // to change in the future.
+    if (uid == 0) {
+        uid = authenticateUser(userName, password);
+    }
+    return uid;
+}
+
 // TODO: this code isn't currently 100% optimal because the core
 // doesn't know it can have multiple auth providers configured (there aren't
 // multiple auth providers at the moment anyway) and we have hardcoded the
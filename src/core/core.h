@@ -26,6 +26,7 @@
 #include <vector>
 
 #include <QDateTime>
+#include <QMutex>
 #include <QPointer>
 #include <QSslSocket>
 #include <QString>
@@ -33,6 +34,7 @@
 #include <QVariant>
 
 #include "authenticator.h"
+#include "authworkerpool.h"
 #include "bufferinfo.h"
 #include "deferredptr.h"
 #include "identserver.h"
@@ -40,6 +42,7 @@
 #include "metricsserver.h"
 #include "oidentdconfiggenerator.h"
 #include "sessionthread.h"
+#include "sharednetworkstate.h"
 #include "singleton.h"
 #include "sslserver.h"
 #include "storage.h"
@@ -96,6 +99,16 @@ public:
         return instance()->_authenticator->validateUser(userName, password);
     }
 
+    //! Authenticate a client login, trying the database first and then the auth backend
+    /**
+     * This may block for a while, so clients are authenticated through authWorkerPool().
+     *
+     * \param userName The user's login name
+     * \param password The user's uncrypted password
+     * \return The user's ID if valid; 0 otherwise
+     */
+    static UserId authenticateLogin(const QString& userName, const QString& password);
+
     //! Add a new user, exposed so auth providers can call this without being the storage.
     /**
      * \param userName The user's login name
@@ -639,6 +652,15 @@ public:
      * \param user      The Owner of the buffers
      */
     static inline QHash<BufferId, int> highlightCounts(UserId user) { return instance()->_storage->highlightCounts(user); }
+
+    //! Get the state a user's BufferSyncer is initialized with
+    /** While sessions are restored on startup, this hands out state preloaded for all of them at once.
+     *  Otherwise, it is loaded from storage for the given user only.
+     *  \note This method is threadsafe.
+     *
+     * \param user      The Owner of the buffers
+     */
+    static Storage::BufferSyncerState bufferSyncerState(UserId user);
     //! Get the highlight count states for a buffer
     /** This method is used to load the highlight count of a buffer when its last seen message changes.
      *  \note This method is threadsafe.
@@ -661,6 +683,26 @@ public:
      */
     static inline bool strictIdentEnabled() { return instance()->_strictIdentEnabled; }
 
+    /**
+     * State shared between sessions connected to the same network
+     *
+     * @return The shared state registry, or nullptr if sharing is not enabled
+     */
+    static inline SharedNetworkState* sharedNetworkState() { return instance()->_sharedNetworkState.get(); }
+
+    /**
+     * Reserves a slot for connecting to an IRC server while restoring sessions
+     *
+     * Connections to the same server are spaced out, so restarting a core with many users doesn't
+     * flood the server with connection attempts it will throttle anyway.
+     *
+     * @note This method is threadsafe.
+     *
+     * @param serverHost Host name of the IRC server
+     * @return Delay in milliseconds before connecting
+     */
+    static int restoreConnectDelay(const QString& serverHost);
+
     static bool sslSupported();
 
     static QVariantList backendInfo();
@@ -678,6 +720,7 @@ public:
     inline OidentdConfigGenerator* oidentdConfigGenerator() const { return _oidentdConfigGenerator; }
     inline IdentServer* identServer() const { return _identServer; }
     inline MetricsServer* metricsServer() const { return _metricsServer; }
+    inline AuthWorkerPool* authWorkerPool() const { return _authWorkerPool; }
 
     static const int AddClientEventId;
 
@@ -753,6 +796,7 @@ private slots:
 
 private:
     SessionThread* sessionForUser(UserId userId, bool restoreState = false);
+    void startPendingRestores();
     void addClientHelper(RemotePeer* peer, UserId uid);
     // void processCoreSetup(QTcpSocket *socket, QVariantMap &msg);
     QString setupCoreForInternalUsage();
@@ -788,6 +832,12 @@ private:
     static Core* _instance;
     QSet<CoreAuthHandler*> _connectingClients;
     QHash<UserId, SessionThread*> _sessions;
+    QList<UserId> _pendingRestores;   ///< Sessions waiting to be restored
+    QSet<UserId> _restoringSessions;  ///< Sessions being restored right now
+    int _maxParallelRestores{1};
+    QMutex _restoreMutex;  ///< Guards the state below, which is accessed from session threads
+    QHash<UserId, Storage::BufferSyncerState> _restoredBufferSyncerStates;
+    QHash<QString, qint64> _nextRestoreConnect;  ///< Per server host, when the next restored connection may start
     DeferredSharedPtr<Storage> _storage;              ///< Active storage backend
     DeferredSharedPtr<Authenticator> _authenticator;  ///< Active authenticator
     QMap<UserId, QString> _authUserNames;
@@ -805,6 +855,7 @@ private:
 
     IdentServer* _identServer{nullptr};
     MetricsServer* _metricsServer{nullptr};
+    AuthWorkerPool* _authWorkerPool{nullptr};
 
     bool _initialized{false};
     bool _configured{false};
@@ -814,6 +865,8 @@ private:
     /// Whether or not strict ident mode is enabled, locking users' idents to Quassel username
     bool _strictIdentEnabled;
 
+    std::unique_ptr<SharedNetworkState> _sharedNetworkState;
+
     static std::unique_ptr<AbstractSqlMigrationReader> getMigrationReader(Storage* storage);
     static std::unique_ptr<AbstractSqlMigrationWriter> getMigrationWriter(Storage* storage);
     static void stdInEcho(bool on);
@@ -257,29 +257,38 @@ void CoreAuthHandler::handle(const Protocol::Login& msg)
         return;
     }
 
-    // First attempt local auth using the real username and password.
-    // If that fails, move onto the auth provider.
+    // Ignore further attempts while the credentials are being checked
+    if (_loginPending)
+        return;
 
-    // Check to see if the user has the "Database" authenticator configured.
-    UserId uid = 0;
-    if (Core::getUserAuthenticator(msg.user) == "Database") {
-        uid = Core::validateUser(msg.user, msg.password);
+    // Checking the credentials may take a while, so it's done off the main thread
+    const QString user = msg.user;
+    bool queued = Core::instance()->authWorkerPool()->authenticate(msg.user, msg.password, this, [this, user](UserId uid) {
+        _loginPending = false;
+        finishLogin(user, uid);
+    });
+    if (!queued) {
+        qWarning() << qPrintable(
+            tr("Too many pending logins, rejecting login attempt from %1 as \"%2\"").arg(hostAddress().toString(), msg.user));
+        _peer->dispatch(Protocol::LoginFailed(
+            tr("<b>The core is busy!</b><br>Too many clients are logging in right now, please try again later.")));
+        return;
     }
+    _loginPending = true;
+}
 
-    // If they did not, *or* if the database login fails, try to use a different authenticator.
-    // TODO: this logic should likely be moved into Core::authenticateUser in the future.
-    // Right now a core can only have one authenticator configured; this might be something
-    // to change in the future.
-    if (uid == 0) {
-        uid = Core::authenticateUser(msg.user, msg.password);
-    }
+void CoreAuthHandler::finishLogin(const QString& user, UserId uid)
+{
+    // The client may have gone away in the meantime
+    if (!socket() || socket()->state() != QAbstractSocket::ConnectedState)
+        return;
 
     if (uid == 0) {
-        qInfo() << qPrintable(tr("Invalid login attempt from %1 as \"%2\"").arg(hostAddress().toString(), msg.user));
+        qInfo() << qPrintable(tr("Invalid login attempt from %1 as \"%2\"").arg(hostAddress().toString(), user));
         _peer->dispatch(Protocol::LoginFailed(tr(
             "<b>Invalid username or password!</b><br>The username/password combination you supplied could not be found in the database.")));
         if (_metricsServer) {
-            _metricsServer->addLoginAttempt(msg.user, false);
+            _metricsServer->addLoginAttempt(user, false);
         }
         return;
     }
@@ -289,7 +298,7 @@ void CoreAuthHandler::handle(const Protocol::Login& msg)
     }
 
     qInfo() << qPrintable(tr("Client %1 initialized and authenticated successfully as \"%2\" (UserId: %3).")
-                              .arg(_peer->address(), msg.user, QString::number(uid.toInt())));
+                              .arg(_peer->address(), user, QString::number(uid.toInt())));
 
     const auto& clientFeatures = _peer->features();
     auto unsupported = clientFeatures.toStringList(false);
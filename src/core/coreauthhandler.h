@@ -47,6 +47,9 @@ private:
     void handle(const Protocol::SetupData& msg) override;
     void handle(const Protocol::Login& msg) override;
 
+    /// Completes a login once the credentials have been checked
+    void finishLogin(const QString& user, UserId uid);
+
     void setPeer(RemotePeer* peer);
     void startSsl();
 
@@ -70,6 +73,7 @@ private:
     bool _magicReceived;
     bool _legacy;
     bool _clientRegistered;
+    bool _loginPending{false};
     quint8 _connectionFeatures;
     QVector<PeerFactory::ProtoDescriptor> _supportedProtos;
 };
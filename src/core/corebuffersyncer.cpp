@@ -23,6 +23,8 @@
 #include <algorithm>
 #include <set>
 
+#include <QDateTime>
+
 #include "core.h"
 #include "corenetwork.h"
 #include "coresession.h"
@@ -30,6 +32,13 @@
 #include "util.h"
 #include "backgroundtaskhandler.h"
 
+namespace {
+
+// Channels count as viewed for much longer than this, so refreshing the mark now and then is enough
+constexpr qint64 kViewedRefreshMs = 60 * 1000;
+
+}  // namespace
+
 class PurgeEvent : public QEvent
 {
 public:
@@ -39,12 +48,11 @@ public:
 };
 
 CoreBufferSyncer::CoreBufferSyncer(CoreSession* parent)
-    : BufferSyncer(Core::bufferLastMsgIds(parent->user()),
-                   Core::bufferLastSeenMsgIds(parent->user()),
-                   Core::bufferMarkerLineMsgIds(parent->user()),
-                   Core::bufferActivities(parent->user()),
-                   Core::highlightCounts(parent->user()),
-                   parent)
+    : CoreBufferSyncer(parent, Core::bufferSyncerState(parent->user()))
+{}
+
+CoreBufferSyncer::CoreBufferSyncer(CoreSession* parent, const Storage::BufferSyncerState& state)
+    : BufferSyncer(state.lastMsgIds, state.lastSeenMsgIds, state.markerLineMsgIds, state.activities, state.highlightCounts, parent)
     , _coreSession(parent)
     , _purgeBuffers(false)
 {
@@ -74,6 +82,20 @@ void CoreBufferSyncer::requestSetLastSeenMsg(BufferId buffer, const MsgId& msgId
         setHighlightCount(buffer, highlightCount);
 
         dirtyLastSeenBuffers << buffer;
+
+        // A client marking messages as read is looking at the buffer. Clients do this constantly while scrolling, so
+        // only look the buffer up if it hasn't been marked as viewed recently.
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+        qint64& lastMarked = _lastMarkedViewed[buffer];
+        if (now - lastMarked >= kViewedRefreshMs) {
+            lastMarked = now;
+            BufferInfo bufferInfo = Core::getBufferInfo(_coreSession->user(), buffer);
+            if (bufferInfo.type() == BufferInfo::ChannelBuffer) {
+                CoreNetwork* net = _coreSession->network(bufferInfo.networkId());
+                if (net)
+                    net->markChannelViewed(bufferInfo.bufferName());
+            }
+        }
     }
 }
 
@@ -115,6 +137,7 @@ void CoreBufferSyncer::storeDirtyIds()
 
 void CoreBufferSyncer::removeBuffer(BufferId bufferId)
 {
+    _lastMarkedViewed.remove(bufferId);
     BufferInfo bufferInfo = Core::getBufferInfo(_coreSession->user(), bufferId);
     if (!bufferInfo.isValid()) {
         qWarning() << "CoreBufferSyncer::removeBuffer(): invalid BufferId:" << bufferId << "for User:" << _coreSession->user();
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "buffersyncer.h"
+#include "storage.h"
 
 class CoreSession;
 
@@ -94,6 +95,8 @@ protected:
     void customEvent(QEvent* event) override;
 
 private:
+    CoreBufferSyncer(CoreSession* parent, const Storage::BufferSyncerState& state);
+
     CoreSession* _coreSession;
     bool _purgeBuffers;
 
@@ -102,5 +105,7 @@ private:
     QSet<BufferId> dirtyActivities;
     QSet<BufferId> dirtyHighlights;
 
+    QHash<BufferId, qint64> _lastMarkedViewed;  ///< When a buffer was last reported to its network as viewed
+
     void purgeBufferIds();
 };
@@ -21,11 +21,15 @@
 #include "coreircchannel.h"
 
 #include "corenetwork.h"
+#include "util.h"
 
 CoreIrcChannel::CoreIrcChannel(const QString& channelname, Network* network)
     : IrcChannel(channelname, network)
     , _receivedWelcomeMsg(false)
 {
+    // Users parting or quitting while refreshing must not be parted again later
+    connect(this, &IrcChannel::ircUserParted, this, [this](IrcUser* ircUser) { _unconfirmedUsers.remove(ircUser); });
+
 #ifdef HAVE_QCA2
     _cipher = nullptr;
 
@@ -56,6 +60,66 @@ CoreIrcChannel::~CoreIrcChannel()
 #endif
 }
 
+void CoreIrcChannel::markStale()
+{
+    _snapshotState = SnapshotState::Stale;
+}
+
+void CoreIrcChannel::beginRefresh()
+{
+    if (_snapshotState != SnapshotState::Stale)
+        return;
+
+    _snapshotState = SnapshotState::Refreshing;
+    _unconfirmedUsers.clear();
+    for (IrcUser* ircUser : ircUsers()) {
+        if (!network()->isMe(ircUser))
+            _unconfirmedUsers.insert(ircUser);
+    }
+}
+
+void CoreIrcChannel::refreshUsers(const QStringList& nicks, const QStringList& modes)
+{
+    QList<IrcUser*> newUsers;
+    QStringList newModes;
+    for (int i = 0; i < nicks.count() && i < modes.count(); ++i) {
+        IrcUser* ircUser = network()->ircUser(nickFromMask(nicks[i]));
+        if (ircUser && isKnownUser(ircUser)) {
+            _unconfirmedUsers.remove(ircUser);
+            if (userModes(ircUser) != network()->sortPrefixModes(modes[i]))
+                setUserModes(ircUser, modes[i]);
+        }
+        else {
+            newUsers << network()->newIrcUser(nicks[i]);
+            newModes << modes[i];
+        }
+    }
+    joinIrcUsers(newUsers, newModes);
+}
+
+void CoreIrcChannel::endRefresh()
+{
+    if (_snapshotState != SnapshotState::Refreshing)
+        return;
+
+    _snapshotState = SnapshotState::Current;
+    const QSet<IrcUser*> departedUsers = _unconfirmedUsers;
+    _unconfirmedUsers.clear();
+    for (IrcUser* ircUser : departedUsers) {
+        // Parting the last user removes the channel, leaving the remaining ones unknown
+        if (isKnownUser(ircUser))
+            part(ircUser);
+    }
+}
+
+void CoreIrcChannel::dropStaleState()
+{
+    _snapshotState = SnapshotState::Current;
+    _unconfirmedUsers.clear();
+    for (IrcUser* ircUser : ircUsers())
+        part(ircUser);
+}
+
 #ifdef HAVE_QCA2
 Cipher* CoreIrcChannel::cipher() const
 {
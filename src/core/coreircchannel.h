@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <QSet>
+
 #include "ircchannel.h"
 
 #ifdef HAVE_QCA2
@@ -42,9 +44,55 @@ public:
     inline bool receivedWelcomeMsg() const { return _receivedWelcomeMsg; }
     inline void setReceivedWelcomeMsg() { _receivedWelcomeMsg = true; }
 
+    /**
+     * Whether the channel's users and modes were restored from a snapshot and not yet confirmed by the server
+     */
+    inline bool isStale() const { return _snapshotState != SnapshotState::Current; }
+    inline bool isRefreshing() const { return _snapshotState == SnapshotState::Refreshing; }
+
+    /**
+     * Marks the channel as restored from a snapshot
+     */
+    void markStale();
+
+    /**
+     * Starts replacing the restored state, to be called once we have rejoined the channel
+     *
+     * Restored users are kept until the end of the following NAMES reply, so that users still in the
+     * channel keep the details known about them.
+     */
+    void beginRefresh();
+
+    /**
+     * Updates the channel from a NAMES reply received while refreshing
+     *
+     * Users already known only get their modes updated, new ones are joined.
+     */
+    void refreshUsers(const QStringList& nicks, const QStringList& modes);
+
+    /**
+     * Finishes refreshing, parting all restored users not seen in the NAMES reply
+     */
+    void endRefresh();
+
+    /**
+     * Parts all users of a channel that was never refreshed, which removes the channel
+     */
+    void dropStaleState();
+
 private:
+    enum class SnapshotState
+    {
+        Current,
+        Stale,
+        Refreshing
+    };
+
     bool _receivedWelcomeMsg;
 
+    SnapshotState _snapshotState{SnapshotState::Current};
+    QSet<IrcUser*> _unconfirmedUsers;  ///< Restored users not yet seen in NAMES while refreshing
+
 #ifdef HAVE_QCA2
     mutable Cipher* _cipher;
 #endif
@@ -22,15 +22,41 @@
 
 #include "corenetwork.h"
 #include "coreuserinputhandler.h"
+#include "peer.h"
+#include "signalproxy.h"
 
 constexpr auto kTimeoutMs = 5000;
+// Subscribed clients are told about the growing list whenever this many channels have been added
+constexpr auto kProgressInterval = 500;
+// Finished lists are dropped once no client has requested a page for this long
+constexpr auto kListExpiryMs = 10 * 60 * 1000;
+
+CoreIrcListHelper::~CoreIrcListHelper()
+{
+    for (TimerWheel::TimerId timeout : _queryTimeouts) {
+        TimerWheel::forCurrentThread()->cancel(timeout);
+    }
+    for (TimerWheel::TimerId timeout : _expiryTimeouts) {
+        TimerWheel::forCurrentThread()->cancel(timeout);
+    }
+}
 
 QVariantList CoreIrcListHelper::requestChannelList(const NetworkId& netId, const QStringList& channelFilters)
 {
-    if (_finishedChannelLists.contains(netId))
-        return _finishedChannelLists.take(netId);
+    Peer* peer = coreSession()->signalProxy()->sourcePeer();
+    bool paged = peer && peer->hasFeature(Quassel::Feature::PagedChannelList);
 
-    if (_channelLists.contains(netId)) {
+    if (paged) {
+        subscribe(netId, peer);
+    }
+    else if (_undeliveredLists.remove(netId)) {
+        QVariantList channelList;
+        for (const ChannelDescription& channel : _channelLists[netId].index.channels())
+            channelList << ChannelListIndex::toVariant(channel);
+        return channelList;
+    }
+
+    if (requestInProgress(netId)) {
         _queuedQuery[netId] = channelFilters.join(",");
     }
     else {
@@ -39,14 +65,41 @@ QVariantList CoreIrcListHelper::requestChannelList(const NetworkId& netId, const
     return QVariantList();
 }
 
+QVariantMap CoreIrcListHelper::requestChannelListPage(const NetworkId& netId, const QVariantMap& query)
+{
+    subscribe(netId, coreSession()->signalProxy()->sourcePeer());
+
+    if (!_channelLists.contains(netId)) {
+        QVariantMap result;
+        result["offset"] = qMax(0, query.value("offset").toInt());
+        result["total"] = 0;
+        result["received"] = 0;
+        result["finished"] = true;
+        result["channels"] = QVariantList();
+        return result;
+    }
+
+    ChannelList& channelList = _channelLists[netId];
+    QVariantMap result = channelList.index.query(query);
+    result["received"] = channelList.index.count();
+    result["finished"] = channelList.finished;
+    if (channelList.finished)
+        touchList(netId);
+    return result;
+}
+
 bool CoreIrcListHelper::addChannel(const NetworkId& netId, const QString& channelName, quint32 userCount, const QString& topic)
 {
-    if (!_channelLists.contains(netId))
+    if (!requestInProgress(netId))
         return false;
 
-    _channelLists[netId] << ChannelDescription(channelName, userCount, topic);
-    if (_queryTimeoutByNetId.contains(netId))
-        _queryTimeoutByNetId[netId]->start(kTimeoutMs, this);
+    ChannelList& channelList = _channelLists[netId];
+    channelList.index.append(ChannelDescription(channelName, userCount, topic));
+    if (_queryTimeouts.contains(netId))
+        TimerWheel::forCurrentThread()->reschedule(_queryTimeouts[netId], kTimeoutMs);
+
+    if (channelList.index.count() - channelList.reportedCount >= kProgressInterval)
+        reportProgress(netId);
 
     return true;
 }
@@ -55,13 +108,18 @@ bool CoreIrcListHelper::dispatchQuery(const NetworkId& netId, const QString& que
 {
     CoreNetwork* network = coreSession()->network(netId);
     if (network) {
-        _channelLists[netId] = QList<ChannelDescription>();
+        _channelLists[netId] = ChannelList();
+        _undeliveredLists.remove(netId);
+        if (_expiryTimeouts.contains(netId))
+            TimerWheel::forCurrentThread()->cancel(_expiryTimeouts.take(netId));
         network->userInputHandler()->handleList(BufferInfo(), query);
 
-        auto timer = std::make_shared<QBasicTimer>();
-        timer->start(kTimeoutMs, this);
-        _queryTimeoutByNetId[netId] = timer;
-        _queryTimeoutByTimerId[timer->timerId()] = netId;
+        TimerWheel* wheel = TimerWheel::forCurrentThread();
+        wheel->cancel(_queryTimeouts.value(netId));
+        _queryTimeouts[netId] = wheel->schedule(kTimeoutMs, [this, netId]() {
+            _queryTimeouts.remove(netId);
+            endOfChannelList(netId);
+        });
 
         return true;
     }
@@ -72,25 +130,19 @@ bool CoreIrcListHelper::dispatchQuery(const NetworkId& netId, const QString& que
 
 bool CoreIrcListHelper::endOfChannelList(const NetworkId& netId)
 {
-    if (_queryTimeoutByNetId.contains(netId)) {
+    if (_queryTimeouts.contains(netId)) {
         // If we received an actual RPL_LISTEND, remove the timer
-        int timerId = _queryTimeoutByNetId.take(netId)->timerId();
-        _queryTimeoutByTimerId.remove(timerId);
+        TimerWheel::forCurrentThread()->cancel(_queryTimeouts.take(netId));
     }
 
     if (_queuedQuery.contains(netId)) {
         // we're no longer interested in the current data. drop it and issue a new request.
         return dispatchQuery(netId, _queuedQuery.take(netId));
     }
-    else if (_channelLists.contains(netId)) {
-        QVariantList channelList;
-        foreach (ChannelDescription channel, _channelLists[netId]) {
-            QVariantList channelVariant;
-            channelVariant << channel.channelName << channel.userCount << channel.topic;
-            channelList << QVariant::fromValue<QVariant>(channelVariant);
-        }
-        _finishedChannelLists[netId] = channelList;
-        _channelLists.remove(netId);
+    else if (requestInProgress(netId)) {
+        _channelLists[netId].finished = true;
+        _undeliveredLists.insert(netId);
+        touchList(netId);
         reportFinishedList(netId);
         return true;
     }
@@ -99,16 +151,49 @@ bool CoreIrcListHelper::endOfChannelList(const NetworkId& netId)
     }
 }
 
-void CoreIrcListHelper::timerEvent(QTimerEvent* event)
+void CoreIrcListHelper::subscribe(const NetworkId& netId, Peer* peer)
 {
-    if (!_queryTimeoutByTimerId.contains(event->timerId())) {
-        IrcListHelper::timerEvent(event);
+    if (!peer || !peer->hasFeature(Quassel::Feature::PagedChannelList))
         return;
+
+    QList<QPointer<Peer>>& subscribers = _subscribers[netId];
+    subscribers.removeAll(QPointer<Peer>());
+    if (!subscribers.contains(peer))
+        subscribers << peer;
+}
+
+void CoreIrcListHelper::reportProgress(const NetworkId& netId)
+{
+    ChannelList& channelList = _channelLists[netId];
+    channelList.reportedCount = channelList.index.count();
+
+    QSet<Peer*> peers;
+    for (const QPointer<Peer>& peer : _subscribers.value(netId)) {
+        if (peer)
+            peers.insert(peer);
     }
+    if (peers.isEmpty())
+        return;
 
-    NetworkId netId = _queryTimeoutByTimerId.take(event->timerId());
-    _queryTimeoutByNetId.remove(netId);
+    coreSession()->signalProxy()->restrictTargetPeers(peers, [&] { reportChannelListProgress(netId, channelList.reportedCount); });
+}
+
+void CoreIrcListHelper::touchList(const NetworkId& netId)
+{
+    TimerWheel* wheel = TimerWheel::forCurrentThread();
+    if (_expiryTimeouts.contains(netId) && wheel->reschedule(_expiryTimeouts[netId], kListExpiryMs))
+        return;
 
-    event->accept();
-    endOfChannelList(netId);
+    _expiryTimeouts[netId] = wheel->schedule(kListExpiryMs, [this, netId]() {
+        _expiryTimeouts.remove(netId);
+        dropList(netId);
+    });
+}
+
+void CoreIrcListHelper::dropList(const NetworkId& netId)
+{
+    // Clients asking for pages of a dropped list get an empty, finished one and have to request it anew
+    _channelLists.remove(netId);
+    _undeliveredLists.remove(netId);
+    _subscribers.remove(netId);
 }
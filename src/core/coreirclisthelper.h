@@ -20,13 +20,14 @@
 
 #pragma once
 
-#include <memory>
+#include <QPointer>
 
+#include "channellistindex.h"
 #include "coresession.h"
 #include "irclisthelper.h"
+#include "timerwheel.h"
 
-class QBasicTimer;
-class QTimerEvent;
+class Peer;
 
 class CoreIrcListHelper : public IrcListHelper
 {
@@ -36,28 +37,47 @@ public:
     inline CoreIrcListHelper(CoreSession* coreSession)
         : IrcListHelper(coreSession)
         , _coreSession(coreSession){};
+    ~CoreIrcListHelper() override;
 
     inline CoreSession* coreSession() const { return _coreSession; }
 
-    inline bool requestInProgress(const NetworkId& netId) const { return _channelLists.contains(netId); }
+    inline bool requestInProgress(const NetworkId& netId) const
+    {
+        auto it = _channelLists.constFind(netId);
+        return it != _channelLists.constEnd() && !it->finished;
+    }
 
 public slots:
     QVariantList requestChannelList(const NetworkId& netId, const QStringList& channelFilters) override;
+    QVariantMap requestChannelListPage(const NetworkId& netId, const QVariantMap& query) override;
     bool addChannel(const NetworkId& netId, const QString& channelName, quint32 userCount, const QString& topic);
     bool endOfChannelList(const NetworkId& netId);
 
-protected:
-    void timerEvent(QTimerEvent* event) override;
-
 private:
+    /**
+     * A channel list as received from the IRC server, along with its progress.
+     */
+    struct ChannelList
+    {
+        ChannelListIndex index;
+        int reportedCount{0};
+        bool finished{false};
+    };
+
     bool dispatchQuery(const NetworkId& netId, const QString& query);
+    void subscribe(const NetworkId& netId, Peer* peer);
+    void reportProgress(const NetworkId& netId);
+    /// (Re)starts the countdown for dropping a finished list nobody is looking at anymore
+    void touchList(const NetworkId& netId);
+    void dropList(const NetworkId& netId);
 
 private:
     CoreSession* _coreSession;
 
     QHash<NetworkId, QString> _queuedQuery;
-    QHash<NetworkId, QList<ChannelDescription>> _channelLists;
-    QHash<NetworkId, QVariantList> _finishedChannelLists;
-    QHash<int, NetworkId> _queryTimeoutByTimerId;
-    QHash<NetworkId, std::shared_ptr<QBasicTimer>> _queryTimeoutByNetId;
+    QHash<NetworkId, ChannelList> _channelLists;
+    QSet<NetworkId> _undeliveredLists;  ///< Finished lists not yet fetched by a legacy client
+    QHash<NetworkId, QList<QPointer<Peer>>> _subscribers;
+    QHash<NetworkId, TimerWheel::TimerId> _queryTimeouts;
+    QHash<NetworkId, TimerWheel::TimerId> _expiryTimeouts;
 };
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 
+#include <QDataStream>
 #include <QDebug>
 #include <QHostInfo>
 #include <QTextBoundaryFinder>
@@ -36,6 +37,15 @@
 #include "irctag.h"
 #include "networkevent.h"
 
+// Time after connecting until channels restored from a snapshot but not rejoined are dropped
+constexpr auto kStaleStateTimeoutMs = 2 * 60 * 1000;
+// AutoWho polls channels with more users than this less often, one cycle more per this many users
+constexpr auto kAutoWhoUsersPerCycle = 50;
+// Channels a client showed activity in within this time are polled first
+constexpr auto kAutoWhoViewedTimeoutMs = 15 * 60 * 1000;
+// Tokens AutoWho leaves in the token bucket for the user's own messages, at most half the burst size
+constexpr auto kAutoWhoReservedTokens = 2u;
+
 CoreNetwork::CoreNetwork(const NetworkId& networkid, CoreSession* session)
     : Network(networkid, session)
     , _coreSession(session)
@@ -53,10 +63,17 @@ CoreNetwork::CoreNetwork(const NetworkId& networkid, CoreSession* session)
     _debugLogRawNetId = Quassel::optionValue("debug-irc-id").toInt();
 
     _autoReconnectTimer.setSingleShot(true);
-    connect(&_socketCloseTimer, &QTimer::timeout, this, &CoreNetwork::onSocketCloseTimeout);
+    _socketCloseTimer.setCallback([this]() { onSocketCloseTimeout(); });
+
+    _delayedConnectTimer.setSingleShot(true);
+    _delayedConnectTimer.setCallback([this]() { connectToIrc(); });
+
+    _staleStateTimer.setSingleShot(true);
+    _staleStateTimer.setInterval(kStaleStateTimeoutMs);
+    _staleStateTimer.setCallback([this]() { dropStaleState(); });
 
     setPingInterval(networkConfig()->pingInterval());
-    connect(&_pingTimer, &QTimer::timeout, this, &CoreNetwork::sendPing);
+    _pingTimer.setCallback([this]() { sendPing(); });
 
     setAutoWhoDelay(networkConfig()->autoWhoDelay());
     setAutoWhoInterval(networkConfig()->autoWhoInterval());
@@ -77,10 +94,10 @@ CoreNetwork::CoreNetwork(const NetworkId& networkid, CoreSession* session)
     connect(networkConfig(), &NetworkConfig::autoWhoIntervalSet, this, &CoreNetwork::setAutoWhoInterval);
     connect(networkConfig(), &NetworkConfig::autoWhoDelaySet, this, &CoreNetwork::setAutoWhoDelay);
 
-    connect(&_autoReconnectTimer, &QTimer::timeout, this, &CoreNetwork::doAutoReconnect);
-    connect(&_autoWhoTimer, &QTimer::timeout, this, &CoreNetwork::sendAutoWho);
-    connect(&_autoWhoCycleTimer, &QTimer::timeout, this, &CoreNetwork::startAutoWhoCycle);
-    connect(&_tokenBucketTimer, &QTimer::timeout, this, &CoreNetwork::checkTokenBucket);
+    _autoReconnectTimer.setCallback([this]() { doAutoReconnect(); });
+    _autoWhoTimer.setCallback([this]() { sendAutoWho(); });
+    _autoWhoCycleTimer.setCallback([this]() { startAutoWhoCycle(); });
+    _tokenBucketTimer.setCallback([this]() { checkTokenBucket(); });
 
     connect(&socket, &QAbstractSocket::connected, this, &CoreNetwork::onSocketInitialized);
     connect(&socket, selectOverload<QAbstractSocket::SocketError>(&QAbstractSocket::error), this, &CoreNetwork::onSocketError);
@@ -181,6 +198,7 @@ void CoreNetwork::connectToIrc(bool reconnecting)
     if (_shuttingDown) {
         return;
     }
+    _delayedConnectTimer.stop();
 
     if (Core::instance()->identServer()) {
         _socketId = Core::instance()->identServer()->addWaitingSocket();
@@ -283,6 +301,7 @@ void CoreNetwork::connectToIrc(bool reconnecting)
 
 void CoreNetwork::disconnectFromIrc(bool requested, const QString& reason, bool withReconnect)
 {
+    _delayedConnectTimer.stop();
     // Disconnecting from the network, should expect a socket close or error
     _disconnectExpected = true;
     _quitRequested = requested;  // see socketDisconnected();
@@ -348,6 +367,14 @@ void CoreNetwork::shutdown()
     disconnectFromIrc(false, {}, false);
 }
 
+void CoreNetwork::connectToIrcDelayed(int delayMs)
+{
+    if (_shuttingDown) {
+        return;
+    }
+    _delayedConnectTimer.start(delayMs);
+}
+
 void CoreNetwork::userInput(const BufferInfo& buf, QString msg)
 {
     userInputHandler()->handleUserInput(buf, msg);
@@ -393,7 +420,14 @@ void CoreNetwork::putCmd(const QString& cmd, const QList<QList<QByteArray>>& par
 
 void CoreNetwork::setChannelJoined(const QString& channel)
 {
-    queueAutoWhoOneshot(channel);  // check this new channel first
+    auto* ircChannel = qobject_cast<CoreIrcChannel*>(this->ircChannel(channel));
+    if (ircChannel && ircChannel->isStale()) {
+        // Users of a restored channel are known already, leave them to the regular WHO cycle
+        ircChannel->beginRefresh();
+    }
+    else {
+        queueAutoWhoOneshot(channel);  // check this new channel first
+    }
 
     Core::setChannelPersistent(userId(), networkId(), channel, true);
     Core::setPersistentChannelKey(userId(), networkId(), channel, _channelKeys[channel.toLower()]);
@@ -403,7 +437,10 @@ void CoreNetwork::setChannelParted(const QString& channel)
 {
     removeChannelKey(channel);
     _autoWhoQueue.removeAll(channel.toLower());
+    _autoWhoOneshots.remove(channel.toLower());
     _autoWhoPending.remove(channel.toLower());
+    _autoWhoSkippedCycles.remove(channel.toLower());
+    _channelLastViewed.remove(channel.toLower());
 
     Core::setChannelPersistent(userId(), networkId(), channel, false);
 }
@@ -511,6 +548,8 @@ void CoreNetwork::setMyNick(const QString& mynick)
 
 void CoreNetwork::onSocketHasData()
 {
+    // Events are processed synchronously, so messages generated from these lines are queued before we return
+    coreSession()->beginNetworkRead();
     while (socket.canReadLine()) {
         QByteArray s = socket.readLine();
         if (_metricsServer) {
@@ -524,6 +563,7 @@ void CoreNetwork::onSocketHasData()
         event->setTimestamp(QDateTime::currentDateTimeUtc());
         emit newEvent(event);
     }
+    coreSession()->endNetworkRead();
 }
 
 void CoreNetwork::onSocketError(QAbstractSocket::SocketError error)
@@ -608,10 +648,124 @@ void CoreNetwork::onSocketInitialized()
     putRawLine(serverEncode(QString("USER %1 8 * :%2").arg(coreSession()->strictCompliantIdent(identity), identity->realName())));
 }
 
+QString CoreNetwork::internString(const QString& str)
+{
+    if (!_sharedStringPool) {
+        SharedNetworkState* sharedState = Core::sharedNetworkState();
+        const QString networkName = support("NETWORK");
+        if (!sharedState || networkName.isEmpty())
+            return Network::internString(str);
+        _sharedStringPool = sharedState->pool(networkName);
+    }
+    return _sharedStringPool->intern(str);
+}
+
+void CoreNetwork::saveSnapshot(QDataStream& out) const
+{
+    out << initSupports();
+
+    // Users are written once and referred to by index from the channels
+    const QList<IrcUser*> users = ircUsers();
+    QHash<IrcUser*, quint32> userIndex;
+    out << static_cast<quint32>(users.count());
+    for (IrcUser* ircUser : users) {
+        userIndex.insert(ircUser, userIndex.count());
+        out << ircUser->nick() << ircUser->user() << ircUser->host() << ircUser->realName() << ircUser->account()
+            << ircUser->isAway() << ircUser->awayMessage() << ircUser->server() << ircUser->userModes();
+    }
+
+    const QList<IrcChannel*> channels = ircChannels();
+    out << static_cast<quint32>(channels.count());
+    for (IrcChannel* ircChannel : channels) {
+        const QList<IrcUser*> channelUsers = ircChannel->ircUsers();
+        out << ircChannel->name() << ircChannel->topic() << ircChannel->initChanModes()
+            << static_cast<quint32>(channelUsers.count());
+        for (IrcUser* ircUser : channelUsers)
+            out << userIndex.value(ircUser) << ircChannel->userModes(ircUser);
+    }
+}
+
+bool CoreNetwork::restoreSnapshot(QDataStream& in)
+{
+    QVariantMap supports;
+    quint32 userCount;
+    in >> supports >> userCount;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    initSetSupports(supports);
+
+    QVector<IrcUser*> users;
+    for (quint32 i = 0; i < userCount; ++i) {
+        QString nick, user, host, realName, account, awayMessage, server, userModes;
+        bool away;
+        in >> nick >> user >> host >> realName >> account >> away >> awayMessage >> server >> userModes;
+        if (in.status() != QDataStream::Ok)
+            return false;
+
+        IrcUser* ircUser = newIrcUser(QString("%1!%2@%3").arg(nick, user, host));
+        ircUser->setRealName(realName);
+        ircUser->setAccount(account);
+        ircUser->setAway(away);
+        ircUser->setAwayMessage(awayMessage);
+        ircUser->setServer(server);
+        ircUser->setUserModes(userModes);
+        users << ircUser;
+    }
+
+    quint32 channelCount;
+    in >> channelCount;
+    for (quint32 i = 0; i < channelCount && in.status() == QDataStream::Ok; ++i) {
+        QString name, topic;
+        QVariantMap chanModes;
+        quint32 memberCount;
+        in >> name >> topic >> chanModes >> memberCount;
+
+        QList<IrcUser*> members;
+        QStringList modes;
+        for (quint32 j = 0; j < memberCount && in.status() == QDataStream::Ok; ++j) {
+            quint32 index;
+            QString userModes;
+            in >> index >> userModes;
+            if (index < static_cast<quint32>(users.count())) {
+                members << users[index];
+                modes << userModes;
+            }
+        }
+        if (in.status() != QDataStream::Ok)
+            break;
+        if (members.isEmpty())
+            continue;
+
+        auto* ircChannel = static_cast<CoreIrcChannel*>(newIrcChannel(name));
+        ircChannel->setTopic(topic);
+        ircChannel->initSetChanModes(chanModes);
+        ircChannel->joinIrcUsers(members, modes);
+        ircChannel->markStale();
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+void CoreNetwork::dropStaleState()
+{
+    for (IrcChannel* ircChannel : ircChannels()) {
+        auto* coreChannel = static_cast<CoreIrcChannel*>(ircChannel);
+        if (coreChannel->isRefreshing())
+            coreChannel->endRefresh();
+        else if (coreChannel->isStale())
+            coreChannel->dropStaleState();
+    }
+}
+
 void CoreNetwork::onSocketDisconnected()
 {
     disablePingTimeout();
     _msgQueue.clear();
+    // The next server might belong to a different network
+    _sharedStringPool.reset();
+    // Restored state can't be confirmed anymore, so don't show it as if it were current
+    _staleStateTimer.stop();
+    dropStaleState();
     if (_metricsServer) {
         _metricsServer->messageQueue(userId(), 0);
     }
@@ -619,7 +773,9 @@ void CoreNetwork::onSocketDisconnected()
     _autoWhoCycleTimer.stop();
     _autoWhoTimer.stop();
     _autoWhoQueue.clear();
+    _autoWhoOneshots.clear();
     _autoWhoPending.clear();
+    _autoWhoSkippedCycles.clear();
 
     _socketCloseTimer.stop();
 
@@ -712,6 +868,9 @@ void CoreNetwork::networkInitialized()
 
     _sendPings = true;
 
+    // Channels restored from a snapshot should be rejoined by now or shortly
+    _staleStateTimer.start();
+
     if (networkConfig()->autoWhoEnabled()) {
         _autoWhoCycleTimer.start();
         _autoWhoTimer.start();
@@ -1407,7 +1566,33 @@ void CoreNetwork::startAutoWhoCycle()
         _autoWhoCycleTimer.stop();
         return;
     }
-    _autoWhoQueue = channels();
+
+    // Channels the user is looking at go first; large channels that aren't are polled less often, as their
+    // replies are large and their users' away state matters less
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QStringList viewed;
+    QStringList others;
+    for (IrcChannel* ircChannel : ircChannels()) {
+        // Restored channels get checked once they're confirmed, in the next cycle
+        if (static_cast<CoreIrcChannel*>(ircChannel)->isStale())
+            continue;
+
+        QString name = ircChannel->name().toLower();
+        auto lastViewed = _channelLastViewed.constFind(name);
+        if (lastViewed != _channelLastViewed.constEnd() && now - *lastViewed <= kAutoWhoViewedTimeoutMs) {
+            _autoWhoSkippedCycles.remove(name);
+            viewed << name;
+            continue;
+        }
+
+        int cycles = qMax(1, ircChannel->ircUsers().count() / kAutoWhoUsersPerCycle);
+        int& skipped = _autoWhoSkippedCycles[name];
+        if (++skipped < cycles)
+            continue;
+        skipped = 0;
+        others << name;
+    }
+    _autoWhoQueue = viewed + others;
 }
 
 void CoreNetwork::queueAutoWhoOneshot(const QString& name)
@@ -1417,12 +1602,28 @@ void CoreNetwork::queueAutoWhoOneshot(const QString& name)
     if (!_autoWhoQueue.contains(name.toLower())) {
         _autoWhoQueue.prepend(name.toLower());
     }
+    _autoWhoOneshots.insert(name.toLower());
     if (capEnabled(IrcCap::AWAY_NOTIFY)) {
         // When away-notify is active, the timer's stopped.  Start a new cycle to who this channel.
         setAutoWhoEnabled(true);
     }
 }
 
+bool CoreNetwork::hasIncompleteUsers(const IrcChannel* channel) const
+{
+    for (IrcUser* ircUser : channel->ircUsers()) {
+        if (ircUser->realName().isEmpty())
+            return true;
+    }
+    return false;
+}
+
+void CoreNetwork::markChannelViewed(const QString& channel)
+{
+    if (ircChannel(channel))
+        _channelLastViewed[channel.toLower()] = QDateTime::currentMSecsSinceEpoch();
+}
+
 void CoreNetwork::setAutoWhoDelay(int delay)
 {
     _autoWhoTimer.setInterval(delay * 1000);
@@ -1449,8 +1650,13 @@ void CoreNetwork::sendAutoWho()
     if (_autoWhoPending.count())
         return;
 
+    // Leave tokens for the user's own messages; automatic WHOs can wait for the next round
+    if (!_skipMessageRates && (!_msgQueue.isEmpty() || _tokenBucket <= qMin(kAutoWhoReservedTokens, _burstSize / 2)))
+        return;
+
     while (!_autoWhoQueue.isEmpty()) {
         QString chanOrNick = _autoWhoQueue.takeFirst();
+        bool oneshot = _autoWhoOneshots.remove(chanOrNick);
         // Check if it's a known channel or nick
         IrcChannel* ircchan = ircChannel(chanOrNick);
         IrcUser* ircuser = ircUser(chanOrNick);
@@ -1472,7 +1678,18 @@ void CoreNetwork::sendAutoWho()
             qDebug() << "Skipping who polling of unknown channel or nick" << chanOrNick;
             continue;
         }
-        if (supports("WHOX")) {
+        if (supports("WHOX") && ircchan && !oneshot && !hasIncompleteUsers(ircchan)) {
+            // The channel's users are known, so refreshing their away state is all the regular cycle is for.
+            // Accounts only need asking for if the server doesn't announce changes.
+            //
+            // WHO <channel> n%tcnf[a],<unique_number>
+            QString fields = capEnabled(IrcCap::ACCOUNT_NOTIFY) ? "tcnf" : "tcnfa";
+            putRawLine(serverEncode(
+                QString("WHO %1 n%%2,%3")
+                    .arg(chanOrNick, fields, QString::number(IrcCap::AUTOWHO_REFRESH_WHOX_NUM))
+            ));
+        }
+        else if (supports("WHOX")) {
             // Use WHO extended to poll away users and/or user accounts
             // Explicitly only match on nickname ("n"), don't rely on server defaults
             //
@@ -1565,6 +1782,11 @@ void CoreNetwork::checkTokenBucket()
 
     // Process whatever messages are pending
     fillBucketAndProcessQueue();
+
+    if (!_skipMessageRates && _msgQueue.isEmpty() && _tokenBucket >= _burstSize) {
+        // Nothing to send and the bucket is full; idle until the next message takes a token
+        _tokenBucketTimer.stop();
+    }
 }
 
 void CoreNetwork::fillBucketAndProcessQueue()
@@ -1598,6 +1820,10 @@ void CoreNetwork::writeToSocket(const QByteArray& data)
     if (!_skipMessageRates) {
         // Only subtract from the token bucket if message rate limiting is enabled
         _tokenBucket--;
+        if (!_tokenBucketTimer.isActive()) {
+            // Start refilling the bucket again
+            _tokenBucketTimer.start(_messageDelay);
+        }
     }
 }
 
@@ -1629,6 +1855,11 @@ void CoreNetwork::requestDisconnect() const
     if (_shuttingDown) {
         return;
     }
+    if (_delayedConnectTimer.isActive()) {
+        // Still waiting to connect, so just don't
+        const_cast<CoreNetwork*>(this)->_delayedConnectTimer.stop();
+        return;
+    }
     if (connectionState() == Disconnected) {
         qWarning() << "Requesting disconnect while not being connected!";
         return;
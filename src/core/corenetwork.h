@@ -21,10 +21,10 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 
 #include <QSslError>
 #include <QSslSocket>
-#include <QTimer>
 
 #ifdef HAVE_QCA2
 #    include "cipher.h"
@@ -36,6 +36,8 @@
 #include "irccap.h"
 #include "irctag.h"
 #include "network.h"
+#include "sharednetworkstate.h"
+#include "timerwheel.h"
 
 class CoreIdentity;
 class CoreUserInputHandler;
@@ -57,6 +59,31 @@ public:
     inline CoreUserInputHandler* userInputHandler() const { return _userInputHandler; }
     inline CoreIgnoreListManager* ignoreListManager() { return coreSession()->ignoreListManager(); }
 
+    /**
+     * Interns the string in the pool shared with other sessions on the same network, if enabled
+     *
+     * @see Core::sharedNetworkState()
+     */
+    QString internString(const QString& str) override;
+
+    /**
+     * Writes the known users and channels to a snapshot, to be restored after a core restart
+     *
+     * @param out Stream to write the snapshot to
+     */
+    void saveSnapshot(QDataStream& out) const;
+
+    /**
+     * Restores users and channels from a snapshot written by saveSnapshot()
+     *
+     * Restored channels are marked stale. Their users are confirmed by the NAMES reply after rejoining,
+     * and channels not rejoined shortly after connecting are dropped.
+     *
+     * @param in Stream to read the snapshot from
+     * @return True if the snapshot was read successfully
+     */
+    bool restoreSnapshot(QDataStream& in);
+
     //! Decode a string using the server (network) decoding.
     inline QString serverDecode(const QByteArray& string) const { return decodeServerString(string); }
 
@@ -223,6 +250,14 @@ public slots:
     void shutdown();
 
     void connectToIrc(bool reconnecting = false);
+    /**
+     * Connect to the IRC server after a delay.
+     *
+     * Used to space out connections when restoring sessions. Connecting or disconnecting in the meantime cancels it.
+     *
+     * @param delayMs Delay in milliseconds
+     */
+    void connectToIrcDelayed(int delayMs);
     /**
      * Disconnect from the IRC server.
      *
@@ -392,6 +427,15 @@ public slots:
      */
     void queueAutoWhoOneshot(const QString& name);
 
+    /**
+     * Notes that a client is looking at the given channel.
+     *
+     * Channels looked at recently are polled first by AutoWho, and regardless of their size.
+     *
+     * @param[in] channel Channel name
+     */
+    void markChannelViewed(const QString& channel);
+
     /**
      * Checks if the given target has an automatic WHO in progress, and sets it as done if so
      *
@@ -418,6 +462,14 @@ public slots:
         emit displayMsg(RawMessage(networkId(), msg));
     }
 
+    /**
+     * Checks if a channel has users that WHO hasn't filled in all details for, e.g. ones that joined since
+     *
+     * @param[in] channel The channel
+     * @return True if a full WHO of the channel is needed, otherwise false
+     */
+    bool hasIncompleteUsers(const IrcChannel* channel) const;
+
 signals:
     void recvRawServerMsg(const QString&);
     void displayStatusMsg(const QString&);
@@ -461,6 +513,7 @@ private slots:
     void onSocketStateChanged(QAbstractSocket::SocketState);
 
     void networkInitialized();
+    void dropStaleState();
 
     void sendPerform();
     void restoreUserModes();
@@ -512,12 +565,17 @@ private:
     CoreUserInputHandler* _userInputHandler;
     MetricsServer* _metricsServer;
 
+    /// Pool shared with other sessions on this network, acquired once the server announced its name
+    std::shared_ptr<SharedNetworkState::Pool> _sharedStringPool;
+
     QHash<QString, QString> _channelKeys;  // stores persistent channels and their passwords, if any
 
-    QTimer _autoReconnectTimer;
+    WheelTimer _autoReconnectTimer;
     int _autoReconnectCount;
 
-    QTimer _socketCloseTimer;
+    WheelTimer _socketCloseTimer;
+    WheelTimer _delayedConnectTimer;
+    WheelTimer _staleStateTimer;  ///< Drops restored channels that weren't rejoined in time
 
     /* this flag triggers quitRequested() once the socket is closed
      * it is needed to determine whether or not the connection needs to be
@@ -534,7 +592,7 @@ private:
     bool _previousConnectionAttemptFailed;
     int _lastUsedServerIndex;
 
-    QTimer _pingTimer;
+    WheelTimer _pingTimer;
     qint64 _lastPingTime = 0;          ///< Unix time of most recently sent automatic ping
     uint _pingCount = 0;               ///< Unacknowledged automatic pings
     bool _sendPings = false;           ///< If true, pings should be periodically sent to server
@@ -544,8 +602,11 @@ private:
     bool _pongReplyPending = false;  ///< If true, at least one PING sent without a PONG reply
 
     QStringList _autoWhoQueue;
+    QSet<QString> _autoWhoOneshots;  ///< Queued names that need all WHO fields, not just a refresh
     QHash<QString, int> _autoWhoPending;
-    QTimer _autoWhoTimer, _autoWhoCycleTimer;
+    QHash<QString, int> _autoWhoSkippedCycles;  ///< Cycles a large channel has been left out of
+    QHash<QString, qint64> _channelLastViewed;  ///< When a client last showed activity in a channel
+    WheelTimer _autoWhoTimer, _autoWhoCycleTimer;
 
     // Maintain a list of CAPs that are being checked; if empty, negotiation finished
     // See http://ircv3.net/specs/core/capability-negotiation-3.2.html
@@ -584,7 +645,7 @@ private:
      */
     const int maxCapRequestLength = 100;
 
-    QTimer _tokenBucketTimer;
+    WheelTimer _tokenBucketTimer;
     // No need for int type as one cannot travel into the past (at least not yet, Doc)
     quint32 _messageDelay;        /// Token refill speed in ms
     quint32 _burstSize;           /// Size of the token bucket
@@ -22,6 +22,13 @@
 
 #include <utility>
 
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
 #include "core.h"
 #include "corebacklogmanager.h"
 #include "corebuffersyncer.h"
@@ -45,10 +52,22 @@
 #include "ircparser.h"
 #include "ircuser.h"
 #include "messageevent.h"
+#include "quassel.h"
 #include "remotepeer.h"
 #include "storage.h"
 #include "util.h"
 
+namespace {
+
+constexpr int kEventLoopLagIntervalMs = 1000;
+
+constexpr quint32 kSnapshotMagic = 0x514e5353;  // "QNSS"
+constexpr quint8 kSnapshotVersion = 1;
+// Older snapshots describe channels that have changed too much to be worth showing
+constexpr qint64 kMaxSnapshotAgeSecs = 30 * 60;
+
+}  // namespace
+
 class ProcessMessagesEvent : public QEvent
 {
 public:
@@ -87,6 +106,8 @@ CoreSession::CoreSession(UserId uid, bool restoreState, bool strictIdentEnabled,
     p->setMaxHeartBeatCount(60);  // 30 mins until we throw a dead socket out
 
     connect(p, &SignalProxy::peerRemoved, this, &CoreSession::removeClient);
+    connect(p, &SignalProxy::peerCongestionChanged, this, &CoreSession::onPeerCongestionChanged);
+    connect(p, &SignalProxy::signalWithheld, this, &CoreSession::onSignalWithheld);
 
     connect(p, &SignalProxy::connected, this, &CoreSession::clientsConnected);
     connect(p, &SignalProxy::disconnected, this, &CoreSession::clientsDisconnected);
@@ -94,6 +115,19 @@ CoreSession::CoreSession(UserId uid, bool restoreState, bool strictIdentEnabled,
     p->attachSlot(SIGNAL(sendInput(BufferInfo,QString)), this, &CoreSession::msgFromClient);
     p->attachSignal(this, &CoreSession::displayMsg);
     p->attachSignal(this, &CoreSession::displayStatusMsg);
+    p->attachSignal(this, &CoreSession::backlogAvailable);
+
+    // Don't let slow clients make the core buffer unbounded amounts of data: capable clients fetch messages they missed
+    // from the backlog once they've caught up, and state updates superseded in the meantime are only sent once
+    p->setWithheldWhenCongested(SIGNAL(displayMsg(Message)), Quassel::Feature::BacklogAvailableNotices);
+    for (auto&& slotName : {"setLastMsg", "setLastSeenMsg", "setMarkerLine", "setBufferActivity", "setHighlightCount"}) {
+        p->setCoalescableSyncCall("BufferSyncer", slotName);
+    }
+    p->setCoalescableSyncCall("Network", "setLatency");
+    for (auto&& slotName : {"setAway", "setAwayMessage", "setIdleTime", "setLoginTime", "setLastAwayMessageTime", "setRealName",
+                            "setAccount", "setServer", "setIrcOperator"}) {
+        p->setCoalescableSyncCall("IrcUser", slotName);
+    }
 
     p->attachSignal(this, &CoreSession::identityCreated);
     p->attachSignal(this, &CoreSession::identityRemoved);
@@ -118,6 +152,7 @@ CoreSession::CoreSession(UserId uid, bool restoreState, bool strictIdentEnabled,
     data["sessionConnectedClients"] = 0;
     _coreInfo->setCoreData(data);
 
+    setupMetrics();
     loadSettings();
 
     eventManager()->registerObject(ircParser(), EventManager::NormalPriority);
@@ -158,6 +193,7 @@ CoreSession::CoreSession(UserId uid, bool restoreState, bool strictIdentEnabled,
 void CoreSession::shutdown()
 {
     saveSessionState();
+    saveNetworkSnapshot();
 
     // Request disconnect from all connected networks in parallel, and wait until every network
     // has emitted the disconnected() signal before deleting the session itself
@@ -245,15 +281,97 @@ void CoreSession::saveSessionState() const
 
 void CoreSession::restoreSessionState()
 {
+    restoreNetworkSnapshot();
+
+    // Space out connections to the same server, as many sessions may be restored at the same time
     for (NetworkId id : Core::connectedNetworks(user())) {
         auto net = network(id);
         Q_ASSERT(net);
-        net->connectToIrc();
+        int delay = Core::restoreConnectDelay(net->serverList().value(0).host);
+        if (delay > 0)
+            net->connectToIrcDelayed(delay);
+        else
+            net->connectToIrc();
     }
 }
 
+QString CoreSession::networkSnapshotPath() const
+{
+    return QString("%1state/%2.snapshot").arg(Quassel::configDirPath()).arg(user().toInt());
+}
+
+void CoreSession::saveNetworkSnapshot() const
+{
+    const QString path = networkSnapshotPath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write network snapshot" << path << ":" << file.errorString();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_5);
+    out << kSnapshotMagic << kSnapshotVersion << QDateTime::currentDateTimeUtc();
+    for (CoreNetwork* net : _networks) {
+        if (!net->isConnected())
+            continue;
+        // Each network is wrapped in its own blob, so networks not reconnected can be skipped on restore
+        QByteArray data;
+        QDataStream netOut(&data, QIODevice::WriteOnly);
+        netOut.setVersion(QDataStream::Qt_5_5);
+        net->saveSnapshot(netOut);
+        out << net->networkId().toInt() << data;
+    }
+
+    if (!file.commit())
+        qWarning() << "Could not write network snapshot" << path << ":" << file.errorString();
+}
+
+void CoreSession::restoreNetworkSnapshot()
+{
+    QFile file(networkSnapshotPath());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_5);
+    quint32 magic;
+    quint8 version;
+    QDateTime savedAt;
+    in >> magic >> version >> savedAt;
+    if (in.status() == QDataStream::Ok && magic == kSnapshotMagic && version == kSnapshotVersion
+        && savedAt.secsTo(QDateTime::currentDateTimeUtc()) < kMaxSnapshotAgeSecs) {
+        const QList<NetworkId> connectedNetworks = Core::connectedNetworks(user());
+        while (!in.atEnd()) {
+            qint32 netId;
+            QByteArray data;
+            in >> netId >> data;
+            if (in.status() != QDataStream::Ok)
+                break;
+
+            CoreNetwork* net = network(netId);
+            if (!net || !connectedNetworks.contains(netId))
+                continue;
+
+            QDataStream netIn(data);
+            netIn.setVersion(QDataStream::Qt_5_5);
+            if (!net->restoreSnapshot(netIn))
+                qWarning() << "Network snapshot for network" << netId << "is damaged, restored it partially";
+        }
+    }
+
+    // A snapshot only describes the state right before the last shutdown
+    file.remove();
+}
+
 void CoreSession::addClient(RemotePeer* peer)
 {
+    qint64 bufferSize = Quassel::optionValue("client-buffer-size").toLongLong() * 1024;
+    if (bufferSize > 0)
+        peer->setOutputBufferWatermarks(bufferSize / 16, bufferSize);
+
     signalProxy()->setTargetPeer(peer);
 
     peer->dispatch(sessionState());
@@ -262,8 +380,16 @@ void CoreSession::addClient(RemotePeer* peer)
 
     signalProxy()->setTargetPeer(nullptr);
 
+    peer->setDispatchMetrics(_clientDispatchTimeMetric, _clientMessageSizeMetric);
     if (_metricsServer) {
         _metricsServer->addClient(user());
+        connect(peer, &RemotePeer::messagesWritten, this, [this](int frames, qint64 bytes) {
+            _metricsServer->addClientWrite(user(), frames, bytes);
+        });
+        connect(peer, &RemotePeer::outputBufferSizeChanged, this, [this, peer](qint64 size) {
+            _clientOutputBuffers[peer] = size;
+            updateClientOutputQueue();
+        });
     }
 }
 
@@ -282,7 +408,63 @@ void CoreSession::removeClient(Peer* peer)
 
     if (_metricsServer) {
         _metricsServer->removeClient(user());
+        if (peer->isCongested())
+            _metricsServer->removeCongestedClient(user());
+        if (_clientOutputBuffers.remove(peer))
+            updateClientOutputQueue();
     }
+    _withheldMessages.remove(peer);
+}
+
+void CoreSession::updateClientOutputQueue()
+{
+    qint64 size = 0;
+    for (qint64 peerSize : _clientOutputBuffers)
+        size += peerSize;
+    _metricsServer->clientOutputQueue(user(), size);
+}
+
+void CoreSession::onPeerCongestionChanged(Peer* peer, bool congested)
+{
+    if (_metricsServer) {
+        if (congested)
+            _metricsServer->addCongestedClient(user());
+        else
+            _metricsServer->removeCongestedClient(user());
+    }
+
+    if (congested)
+        return;
+
+    const auto withheld = _withheldMessages.take(peer);
+    if (withheld.isEmpty())
+        return;
+
+    qInfo() << qPrintable(tr("Client")) << peer->description()
+            << qPrintable(tr("caught up, announcing missed messages in %1 buffers (UserId: %2).").arg(withheld.size()).arg(user().toInt()));
+    signalProxy()->restrictTargetPeers(peer, [&] {
+        for (auto it = withheld.cbegin(); it != withheld.cend(); ++it) {
+            emit backlogAvailable(it.key(), it->first, MsgId(it->last.toQint64() + 1));
+        }
+    });
+}
+
+void CoreSession::onSignalWithheld(Peer* peer, const QByteArray& signalName, const QVariantList& params)
+{
+    Q_UNUSED(signalName)
+    if (params.isEmpty())
+        return;
+
+    auto msg = params.first().value<Message>();
+    auto& buffers = _withheldMessages[peer];
+    auto it = buffers.find(msg.bufferId());
+    if (it == buffers.end())
+        buffers.insert(msg.bufferId(), {msg.msgId(), msg.msgId()});
+    else
+        it->last = msg.msgId();
+
+    if (_metricsServer)
+        _metricsServer->addWithheldMessages(user(), 1);
 }
 
 QHash<QString, QString> CoreSession::persistentChannels(NetworkId id) const
@@ -305,6 +487,8 @@ void CoreSession::msgFromClient(BufferInfo bufinfo, QString msg)
 {
     CoreNetwork* net = network(bufinfo.networkId());
     if (net) {
+        if (bufinfo.type() == BufferInfo::ChannelBuffer)
+            net->markChannelViewed(bufinfo.bufferName());
         net->userInput(bufinfo, msg);
     }
     else {
@@ -342,6 +526,8 @@ void CoreSession::recvMessageFromServer(RawMessage msg)
 
     _messageQueue << std::move(msg);
     if (!_processMessages) {
+        if (_ingestLatencyMetric)
+            _messageQueueSince = _networkReadStart ? _networkReadStart : Metrics::monotonicMicroseconds();
         _processMessages = true;
         QCoreApplication::postEvent(this, new ProcessMessagesEvent());
     }
@@ -401,8 +587,10 @@ void CoreSession::processMessages()
                     realName(rawMsg.sender, rawMsg.networkId),
                     avatarUrl(rawMsg.sender, rawMsg.networkId),
                     rawMsg.flags);
-        if (Core::storeMessage(msg))
+        if (Core::storeMessage(msg)) {
+            recordMessagesStored(1);
             emit displayMsg(msg);
+        }
     }
     else {
         QHash<NetworkId, QHash<QString, BufferInfo>> bufferInfoCache;
@@ -461,6 +649,7 @@ void CoreSession::processMessages()
         }
 
         if (Core::storeMessages(messages)) {
+            recordMessagesStored(messages.count());
             // FIXME: extend protocol to a displayMessages(MessageList)
             for (int i = 0; i < messages.count(); i++) {
                 emit displayMsg(messages[i]);
@@ -471,6 +660,64 @@ void CoreSession::processMessages()
     _messageQueue.clear();
 }
 
+void CoreSession::recordMessagesStored(int count)
+{
+    if (!_ingestLatencyMetric)
+        return;
+
+    _ingestLatencyMetric->observe(Metrics::monotonicMicroseconds() - _messageQueueSince);
+    _storedMessagesMetric->add(count);
+}
+
+void CoreSession::beginNetworkRead()
+{
+    if (_ingestLatencyMetric)
+        _networkReadStart = Metrics::monotonicMicroseconds();
+}
+
+void CoreSession::endNetworkRead()
+{
+    _networkReadStart = 0;
+}
+
+void CoreSession::setupMetrics()
+{
+    if (!_metricsServer)
+        return;
+
+    const Metrics::Labels labels{{"user", Core::instance()->strictSysIdent(_user)}};
+    _ingestLatencyMetric = MetricsServer::latencyHistogram("quassel_message_ingest_seconds",
+                                                           "Time from reading IRC messages off the socket until they are stored",
+                                                           labels);
+    _storedMessagesMetric = MetricsServer::counter("quassel_messages_stored_total", "Number of IRC messages stored", labels);
+    _clientDispatchTimeMetric = MetricsServer::latencyHistogram("quassel_client_dispatch_seconds",
+                                                                "Time taken to serialize and send a protocol message to a quassel client",
+                                                                labels);
+    _clientMessageSizeMetric = MetricsServer::sizeHistogram("quassel_client_message_bytes",
+                                                            "Uncompressed size of protocol messages sent to quassel clients",
+                                                            labels);
+    _eventLoopLagMetric = MetricsServer::latencyHistogram("quassel_session_event_loop_lag_seconds",
+                                                          "Delay of timers in the session thread's event loop",
+                                                          labels);
+
+    if (_eventLoopLagMetric) {
+        // Restarted on every timeout, so that lag doesn't accumulate
+        _eventLoopLagTimer.setSingleShot(true);
+        _eventLoopLagTimer.setTimerType(Qt::PreciseTimer);
+        connect(&_eventLoopLagTimer, &QTimer::timeout, this, &CoreSession::checkEventLoopLag);
+        _eventLoopLagDeadline = Metrics::monotonicMicroseconds() + kEventLoopLagIntervalMs * 1000;
+        _eventLoopLagTimer.start(kEventLoopLagIntervalMs);
+    }
+}
+
+void CoreSession::checkEventLoopLag()
+{
+    qint64 now = Metrics::monotonicMicroseconds();
+    _eventLoopLagMetric->observe(qMax<qint64>(0, now - _eventLoopLagDeadline));
+    _eventLoopLagDeadline = now + kEventLoopLagIntervalMs * 1000;
+    _eventLoopLagTimer.start(kEventLoopLagIntervalMs);
+}
+
 QString CoreSession::senderPrefixes(const QString& sender, const BufferInfo& bufferInfo) const
 {
     CoreNetwork* currentNetwork = network(bufferInfo.networkId());
@@ -26,6 +26,7 @@
 #include <QHash>
 #include <QSet>
 #include <QString>
+#include <QTimer>
 #include <QVariant>
 
 #include "backgroundtaskhandler.h"
@@ -110,6 +111,14 @@ public:
     //! Return necessary data for restoring the session after restarting the core
     void restoreSessionState();
 
+    /**
+     * Marks the start and end of handling data read from a network's socket.
+     *
+     * Messages queued in between are timed from the start of the read until they're stored.
+     */
+    void beginNetworkRead();
+    void endNetworkRead();
+
 public slots:
     void addClient(RemotePeer* peer);
     void addClient(InternalPeer* peer);
@@ -174,6 +183,15 @@ signals:
     void displayMsg(Message message);
     void displayStatusMsg(QString, QString);
 
+    /**
+     * Informs a client that it missed messages while it was congested.
+     *
+     * @param bufferId The buffer the messages belong to
+     * @param first    Id of the first missed message
+     * @param last     Id following the last missed message
+     */
+    void backlogAvailable(BufferId bufferId, MsgId first, MsgId last);
+
     //! Identity has been created.
     /** This signal is propagated to the clients to tell them that the given identity has been created.
      *  \param identity The new identity.
@@ -202,6 +220,9 @@ protected:
 private slots:
     void removeClient(Peer* peer);
 
+    void onPeerCongestionChanged(Peer* peer, bool congested);
+    void onSignalWithheld(Peer* peer, const QByteArray& signalName, const QVariantList& params);
+
     void recvStatusMsgFromServer(QString msg);
     void recvMessageFromServer(RawMessage msg);
 
@@ -216,9 +237,33 @@ private slots:
 
     void onNetworkDisconnected(NetworkId networkId);
 
+    void checkEventLoopLag();
+
 private:
     void processMessages();
 
+    /// Looks up the per-user metrics of the session, if metrics are enabled
+    void setupMetrics();
+
+    /// Records a batch of messages from the message queue having been stored
+    void recordMessagesStored(int count);
+
+    /// Reports the amount of data queued for all of the user's clients to the metrics server
+    void updateClientOutputQueue();
+
+    /**
+     * Writes the IRC state of all connected networks to the session's snapshot file
+     */
+    void saveNetworkSnapshot() const;
+
+    /**
+     * Restores the IRC state of networks about to be reconnected from the snapshot file, then removes it
+     */
+    void restoreNetworkSnapshot();
+
+    /// Path of the snapshot file written on shutdown and read on the next start
+    QString networkSnapshotPath() const;
+
     void loadSettings();
 
     /// Hook for converting events to the old displayMsg() handlers
@@ -279,6 +324,25 @@ private:
     CoreIgnoreListManager _ignoreListManager;
     CoreHighlightRuleManager _highlightRuleManager;
     MetricsServer* _metricsServer{nullptr};
+
+    Metrics::Histogram* _ingestLatencyMetric{nullptr};
+    Metrics::Counter* _storedMessagesMetric{nullptr};
+    Metrics::Histogram* _clientDispatchTimeMetric{nullptr};
+    Metrics::Histogram* _clientMessageSizeMetric{nullptr};
+    Metrics::Histogram* _eventLoopLagMetric{nullptr};
+    QTimer _eventLoopLagTimer;
+    qint64 _eventLoopLagDeadline{0};  ///< When the lag timer should fire, in monotonic microseconds
+    qint64 _networkReadStart{0};      ///< Start of the network read being handled, in monotonic microseconds, or 0
+    qint64 _messageQueueSince{0};     ///< Start of the network read the oldest queued message came from
+
+    /// Range of messages withheld from a congested client, per buffer
+    struct WithheldRange
+    {
+        MsgId first;
+        MsgId last;
+    };
+    QHash<Peer*, QHash<BufferId, WithheldRange>> _withheldMessages;
+    QHash<Peer*, qint64> _clientOutputBuffers;  ///< Output buffer size per client, for metrics
 };
 
 struct NetworkInternalMessage
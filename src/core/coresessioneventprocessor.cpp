@@ -1262,7 +1262,11 @@ void CoreSessionEventProcessor::processIrcEvent353(IrcEvent* e)
         modes << mode;
     }
 
-    channel->joinIrcUsers(nicks, modes);
+    auto* coreChannel = qobject_cast<CoreIrcChannel*>(channel);
+    if (coreChannel && coreChannel->isRefreshing())
+        coreChannel->refreshUsers(nicks, modes);
+    else
+        channel->joinIrcUsers(nicks, modes);
 }
 
 /*  RPL_WHOSPCRPL: "<yournick> 152 #<channel> ~<ident> <host> <servname> <nick>
@@ -1279,6 +1283,21 @@ void CoreSessionEventProcessor::processIrcEvent354(IrcEvent* e)
     if (!checkParamCount(e, 1))
         return;
 
+    if (e->params()[0].toUInt() == IrcCap::AUTOWHO_REFRESH_WHOX_NUM) {
+        // Periodic automatic WHO, see CoreNetwork::sendAutoWho(): channel, nick, flags and maybe the account
+        if (!checkParamCount(e, 4))
+            return;
+
+        IrcUser* ircuser = e->network()->ircUser(e->params()[2]);
+        if (ircuser) {
+            processWhoStatus(e->network(), e->params()[1], ircuser, e->params()[3]);
+            if (e->params().count() > 4)
+                processWhoAccount(ircuser, e->params()[4]);
+        }
+        e->setFlag(EventManager::Silent);
+        return;
+    }
+
     if (e->params()[0].toUInt() != IrcCap::ACCOUNT_NOTIFY_WHOX_NUM) {
         // Ignore WHOX replies without expected number for we have no idea what fields are specified
         return;
@@ -1301,16 +1320,7 @@ void CoreSessionEventProcessor::processIrcEvent354(IrcEvent* e)
         // Don't use .section(" ", 1) with WHOX replies, for there's no hopcount to trim out
 
         // As part of IRCv3 account-notify, check account name
-        // WHOX uses '0' to indicate logged-out, account-notify and extended-join uses '*'.
-        QString newAccount = e->params()[7];
-        if (newAccount != "0") {
-            // Account logged in, set account name
-            ircuser->setAccount(newAccount);
-        }
-        else {
-            // Account logged out, set account name to logged-out
-            ircuser->setAccount("*");
-        }
+        processWhoAccount(ircuser, e->params()[7]);
     }
 
     // Check if channel name has a who in progress.
@@ -1319,6 +1329,18 @@ void CoreSessionEventProcessor::processIrcEvent354(IrcEvent* e)
     }
 }
 
+/* RPL_ENDOFNAMES: "<channel> :End of NAMES list" */
+void CoreSessionEventProcessor::processIrcEvent366(IrcEvent* e)
+{
+    if (!checkParamCount(e, 1))
+        return;
+
+    // Users of a channel restored from a snapshot that weren't listed have left meanwhile
+    auto* coreChannel = qobject_cast<CoreIrcChannel*>(e->network()->ircChannel(e->params()[0]));
+    if (coreChannel && coreChannel->isRefreshing())
+        coreChannel->endRefresh();
+}
+
 void CoreSessionEventProcessor::processWhoInformation(Network* net,
                                                       const QString& targetChannel,
                                                       IrcUser* ircUser,
@@ -1333,6 +1355,11 @@ void CoreSessionEventProcessor::processWhoInformation(Network* net,
     ircUser->setServer(server);
     ircUser->setRealName(realname);
 
+    processWhoStatus(net, targetChannel, ircUser, awayStateAndModes);
+}
+
+void CoreSessionEventProcessor::processWhoStatus(Network* net, const QString& targetChannel, IrcUser* ircUser, const QString& awayStateAndModes)
+{
     bool away = awayStateAndModes.contains("G", Qt::CaseInsensitive);
     ircUser->setAway(away);
 
@@ -1374,6 +1401,19 @@ void CoreSessionEventProcessor::processWhoInformation(Network* net,
     }
 }
 
+void CoreSessionEventProcessor::processWhoAccount(IrcUser* ircUser, const QString& account)
+{
+    // WHOX uses '0' to indicate logged-out, account-notify and extended-join uses '*'.
+    if (account != "0") {
+        // Account logged in, set account name
+        ircUser->setAccount(account);
+    }
+    else {
+        // Account logged out, set account name to logged-out
+        ircUser->setAccount("*");
+    }
+}
+
 /* ERR_NOSUCHCHANNEL - "<channel name> :No such channel" */
 void CoreSessionEventProcessor::processIrcEvent403(IrcEventNumeric* e)
 {
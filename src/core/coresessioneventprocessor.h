@@ -94,6 +94,7 @@ public:
     Q_INVOKABLE void processIrcEvent352(IrcEvent* event);         // RPL_WHOREPLY
     Q_INVOKABLE void processIrcEvent353(IrcEvent* event);         // RPL_NAMREPLY
     Q_INVOKABLE void processIrcEvent354(IrcEvent* event);         // RPL_WHOSPCRPL
+    Q_INVOKABLE void processIrcEvent366(IrcEvent* event);         // RPL_ENDOFNAMES
     Q_INVOKABLE void processIrcEvent403(IrcEventNumeric* event);  // ERR_NOSUCHCHANNEL
     Q_INVOKABLE void processIrcEvent432(IrcEventNumeric* event);  // ERR_ERRONEUSNICKNAME
     Q_INVOKABLE void processIrcEvent433(IrcEventNumeric* event);  // ERR_NICKNAMEINUSE
@@ -185,4 +186,22 @@ private:
                                const QString& host,
                                const QString& awayStateAndModes,
                                const QString& realname);
+
+    /**
+     * Process the away state and modes from a WHO reply
+     *
+     * @param[in] net                 Network object for the IRC server
+     * @param[in] targetChannel       Target channel, or * if unspecified
+     * @param[in] ircUser             IrcUser representing the desired nick
+     * @param[in] awayStateAndModes   Nick away-state and modes (e.g. G@)
+     */
+    void processWhoStatus(Network* net, const QString& targetChannel, IrcUser* ircUser, const QString& awayStateAndModes);
+
+    /**
+     * Process the account name from a WHOX reply
+     *
+     * @param[in] ircUser  IrcUser representing the desired nick
+     * @param[in] account  Account name, or 0 if logged out
+     */
+    void processWhoAccount(IrcUser* ircUser, const QString& account);
 };
@@ -20,14 +20,26 @@
 
 #include "coretransfer.h"
 
-#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QTcpSocket>
 #include <QtEndian>
 
 #include "util.h"
 
+namespace {
+
 const qint64 chunkSize = 16 * 1024;
 
+// Amount of data read from the DCC socket at once
+const int readBufferSize = 256 * 1024;
+
+// Upper bound of chunks relayed to a client per event loop iteration
+const int maxRelayChunks = 64;
+
+}  // namespace
+
 CoreTransfer::CoreTransfer(Direction direction,
                            const QString& nick,
                            const QString& fileName,
@@ -38,30 +50,79 @@ CoreTransfer::CoreTransfer(Direction direction,
     : Transfer(direction, nick, fileName, address, port, fileSize, parent)
     , _socket(nullptr)
     , _pos(0)
-    , _reading(false)
 {}
 
+CoreTransfer::~CoreTransfer()
+{
+    delete _spoolFile;
+    delete _spoolReader;
+    if (!_spoolFilePath.isEmpty())
+        QFile::remove(_spoolFilePath);
+}
+
 quint64 CoreTransfer::transferred() const
 {
     return _pos;
 }
 
+void CoreTransfer::setSpoolFilePath(const QString& spoolFilePath)
+{
+    _spoolFilePath = spoolFilePath;
+}
+
+quint64 CoreTransfer::spoolSize() const
+{
+    return _spoolReader ? _pos : 0;
+}
+
+bool CoreTransfer::isRelaying() const
+{
+    return _relayPeer && _relayPos < _pos;
+}
+
+void CoreTransfer::abort(const QString& reason)
+{
+    if (status() == Status::Completed || status() == Status::Failed || status() == Status::Rejected)
+        return;
+
+    setError(reason);
+}
+
 void CoreTransfer::cleanUp()
 {
     if (_socket) {
+        // We're done with the socket, don't get notified about its disconnect anymore
+        disconnect(_socket, nullptr, this, nullptr);
         _socket->close();
         _socket->deleteLater();
         _socket = nullptr;
     }
 
-    _buffer.clear();
-    _reading = false;
+    _readBuffer.clear();
+
+    if (_spoolFile) {
+        _spoolFile->close();
+        delete _spoolFile;
+        _spoolFile = nullptr;
+    }
+
+    // Completed transfers stay available for fetching from the spool
+    if (status() == Status::Failed) {
+        _relayPeer = nullptr;
+        delete _spoolReader;
+        _spoolReader = nullptr;
+        if (!_spoolFilePath.isEmpty())
+            QFile::remove(_spoolFilePath);
+    }
 }
 
 void CoreTransfer::onSocketDisconnected()
 {
     if (status() == Status::Connecting || status() == Status::Transferring) {
-        setError(tr("Socket closed while still transferring!"));
+        if (_pos < fileSize())
+            setError(tr("Socket closed while still transferring!"));
+        else
+            checkCompleted();  // Everything has been received, we're only waiting for the relay
     }
     else
         cleanUp();
@@ -71,7 +132,7 @@ void CoreTransfer::onSocketError(QAbstractSocket::SocketError error)
 {
     Q_UNUSED(error)
 
-    if (status() == Status::Connecting || status() == Status::Transferring) {
+    if ((status() == Status::Connecting || status() == Status::Transferring) && _pos < fileSize()) {
         setError(tr("DCC connection error: %1").arg(_socket->errorString()));
     }
 }
@@ -86,6 +147,10 @@ void CoreTransfer::requestAccepted(PeerPtr peer)
 
     emit accepted(peer);
 
+    // Clients that don't know about spooling expect the data to be pushed to them
+    if (!peer->hasFeature(Quassel::Feature::SpooledTransfers))
+        startRelay(peer, 0);
+
     // FIXME temporary until we have queueing
     start();
 }
@@ -101,6 +166,14 @@ void CoreTransfer::requestRejected(PeerPtr peer)
     emit rejected(peer);
 }
 
+void CoreTransfer::requestData(PeerPtr peer, quint64 offset)
+{
+    if (!peer || status() == Status::New || status() == Status::Rejected || status() == Status::Failed)
+        return;
+
+    startRelay(peer, offset);
+}
+
 void CoreTransfer::start()
 {
     if (!_peer || status() != Status::Pending || direction() != Direction::Receive)
@@ -116,7 +189,14 @@ void CoreTransfer::setupConnectionForReceive()
         return;
     }
 
+    if (!openSpoolFile())
+        return;
+
     setStatus(Status::Connecting);
+    if (status() != Status::Connecting)
+        return;  // aborted when connecting, e.g. for lack of spool space
+
+    _readBuffer.resize(readBufferSize);
 
     _socket = new QTcpSocket(this);
     connect(_socket, &QAbstractSocket::connected, this, &CoreTransfer::startReceiving);
@@ -127,6 +207,28 @@ void CoreTransfer::setupConnectionForReceive()
     _socket->connectToHost(address(), port());
 }
 
+bool CoreTransfer::openSpoolFile()
+{
+    if (_spoolFilePath.isEmpty()) {
+        setError(tr("DCC Receive: No spool file available!"));
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(_spoolFilePath).absolutePath());
+
+    _spoolFile = new QFile(_spoolFilePath);
+    if (!_spoolFile->open(QFile::WriteOnly | QFile::Truncate)) {
+        setError(tr("DCC Receive: Could not open spool file: %1").arg(_spoolFile->errorString()));
+        return false;
+    }
+    _spoolReader = new QFile(_spoolFilePath);
+    if (!_spoolReader->open(QFile::ReadOnly)) {
+        setError(tr("DCC Receive: Could not open spool file: %1").arg(_spoolReader->errorString()));
+        return false;
+    }
+    return true;
+}
+
 void CoreTransfer::startReceiving()
 {
     setStatus(Status::Transferring);
@@ -134,21 +236,22 @@ void CoreTransfer::startReceiving()
 
 void CoreTransfer::onDataReceived()
 {
-    if (_reading)  // since we're spinning the event loop, we may get another readyRead() and thus reentrancy
+    if (!_spoolFile)
         return;
-    _reading = true;
 
-    while (_socket->bytesAvailable()) {
-        QByteArray data = _socket->read(chunkSize);
-        _pos += data.size();
-        emit transferredChanged(transferred());
-        if (!relayData(data, true))
-            return;
-
-        QCoreApplication::processEvents();  // don't block the rest of the core/client communication
-        if (!_socket)                       // just in case something happened during spinning the event loop that killed our socket
+    // Write everything that's available straight to the spool, without keeping it in memory or
+    // waiting for clients
+    qint64 bytesRead;
+    while ((bytesRead = _socket->read(_readBuffer.data(), _readBuffer.size())) > 0) {
+        if (_spoolFile->write(_readBuffer.constData(), bytesRead) != bytesRead) {
+            setError(tr("DCC Receive: Could not write to spool file: %1").arg(_spoolFile->errorString()));
             return;
+        }
+        _pos += bytesRead;
     }
+    // Make the data visible to the read handle
+    _spoolFile->flush();
+    emit transferredChanged(transferred());
 
     // Send ack to sender. The DCC protocol only specifies 32 bit values, but modern clients (i.e. those who can send files
     // larger than 4 GB) will ignore this anyway...
@@ -158,31 +261,87 @@ void CoreTransfer::onDataReceived()
     if (_pos > fileSize()) {
         qWarning() << "DCC Receive: Got more data than expected!";
         setError(tr("DCC Receive: Got more data than expected!"));
+        return;
     }
-    else if (_pos == fileSize()) {
+
+    scheduleRelay();
+    if (_pos == fileSize()) {
         qDebug() << "DCC Receive: Transfer finished";
-        if (relayData(QByteArray(), false))  // empty buffer
-            setStatus(Status::Completed);
+        checkCompleted();
     }
+}
 
-    _reading = false;
+void CoreTransfer::startRelay(Peer* peer, quint64 offset)
+{
+    if (_relayPeer && _relayPeer != peer)
+        disconnect(_relayPeer, nullptr, this, nullptr);
+
+    if (_relayPeer != peer) {
+        _relayPeer = peer;
+        connect(peer, &Peer::congestionChanged, this, [this](bool congested) {
+            if (!congested)
+                scheduleRelay();
+        });
+    }
+    _relayPos = offset;
+    scheduleRelay();
 }
 
-bool CoreTransfer::relayData(const QByteArray& data, bool requireChunkSize)
+void CoreTransfer::scheduleRelay()
 {
-    // safeguard against a disconnecting quasselclient
-    if (!_peer) {
-        setError(tr("DCC Receive: Quassel Client disconnected during transfer!"));
-        return false;
+    if (_relayScheduled || !_relayPeer)
+        return;
+
+    _relayScheduled = true;
+    QMetaObject::invokeMethod(this, "relaySpooledData", Qt::QueuedConnection);
+}
+
+void CoreTransfer::relaySpooledData()
+{
+    _relayScheduled = false;
+    if (!_spoolReader)
+        return;
+
+    // Hand out a bounded amount of data per event loop iteration, and pause while the client can't
+    // keep up; relaying continues once its congestion clears
+    for (int i = 0; i < maxRelayChunks && _relayPeer && _relayPos < _pos; i++) {
+        if (_relayPeer->isCongested())
+            return;
+
+        if (!_spoolReader->seek(_relayPos)) {
+            setError(tr("DCC Receive: Could not read from spool file: %1").arg(_spoolReader->errorString()));
+            return;
+        }
+        QByteArray data = _spoolReader->read(qMin<quint64>(chunkSize, _pos - _relayPos));
+        if (data.isEmpty()) {
+            setError(tr("DCC Receive: Could not read from spool file: %1").arg(_spoolReader->errorString()));
+            return;
+        }
+
+        Peer* p = _relayPeer.data();
+        SYNC_OTHER(dataReceived, ARG(p), ARG(data));
+        _relayPos += data.size();
     }
-    _buffer.append(data);
 
-    // we only want to send data to the client once we have reached the chunksize
-    if (_buffer.size() > 0 && (_buffer.size() >= chunkSize || !requireChunkSize)) {
-        Peer* p = _peer.data();
-        SYNC_OTHER(dataReceived, ARG(p), ARG(_buffer));
-        _buffer.clear();
+    if (_relayPeer && _relayPos < _pos) {
+        scheduleRelay();
+    }
+    else {
+        checkCompleted();
+        if (_relayPeer && status() == Status::Completed)
+            emit spoolRelayed();
     }
+}
 
-    return true;
+void CoreTransfer::checkCompleted()
+{
+    if (_pos != fileSize() || (status() != Status::Connecting && status() != Status::Transferring))
+        return;
+
+    // The client that's fetching the file must have received everything before it sees the transfer completed, as it
+    // finishes its local file on that
+    if (_relayPeer && _relayPos < _pos)
+        return;
+
+    setStatus(Status::Completed);
 }
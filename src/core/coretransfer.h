@@ -20,14 +20,17 @@
 
 #pragma once
 
+#include "core-export.h"
+
 #include <QPointer>
 
 #include "peer.h"
 #include "transfer.h"
 
+class QFile;
 class QTcpSocket;
 
-class CoreTransfer : public Transfer
+class CORE_EXPORT CoreTransfer : public Transfer
 {
     Q_OBJECT
 
@@ -39,30 +42,77 @@ public:
                  quint16 port,
                  quint64 size = 0,
                  QObject* parent = nullptr);
+    ~CoreTransfer() override;
 
     quint64 transferred() const override;
 
+    /**
+     * Sets the file received data is spooled to
+     *
+     * Received data is written straight to this file instead of being kept in memory, and relayed
+     * to clients from there at the pace they can take it.  The file is removed along with the
+     * transfer.
+     *
+     * @param spoolFilePath Path of the spool file
+     */
+    void setSpoolFilePath(const QString& spoolFilePath);
+
+    /**
+     * Gets the amount of received data currently kept in the spool file
+     *
+     * @return Spool file size in bytes
+     */
+    quint64 spoolSize() const;
+
+    /**
+     * Checks if spooled data is currently being relayed to a client
+     *
+     * @return True if a client is still fetching the data received so far, otherwise false
+     */
+    bool isRelaying() const;
+
+    /**
+     * Aborts the transfer, discarding anything received so far
+     *
+     * @param reason Error message shown to clients
+     */
+    void abort(const QString& reason);
+
+signals:
+    /// A client has fetched the whole file, the spool is no longer needed
+    void spoolRelayed();
+
 public slots:
     void start();
 
     // called through sync calls
     void requestAccepted(PeerPtr peer) override;
     void requestRejected(PeerPtr peer) override;
+    void requestData(PeerPtr peer, quint64 offset) override;
 
 private slots:
     void startReceiving();
     void onDataReceived();
     void onSocketDisconnected();
     void onSocketError(QAbstractSocket::SocketError error);
+    void relaySpooledData();
 
 private:
     void setupConnectionForReceive();
-    bool relayData(const QByteArray& data, bool requireChunkSize);
+    bool openSpoolFile();
+    void startRelay(Peer* peer, quint64 offset);
+    void scheduleRelay();
+    void checkCompleted();
     void cleanUp() override;
 
     QPointer<Peer> _peer;
+    QPointer<Peer> _relayPeer;  ///< Peer spooled data is currently relayed to
     QTcpSocket* _socket;
+    QString _spoolFilePath;
+    QFile* _spoolFile{nullptr};    ///< Write handle for received data
+    QFile* _spoolReader{nullptr};  ///< Read handle for relaying data
+    QByteArray _readBuffer;
     quint64 _pos;
-    QByteArray _buffer;
-    bool _reading;
+    quint64 _relayPos{0};
+    bool _relayScheduled{false};
 };
@@ -19,3 +19,138 @@
  ***************************************************************************/
 
 #include "coretransfermanager.h"
+
+#include <utility>
+
+#include <QDir>
+
+#include "coresession.h"
+#include "coretransfer.h"
+#include "quassel.h"
+
+namespace {
+
+// Finished transfers nobody fetched are dropped along with their spool after this long
+constexpr int kSpoolExpiryMs = 24 * 60 * 60 * 1000;
+
+}  // namespace
+
+CoreTransferManager::CoreTransferManager(CoreSession* session)
+    : CoreTransferManager(QString("%1dcc/%2/").arg(Quassel::configDirPath()).arg(session->user().toInt()),
+                          Quassel::optionValue("dcc-spool-size").toULongLong() * 1024 * 1024,
+                          kSpoolExpiryMs,
+                          session)
+{}
+
+CoreTransferManager::CoreTransferManager(QString spoolDirPath, quint64 spoolSizeLimit, int spoolExpiryMs, QObject* parent)
+    : TransferManager(parent)
+    , _spoolDirPath(std::move(spoolDirPath))
+    , _spoolSizeLimit(spoolSizeLimit)
+    , _spoolExpiryMs(spoolExpiryMs)
+{
+    // Transfers don't survive a restart, so anything left in the spool is stale
+    QDir spoolDir(_spoolDirPath);
+    if (spoolDir.exists())
+        spoolDir.removeRecursively();
+}
+
+CoreTransferManager::~CoreTransferManager()
+{
+    for (TimerWheel::TimerId timeout : _expiryTimeouts) {
+        TimerWheel::forCurrentThread()->cancel(timeout);
+    }
+}
+
+QString CoreTransferManager::spoolFilePath(const QUuid& uuid) const
+{
+    return _spoolDirPath + uuid.toString().mid(1, 36);
+}
+
+quint64 CoreTransferManager::spoolSize() const
+{
+    quint64 size = 0;
+    for (const QUuid& uuid : transferIds()) {
+        auto transfer = qobject_cast<const CoreTransfer*>(this->transfer(uuid));
+        if (!transfer)
+            continue;
+        if (transfer->status() == Transfer::Status::Connecting || transfer->status() == Transfer::Status::Transferring)
+            size += qMax(transfer->fileSize(), transfer->spoolSize());
+        else
+            size += transfer->spoolSize();
+    }
+    return size;
+}
+
+void CoreTransferManager::addTransfer(CoreTransfer* transfer)
+{
+    if (transfer->direction() == Transfer::Direction::Receive)
+        transfer->setSpoolFilePath(spoolFilePath(transfer->uuid()));
+
+    connect(transfer, &Transfer::statusChanged, this, [this, transfer]() { onStatusChanged(transfer); });
+    connect(transfer, &CoreTransfer::spoolRelayed, this, [this, transfer]() { onSpoolRelayed(transfer); });
+
+    TransferManager::addTransfer(transfer);
+}
+
+void CoreTransferManager::onStatusChanged(CoreTransfer* transfer)
+{
+    switch (transfer->status()) {
+    case Transfer::Status::Connecting:
+        if (!reserveSpoolSpace(transfer))
+            transfer->abort(tr("DCC Receive: Not enough spool space left on the core for this file!"));
+        break;
+    case Transfer::Status::Completed:
+    case Transfer::Status::Failed:
+    case Transfer::Status::Rejected: {
+        // Keep the transfer around for a while, so clients can still fetch the file or see what became of it
+        QUuid uuid = transfer->uuid();
+        if (_expiryTimeouts.contains(uuid))
+            break;
+        _finishedTransfers.append(uuid);
+        _expiryTimeouts[uuid] = TimerWheel::forCurrentThread()->schedule(_spoolExpiryMs, [this, uuid]() {
+            _expiryTimeouts.remove(uuid);
+            dropTransfer(uuid);
+        });
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void CoreTransferManager::onSpoolRelayed(CoreTransfer* transfer)
+{
+    // A client has all of the file now, so there's no point in keeping it around any longer
+    dropTransfer(transfer->uuid());
+}
+
+bool CoreTransferManager::reserveSpoolSpace(CoreTransfer* transfer)
+{
+    // The new transfer is already accounted for in spoolSize(), as it's connecting
+    if (transfer->fileSize() > _spoolSizeLimit)
+        return false;
+
+    // Make room by dropping the oldest files still waiting to be fetched, unless they're being fetched right now
+    for (int i = 0; i < _finishedTransfers.size() && spoolSize() > _spoolSizeLimit;) {
+        QUuid uuid = _finishedTransfers.at(i);
+        auto finished = qobject_cast<CoreTransfer*>(this->transfer(uuid));
+        if (finished && finished->isRelaying()) {
+            ++i;
+            continue;
+        }
+        dropTransfer(uuid);
+    }
+    return spoolSize() <= _spoolSizeLimit;
+}
+
+void CoreTransferManager::dropTransfer(const QUuid& uuid)
+{
+    _finishedTransfers.removeOne(uuid);
+    if (_expiryTimeouts.contains(uuid))
+        TimerWheel::forCurrentThread()->cancel(_expiryTimeouts.take(uuid));
+
+    if (!transfer(uuid))
+        return;
+    // Deleting the transfer also deletes its spool file
+    removeTransfer(uuid);
+}
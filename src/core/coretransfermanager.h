@@ -20,17 +20,74 @@
 
 #pragma once
 
+#include "core-export.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QUuid>
+
+#include "timerwheel.h"
 #include "transfermanager.h"
 
+class CoreSession;
 class CoreTransfer;
 
-class CoreTransferManager : public TransferManager
+class CORE_EXPORT CoreTransferManager : public TransferManager
 {
     Q_OBJECT
 
 public:
-    using TransferManager::TransferManager;
+    explicit CoreTransferManager(CoreSession* session);
+
+    /**
+     * Constructs a transfer manager spooling to the given directory
+     *
+     * @param spoolDirPath   Directory received data is spooled to, including a trailing slash
+     * @param spoolSizeLimit Maximum size of all spool files together, in bytes
+     * @param spoolExpiryMs  How long finished transfers are kept around for clients to fetch, in milliseconds
+     * @param parent         Parent object
+     */
+    CoreTransferManager(QString spoolDirPath, quint64 spoolSizeLimit, int spoolExpiryMs, QObject* parent = nullptr);
+    ~CoreTransferManager() override;
+
+    /**
+     * Gets the path received data of the given transfer is spooled to
+     *
+     * Each user has their own spool directory within the config directory.
+     *
+     * @param uuid Transfer ID
+     * @return Path of the spool file
+     */
+    QString spoolFilePath(const QUuid& uuid) const;
+
+    /**
+     * Gets the space taken up by spool files, or reserved for transfers still receiving
+     *
+     * @return Spool size in bytes
+     */
+    quint64 spoolSize() const;
+
+    /**
+     * Adds a transfer and applies the spool retention policy to it
+     *
+     * Transfers are removed (and their spool deleted) as soon as a client has fetched all of the received data, or
+     * otherwise once they have been finished for a while. Transfers that would exceed the spool size limit fail
+     * right away, after the oldest finished transfers have been dropped to make room.
+     *
+     * @param transfer Transfer to add; its spool file path is set up here
+     */
+    void addTransfer(CoreTransfer* transfer);
+
+private:
+    void onStatusChanged(CoreTransfer* transfer);
+    void onSpoolRelayed(CoreTransfer* transfer);
+    bool reserveSpoolSpace(CoreTransfer* transfer);
+    void dropTransfer(const QUuid& uuid);
 
-    // make available unprotected
-    using TransferManager::addTransfer;
+    QString _spoolDirPath;
+    quint64 _spoolSizeLimit;
+    int _spoolExpiryMs;
+    QList<QUuid> _finishedTransfers;  ///< Finished transfers waiting to expire, oldest first
+    QHash<QUuid, TimerWheel::TimerId> _expiryTimeouts;
 };
@@ -28,6 +28,8 @@
 
 #include "ldapauthenticator.h"
 
+#include <QMutexLocker>
+
 #include "ldapescaper.h"
 #include "network.h"
 #include "quassel.h"
@@ -129,6 +131,7 @@ UserId LdapAuthenticator::validateUser(const QString& username, const QString& p
     // Users created via LDAP have empty passwords, but authenticator column = LDAP.
     // On the other hand, if auth succeeds and the user already exists, do a final
     // cross-check to confirm we're using the right auth provider.
+    QMutexLocker locker(&_userCreationMutex);
     UserId quasselId = Core::getUserId(lUsername);
     if (!quasselId.isValid()) {
         return Core::addUser(lUsername, QString(), backendId());
@@ -212,6 +215,8 @@ bool LdapAuthenticator::ldapAuth(const QString& username, const QString& passwor
         return false;
     }
 
+    QMutexLocker locker(&_connectionMutex);
+
     int res;
 
     // Attempt to establish a connection.
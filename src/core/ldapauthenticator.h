@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <QMutex>
+
 #include "authenticator.h"
 #include "core.h"
 
@@ -89,4 +91,8 @@ private:
 
     // The actual connection object.
     LDAP* _connection{nullptr};
+    // Logins are checked on several worker threads, but they share the connection
+    QMutex _connectionMutex;
+    // Keeps concurrent first logins of the same user from both creating it
+    QMutex _userCreationMutex;
 };
@@ -31,9 +31,81 @@
 #include "core.h"
 #include "corenetwork.h"
 
+namespace {
+
+/// Writes metrics from the registry in the Prometheus text exposition format
+class PrometheusExporter : public Metrics::Exporter
+{
+public:
+    explicit PrometheusExporter(int64_t timestamp)
+        : _timestamp(QString::number(timestamp))
+    {}
+
+    const QByteArray& output() const { return _output; }
+
+    void beginFamily(const Metrics::Family& family) override
+    {
+        _output += QString("# HELP %1 %2\n").arg(family.name, family.help).toUtf8();
+        _output += QString("# TYPE %1 %2\n")
+                       .arg(family.name, family.type == Metrics::Family::Type::Histogram ? "histogram" : "counter")
+                       .toUtf8();
+    }
+
+    void addCounter(const Metrics::Family& family, const Metrics::Labels& labels, quint64 value) override
+    {
+        writeSample(family.name, labels, {}, formatValue(family, value));
+    }
+
+    void addHistogram(const Metrics::Family& family, const Metrics::Labels& labels, const Metrics::Histogram::Snapshot& snapshot) override
+    {
+        const QString bucketName = family.name + "_bucket";
+        for (size_t i = 0; i < snapshot.bounds.size(); ++i) {
+            writeSample(bucketName, labels, formatValue(family, snapshot.bounds[i]), QString::number(snapshot.buckets[i]));
+        }
+        writeSample(bucketName, labels, "+Inf", QString::number(snapshot.count));
+        writeSample(family.name + "_sum", labels, {}, formatValue(family, snapshot.sum));
+        writeSample(family.name + "_count", labels, {}, QString::number(snapshot.count));
+    }
+
+private:
+    static QString formatValue(const Metrics::Family& family, double value)
+    {
+        return QString::number(value * family.scale, 'g', 12);
+    }
+
+    static QString escapeLabel(QString value)
+    {
+        return value.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    }
+
+    void writeSample(const QString& name, const Metrics::Labels& labels, const QString& le, const QString& value)
+    {
+        QStringList labelList;
+        for (auto&& label : labels) {
+            labelList << QString("%1=\"%2\"").arg(label.first, escapeLabel(label.second));
+        }
+        if (!le.isEmpty()) {
+            labelList << QString("le=\"%1\"").arg(le);
+        }
+        QString sample = name;
+        if (!labelList.isEmpty()) {
+            sample += "{" + labelList.join(",") + "}";
+        }
+        _output += QString("%1 %2 %3\n").arg(sample, value, _timestamp).toUtf8();
+    }
+
+    QString _timestamp;
+    QByteArray _output;
+};
+
+}  // namespace
+
 MetricsServer::MetricsServer(QObject* parent)
     : QObject(parent)
 {
+    // Only record the more detailed metrics if someone can fetch them
+    Metrics::Registry::instance().setEnabled(true);
+
     connect(&_server, &QTcpServer::newConnection, this, &MetricsServer::incomingConnection);
     connect(&_v6server, &QTcpServer::newConnection, this, &MetricsServer::incomingConnection);
 }
@@ -243,6 +315,60 @@ void MetricsServer::respond()
                     .arg(timestamp)
                     .toUtf8()
             );
+            socket->write("# HELP quassel_client_messages_sent Number of protocol messages sent to quassel clients\n");
+            socket->write("# TYPE quassel_client_messages_sent counter\n");
+            socket->write(
+                QString("quassel_client_messages_sent{user=\"%1\"} %2 %3\n")
+                    .arg(name)
+                    .arg(_clientFramesTransmit.value(key, 0))
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+            socket->write("# HELP quassel_client_writes Number of batched socket writes to quassel clients\n");
+            socket->write("# TYPE quassel_client_writes counter\n");
+            socket->write(
+                QString("quassel_client_writes{user=\"%1\"} %2 %3\n")
+                    .arg(name)
+                    .arg(_clientWritesTransmit.value(key, 0))
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+            socket->write("# HELP quassel_client_bytes_sent Amount of uncompressed bytes sent to quassel clients\n");
+            socket->write("# TYPE quassel_client_bytes_sent counter\n");
+            socket->write(
+                QString("quassel_client_bytes_sent{user=\"%1\"} %2 %3\n")
+                    .arg(name)
+                    .arg(_clientDataTransmit.value(key, 0))
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+            socket->write("# HELP quassel_client_output_queue_bytes Amount of data waiting to be sent to quassel clients\n");
+            socket->write("# TYPE quassel_client_output_queue_bytes gauge\n");
+            socket->write(
+                QString("quassel_client_output_queue_bytes{user=\"%1\"} %2 %3\n")
+                    .arg(name)
+                    .arg(_clientOutputQueue.value(key, 0))
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+            socket->write("# HELP quassel_client_congested Number of quassel clients currently unable to keep up with the core\n");
+            socket->write("# TYPE quassel_client_congested gauge\n");
+            socket->write(
+                QString("quassel_client_congested{user=\"%1\"} %2 %3\n")
+                    .arg(name)
+                    .arg(_congestedClients.value(key, 0))
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+            socket->write("# HELP quassel_client_messages_withheld Number of messages withheld from congested quassel clients\n");
+            socket->write("# TYPE quassel_client_messages_withheld counter\n");
+            socket->write(
+                QString("quassel_client_messages_withheld{user=\"%1\"} %2 %3\n")
+                    .arg(name)
+                    .arg(_withheldMessages.value(key, 0))
+                    .arg(timestamp)
+                    .toUtf8()
+            );
             socket->write("# HELP quassel_login_attempts The number of times the user has attempted to log in\n");
             socket->write("# TYPE quassel_login_attempts counter\n");
             socket->write(
@@ -270,6 +396,9 @@ void MetricsServer::respond()
                     .toUtf8()
             );
         }
+        PrometheusExporter exporter{timestamp};
+        Metrics::Registry::instance().collect(exporter);
+        socket->write(exporter.output());
         socket->close();
     }
     else if (requestPath == "/healthz") {
@@ -382,7 +511,57 @@ void MetricsServer::messageQueue(UserId user, uint64_t size)
     _messageQueue.insert(user, size);
 }
 
+void MetricsServer::addClientWrite(UserId user, int frames, int64_t bytes)
+{
+    _clientFramesTransmit.insert(user, _clientFramesTransmit.value(user, 0) + frames);
+    _clientWritesTransmit.insert(user, _clientWritesTransmit.value(user, 0) + 1);
+    _clientDataTransmit.insert(user, _clientDataTransmit.value(user, 0) + bytes);
+}
+
+void MetricsServer::clientOutputQueue(UserId user, uint64_t size)
+{
+    _clientOutputQueue.insert(user, size);
+}
+
+void MetricsServer::addCongestedClient(UserId user)
+{
+    _congestedClients.insert(user, _congestedClients.value(user, 0) + 1);
+}
+
+void MetricsServer::removeCongestedClient(UserId user)
+{
+    int32_t count = _congestedClients.value(user, 0) - 1;
+    if (count <= 0) {
+        _congestedClients.remove(user);
+    }
+    else {
+        _congestedClients.insert(user, count);
+    }
+}
+
+void MetricsServer::addWithheldMessages(UserId user, uint64_t count)
+{
+    _withheldMessages.insert(user, _withheldMessages.value(user, 0) + count);
+}
+
 void MetricsServer::setCertificateExpires(QDateTime expires)
 {
     _certificateExpires = std::move(expires);
 }
+
+Metrics::Histogram* MetricsServer::latencyHistogram(const QString& name, const QString& help, const Metrics::Labels& labels)
+{
+    static const auto bounds = Metrics::Histogram::exponentialBounds(100, 4, 10);
+    return Metrics::Registry::instance().histogram(name, help, bounds, 1e-6, labels);
+}
+
+Metrics::Histogram* MetricsServer::sizeHistogram(const QString& name, const QString& help, const Metrics::Labels& labels)
+{
+    static const auto bounds = Metrics::Histogram::exponentialBounds(64, 4, 10);
+    return Metrics::Registry::instance().histogram(name, help, bounds, 1, labels);
+}
+
+Metrics::Counter* MetricsServer::counter(const QString& name, const QString& help, const Metrics::Labels& labels)
+{
+    return Metrics::Registry::instance().counter(name, help, labels);
+}
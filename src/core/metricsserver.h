@@ -26,6 +26,7 @@
 #include <QTcpServer>
 
 #include "coreidentity.h"
+#include "metrics.h"
 
 class MetricsServer : public QObject
 {
@@ -54,8 +55,40 @@ public:
 
     void messageQueue(UserId user, uint64_t size);
 
+    void addClientWrite(UserId user, int frames, int64_t bytes);
+    void clientOutputQueue(UserId user, uint64_t size);
+
+    void addCongestedClient(UserId user);
+    void removeCongestedClient(UserId user);
+    void addWithheldMessages(UserId user, uint64_t count);
+
     void setCertificateExpires(QDateTime expires);
 
+    /**
+     * Returns a histogram for durations recorded in microseconds and exported in seconds.
+     *
+     * Buckets range from 100µs to about 26s.
+     *
+     * @returns The histogram, or nullptr if the metrics server isn't enabled
+     */
+    static Metrics::Histogram* latencyHistogram(const QString& name, const QString& help, const Metrics::Labels& labels);
+
+    /**
+     * Returns a histogram for sizes recorded in bytes.
+     *
+     * Buckets range from 64 bytes to 16 MiB.
+     *
+     * @returns The histogram, or nullptr if the metrics server isn't enabled
+     */
+    static Metrics::Histogram* sizeHistogram(const QString& name, const QString& help, const Metrics::Labels& labels);
+
+    /**
+     * Returns a counter.
+     *
+     * @returns The counter, or nullptr if the metrics server isn't enabled
+     */
+    static Metrics::Counter* counter(const QString& name, const QString& help, const Metrics::Labels& labels);
+
 private slots:
     void incomingConnection();
     void respond();
@@ -76,5 +109,13 @@ private:
 
     QHash<UserId, uint64_t> _messageQueue{};
 
+    QHash<UserId, uint64_t> _clientFramesTransmit{};
+    QHash<UserId, uint64_t> _clientWritesTransmit{};
+    QHash<UserId, uint64_t> _clientDataTransmit{};
+    QHash<UserId, uint64_t> _clientOutputQueue{};
+
+    QHash<UserId, int32_t> _congestedClients{};
+    QHash<UserId, uint64_t> _withheldMessages{};
+
     QDateTime _certificateExpires{};
 };
@@ -37,10 +37,10 @@ Netsplit::Netsplit(Network* network, QObject* parent)
     _joinTimer.setSingleShot(true);
     _quitTimer.setSingleShot(true);
 
-    connect(&_discardTimer, &QTimer::timeout, this, &Netsplit::finished);
+    _discardTimer.setCallback([this]() { emit finished(); });
 
-    connect(&_joinTimer, &QTimer::timeout, this, &Netsplit::joinTimeout);
-    connect(&_quitTimer, &QTimer::timeout, this, &Netsplit::quitTimeout);
+    _joinTimer.setCallback([this]() { joinTimeout(); });
+    _quitTimer.setCallback([this]() { quitTimeout(); });
 
     // wait for a maximum of 1 hour until we discard the netsplit
     _discardTimer.start(3600000);
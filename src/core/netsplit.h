@@ -24,7 +24,8 @@
 #include <QHash>
 #include <QPair>
 #include <QStringList>
-#include <QTimer>
+
+#include "timerwheel.h"
 
 class Network;
 
@@ -132,9 +133,9 @@ private:
     QHash<QString, QStringList> _quits;
     QHash<QString, QStringList> _quitsWithMessageSent;
     bool _sentQuit;
-    QTimer _joinTimer;
-    QTimer _quitTimer;
-    QTimer _discardTimer;
+    WheelTimer _joinTimer;
+    WheelTimer _quitTimer;
+    WheelTimer _discardTimer;
     int _joinCounter;
     int _quitCounter;
 };
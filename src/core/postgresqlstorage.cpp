@@ -270,7 +270,7 @@ UserId PostgreSqlStorage::addUser(const QString& user, const QString& password,
     query.bindValue(":password", hashPassword(password));
     query.bindValue(":hashversion", Storage::HashVersion::Latest);
     query.bindValue(":authenticator", authenticator);
-    safeExec(query);
+    safeExec(query, "insert_quasseluser");
     if (!watchQuery(query))
         return 0;
 
@@ -287,7 +287,7 @@ bool PostgreSqlStorage::updateUser(UserId user, const QString& password)
     query.bindValue(":userid", user.toInt());
     query.bindValue(":password", hashPassword(password));
     query.bindValue(":hashversion", Storage::HashVersion::Latest);
-    safeExec(query);
+    safeExec(query, "update_userpassword");
     watchQuery(query);
     return query.numRowsAffected() != 0;
 }
@@ -298,7 +298,7 @@ void PostgreSqlStorage::renameUser(UserId user, const QString& newName)
     query.prepare(queryString("update_username"));
     query.bindValue(":userid", user.toInt());
     query.bindValue(":username", newName);
-    safeExec(query);
+    safeExec(query, "update_username");
     watchQuery(query);
     emit userRenamed(user, newName);
 }
@@ -308,7 +308,7 @@ UserId PostgreSqlStorage::validateUser(const QString& user, const QString& passw
     QSqlQuery query(logDb());
     query.prepare(queryString("select_authuser"));
     query.bindValue(":username", user);
-    safeExec(query);
+    safeExec(query, "select_authuser");
     watchQuery(query);
 
     if (query.first()
@@ -328,7 +328,7 @@ UserId PostgreSqlStorage::getUserId(const QString& user)
     QSqlQuery query(logDb());
     query.prepare(queryString("select_userid"));
     query.bindValue(":username", user);
-    safeExec(query);
+    safeExec(query, "select_userid");
     watchQuery(query);
 
     if (query.first()) {
@@ -344,7 +344,7 @@ QString PostgreSqlStorage::getUserAuthenticator(const UserId userid)
     QSqlQuery query(logDb());
     query.prepare(queryString("select_authenticator"));
     query.bindValue(":userid", userid.toInt());
-    safeExec(query);
+    safeExec(query, "select_authenticator");
     watchQuery(query);
 
     if (query.first()) {
@@ -359,7 +359,7 @@ UserId PostgreSqlStorage::internalUser()
 {
     QSqlQuery query(logDb());
     query.prepare(queryString("select_internaluser"));
-    safeExec(query);
+    safeExec(query, "select_internaluser");
     watchQuery(query);
 
     if (query.first()) {
@@ -381,7 +381,7 @@ void PostgreSqlStorage::delUser(UserId user)
     QSqlQuery query(db);
     query.prepare(queryString("delete_quasseluser"));
     query.bindValue(":userid", user.toInt());
-    safeExec(query);
+    safeExec(query, "delete_quasseluser");
     if (!watchQuery(query)) {
         db.rollback();
         return;
@@ -404,23 +404,23 @@ void PostgreSqlStorage::setUserSetting(UserId userId, const QString& settingName
     selectQuery.prepare(queryString("select_user_setting"));
     selectQuery.bindValue(":userid", userId.toInt());
     selectQuery.bindValue(":settingname", settingName);
-    safeExec(selectQuery);
+    safeExec(selectQuery, "select_user_setting");
     watchQuery(selectQuery);
 
-    QString setQueryString;
+    QString setQueryName;
     if (!selectQuery.first()) {
-        setQueryString = queryString("insert_user_setting");
+        setQueryName = "insert_user_setting";
     }
     else {
-        setQueryString = queryString("update_user_setting");
+        setQueryName = "update_user_setting";
     }
 
     QSqlQuery setQuery(db);
-    setQuery.prepare(setQueryString);
+    setQuery.prepare(queryString(setQueryName));
     setQuery.bindValue(":userid", userId.toInt());
     setQuery.bindValue(":settingname", settingName);
     setQuery.bindValue(":settingvalue", rawData);
-    safeExec(setQuery);
+    safeExec(setQuery, setQueryName);
     watchQuery(setQuery);
 }
 
@@ -430,7 +430,7 @@ QVariant PostgreSqlStorage::getUserSetting(UserId userId, const QString& setting
     query.prepare(queryString("select_user_setting"));
     query.bindValue(":userid", userId.toInt());
     query.bindValue(":settingname", settingName);
-    safeExec(query);
+    safeExec(query, "select_user_setting");
     watchQuery(query);
 
     if (query.first()) {
@@ -457,22 +457,22 @@ void PostgreSqlStorage::setCoreState(const QVariantList& data)
     QSqlQuery selectQuery(db);
     selectQuery.prepare(queryString("select_core_state"));
     selectQuery.bindValue(":key", "active_sessions");
-    safeExec(selectQuery);
+    safeExec(selectQuery, "select_core_state");
     watchQuery(selectQuery);
 
-    QString setQueryString;
+    QString setQueryName;
     if (!selectQuery.first()) {
-        setQueryString = queryString("insert_core_state");
+        setQueryName = "insert_core_state";
     }
     else {
-        setQueryString = queryString("update_core_state");
+        setQueryName = "update_core_state";
     }
 
     QSqlQuery setQuery(db);
-    setQuery.prepare(setQueryString);
+    setQuery.prepare(queryString(setQueryName));
     setQuery.bindValue(":key", "active_sessions");
     setQuery.bindValue(":value", rawData);
-    safeExec(setQuery);
+    safeExec(setQuery, setQueryName);
     watchQuery(setQuery);
 }
 
@@ -481,7 +481,7 @@ QVariantList PostgreSqlStorage::getCoreState(const QVariantList& defaultData)
     QSqlQuery query(logDb());
     query.prepare(queryString("select_core_state"));
     query.bindValue(":key", "active_sessions");
-    safeExec(query);
+    safeExec(query, "select_core_state");
     watchQuery(query);
 
     if (query.first()) {
@@ -530,7 +530,7 @@ IdentityId PostgreSqlStorage::createIdentity(UserId user, CoreIdentity& identity
     query.bindValue(":quitreason", identity.quitReason());
     query.bindValue(":sslcert", identity.sslCert().toPem());
     query.bindValue(":sslkey", identity.sslKey().toPem());
-    safeExec(query);
+    safeExec(query, "insert_identity");
     if (!watchQuery(query)) {
         db.rollback();
         return {};
@@ -550,7 +550,7 @@ IdentityId PostgreSqlStorage::createIdentity(UserId user, CoreIdentity& identity
     foreach (QString nick, identity.nicks()) {
         insertNickQuery.bindValue(":identityid", identityId.toInt());
         insertNickQuery.bindValue(":nick", nick);
-        safeExec(insertNickQuery);
+        safeExec(insertNickQuery, "insert_nick");
         if (!watchQuery(insertNickQuery)) {
             db.rollback();
             return {};
@@ -578,7 +578,7 @@ bool PostgreSqlStorage::updateIdentity(UserId user, const CoreIdentity& identity
     checkQuery.prepare(queryString("select_checkidentity"));
     checkQuery.bindValue(":identityid", identity.id().toInt());
     checkQuery.bindValue(":userid", user.toInt());
-    safeExec(checkQuery);
+    safeExec(checkQuery, "select_checkidentity");
     watchQuery(checkQuery);
 
     // there should be exactly one identity for the given id and user
@@ -610,7 +610,7 @@ bool PostgreSqlStorage::updateIdentity(UserId user, const CoreIdentity& identity
     query.bindValue(":sslkey", identity.sslKey().toPem());
     query.bindValue(":identityid", identity.id().toInt());
 
-    safeExec(query);
+    safeExec(query, "update_identity");
     if (!watchQuery(query)) {
         db.rollback();
         return false;
@@ -619,7 +619,7 @@ bool PostgreSqlStorage::updateIdentity(UserId user, const CoreIdentity& identity
     QSqlQuery deleteNickQuery(db);
     deleteNickQuery.prepare(queryString("delete_nicks"));
     deleteNickQuery.bindValue(":identityid", identity.id().toInt());
-    safeExec(deleteNickQuery);
+    safeExec(deleteNickQuery, "delete_nicks");
     if (!watchQuery(deleteNickQuery)) {
         db.rollback();
         return false;
@@ -630,7 +630,7 @@ bool PostgreSqlStorage::updateIdentity(UserId user, const CoreIdentity& identity
     foreach (QString nick, identity.nicks()) {
         insertNickQuery.bindValue(":identityid", identity.id().toInt());
         insertNickQuery.bindValue(":nick", nick);
-        safeExec(insertNickQuery);
+        safeExec(insertNickQuery, "insert_nick");
         if (!watchQuery(insertNickQuery)) {
             db.rollback();
             return false;
@@ -658,7 +658,7 @@ void PostgreSqlStorage::removeIdentity(UserId user, IdentityId identityId)
     query.prepare(queryString("delete_identity"));
     query.bindValue(":identityid", identityId.toInt());
     query.bindValue(":userid", user.toInt());
-    safeExec(query);
+    safeExec(query, "delete_identity");
     if (!watchQuery(query)) {
         db.rollback();
     }
@@ -685,7 +685,7 @@ std::vector<CoreIdentity> PostgreSqlStorage::identities(UserId user)
     QSqlQuery nickQuery(db);
     nickQuery.prepare(queryString("select_nicks"));
 
-    safeExec(query);
+    safeExec(query, "select_identities");
     watchQuery(query);
 
     while (query.next()) {
@@ -713,7 +713,7 @@ std::vector<CoreIdentity> PostgreSqlStorage::identities(UserId user)
 
         nickQuery.bindValue(":identityid", identity.id().toInt());
         QList<QString> nicks;
-        safeExec(nickQuery);
+        safeExec(nickQuery, "select_nicks");
         watchQuery(nickQuery);
         while (nickQuery.next()) {
             nicks << nickQuery.value(0).toString();
@@ -740,7 +740,7 @@ NetworkId PostgreSqlStorage::createNetwork(UserId user, const NetworkInfo& info)
     query.prepare(queryString("insert_network"));
     query.bindValue(":userid", user.toInt());
     bindNetworkInfo(query, info);
-    safeExec(query);
+    safeExec(query, "insert_network");
     if (!watchQuery(query)) {
         db.rollback();
         return {};
@@ -760,7 +760,7 @@ NetworkId PostgreSqlStorage::createNetwork(UserId user, const NetworkInfo& info)
         insertServersQuery.bindValue(":userid", user.toInt());
         insertServersQuery.bindValue(":networkid", networkId.toInt());
         bindServerInfo(insertServersQuery, server);
-        safeExec(insertServersQuery);
+        safeExec(insertServersQuery, "insert_server");
         if (!watchQuery(insertServersQuery)) {
             db.rollback();
             return {};
@@ -835,7 +835,7 @@ bool PostgreSqlStorage::updateNetwork(UserId user, const NetworkInfo& info)
     updateQuery.prepare(queryString("update_network"));
     updateQuery.bindValue(":userid", user.toInt());
     bindNetworkInfo(updateQuery, info);
-    safeExec(updateQuery);
+    safeExec(updateQuery, "update_network");
     if (!watchQuery(updateQuery)) {
         db.rollback();
         return false;
@@ -861,7 +861,7 @@ bool PostgreSqlStorage::updateNetwork(UserId user, const NetworkInfo& info)
         insertServersQuery.bindValue(":userid", user.toInt());
         insertServersQuery.bindValue(":networkid", info.networkId.toInt());
         bindServerInfo(insertServersQuery, server);
-        safeExec(insertServersQuery);
+        safeExec(insertServersQuery, "insert_server");
         if (!watchQuery(insertServersQuery)) {
             db.rollback();
             return false;
@@ -889,7 +889,7 @@ bool PostgreSqlStorage::removeNetwork(UserId user, const NetworkId& networkId)
     query.prepare(queryString("delete_network"));
     query.bindValue(":userid", user.toInt());
     query.bindValue(":networkid", networkId.toInt());
-    safeExec(query);
+    safeExec(query, "delete_network");
     if (!watchQuery(query)) {
         db.rollback();
         return false;
@@ -917,7 +917,7 @@ std::vector<NetworkInfo> PostgreSqlStorage::networks(UserId user)
     QSqlQuery serversQuery(db);
     serversQuery.prepare(queryString("select_servers_for_network"));
 
-    safeExec(networksQuery);
+    safeExec(networksQuery, "select_networks_for_user");
     if (!watchQuery(networksQuery)) {
         db.rollback();
         return nets;
@@ -952,7 +952,7 @@ std::vector<NetworkInfo> PostgreSqlStorage::networks(UserId user)
         net.skipCapsFromString(networksQuery.value(23).toString());
 
         serversQuery.bindValue(":networkid", net.networkId.toInt());
-        safeExec(serversQuery);
+        safeExec(serversQuery, "select_servers_for_network");
         if (!watchQuery(serversQuery)) {
             db.rollback();
             return nets;
@@ -996,7 +996,7 @@ std::vector<NetworkId> PostgreSqlStorage::connectedNetworks(UserId user)
     QSqlQuery query(db);
     query.prepare(queryString("select_connected_networks"));
     query.bindValue(":userid", user.toInt());
-    safeExec(query);
+    safeExec(query, "select_connected_networks");
     watchQuery(query);
 
     while (query.next()) {
@@ -1014,7 +1014,7 @@ void PostgreSqlStorage::setNetworkConnected(UserId user, const NetworkId& networ
     query.bindValue(":userid", user.toInt());
     query.bindValue(":networkid", networkId.toInt());
     query.bindValue(":connected", isConnected);
-    safeExec(query);
+    safeExec(query, "update_network_connected");
     watchQuery(query);
 }
 
@@ -1033,7 +1033,7 @@ QHash<QString, QString> PostgreSqlStorage::persistentChannels(UserId user, const
     query.prepare(queryString("select_persistent_channels"));
     query.bindValue(":userid", user.toInt());
     query.bindValue(":networkid", networkId.toInt());
-    safeExec(query);
+    safeExec(query, "select_persistent_channels");
     watchQuery(query);
 
     while (query.next()) {
@@ -1052,7 +1052,7 @@ void PostgreSqlStorage::setChannelPersistent(UserId user, const NetworkId& netwo
     query.bindValue(":networkid", networkId.toInt());
     query.bindValue(":buffercname", channel.toLower());
     query.bindValue(":joined", isJoined);
-    safeExec(query);
+    safeExec(query, "update_buffer_persistent_channel");
     watchQuery(query);
 }
 
@@ -1064,7 +1064,7 @@ void PostgreSqlStorage::setPersistentChannelKey(UserId user, const NetworkId& ne
     query.bindValue(":networkid", networkId.toInt());
     query.bindValue(":buffercname", channel.toLower());
     query.bindValue(":key", key);
-    safeExec(query);
+    safeExec(query, "update_buffer_set_channel_key");
     watchQuery(query);
 }
 
@@ -1074,7 +1074,7 @@ QString PostgreSqlStorage::awayMessage(UserId user, NetworkId networkId)
     query.prepare(queryString("select_network_awaymsg"));
     query.bindValue(":userid", user.toInt());
     query.bindValue(":networkid", networkId.toInt());
-    safeExec(query);
+    safeExec(query, "select_network_awaymsg");
     watchQuery(query);
     QString awayMsg;
     if (query.first())
@@ -1089,7 +1089,7 @@ void PostgreSqlStorage::setAwayMessage(UserId user, NetworkId networkId, const Q
     query.bindValue(":userid", user.toInt());
     query.bindValue(":networkid", networkId.toInt());
     query.bindValue(":awaymsg", awayMsg);
-    safeExec(query);
+    safeExec(query, "update_network_set_awaymsg");
     watchQuery(query);
 }
 
@@ -1099,7 +1099,7 @@ QString PostgreSqlStorage::userModes(UserId user, NetworkId networkId)
     query.prepare(queryString("select_network_usermode"));
     query.bindValue(":userid", user.toInt());
     query.bindValue(":networkid", networkId.toInt());
-    safeExec(query);
+    safeExec(query, "select_network_usermode");
     watchQuery(query);
     QString modes;
     if (query.first())
@@ -1114,7 +1114,7 @@ void PostgreSqlStorage::setUserModes(UserId user, NetworkId networkId, const QSt
     query.bindValue(":userid", user.toInt());
     query.bindValue(":networkid", networkId.toInt());
     query.bindValue(":usermode", userModes);
-    safeExec(query);
+    safeExec(query, "update_network_set_usermode");
     watchQuery(query);
 }
 
@@ -1132,7 +1132,7 @@ BufferInfo PostgreSqlStorage::bufferInfo(UserId user, const NetworkId& networkId
     query.bindValue(":networkid", networkId.toInt());
     query.bindValue(":userid", user.toInt());
     query.bindValue(":buffercname", buffer.toLower());
-    safeExec(query);
+    safeExec(query, "select_bufferByName");
     watchQuery(query);
 
     if (query.first()) {
@@ -1164,7 +1164,7 @@ BufferInfo PostgreSqlStorage::bufferInfo(UserId user, const NetworkId& networkId
     createQuery.bindValue(":buffercname", buffer.toLower());
     createQuery.bindValue(":joined", type & BufferInfo::ChannelBuffer ? true : false);
 
-    safeExec(createQuery);
+    safeExec(createQuery, "insert_buffer");
 
     if (!watchQuery(createQuery)) {
         qWarning() << "PostgreSqlStorage::bufferInfo(): unable to create buffer";
@@ -1185,7 +1185,7 @@ BufferInfo PostgreSqlStorage::getBufferInfo(UserId user, const BufferId& bufferI
     query.prepare(queryString("select_buffer_by_id"));
     query.bindValue(":userid", user.toInt());
     query.bindValue(":bufferid", bufferId.toInt());
-    safeExec(query);
+    safeExec(query, "select_buffer_by_id");
     if (!watchQuery(query))
         return {};
 
@@ -1217,7 +1217,7 @@ std::vector<BufferInfo> PostgreSqlStorage::requestBuffers(UserId user)
     query.prepare(queryString("select_buffers"));
     query.bindValue(":userid", user.toInt());
 
-    safeExec(query);
+    safeExec(query, "select_buffers");
     watchQuery(query);
     while (query.next()) {
         bufferlist.emplace_back(query.value(0).toInt(),
@@ -1246,7 +1246,7 @@ std::vector<BufferId> PostgreSqlStorage::requestBufferIdsForNetwork(UserId user,
     query.bindValue(":networkid", networkId.toInt());
     query.bindValue(":userid", user.toInt());
 
-    safeExec(query);
+    safeExec(query, "select_buffers_for_network");
     watchQuery(query);
     while (query.next()) {
         bufferList.emplace_back(query.value(0).toInt());
@@ -1267,7 +1267,7 @@ bool PostgreSqlStorage::removeBuffer(const UserId& user, const BufferId& bufferI
     query.prepare(queryString("delete_buffer_for_bufferid"));
     query.bindValue(":userid", user.toInt());
     query.bindValue(":bufferid", bufferId.toInt());
-    safeExec(query);
+    safeExec(query, "delete_buffer_for_bufferid");
     if (!watchQuery(query)) {
         db.rollback();
         return false;
@@ -1304,7 +1304,7 @@ bool PostgreSqlStorage::renameBuffer(const UserId& user, const BufferId& bufferI
     query.bindValue(":buffercname", newName.toLower());
     query.bindValue(":userid", user.toInt());
     query.bindValue(":bufferid", bufferId.toInt());
-    safeExec(query);
+    safeExec(query, "update_buffer_name");
     if (!watchQuery(query)) {
         db.rollback();
         return false;
@@ -1357,7 +1357,7 @@ bool PostgreSqlStorage::mergeBuffersPermanently(const UserId& user, const Buffer
     query.prepare(queryString("update_backlog_bufferid"));
     query.bindValue(":oldbufferid", bufferId2.toInt());
     query.bindValue(":newbufferid", bufferId1.toInt());
-    safeExec(query);
+    safeExec(query, "update_backlog_bufferid");
     if (!watchQuery(query)) {
         db.rollback();
         return false;
@@ -1367,7 +1367,7 @@ bool PostgreSqlStorage::mergeBuffersPermanently(const UserId& user, const Buffer
     delBufferQuery.prepare(queryString("delete_buffer_for_bufferid"));
     delBufferQuery.bindValue(":userid", user.toInt());
     delBufferQuery.bindValue(":bufferid", bufferId2.toInt());
-    safeExec(delBufferQuery);
+    safeExec(delBufferQuery, "delete_buffer_for_bufferid");
     if (!watchQuery(delBufferQuery)) {
         db.rollback();
         return false;
@@ -1391,7 +1391,7 @@ QHash<BufferId, MsgId> PostgreSqlStorage::bufferLastMsgIds(UserId user)
     QSqlQuery query(db);
     query.prepare(queryString("select_buffer_last_messages"));
     query.bindValue(":userid", user.toInt());
-    safeExec(query);
+    safeExec(query, "select_buffer_last_messages");
     if (!watchQuery(query)) {
         db.rollback();
         return lastMsgHash;
@@ -1413,7 +1413,7 @@ void PostgreSqlStorage::setBufferLastSeenMsg(UserId user, const BufferId& buffer
     query.bindValue(":userid", user.toInt());
     query.bindValue(":bufferid", bufferId.toInt());
     query.bindValue(":lastseenmsgid", msgId.toQint64());
-    safeExec(query);
+    safeExec(query, "update_buffer_lastseen");
     watchQuery(query);
 }
 
@@ -1431,7 +1431,7 @@ QHash<BufferId, MsgId> PostgreSqlStorage::bufferLastSeenMsgIds(UserId user)
     QSqlQuery query(db);
     query.prepare(queryString("select_buffer_lastseen_messages"));
     query.bindValue(":userid", user.toInt());
-    safeExec(query);
+    safeExec(query, "select_buffer_lastseen_messages");
     if (!watchQuery(query)) {
         db.rollback();
         return lastSeenHash;
@@ -1453,7 +1453,7 @@ void PostgreSqlStorage::setBufferMarkerLineMsg(UserId user, const BufferId& buff
     query.bindValue(":userid", user.toInt());
     query.bindValue(":bufferid", bufferId.toInt());
     query.bindValue(":markerlinemsgid", msgId.toQint64());
-    safeExec(query);
+    safeExec(query, "update_buffer_markerlinemsgid");
     watchQuery(query);
 }
 
@@ -1471,7 +1471,7 @@ QHash<BufferId, MsgId> PostgreSqlStorage::bufferMarkerLineMsgIds(UserId user)
     QSqlQuery query(db);
     query.prepare(queryString("select_buffer_markerlinemsgids"));
     query.bindValue(":userid", user.toInt());
-    safeExec(query);
+    safeExec(query, "select_buffer_markerlinemsgids");
     if (!watchQuery(query)) {
         db.rollback();
         return markerLineHash;
@@ -1493,7 +1493,7 @@ void PostgreSqlStorage::setBufferActivity(UserId user, BufferId bufferId, Messag
     query.bindValue(":userid", user.toInt());
     query.bindValue(":bufferid", bufferId.toInt());
     query.bindValue(":bufferactivity", (int)bufferActivity);
-    safeExec(query);
+    safeExec(query, "update_buffer_bufferactivity");
     watchQuery(query);
 }
 
@@ -1511,7 +1511,7 @@ QHash<BufferId, Message::Types> PostgreSqlStorage::bufferActivities(UserId user)
     QSqlQuery query(db);
     query.prepare(queryString("select_buffer_bufferactivities"));
     query.bindValue(":userid", user.toInt());
-    safeExec(query);
+    safeExec(query, "select_buffer_bufferactivities");
     if (!watchQuery(query)) {
         db.rollback();
         return bufferActivityHash;
@@ -1531,7 +1531,7 @@ Message::Types PostgreSqlStorage::bufferActivity(BufferId bufferId, MsgId lastSe
     query.prepare(queryString("select_buffer_bufferactivity"));
     query.bindValue(":bufferid", bufferId.toInt());
     query.bindValue(":lastseenmsgid", lastSeenMsgId.toQint64());
-    safeExec(query);
+    safeExec(query, "select_buffer_bufferactivity");
     watchQuery(query);
     Message::Types result{};
     if (query.first())
@@ -1554,7 +1554,7 @@ QHash<QString, QByteArray> PostgreSqlStorage::bufferCiphers(UserId user, const N
     query.prepare(queryString("select_buffer_ciphers"));
     query.bindValue(":userid", user.toInt());
     query.bindValue(":networkid", networkId.toInt());
-    safeExec(query);
+    safeExec(query, "select_buffer_ciphers");
     watchQuery(query);
 
     while (query.next()) {
@@ -1573,7 +1573,7 @@ void PostgreSqlStorage::setBufferCipher(UserId user, const NetworkId& networkId,
     query.bindValue(":networkid", networkId.toInt());
     query.bindValue(":buffercname", bufferName.toLower());
     query.bindValue(":cipher", QString(cipher.toHex()));
-    safeExec(query);
+    safeExec(query, "update_buffer_cipher");
     watchQuery(query);
 }
 
@@ -1585,7 +1585,7 @@ void PostgreSqlStorage::setHighlightCount(UserId user, BufferId bufferId, int hi
     query.bindValue(":userid", user.toInt());
     query.bindValue(":bufferid", bufferId.toInt());
     query.bindValue(":highlightcount", highlightcount);
-    safeExec(query);
+    safeExec(query, "update_buffer_highlightcount");
     watchQuery(query);
 }
 
@@ -1603,7 +1603,7 @@ QHash<BufferId, int> PostgreSqlStorage::highlightCounts(UserId user)
     QSqlQuery query(db);
     query.prepare(queryString("select_buffer_highlightcounts"));
     query.bindValue(":userid", user.toInt());
-    safeExec(query);
+    safeExec(query, "select_buffer_highlightcounts");
     if (!watchQuery(query)) {
         db.rollback();
         return highlightCountHash;
@@ -1623,7 +1623,7 @@ int PostgreSqlStorage::highlightCount(BufferId bufferId, MsgId lastSeenMsgId)
     query.prepare(queryString("select_buffer_highlightcount"));
     query.bindValue(":bufferid", bufferId.toInt());
     query.bindValue(":lastseenmsgid", lastSeenMsgId.toQint64());
-    safeExec(query);
+    safeExec(query, "select_buffer_highlightcount");
     watchQuery(query);
     auto result = int(0);
     if (query.first())
@@ -1631,6 +1631,42 @@ int PostgreSqlStorage::highlightCount(BufferId bufferId, MsgId lastSeenMsgId)
     return result;
 }
 
+QHash<UserId, Storage::BufferSyncerState> PostgreSqlStorage::bufferSyncerStates(const QSet<UserId>& users)
+{
+    QHash<UserId, BufferSyncerState> states;
+
+    QSqlDatabase db = logDb();
+    if (!beginReadOnlyTransaction(db)) {
+        qWarning() << "PostgreSqlStorage::bufferSyncerStates(): cannot start read only transaction!";
+        qWarning() << " -" << qPrintable(db.lastError().text());
+        return states;
+    }
+
+    QSqlQuery query(db);
+    query.prepare(queryString("select_buffer_syncer_states"));
+    safeExec(query, "select_buffer_syncer_states");
+    if (!watchQuery(query)) {
+        db.rollback();
+        return states;
+    }
+
+    while (query.next()) {
+        UserId user = query.value(0).toInt();
+        if (!users.contains(user))
+            continue;
+        BufferId bufferId = query.value(1).toInt();
+        BufferSyncerState& state = states[user];
+        state.lastMsgIds[bufferId] = query.value(2).toLongLong();
+        state.lastSeenMsgIds[bufferId] = query.value(3).toLongLong();
+        state.markerLineMsgIds[bufferId] = query.value(4).toLongLong();
+        state.activities[bufferId] = Message::Types(query.value(5).toInt());
+        state.highlightCounts[bufferId] = query.value(6).toInt();
+    }
+
+    db.commit();
+    return states;
+}
+
 bool PostgreSqlStorage::logMessage(Message& msg)
 {
     QSqlDatabase db = logDb();
@@ -1862,15 +1898,19 @@ std::vector<Message> PostgreSqlStorage::requestMsgsFiltered(
     }
 
     QSqlQuery query(db);
+    QString queryName;
     if (last == -1 && first == -1) {
-        query.prepare(queryString("select_messagesNewestK_filtered"));
+        queryName = "select_messagesNewestK_filtered";
+        query.prepare(queryString(queryName));
     }
     else if (last == -1) {
-        query.prepare(queryString("select_messagesNewerThan_filtered"));
+        queryName = "select_messagesNewerThan_filtered";
+        query.prepare(queryString(queryName));
         query.bindValue(":first", first.toQint64());
     }
     else {
-        query.prepare(queryString("select_messagesRange_filtered"));
+        queryName = "select_messagesRange_filtered";
+        query.prepare(queryString(queryName));
         query.bindValue(":last", last.toQint64());
         query.bindValue(":first", first.toQint64());
     }
@@ -1881,7 +1921,7 @@ std::vector<Message> PostgreSqlStorage::requestMsgsFiltered(
     int flagsRaw = flags;
     query.bindValue(":flags", flagsRaw);
 
-    safeExec(query);
+    safeExec(query, queryName);
     if (!watchQuery(query)) {
         qDebug() << "select_messages failed";
         db.rollback();
@@ -2005,16 +2045,19 @@ std::vector<Message> PostgreSqlStorage::requestAllMsgs(UserId user, MsgId first,
     }
 
     QSqlQuery query(db);
+    QString queryName;
     if (last == -1) {
-        query.prepare(queryString("select_messagesAllNew"));
+        queryName = "select_messagesAllNew";
+        query.prepare(queryString(queryName));
     }
     else {
-        query.prepare(queryString("select_messagesAll"));
+        queryName = "select_messagesAll";
+        query.prepare(queryString(queryName));
         query.bindValue(":lastmsg", last.toQint64());
     }
     query.bindValue(":userid", user.toInt());
     query.bindValue(":firstmsg", first.toQint64());
-    safeExec(query);
+    safeExec(query, queryName);
     if (!watchQuery(query)) {
         db.rollback();
         return messagelist;
@@ -2062,11 +2105,14 @@ std::vector<Message> PostgreSqlStorage::requestAllMsgsFiltered(
     }
 
     QSqlQuery query(db);
+    QString queryName;
     if (last == -1) {
-        query.prepare(queryString("select_messagesAllNew_filtered"));
+        queryName = "select_messagesAllNew_filtered";
+        query.prepare(queryString(queryName));
     }
     else {
-        query.prepare(queryString("select_messagesAll_filtered"));
+        queryName = "select_messagesAll_filtered";
+        query.prepare(queryString(queryName));
         query.bindValue(":lastmsg", last.toQint64());
     }
     query.bindValue(":userid", user.toInt());
@@ -2078,7 +2124,7 @@ std::vector<Message> PostgreSqlStorage::requestAllMsgsFiltered(
     int flagsRaw = flags;
     query.bindValue(":flags", flagsRaw);
 
-    safeExec(query);
+    safeExec(query, queryName);
     if (!watchQuery(query)) {
         db.rollback();
         return messagelist;
@@ -2112,7 +2158,7 @@ QMap<UserId, QString> PostgreSqlStorage::getAllAuthUserNames()
     QMap<UserId, QString> authusernames;
     QSqlQuery query(logDb());
     query.prepare(queryString("select_all_authusernames"));
-    safeExec(query);
+    safeExec(query, "select_all_authusernames");
     watchQuery(query);
 
     while (query.next()) {
@@ -2166,6 +2212,8 @@ bool PostgreSqlStorage::beginReadOnlyTransaction(QSqlDatabase& db)
 
 QSqlQuery PostgreSqlStorage::prepareAndExecuteQuery(const QString& queryname, const QString& paramstring, QSqlDatabase& db)
 {
+    Metrics::ScopedTimer timer{queryDurationMetric(queryname)};
+
     // Query preparing is done lazily. That means that instead of always checking if the query is already prepared
     // we just EXECUTE and catch the error
     QSqlQuery query;
@@ -2268,8 +2316,10 @@ void PostgreSqlStorage::deallocateQuery(const QString& queryname, const QSqlData
     db.exec(QString("DEALLOCATE quassel_%1").arg(queryname));
 }
 
-void PostgreSqlStorage::safeExec(QSqlQuery& query)
+void PostgreSqlStorage::safeExec(QSqlQuery& query, const QString& queryName)
 {
+    Metrics::ScopedTimer timer{queryDurationMetric(queryName)};
+
     // If the query fails due to the connection being gone, it seems to cause
     // exec() to return false but no lastError to be set
     if (!query.exec() && !query.lastError().isValid()) {
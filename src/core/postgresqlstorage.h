@@ -102,6 +102,7 @@ public:
     void setHighlightCount(UserId id, BufferId bufferId, int count) override;
     QHash<BufferId, int> highlightCounts(UserId id) override;
     int highlightCount(BufferId bufferId, MsgId lastSeenMsgId) override;
+    QHash<UserId, BufferSyncerState> bufferSyncerStates(const QSet<UserId>& users) override;
     QHash<QString, QByteArray> bufferCiphers(UserId user, const NetworkId& networkId) override;
     void setBufferCipher(UserId user, const NetworkId& networkId, const QString& bufferName, const QByteArray& cipher) override;
 
@@ -162,7 +163,13 @@ protected:
      */
     virtual bool setSchemaVersionUpgradeStep(QString upgradeQuery) override;
 
-    void safeExec(QSqlQuery& query);
+    /**
+     * Executes a query, reopening the connection if it was lost
+     *
+     * @param query      The prepared query
+     * @param queryName  Name of the query file, for labelling the query's duration metric
+     */
+    void safeExec(QSqlQuery& query, const QString& queryName = QString());
 
     bool beginTransaction(QSqlDatabase& db);
     bool beginReadOnlyTransaction(QSqlDatabase& db);
@@ -0,0 +1,174 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "scrypt.h"
+
+#include <cstring>
+#include <vector>
+
+#include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QtEndian>
+
+namespace {
+
+/// PBKDF2-HMAC-SHA256 with a single iteration, as used by scrypt
+QByteArray pbkdf2Sha256(const QByteArray& password, const QByteArray& salt, int keyLength)
+{
+    QMessageAuthenticationCode mac(QCryptographicHash::Sha256, password);
+    QByteArray key;
+    key.reserve(keyLength + 32);
+    for (quint32 block = 1; key.size() < keyLength; ++block) {
+        const quint32 blockIndex = qToBigEndian(block);
+        mac.reset();
+        mac.addData(salt);
+        mac.addData(reinterpret_cast<const char*>(&blockIndex), sizeof(blockIndex));
+        key += mac.result();
+    }
+    key.truncate(keyLength);
+    return key;
+}
+
+inline quint32 rotl(quint32 value, int count)
+{
+    return (value << count) | (value >> (32 - count));
+}
+
+/// Applies the Salsa20/8 core to a 64 byte block
+void salsa20_8(quint32* block)
+{
+    quint32 x[16];
+    std::memcpy(x, block, sizeof(x));
+    for (int round = 0; round < 8; round += 2) {
+        // Columns
+        x[4] ^= rotl(x[0] + x[12], 7);
+        x[8] ^= rotl(x[4] + x[0], 9);
+        x[12] ^= rotl(x[8] + x[4], 13);
+        x[0] ^= rotl(x[12] + x[8], 18);
+        x[9] ^= rotl(x[5] + x[1], 7);
+        x[13] ^= rotl(x[9] + x[5], 9);
+        x[1] ^= rotl(x[13] + x[9], 13);
+        x[5] ^= rotl(x[1] + x[13], 18);
+        x[14] ^= rotl(x[10] + x[6], 7);
+        x[2] ^= rotl(x[14] + x[10], 9);
+        x[6] ^= rotl(x[2] + x[14], 13);
+        x[10] ^= rotl(x[6] + x[2], 18);
+        x[3] ^= rotl(x[15] + x[11], 7);
+        x[7] ^= rotl(x[3] + x[15], 9);
+        x[11] ^= rotl(x[7] + x[3], 13);
+        x[15] ^= rotl(x[11] + x[7], 18);
+        // Rows
+        x[1] ^= rotl(x[0] + x[3], 7);
+        x[2] ^= rotl(x[1] + x[0], 9);
+        x[3] ^= rotl(x[2] + x[1], 13);
+        x[0] ^= rotl(x[3] + x[2], 18);
+        x[6] ^= rotl(x[5] + x[4], 7);
+        x[7] ^= rotl(x[6] + x[5], 9);
+        x[4] ^= rotl(x[7] + x[6], 13);
+        x[5] ^= rotl(x[4] + x[7], 18);
+        x[11] ^= rotl(x[10] + x[9], 7);
+        x[8] ^= rotl(x[11] + x[10], 9);
+        x[9] ^= rotl(x[8] + x[11], 13);
+        x[10] ^= rotl(x[9] + x[8], 18);
+        x[12] ^= rotl(x[15] + x[14], 7);
+        x[13] ^= rotl(x[12] + x[15], 9);
+        x[14] ^= rotl(x[13] + x[12], 13);
+        x[15] ^= rotl(x[14] + x[13], 18);
+    }
+    for (int i = 0; i < 16; ++i) {
+        block[i] += x[i];
+    }
+}
+
+/**
+ * Mixes 2 * r blocks of 16 words from input into output
+ *
+ * Output blocks are stored with the even ones first, followed by the odd ones.
+ */
+void blockMix(const quint32* input, quint32* output, int r)
+{
+    quint32 x[16];
+    std::memcpy(x, input + (2 * r - 1) * 16, sizeof(x));
+    for (int i = 0; i < 2 * r; ++i) {
+        for (int k = 0; k < 16; ++k) {
+            x[k] ^= input[i * 16 + k];
+        }
+        salsa20_8(x);
+        std::memcpy(output + ((i % 2) * r + i / 2) * 16, x, sizeof(x));
+    }
+}
+
+/// Applies ROMix to a chunk of 32 * r words, using v as scratch space for 2^logCost chunks
+void roMix(quint32* chunk, int r, int logCost, std::vector<quint32>& v)
+{
+    const size_t chunkWords = 32 * r;
+    const quint32 n = 1u << logCost;
+    std::vector<quint32> x(chunk, chunk + chunkWords);
+    std::vector<quint32> y(chunkWords);
+
+    for (quint32 i = 0; i < n; ++i) {
+        std::memcpy(&v[i * chunkWords], x.data(), chunkWords * sizeof(quint32));
+        blockMix(x.data(), y.data(), r);
+        x.swap(y);
+    }
+    for (quint32 i = 0; i < n; ++i) {
+        // Integerify: the first word of the last block, N being a power of two
+        const quint32 j = x[(2 * r - 1) * 16] & (n - 1);
+        for (size_t k = 0; k < chunkWords; ++k) {
+            x[k] ^= v[j * chunkWords + k];
+        }
+        blockMix(x.data(), y.data(), r);
+        x.swap(y);
+    }
+    std::memcpy(chunk, x.data(), chunkWords * sizeof(quint32));
+}
+
+}  // namespace
+
+namespace Scrypt {
+
+QByteArray deriveKey(const QByteArray& password, const QByteArray& salt, int logCost, int blockSize, int parallelism, int keyLength)
+{
+    if (logCost < 1 || logCost > 30 || blockSize < 1 || parallelism < 1 || keyLength < 1)
+        return {};
+    // Keep the scratch space addressable and the work reasonable
+    if (static_cast<quint64>(blockSize) * parallelism >= (1u << 20) || (128ull * blockSize << logCost) > (1ull << 32))
+        return {};
+
+    const int chunkBytes = 128 * blockSize;
+    QByteArray b = pbkdf2Sha256(password, salt, chunkBytes * parallelism);
+
+    std::vector<quint32> words(b.size() / 4);
+    for (size_t i = 0; i < words.size(); ++i) {
+        words[i] = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(b.constData()) + i * 4);
+    }
+
+    std::vector<quint32> v((static_cast<size_t>(32) * blockSize) << logCost);
+    for (int i = 0; i < parallelism; ++i) {
+        roMix(words.data() + i * 32 * blockSize, blockSize, logCost, v);
+    }
+
+    for (size_t i = 0; i < words.size(); ++i) {
+        qToLittleEndian<quint32>(words[i], reinterpret_cast<uchar*>(b.data()) + i * 4);
+    }
+    return pbkdf2Sha256(password, b, keyLength);
+}
+
+}  // namespace Scrypt
@@ -0,0 +1,45 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "core-export.h"
+
+#include <QByteArray>
+
+namespace Scrypt {
+
+/**
+ * Derives a key from a password using scrypt, as specified in RFC 7914
+ *
+ * scrypt is memory-hard: deriving a key needs 128 * blockSize * 2^logCost bytes of memory, which makes brute-forcing
+ * stolen hashes on GPUs and ASICs expensive.
+ *
+ * @param password    The password
+ * @param salt        A random salt, unique per password
+ * @param logCost     CPU/memory cost as a power of two (the N parameter is 2^logCost), 1 to 30
+ * @param blockSize   Block size (r), usually 8
+ * @param parallelism Parallelization (p), usually 1
+ * @param keyLength   Length of the derived key in bytes
+ * @return The derived key, or an empty array if the parameters are out of range
+ */
+CORE_EXPORT QByteArray deriveKey(const QByteArray& password, const QByteArray& salt, int logCost, int blockSize, int parallelism, int keyLength);
+
+}  // namespace Scrypt
@@ -129,6 +129,7 @@ void SessionThread::onSessionInitialized()
         emit addClientToWorker(peer);
     }
     _clientQueue.clear();
+    emit initialized();
 }
 
 void SessionThread::onSessionDestroyed()
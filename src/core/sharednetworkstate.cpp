@@ -0,0 +1,57 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "sharednetworkstate.h"
+
+#include <QMutexLocker>
+
+QString SharedNetworkState::Pool::intern(const QString& str)
+{
+    if (str.isEmpty())
+        return str;
+
+    QMutexLocker locker(&_mutex);
+    // Strings only held by the pool belong to users and channels all sessions have forgotten about
+    if (_stringPool.size() > _pruneSize) {
+        _stringPool.prune();
+        _pruneSize = qMax(2 * _stringPool.size(), static_cast<int>(MinPruneSize));
+    }
+    return _stringPool.intern(str);
+}
+
+std::shared_ptr<SharedNetworkState::Pool> SharedNetworkState::pool(const QString& networkName)
+{
+    const QString key = networkName.toCaseFolded();
+
+    QMutexLocker locker(&_mutex);
+    std::shared_ptr<Pool> pool = _pools.value(key).lock();
+    if (!pool) {
+        // Drop entries of networks nobody is connected to anymore
+        for (auto it = _pools.begin(); it != _pools.end();) {
+            if (it->expired())
+                it = _pools.erase(it);
+            else
+                ++it;
+        }
+        pool = std::make_shared<Pool>();
+        _pools[key] = pool;
+    }
+    return pool;
+}
@@ -0,0 +1,72 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <memory>
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include "stringpool.h"
+
+/**
+ * Registry of state shared between sessions connected to the same IRC network.
+ *
+ * Many users of one core tend to sit in the same big channels, so every session would otherwise hold its own
+ * copy of the same hosts, real names and topics. Networks announcing the same NETWORK name in RPL_ISUPPORT get
+ * the same StringPool, so equal strings across sessions share one buffer.
+ *
+ * Only deduplicated values are shared. Which users and channels a session knows about stays private to it.
+ * The registry and its pools can be used from any session thread.
+ */
+class SharedNetworkState
+{
+public:
+    /**
+     * A string pool that may be used from several threads at once.
+     */
+    class Pool
+    {
+    public:
+        QString intern(const QString& str);
+
+    private:
+        QMutex _mutex;
+        StringPool _stringPool;
+        int _pruneSize{MinPruneSize};
+        static const int MinPruneSize = 4096;
+    };
+
+    /**
+     * Gets the pool for the given network, creating it if needed
+     *
+     * The pool lives as long as a network holds a reference to it.
+     *
+     * @param networkName The network name the server announced
+     * @return The pool shared by all networks announcing that name
+     */
+    std::shared_ptr<Pool> pool(const QString& networkName);
+
+private:
+    QMutex _mutex;
+    QHash<QString, std::weak_ptr<Pool>> _pools;
+};
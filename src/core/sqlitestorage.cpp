@@ -193,7 +193,7 @@ UserId SqliteStorage::addUser(const QString& user, const QString& password, cons
         query.bindValue(":hashversion", Storage::HashVersion::Latest);
         query.bindValue(":authenticator", authenticator);
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "insert_quasseluser");
         if (query.lastError().isValid()
             && query.lastError().nativeErrorCode() == QLatin1String{"19"}) {  // user already exists - sadly 19 seems to be the general constraint violation error...
             db.rollback();
@@ -223,7 +223,7 @@ bool SqliteStorage::updateUser(UserId user, const QString& password)
         query.bindValue(":password", hashPassword(password));
         query.bindValue(":hashversion", Storage::HashVersion::Latest);
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_userpassword");
         success = query.numRowsAffected() != 0;
         db.commit();
     }
@@ -241,7 +241,7 @@ void SqliteStorage::renameUser(UserId user, const QString& newName)
         query.bindValue(":userid", user.toInt());
         query.bindValue(":username", newName);
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_username");
         db.commit();
     }
     unlock();
@@ -260,7 +260,7 @@ UserId SqliteStorage::validateUser(const QString& user, const QString& password)
         query.bindValue(":username", user);
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_authuser");
 
         if (query.first()) {
             userId = query.value(0).toInt();
@@ -287,7 +287,7 @@ UserId SqliteStorage::getUserId(const QString& username)
         query.bindValue(":username", username);
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_userid");
 
         if (query.first()) {
             userId = query.value(0).toInt();
@@ -308,7 +308,7 @@ QString SqliteStorage::getUserAuthenticator(const UserId userid)
         query.bindValue(":userid", userid.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_authenticator");
 
         if (query.first()) {
             authenticator = query.value(0).toString();
@@ -327,7 +327,7 @@ UserId SqliteStorage::internalUser()
         QSqlQuery query(logDb());
         query.prepare(queryString("select_internaluser"));
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_internaluser");
 
         if (query.first()) {
             userId = query.value(0).toInt();
@@ -348,19 +348,19 @@ void SqliteStorage::delUser(UserId user)
         QSqlQuery query(db);
         query.prepare(queryString("delete_backlog_by_uid"));
         query.bindValue(":userid", user.toInt());
-        safeExec(query);
+        safeExec(query, "delete_backlog_by_uid");
 
         query.prepare(queryString("delete_buffers_by_uid"));
         query.bindValue(":userid", user.toInt());
-        safeExec(query);
+        safeExec(query, "delete_buffers_by_uid");
 
         query.prepare(queryString("delete_networks_by_uid"));
         query.bindValue(":userid", user.toInt());
-        safeExec(query);
+        safeExec(query, "delete_networks_by_uid");
 
         query.prepare(queryString("delete_quasseluser"));
         query.bindValue(":userid", user.toInt());
-        safeExec(query);
+        safeExec(query, "delete_quasseluser");
         // I hate the lack of foreign keys and on delete cascade... :(
         db.commit();
     }
@@ -385,7 +385,7 @@ void SqliteStorage::setUserSetting(UserId userId, const QString& settingName, co
         query.bindValue(":settingname", settingName);
         query.bindValue(":settingvalue", rawData);
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "insert_user_setting");
 
         if (query.lastError().isValid()) {
             QSqlQuery updateQuery(db);
@@ -393,7 +393,7 @@ void SqliteStorage::setUserSetting(UserId userId, const QString& settingName, co
             updateQuery.bindValue(":userid", userId.toInt());
             updateQuery.bindValue(":settingname", settingName);
             updateQuery.bindValue(":settingvalue", rawData);
-            safeExec(updateQuery);
+            safeExec(updateQuery, "update_user_setting");
         }
         db.commit();
     }
@@ -409,7 +409,7 @@ QVariant SqliteStorage::getUserSetting(UserId userId, const QString& settingName
         query.bindValue(":userid", userId.toInt());
         query.bindValue(":settingname", settingName);
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_user_setting");
 
         if (query.first()) {
             QByteArray rawData = query.value(0).toByteArray();
@@ -437,14 +437,14 @@ void SqliteStorage::setCoreState(const QVariantList& data)
         query.bindValue(":key", "active_sessions");
         query.bindValue(":value", rawData);
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "insert_core_state");
 
         if (query.lastError().isValid()) {
             QSqlQuery updateQuery(db);
             updateQuery.prepare(queryString("update_core_state"));
             updateQuery.bindValue(":key", "active_sessions");
             updateQuery.bindValue(":value", rawData);
-            safeExec(updateQuery);
+            safeExec(updateQuery, "update_core_state");
         }
         db.commit();
     }
@@ -459,7 +459,7 @@ QVariantList SqliteStorage::getCoreState(const QVariantList& defaultData)
         query.prepare(queryString("select_core_state"));
         query.bindValue(":key", "active_sessions");
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_core_state");
 
         if (query.first()) {
             QByteArray rawData = query.value(0).toByteArray();
@@ -507,7 +507,7 @@ IdentityId SqliteStorage::createIdentity(UserId user, CoreIdentity& identity)
         query.bindValue(":sslkey", identity.sslKey().toPem());
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "insert_identity");
 
         identityId = query.lastInsertId().toInt();
         if (!identityId.isValid()) {
@@ -517,14 +517,14 @@ IdentityId SqliteStorage::createIdentity(UserId user, CoreIdentity& identity)
             QSqlQuery deleteNickQuery(db);
             deleteNickQuery.prepare(queryString("delete_nicks"));
             deleteNickQuery.bindValue(":identityid", identityId.toInt());
-            safeExec(deleteNickQuery);
+            safeExec(deleteNickQuery, "delete_nicks");
 
             QSqlQuery insertNickQuery(db);
             insertNickQuery.prepare(queryString("insert_nick"));
             foreach (QString nick, identity.nicks()) {
                 insertNickQuery.bindValue(":identityid", identityId.toInt());
                 insertNickQuery.bindValue(":nick", nick);
-                safeExec(insertNickQuery);
+                safeExec(insertNickQuery, "insert_nick");
             }
         }
         db.commit();
@@ -546,7 +546,7 @@ bool SqliteStorage::updateIdentity(UserId user, const CoreIdentity& identity)
         checkQuery.bindValue(":identityid", identity.id().toInt());
         checkQuery.bindValue(":userid", user.toInt());
         lockForRead();
-        safeExec(checkQuery);
+        safeExec(checkQuery, "select_checkidentity");
 
         // there should be exactly one identity for the given id and user
         error = (!checkQuery.first() || checkQuery.value(0).toInt() != 1);
@@ -579,13 +579,13 @@ bool SqliteStorage::updateIdentity(UserId user, const CoreIdentity& identity)
         query.bindValue(":sslcert", identity.sslCert().toPem());
         query.bindValue(":sslkey", identity.sslKey().toPem());
         query.bindValue(":identityid", identity.id().toInt());
-        safeExec(query);
+        safeExec(query, "update_identity");
         watchQuery(query);
 
         QSqlQuery deleteNickQuery(db);
         deleteNickQuery.prepare(queryString("delete_nicks"));
         deleteNickQuery.bindValue(":identityid", identity.id().toInt());
-        safeExec(deleteNickQuery);
+        safeExec(deleteNickQuery, "delete_nicks");
         watchQuery(deleteNickQuery);
 
         QSqlQuery insertNickQuery(db);
@@ -593,7 +593,7 @@ bool SqliteStorage::updateIdentity(UserId user, const CoreIdentity& identity)
         foreach (QString nick, identity.nicks()) {
             insertNickQuery.bindValue(":identityid", identity.id().toInt());
             insertNickQuery.bindValue(":nick", nick);
-            safeExec(insertNickQuery);
+            safeExec(insertNickQuery, "insert_nick");
             watchQuery(insertNickQuery);
         }
         db.commit();
@@ -614,7 +614,7 @@ void SqliteStorage::removeIdentity(UserId user, IdentityId identityId)
         checkQuery.bindValue(":identityid", identityId.toInt());
         checkQuery.bindValue(":userid", user.toInt());
         lockForRead();
-        safeExec(checkQuery);
+        safeExec(checkQuery, "select_checkidentity");
 
         // there should be exactly one identity for the given id and user
         error = (!checkQuery.first() || checkQuery.value(0).toInt() != 1);
@@ -628,13 +628,13 @@ void SqliteStorage::removeIdentity(UserId user, IdentityId identityId)
         QSqlQuery deleteNickQuery(db);
         deleteNickQuery.prepare(queryString("delete_nicks"));
         deleteNickQuery.bindValue(":identityid", identityId.toInt());
-        safeExec(deleteNickQuery);
+        safeExec(deleteNickQuery, "delete_nicks");
 
         QSqlQuery deleteIdentityQuery(db);
         deleteIdentityQuery.prepare(queryString("delete_identity"));
         deleteIdentityQuery.bindValue(":identityid", identityId.toInt());
         deleteIdentityQuery.bindValue(":userid", user.toInt());
-        safeExec(deleteIdentityQuery);
+        safeExec(deleteIdentityQuery, "delete_identity");
         db.commit();
     }
     unlock();
@@ -655,7 +655,7 @@ std::vector<CoreIdentity> SqliteStorage::identities(UserId user)
         nickQuery.prepare(queryString("select_nicks"));
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_identities");
 
         while (query.next()) {
             CoreIdentity identity(IdentityId(query.value(0).toInt()));
@@ -682,7 +682,7 @@ std::vector<CoreIdentity> SqliteStorage::identities(UserId user)
 
             nickQuery.bindValue(":identityid", identity.id().toInt());
             QList<QString> nicks;
-            safeExec(nickQuery);
+            safeExec(nickQuery, "select_nicks");
             watchQuery(nickQuery);
             while (nickQuery.next()) {
                 nicks << nickQuery.value(0).toString();
@@ -710,7 +710,7 @@ NetworkId SqliteStorage::createNetwork(UserId user, const NetworkInfo& info)
         query.bindValue(":userid", user.toInt());
         bindNetworkInfo(query, info);
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "insert_network");
         if (!watchQuery(query)) {
             db.rollback();
             error = true;
@@ -731,7 +731,7 @@ NetworkId SqliteStorage::createNetwork(UserId user, const NetworkInfo& info)
             insertServersQuery.bindValue(":userid", user.toInt());
             insertServersQuery.bindValue(":networkid", networkId.toInt());
             bindServerInfo(insertServersQuery, server);
-            safeExec(insertServersQuery);
+            safeExec(insertServersQuery, "insert_server");
             if (!watchQuery(insertServersQuery)) {
                 db.rollback();
                 error = true;
@@ -807,7 +807,7 @@ bool SqliteStorage::updateNetwork(UserId user, const NetworkInfo& info)
         bindNetworkInfo(updateQuery, info);
 
         lockForWrite();
-        safeExec(updateQuery);
+        safeExec(updateQuery, "update_network");
         if (!watchQuery(updateQuery) || updateQuery.numRowsAffected() != 1) {
             error = true;
             db.rollback();
@@ -840,7 +840,7 @@ bool SqliteStorage::updateNetwork(UserId user, const NetworkInfo& info)
             insertServersQuery.bindValue(":userid", user.toInt());
             insertServersQuery.bindValue(":networkid", info.networkId.toInt());
             bindServerInfo(insertServersQuery, server);
-            safeExec(insertServersQuery);
+            safeExec(insertServersQuery, "insert_server");
             if (!watchQuery(insertServersQuery)) {
                 error = true;
                 db.rollback();
@@ -866,7 +866,7 @@ bool SqliteStorage::removeNetwork(UserId user, const NetworkId& networkId)
         deleteNetworkQuery.bindValue(":networkid", networkId.toInt());
         deleteNetworkQuery.bindValue(":userid", user.toInt());
         lockForWrite();
-        safeExec(deleteNetworkQuery);
+        safeExec(deleteNetworkQuery, "delete_network");
         if (!watchQuery(deleteNetworkQuery) || deleteNetworkQuery.numRowsAffected() != 1) {
             error = true;
             db.rollback();
@@ -881,7 +881,7 @@ bool SqliteStorage::removeNetwork(UserId user, const NetworkId& networkId)
         QSqlQuery deleteBacklogQuery(db);
         deleteBacklogQuery.prepare(queryString("delete_backlog_for_network"));
         deleteBacklogQuery.bindValue(":networkid", networkId.toInt());
-        safeExec(deleteBacklogQuery);
+        safeExec(deleteBacklogQuery, "delete_backlog_for_network");
         if (!watchQuery(deleteBacklogQuery)) {
             db.rollback();
             error = true;
@@ -896,7 +896,7 @@ bool SqliteStorage::removeNetwork(UserId user, const NetworkId& networkId)
         QSqlQuery deleteBuffersQuery(db);
         deleteBuffersQuery.prepare(queryString("delete_buffers_for_network"));
         deleteBuffersQuery.bindValue(":networkid", networkId.toInt());
-        safeExec(deleteBuffersQuery);
+        safeExec(deleteBuffersQuery, "delete_buffers_for_network");
         if (!watchQuery(deleteBuffersQuery)) {
             db.rollback();
             error = true;
@@ -911,7 +911,7 @@ bool SqliteStorage::removeNetwork(UserId user, const NetworkId& networkId)
         QSqlQuery deleteServersQuery(db);
         deleteServersQuery.prepare(queryString("delete_ircservers_for_network"));
         deleteServersQuery.bindValue(":networkid", networkId.toInt());
-        safeExec(deleteServersQuery);
+        safeExec(deleteServersQuery, "delete_ircservers_for_network");
         if (!watchQuery(deleteServersQuery)) {
             db.rollback();
             error = true;
@@ -943,7 +943,7 @@ std::vector<NetworkInfo> SqliteStorage::networks(UserId user)
         serversQuery.prepare(queryString("select_servers_for_network"));
 
         lockForRead();
-        safeExec(networksQuery);
+        safeExec(networksQuery, "select_networks_for_user");
         if (watchQuery(networksQuery)) {
             while (networksQuery.next()) {
                 NetworkInfo net;
@@ -974,7 +974,7 @@ std::vector<NetworkInfo> SqliteStorage::networks(UserId user)
                 net.skipCapsFromString(networksQuery.value(23).toString());
 
                 serversQuery.bindValue(":networkid", net.networkId.toInt());
-                safeExec(serversQuery);
+                safeExec(serversQuery, "select_servers_for_network");
                 if (!watchQuery(serversQuery)) {
                     nets.clear();
                     break;
@@ -1020,7 +1020,7 @@ std::vector<NetworkId> SqliteStorage::connectedNetworks(UserId user)
         query.prepare(queryString("select_connected_networks"));
         query.bindValue(":userid", user.toInt());
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_connected_networks");
         watchQuery(query);
 
         while (query.next()) {
@@ -1045,7 +1045,7 @@ void SqliteStorage::setNetworkConnected(UserId user, const NetworkId& networkId,
         query.bindValue(":connected", isConnected ? 1 : 0);
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_network_connected");
         watchQuery(query);
         db.commit();
     }
@@ -1065,7 +1065,7 @@ QHash<QString, QString> SqliteStorage::persistentChannels(UserId user, const Net
         query.bindValue(":networkid", networkId.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_persistent_channels");
         watchQuery(query);
         while (query.next()) {
             persistentChans[query.value(0).toString()] = query.value(1).toString();
@@ -1089,7 +1089,7 @@ void SqliteStorage::setChannelPersistent(UserId user, const NetworkId& networkId
         query.bindValue(":joined", isJoined ? 1 : 0);
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_buffer_persistent_channel");
         watchQuery(query);
         db.commit();
     }
@@ -1110,7 +1110,7 @@ void SqliteStorage::setPersistentChannelKey(UserId user, const NetworkId& networ
         query.bindValue(":key", key);
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_buffer_set_channel_key");
         watchQuery(query);
         db.commit();
     }
@@ -1130,7 +1130,7 @@ QString SqliteStorage::awayMessage(UserId user, NetworkId networkId)
         query.bindValue(":networkid", networkId.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_network_awaymsg");
         watchQuery(query);
         if (query.first())
             awayMsg = query.value(0).toString();
@@ -1154,7 +1154,7 @@ void SqliteStorage::setAwayMessage(UserId user, NetworkId networkId, const QStri
         query.bindValue(":awaymsg", awayMsg);
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_network_set_awaymsg");
         watchQuery(query);
         db.commit();
     }
@@ -1174,7 +1174,7 @@ QString SqliteStorage::userModes(UserId user, NetworkId networkId)
         query.bindValue(":networkid", networkId.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_network_usermode");
         watchQuery(query);
         if (query.first())
             modes = query.value(0).toString();
@@ -1198,7 +1198,7 @@ void SqliteStorage::setUserModes(UserId user, NetworkId networkId, const QString
         query.bindValue(":usermode", userModes);
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_network_set_usermode");
         watchQuery(query);
         db.commit();
     }
@@ -1219,7 +1219,7 @@ BufferInfo SqliteStorage::bufferInfo(UserId user, const NetworkId& networkId, Bu
         query.bindValue(":buffercname", buffer.toLower());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_bufferByName");
 
         if (query.first()) {
             bufferInfo = BufferInfo(query.value(0).toInt(), networkId, (BufferInfo::Type)query.value(1).toInt(), 0, buffer);
@@ -1246,7 +1246,7 @@ BufferInfo SqliteStorage::bufferInfo(UserId user, const NetworkId& networkId, Bu
 
             unlock();
             lockForWrite();
-            safeExec(createQuery);
+            safeExec(createQuery, "insert_buffer");
             watchQuery(createQuery);
             bufferInfo = BufferInfo(createQuery.lastInsertId().toInt(), networkId, type, 0, buffer);
         }
@@ -1269,7 +1269,7 @@ BufferInfo SqliteStorage::getBufferInfo(UserId user, const BufferId& bufferId)
         query.bindValue(":bufferid", bufferId.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffer_by_id");
 
         if (watchQuery(query) && query.first()) {
             bufferInfo = BufferInfo(query.value(0).toInt(),
@@ -1298,7 +1298,7 @@ std::vector<BufferInfo> SqliteStorage::requestBuffers(UserId user)
         query.bindValue(":userid", user.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffers");
         watchQuery(query);
         while (query.next()) {
             bufferlist.emplace_back(query.value(0).toInt(),
@@ -1328,7 +1328,7 @@ std::vector<BufferId> SqliteStorage::requestBufferIdsForNetwork(UserId user, Net
         query.bindValue(":userid", user.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffers_for_network");
         watchQuery(query);
         while (query.next()) {
             bufferList.emplace_back(query.value(0).toInt());
@@ -1353,7 +1353,7 @@ bool SqliteStorage::removeBuffer(const UserId& user, const BufferId& bufferId)
         delBufferQuery.bindValue(":userid", user.toInt());
 
         lockForWrite();
-        safeExec(delBufferQuery);
+        safeExec(delBufferQuery, "delete_buffer_for_bufferid");
 
         error = (!watchQuery(delBufferQuery) || delBufferQuery.numRowsAffected() != 1);
     }
@@ -1369,7 +1369,7 @@ bool SqliteStorage::removeBuffer(const UserId& user, const BufferId& bufferId)
         delBacklogQuery.prepare(queryString("delete_backlog_for_buffer"));
         delBacklogQuery.bindValue(":bufferid", bufferId.toInt());
 
-        safeExec(delBacklogQuery);
+        safeExec(delBacklogQuery, "delete_backlog_for_buffer");
         error = !watchQuery(delBacklogQuery);
     }
 
@@ -1398,7 +1398,7 @@ bool SqliteStorage::renameBuffer(const UserId& user, const BufferId& bufferId, c
         query.bindValue(":userid", user.toInt());
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_buffer_name");
 
         error = query.lastError().isValid();
         // unexpected error occurred (19 == constraint violation)
@@ -1433,7 +1433,7 @@ bool SqliteStorage::mergeBuffersPermanently(const UserId& user, const BufferId&
         checkQuery.bindValue(":userid", user.toInt());
 
         lockForRead();
-        safeExec(checkQuery);
+        safeExec(checkQuery, "select_buffers_for_merge");
         error = (!checkQuery.first() || checkQuery.value(0).toInt() != 2);
     }
     if (error) {
@@ -1447,7 +1447,7 @@ bool SqliteStorage::mergeBuffersPermanently(const UserId& user, const BufferId&
         query.prepare(queryString("update_backlog_bufferid"));
         query.bindValue(":oldbufferid", bufferId2.toInt());
         query.bindValue(":newbufferid", bufferId1.toInt());
-        safeExec(query);
+        safeExec(query, "update_backlog_bufferid");
         error = !watchQuery(query);
     }
     if (error) {
@@ -1461,7 +1461,7 @@ bool SqliteStorage::mergeBuffersPermanently(const UserId& user, const BufferId&
         delBufferQuery.prepare(queryString("delete_buffer_for_bufferid"));
         delBufferQuery.bindValue(":bufferid", bufferId2.toInt());
         delBufferQuery.bindValue(":userid", user.toInt());
-        safeExec(delBufferQuery);
+        safeExec(delBufferQuery, "delete_buffer_for_bufferid");
         error = !watchQuery(delBufferQuery);
     }
 
@@ -1489,7 +1489,7 @@ QHash<BufferId, MsgId> SqliteStorage::bufferLastMsgIds(UserId user)
         query.bindValue(":userid", user.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffer_last_messages");
         error = !watchQuery(query);
         if (!error) {
             while (query.next()) {
@@ -1516,7 +1516,7 @@ void SqliteStorage::setBufferLastSeenMsg(UserId user, const BufferId& bufferId,
         query.bindValue(":lastseenmsgid", msgId.toQint64());
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_buffer_lastseen");
         watchQuery(query);
     }
     db.commit();
@@ -1537,7 +1537,7 @@ QHash<BufferId, MsgId> SqliteStorage::bufferLastSeenMsgIds(UserId user)
         query.bindValue(":userid", user.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffer_lastseen_messages");
         error = !watchQuery(query);
         if (!error) {
             while (query.next()) {
@@ -1564,7 +1564,7 @@ void SqliteStorage::setBufferMarkerLineMsg(UserId user, const BufferId& bufferId
         query.bindValue(":markerlinemsgid", msgId.toQint64());
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_buffer_markerlinemsgid");
         watchQuery(query);
     }
     db.commit();
@@ -1585,7 +1585,7 @@ QHash<BufferId, MsgId> SqliteStorage::bufferMarkerLineMsgIds(UserId user)
         query.bindValue(":userid", user.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffer_markerlinemsgids");
         error = !watchQuery(query);
         if (!error) {
             while (query.next()) {
@@ -1612,7 +1612,7 @@ void SqliteStorage::setBufferActivity(UserId user, BufferId bufferId, Message::T
         query.bindValue(":bufferactivity", (int)bufferActivity);
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_buffer_bufferactivity");
         watchQuery(query);
     }
     db.commit();
@@ -1633,7 +1633,7 @@ QHash<BufferId, Message::Types> SqliteStorage::bufferActivities(UserId user)
         query.bindValue(":userid", user.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffer_bufferactivities");
         error = !watchQuery(query);
         if (!error) {
             while (query.next()) {
@@ -1660,7 +1660,7 @@ Message::Types SqliteStorage::bufferActivity(BufferId bufferId, MsgId lastSeenMs
         query.bindValue(":lastseenmsgid", lastSeenMsgId.toQint64());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffer_bufferactivity");
         if (query.first())
             result = Message::Types(query.value(0).toInt());
     }
@@ -1683,7 +1683,7 @@ QHash<QString, QByteArray> SqliteStorage::bufferCiphers(UserId user, const Netwo
         query.bindValue(":networkid", networkId.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffer_ciphers");
         watchQuery(query);
         while (query.next()) {
             bufferCiphers[query.value(0).toString()] = QByteArray::fromHex(query.value(1).toString().toUtf8());
@@ -1707,7 +1707,7 @@ void SqliteStorage::setBufferCipher(UserId user, const NetworkId& networkId, con
         query.bindValue(":cipher", QString(cipher.toHex()));
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_buffer_cipher");
         watchQuery(query);
         db.commit();
     }
@@ -1727,7 +1727,7 @@ void SqliteStorage::setHighlightCount(UserId user, BufferId bufferId, int count)
         query.bindValue(":highlightcount", count);
 
         lockForWrite();
-        safeExec(query);
+        safeExec(query, "update_buffer_highlightcount");
         watchQuery(query);
     }
     db.commit();
@@ -1748,7 +1748,7 @@ QHash<BufferId, int> SqliteStorage::highlightCounts(UserId user)
         query.bindValue(":userid", user.toInt());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffer_highlightcounts");
         error = !watchQuery(query);
         if (!error) {
             while (query.next()) {
@@ -1775,7 +1775,7 @@ int SqliteStorage::highlightCount(BufferId bufferId, MsgId lastSeenMsgId)
         query.bindValue(":lastseenmsgid", lastSeenMsgId.toQint64());
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_buffer_highlightcount");
         if (query.first())
             result = query.value(0).toInt();
     }
@@ -1785,6 +1785,42 @@ int SqliteStorage::highlightCount(BufferId bufferId, MsgId lastSeenMsgId)
     return result;
 }
 
+QHash<UserId, Storage::BufferSyncerState> SqliteStorage::bufferSyncerStates(const QSet<UserId>& users)
+{
+    QHash<UserId, BufferSyncerState> states;
+
+    QSqlDatabase db = logDb();
+    db.transaction();
+
+    bool error = false;
+    {
+        QSqlQuery query(db);
+        query.prepare(queryString("select_buffer_syncer_states"));
+
+        lockForRead();
+        safeExec(query, "select_buffer_syncer_states");
+        error = !watchQuery(query);
+        if (!error) {
+            while (query.next()) {
+                UserId user = query.value(0).toInt();
+                if (!users.contains(user))
+                    continue;
+                BufferId bufferId = query.value(1).toInt();
+                BufferSyncerState& state = states[user];
+                state.lastMsgIds[bufferId] = query.value(2).toLongLong();
+                state.lastSeenMsgIds[bufferId] = query.value(3).toLongLong();
+                state.markerLineMsgIds[bufferId] = query.value(4).toLongLong();
+                state.activities[bufferId] = Message::Types(query.value(5).toInt());
+                state.highlightCounts[bufferId] = query.value(6).toInt();
+            }
+        }
+    }
+
+    db.commit();
+    unlock();
+    return states;
+}
+
 bool SqliteStorage::logMessage(Message& msg)
 {
     QSqlDatabase db = logDb();
@@ -1807,7 +1843,7 @@ bool SqliteStorage::logMessage(Message& msg)
         logMessageQuery.bindValue(":message", msg.contents());
 
         lockForWrite();
-        safeExec(logMessageQuery);
+        safeExec(logMessageQuery, "insert_message");
 
         if (logMessageQuery.lastError().isValid()) {
             // constraint violation - must be NOT NULL constraint - probably the sender is missing...
@@ -1817,8 +1853,8 @@ bool SqliteStorage::logMessage(Message& msg)
                 addSenderQuery.bindValue(":sender", msg.sender());
                 addSenderQuery.bindValue(":realname", msg.realName());
                 addSenderQuery.bindValue(":avatarurl", msg.avatarUrl());
-                safeExec(addSenderQuery);
-                safeExec(logMessageQuery);
+                safeExec(addSenderQuery, "insert_sender");
+                safeExec(logMessageQuery, "insert_message");
                 error = !watchQuery(logMessageQuery);
             }
             else {
@@ -1867,7 +1903,7 @@ bool SqliteStorage::logMessages(MessageList& msgs)
             addSenderQuery.bindValue(":sender", sender.sender);
             addSenderQuery.bindValue(":realname", sender.realname);
             addSenderQuery.bindValue(":avatarurl", sender.avatarurl);
-            safeExec(addSenderQuery);
+            safeExec(addSenderQuery, "insert_sender");
         }
     }
 
@@ -1889,7 +1925,7 @@ bool SqliteStorage::logMessages(MessageList& msgs)
             logMessageQuery.bindValue(":senderprefixes", msg.senderPrefixes());
             logMessageQuery.bindValue(":message", msg.contents());
 
-            safeExec(logMessageQuery);
+            safeExec(logMessageQuery, "insert_message");
             if (!watchQuery(logMessageQuery)) {
                 error = true;
                 break;
@@ -1933,7 +1969,7 @@ std::vector<Message> SqliteStorage::requestMsgs(UserId user, BufferId bufferId,
         bufferInfoQuery.bindValue(":bufferid", bufferId.toInt());
 
         lockForRead();
-        safeExec(bufferInfoQuery);
+        safeExec(bufferInfoQuery, "select_buffer_by_id");
         error = !watchQuery(bufferInfoQuery) || !bufferInfoQuery.first();
         if (!error) {
             bufferInfo = BufferInfo(bufferInfoQuery.value(0).toInt(),
@@ -1952,22 +1988,26 @@ std::vector<Message> SqliteStorage::requestMsgs(UserId user, BufferId bufferId,
 
     {
         QSqlQuery query(db);
+        QString queryName;
         if (last == -1 && first == -1) {
-            query.prepare(queryString("select_messagesNewestK"));
+            queryName = "select_messagesNewestK";
+            query.prepare(queryString(queryName));
         }
         else if (last == -1) {
-            query.prepare(queryString("select_messagesNewerThan"));
+            queryName = "select_messagesNewerThan";
+            query.prepare(queryString(queryName));
             query.bindValue(":firstmsg", first.toQint64());
         }
         else {
-            query.prepare(queryString("select_messagesRange"));
+            queryName = "select_messagesRange";
+            query.prepare(queryString(queryName));
             query.bindValue(":lastmsg", last.toQint64());
             query.bindValue(":firstmsg", first.toQint64());
         }
         query.bindValue(":bufferid", bufferId.toInt());
         query.bindValue(":limit", limit);
 
-        safeExec(query);
+        safeExec(query, queryName);
         watchQuery(query);
 
         while (query.next()) {
@@ -2012,7 +2052,7 @@ std::vector<Message> SqliteStorage::requestMsgsFiltered(
         bufferInfoQuery.bindValue(":bufferid", bufferId.toInt());
 
         lockForRead();
-        safeExec(bufferInfoQuery);
+        safeExec(bufferInfoQuery, "select_buffer_by_id");
         error = !watchQuery(bufferInfoQuery) || !bufferInfoQuery.first();
         if (!error) {
             bufferInfo = BufferInfo(bufferInfoQuery.value(0).toInt(),
@@ -2031,15 +2071,19 @@ std::vector<Message> SqliteStorage::requestMsgsFiltered(
 
     {
         QSqlQuery query(db);
+        QString queryName;
         if (last == -1 && first == -1) {
-            query.prepare(queryString("select_messagesNewestK_filtered"));
+            queryName = "select_messagesNewestK_filtered";
+            query.prepare(queryString(queryName));
         }
         else if (last == -1) {
-            query.prepare(queryString("select_messagesNewerThan_filtered"));
+            queryName = "select_messagesNewerThan_filtered";
+            query.prepare(queryString(queryName));
             query.bindValue(":firstmsg", first.toQint64());
         }
         else {
-            query.prepare(queryString("select_messagesRange_filtered"));
+            queryName = "select_messagesRange_filtered";
+            query.prepare(queryString(queryName));
             query.bindValue(":lastmsg", last.toQint64());
             query.bindValue(":firstmsg", first.toQint64());
         }
@@ -2050,7 +2094,7 @@ std::vector<Message> SqliteStorage::requestMsgsFiltered(
         int flagsRaw = flags;
         query.bindValue(":flags", flagsRaw);
 
-        safeExec(query);
+        safeExec(query, queryName);
         watchQuery(query);
 
         while (query.next()) {
@@ -2096,7 +2140,7 @@ std::vector<Message> SqliteStorage::requestMsgsForward(
         bufferInfoQuery.bindValue(":bufferid", bufferId.toInt());
 
         lockForRead();
-        safeExec(bufferInfoQuery);
+        safeExec(bufferInfoQuery, "select_buffer_by_id");
         error = !watchQuery(bufferInfoQuery) || !bufferInfoQuery.first();
         if (!error) {
             bufferInfo = BufferInfo(bufferInfoQuery.value(0).toInt(),
@@ -2138,7 +2182,7 @@ std::vector<Message> SqliteStorage::requestMsgsForward(
 
         query.bindValue(":limit", limit);
 
-        safeExec(query);
+        safeExec(query, "select_messagesForward");
         watchQuery(query);
 
         while (query.next()) {
@@ -2179,7 +2223,7 @@ std::vector<Message> SqliteStorage::requestAllMsgs(UserId user, MsgId first, Msg
         bufferInfoQuery.bindValue(":userid", user.toInt());
 
         lockForRead();
-        safeExec(bufferInfoQuery);
+        safeExec(bufferInfoQuery, "select_buffers");
         watchQuery(bufferInfoQuery);
         while (bufferInfoQuery.next()) {
             BufferInfo bufferInfo = BufferInfo(bufferInfoQuery.value(0).toInt(),
@@ -2191,17 +2235,20 @@ std::vector<Message> SqliteStorage::requestAllMsgs(UserId user, MsgId first, Msg
         }
 
         QSqlQuery query(db);
+        QString queryName;
         if (last == -1) {
-            query.prepare(queryString("select_messagesAllNew"));
+            queryName = "select_messagesAllNew";
+            query.prepare(queryString(queryName));
         }
         else {
-            query.prepare(queryString("select_messagesAll"));
+            queryName = "select_messagesAll";
+            query.prepare(queryString(queryName));
             query.bindValue(":lastmsg", last.toQint64());
         }
         query.bindValue(":userid", user.toInt());
         query.bindValue(":firstmsg", first.toQint64());
         query.bindValue(":limit", limit);
-        safeExec(query);
+        safeExec(query, queryName);
 
         watchQuery(query);
 
@@ -2241,7 +2288,7 @@ std::vector<Message> SqliteStorage::requestAllMsgsFiltered(UserId user, MsgId fi
         bufferInfoQuery.bindValue(":userid", user.toInt());
 
         lockForRead();
-        safeExec(bufferInfoQuery);
+        safeExec(bufferInfoQuery, "select_buffers");
         watchQuery(bufferInfoQuery);
         while (bufferInfoQuery.next()) {
             BufferInfo bufferInfo = BufferInfo(bufferInfoQuery.value(0).toInt(),
@@ -2253,11 +2300,14 @@ std::vector<Message> SqliteStorage::requestAllMsgsFiltered(UserId user, MsgId fi
         }
 
         QSqlQuery query(db);
+        QString queryName;
         if (last == -1) {
-            query.prepare(queryString("select_messagesAllNew_filtered"));
+            queryName = "select_messagesAllNew_filtered";
+            query.prepare(queryString(queryName));
         }
         else {
-            query.prepare(queryString("select_messagesAll_filtered"));
+            queryName = "select_messagesAll_filtered";
+            query.prepare(queryString(queryName));
             query.bindValue(":lastmsg", last.toQint64());
         }
         query.bindValue(":userid", user.toInt());
@@ -2267,7 +2317,7 @@ std::vector<Message> SqliteStorage::requestAllMsgsFiltered(UserId user, MsgId fi
         query.bindValue(":type", typeRaw);
         int flagsRaw = flags;
         query.bindValue(":flags", flagsRaw);
-        safeExec(query);
+        safeExec(query, queryName);
 
         watchQuery(query);
 
@@ -2305,7 +2355,7 @@ QMap<UserId, QString> SqliteStorage::getAllAuthUserNames()
         query.prepare(queryString("select_all_authusernames"));
 
         lockForRead();
-        safeExec(query);
+        safeExec(query, "select_all_authusernames");
         watchQuery(query);
         while (query.next()) {
             authusernames[query.value(0).toInt()] = query.value(1).toString();
@@ -2321,8 +2371,10 @@ QString SqliteStorage::backlogFile()
     return Quassel::configDirPath() + "quassel-storage.sqlite";
 }
 
-bool SqliteStorage::safeExec(QSqlQuery& query, int retryCount)
+bool SqliteStorage::safeExec(QSqlQuery& query, const QString& queryName, int retryCount)
 {
+    // Retries are included in the duration of the initial attempt
+    Metrics::ScopedTimer timer{retryCount == 0 ? queryDurationMetric(queryName) : nullptr};
     query.exec();
 
     if (!query.lastError().isValid())
@@ -2334,7 +2386,7 @@ bool SqliteStorage::safeExec(QSqlQuery& query, int retryCount)
     // SQLITE_LOCKED       6   /* A table in the database is locked */
     if (nativeErrorCode == QLatin1String{"5"} || nativeErrorCode == QLatin1String{"6"}) {
         if (retryCount < _maxRetryCount)
-            return safeExec(query, retryCount + 1);
+            return safeExec(query, queryName, retryCount + 1);
     }
     return false;
 }
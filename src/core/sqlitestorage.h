@@ -106,6 +106,7 @@ public:
     void setHighlightCount(UserId id, BufferId bufferId, int count) override;
     QHash<BufferId, int> highlightCounts(UserId id) override;
     int highlightCount(BufferId bufferId, MsgId lastSeenMsgId) override;
+    QHash<UserId, BufferSyncerState> bufferSyncerStates(const QSet<UserId>& users) override;
     QHash<QString, QByteArray> bufferCiphers(UserId user, const NetworkId& networkId) override;
     void setBufferCipher(UserId user, const NetworkId& networkId, const QString& bufferName, const QByteArray& cipher) override;
 
@@ -167,7 +168,15 @@ protected:
      */
     virtual bool setSchemaVersionUpgradeStep(QString upgradeQuery) override;
 
-    bool safeExec(QSqlQuery& query, int retryCount = 0);
+    /**
+     * Executes a query, retrying while the database is locked
+     *
+     * @param query       The prepared query
+     * @param queryName   Name of the query file, for labelling the query's duration metric
+     * @param retryCount  Number of attempts made so far
+     * @return True if the query succeeded
+     */
+    bool safeExec(QSqlQuery& query, const QString& queryName = QString(), int retryCount = 0);
 
 private:
     static QString backlogFile();
@@ -24,13 +24,34 @@
 
 #include <QCryptographicHash>
 
+#include "quassel.h"
+#include "scrypt.h"
+
+namespace {
+
+constexpr int kScryptDefaultCost = 14;  // 16 MiB of memory with a block size of 8
+constexpr int kScryptMinCost = 10;
+constexpr int kScryptMaxCost = 20;
+constexpr int kScryptBlockSize = 8;
+constexpr int kScryptParallelism = 1;
+constexpr int kScryptKeyLength = 64;
+
+int scryptCost()
+{
+    bool ok;
+    int cost = Quassel::optionValue("password-hash-cost").toInt(&ok);
+    return ok ? qBound(kScryptMinCost, cost, kScryptMaxCost) : kScryptDefaultCost;
+}
+
+}  // namespace
+
 Storage::Storage(QObject* parent)
     : QObject(parent)
 {}
 
 QString Storage::hashPassword(const QString& password)
 {
-    return hashPasswordSha2_512(password);
+    return hashPasswordScrypt(password);
 }
 
 bool Storage::checkHashedPassword(const UserId user, const QString& password, const QString& hashedPassword, const Storage::HashVersion version)
@@ -46,11 +67,15 @@ bool Storage::checkHashedPassword(const UserId user, const QString& password, co
         passwordCorrect = checkHashedPasswordSha2_512(password, hashedPassword);
         break;
 
+    case Storage::HashVersion::Scrypt:
+        passwordCorrect = checkHashedPasswordScrypt(password, hashedPassword);
+        break;
+
     default:
         qWarning() << "Password hash version" << QString(version) << "is not supported, please reset password";
     }
 
-    if (passwordCorrect && version < Storage::HashVersion::Latest) {
+    if (passwordCorrect && (version < Storage::HashVersion::Latest || scryptCostChanged(hashedPassword))) {
         updateUser(user, password);
     }
 
@@ -69,16 +94,8 @@ bool Storage::checkHashedPasswordSha1(const QString& password, const QString& ha
 
 QString Storage::hashPasswordSha2_512(const QString& password)
 {
-    // Generate a salt of 512 bits (64 bytes) using the Mersenne Twister
-    std::random_device seed;
-    std::mt19937 generator(seed());
-    std::uniform_int_distribution<int> distribution(0, 255);
-    QByteArray saltBytes;
-    saltBytes.resize(64);
-    for (int i = 0; i < 64; i++) {
-        saltBytes[i] = (unsigned char)distribution(generator);
-    }
-    QString salt(saltBytes.toHex());
+    // Generate a salt of 512 bits (64 bytes)
+    QString salt(randomSalt(64).toHex());
 
     // Append the salt to the password, hash the result, and append the salt value
     return sha2_512(password + salt) + ":" + salt;
@@ -102,3 +119,50 @@ QString Storage::sha2_512(const QString& input)
 {
     return QString(QCryptographicHash::hash(input.toUtf8(), QCryptographicHash::Sha512).toHex());
 }
+
+QString Storage::hashPasswordScrypt(const QString& password)
+{
+    const int cost = scryptCost();
+    const QByteArray salt = randomSalt(32);
+    const QByteArray hash = Scrypt::deriveKey(password.toUtf8(), salt, cost, kScryptBlockSize, kScryptParallelism, kScryptKeyLength);
+    return QString("%1:%2:%3:%4:%5")
+        .arg(QString(hash.toHex()), QString(salt.toHex()))
+        .arg(cost)
+        .arg(kScryptBlockSize)
+        .arg(kScryptParallelism);
+}
+
+bool Storage::checkHashedPasswordScrypt(const QString& password, const QString& hashedPassword)
+{
+    QStringList parts = hashedPassword.split(':');
+    if (parts.size() != 5) {
+        qWarning() << "Password hash and parameters were not in the correct format";
+        return false;
+    }
+
+    const QByteArray expectedHash = QByteArray::fromHex(parts[0].toLatin1());
+    const QByteArray salt = QByteArray::fromHex(parts[1].toLatin1());
+    const QByteArray hash
+        = Scrypt::deriveKey(password.toUtf8(), salt, parts[2].toInt(), parts[3].toInt(), parts[4].toInt(), expectedHash.size());
+    return !hash.isEmpty() && hash == expectedHash;
+}
+
+bool Storage::scryptCostChanged(const QString& hashedPassword)
+{
+    QStringList parts = hashedPassword.split(':');
+    return parts.size() == 5 && parts[2].toInt() != scryptCost();
+}
+
+QByteArray Storage::randomSalt(int size)
+{
+    // Generate the salt using the Mersenne Twister
+    std::random_device seed;
+    std::mt19937 generator(seed());
+    std::uniform_int_distribution<int> distribution(0, 255);
+    QByteArray saltBytes;
+    saltBytes.resize(size);
+    for (int i = 0; i < size; i++) {
+        saltBytes[i] = (unsigned char)distribution(generator);
+    }
+    return saltBytes;
+}
@@ -25,6 +25,7 @@
 #include <QMap>
 #include <QObject>
 #include <QProcessEnvironment>
+#include <QSet>
 #include <QString>
 #include <QVariant>
 #include <QVariantList>
@@ -52,10 +53,21 @@ public:
     {
         Sha1,
         Sha2_512,
-        Latest = Sha2_512
+        Scrypt,
+        Latest = Scrypt
 
     };
 
+    //! The persistent buffer state a session's BufferSyncer is initialized with
+    struct BufferSyncerState
+    {
+        QHash<BufferId, MsgId> lastMsgIds;
+        QHash<BufferId, MsgId> lastSeenMsgIds;
+        QHash<BufferId, MsgId> markerLineMsgIds;
+        QHash<BufferId, Message::Types> activities;
+        QHash<BufferId, int> highlightCounts;
+    };
+
     /* General */
 
     //! Check if the storage type is available.
@@ -488,6 +500,15 @@ public:
      */
     virtual int highlightCount(BufferId bufferId, MsgId lastSeenMsgId) = 0;
 
+    //! Get the BufferSyncer state of several users at once
+    /** This method is called when the Quassel Core is started, so restoring many sessions costs a single
+     *  query instead of several per user. Users without any buffers are missing from the result.
+     *  \note This method is threadsafe.
+     *
+     * \param users     The users whose buffer states should be loaded
+     */
+    virtual QHash<UserId, BufferSyncerState> bufferSyncerStates(const QSet<UserId>& users) = 0;
+
     /* Message handling */
 
     //! Store a Message in the storage backend and set its unique Id.
@@ -597,4 +618,16 @@ private:
     QString hashPasswordSha2_512(const QString& password);
     bool checkHashedPasswordSha2_512(const QString& password, const QString& hashedPassword);
     QString sha2_512(const QString& input);
+
+    /**
+     * Hashes a password with scrypt, using the cost configured with --password-hash-cost
+     *
+     * The result has the format "hash:salt:cost:blocksize:parallelism", with hash and salt hex-encoded.
+     */
+    QString hashPasswordScrypt(const QString& password);
+    bool checkHashedPasswordScrypt(const QString& password, const QString& hashedPassword);
+    /// True if the given scrypt hash was created with a different cost than the configured one
+    bool scryptCostChanged(const QString& hashedPassword);
+
+    QByteArray randomSalt(int size);
 };
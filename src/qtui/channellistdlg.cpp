@@ -44,7 +44,12 @@ ChannelListDlg::ChannelListDlg(QWidget* parent)
     ui.channelListView->setSelectionMode(QAbstractItemView::SingleSelection);
     ui.channelListView->setAlternatingRowColors(true);
     ui.channelListView->setTabKeyNavigation(false);
-    ui.channelListView->setModel(&_sortFilter);
+    // Cores that keep the channel list filter and sort it themselves, so there's no need for a proxy
+    _paged = Client::isCoreFeatureEnabled(Quassel::Feature::PagedChannelList);
+    if (_paged)
+        ui.channelListView->setModel(&_ircListModel);
+    else
+        ui.channelListView->setModel(&_sortFilter);
     ui.channelListView->setSortingEnabled(true);
     // Sort A-Z by default
     ui.channelListView->sortByColumn(0, Qt::AscendingOrder);
@@ -58,7 +63,10 @@ ChannelListDlg::ChannelListDlg(QWidget* parent)
     connect(ui.advancedModeLabel, &ClickableLabel::clicked, this, &ChannelListDlg::toggleMode);
     connect(ui.searchChannelsButton, &QAbstractButton::clicked, this, &ChannelListDlg::requestSearch);
     connect(ui.channelNameLineEdit, &QLineEdit::returnPressed, this, &ChannelListDlg::requestSearch);
-    connect(ui.filterLineEdit, &QLineEdit::textChanged, &_sortFilter, &QSortFilterProxyModel::setFilterFixedString);
+    if (_paged)
+        connect(ui.filterLineEdit, &QLineEdit::textChanged, &_ircListModel, &IrcListModel::setFilterString);
+    else
+        connect(ui.filterLineEdit, &QLineEdit::textChanged, &_sortFilter, &QSortFilterProxyModel::setFilterFixedString);
     connect(Client::ircListHelper(), &ClientIrcListHelper::channelListReceived, this, &ChannelListDlg::receiveChannelList);
     connect(Client::ircListHelper(), &ClientIrcListHelper::finishedListReported, this, &ChannelListDlg::reportFinishedList);
     connect(Client::ircListHelper(), &ClientIrcListHelper::errorReported, this, &ChannelListDlg::showError);
@@ -104,6 +112,12 @@ void ChannelListDlg::requestSearch()
     QStringList channelFilters;
     channelFilters << ui.channelNameLineEdit->text().trimmed();
     Client::ircListHelper()->requestChannelList(_netId, channelFilters);
+
+    if (_paged) {
+        _ircListModel.setPagedNetwork(_netId);
+        showFilterLine(true);
+        updateInputFocus();
+    }
 }
 
 void ChannelListDlg::receiveChannelList(const NetworkId& netId,
@@ -111,7 +125,8 @@ void ChannelListDlg::receiveChannelList(const NetworkId& netId,
                                         const QList<IrcListHelper::ChannelDescription>& channelList)
 {
     Q_UNUSED(channelFilters)
-    if (netId != _netId)
+    // In paged mode, the model fetches the list itself
+    if (netId != _netId || _paged)
         return;
 
     showFilterLine(!channelList.isEmpty());
@@ -183,6 +198,8 @@ void ChannelListDlg::showErrors(bool show)
 void ChannelListDlg::reportFinishedList()
 {
     _listFinished = true;
+    if (_paged)
+        enableQuery(true);
 }
 
 void ChannelListDlg::showError(const QString& error)
@@ -81,6 +81,7 @@ private:
     Ui::ChannelListDlg ui;
 
     bool _listFinished{true};
+    bool _paged{false};
     NetworkId _netId;
     IrcListModel _ircListModel;
     QSortFilterProxyModel _sortFilter;
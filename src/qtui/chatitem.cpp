@@ -121,7 +121,9 @@ QTextLayout* ChatItem::layout() const
 
     _cachedLayout = new QTextLayout;
     initLayout(_cachedLayout);
-    chatView()->setHasCache(chatLine());
+    // Only lines in the scene are laid out through here, see findWords() for detached ones
+    if (chatLine()->chatView())
+        chatView()->setHasCache(chatLine());
     return _cachedLayout;
 }
 
@@ -445,9 +447,20 @@ QList<QRectF> ChatItem::findWords(const QString& searchWord, Qt::CaseSensitivity
         indexList << searchIdx;
         searchIdx = plainText.indexOf(searchWord, searchIdx + 1, caseSensitive);
     }
+    if (indexList.isEmpty())
+        return resultList;
+
+    // Searching covers lines detached from the scene as well. Nothing would ever release a cached layout for those,
+    // so they get a temporary one.
+    QTextLayout detachedLayout;
+    QTextLayout* textLayout = &detachedLayout;
+    if (_cachedLayout || chatLine()->chatView())
+        textLayout = layout();
+    else
+        initLayout(&detachedLayout);
 
     foreach (int idx, indexList) {
-        QTextLine line = layout()->lineForTextPosition(idx);
+        QTextLine line = textLayout->lineForTextPosition(idx);
         qreal x = line.cursorToX(idx);
         qreal width = line.cursorToX(idx + searchWord.count()) - x;
         qreal height = line.height();
@@ -29,7 +29,25 @@ ChatLineModel::ChatLineModel(QObject* parent)
     qRegisterMetaType<WrapList>("ChatLineModel::WrapList");
     qRegisterMetaTypeStreamOperators<WrapList>("ChatLineModel::WrapList");
 
+    qRegisterMetaType<ChatLinePreparer::Batch>("ChatLinePreparer::Batch");
+
     connect(QtUi::style(), &UiStyle::changed, this, &ChatLineModel::styleChanged);
+
+    if (ChatLinePreparer::isSupported()) {
+        auto* preparer = new ChatLinePreparer;
+        preparer->moveToThread(&_preparerThread);
+        connect(&_preparerThread, &QThread::finished, preparer, &QObject::deleteLater);
+        connect(this, &ChatLineModel::prepareBatch, preparer, &ChatLinePreparer::prepare);
+        connect(preparer, &ChatLinePreparer::prepared, this, &ChatLineModel::batchPrepared);
+        _preparerThread.setObjectName("ChatLinePreparer");
+        _preparerThread.start(QThread::LowPriority);
+    }
+}
+
+ChatLineModel::~ChatLineModel()
+{
+    _preparerThread.quit();
+    _preparerThread.wait();
 }
 
 // MessageModelItem *ChatLineModel::createMessageModelItem(const Message &msg) {
@@ -39,11 +57,63 @@ ChatLineModel::ChatLineModel(QObject* parent)
 void ChatLineModel::insertMessages__(int pos, const QList<Message>& messages)
 {
     for (int i = 0; i < messages.count(); i++) {
-        _messageList.insert(pos, ChatLineModelItem(messages[i]));
+        _messageList.insert(pos, takePreparedItem(messages[i]));
         pos++;
     }
 }
 
+ChatLineModelItem ChatLineModel::takePreparedItem(const Message& msg)
+{
+    auto it = _preparedItems.find(msg.msgId());
+    // DayChange messages share the id of the preceding message, and are never prepared in advance
+    if (it == _preparedItems.end() || it->msgType() != msg.type())
+        return ChatLineModelItem(msg);
+
+    ChatLineModelItem item = *it;
+    _preparedItems.erase(it);
+    return item;
+}
+
+void ChatLineModel::prepareMessages(const QList<Message>& msglist)
+{
+    if (msglist.count() < MinPreparedBatchSize || !_preparerThread.isRunning()) {
+        insertPreparedMessages(msglist);
+        return;
+    }
+
+    ChatLinePreparer::Batch batch;
+    batch.id = ++_nextBatchId;
+    batch.styleGeneration = _styleGeneration;
+    batch.style = QtUi::style()->snapshot();
+    batch.messages = msglist;
+    _pendingBatches.insert(batch.id);
+    emit prepareBatch(batch);
+}
+
+void ChatLineModel::discardPreparedMessages()
+{
+    // Batches still in flight will be ignored once they come back
+    _pendingBatches.clear();
+}
+
+void ChatLineModel::batchPrepared(ChatLinePreparer::Batch batch)
+{
+    if (!_pendingBatches.remove(batch.id))
+        return;
+
+    bool styleChanged = batch.styleGeneration != _styleGeneration;
+    for (int i = 0; i < batch.items.count(); i++) {
+        ChatLineModelItem& item = batch.items[i];
+        // Wrap lists depend on the fonts of the style sheet that was active while preparing
+        if (styleChanged)
+            item.invalidateWrapList();
+        _preparedItems.insert(item.msgId(), item);
+    }
+    insertPreparedMessages(batch.messages);
+    // Items of duplicates are left over
+    _preparedItems.clear();
+}
+
 Message ChatLineModel::takeMessageAt(int i)
 {
     Message msg = _messageList[i].message();
@@ -53,6 +123,7 @@ Message ChatLineModel::takeMessageAt(int i)
 
 void ChatLineModel::styleChanged()
 {
+    _styleGeneration++;
     foreach (ChatLineModelItem item, _messageList) {
         item.invalidateWrapList();
     }
@@ -21,9 +21,13 @@
 #ifndef CHATLINEMODEL_H_
 #define CHATLINEMODEL_H_
 
+#include <QHash>
 #include <QList>
+#include <QSet>
+#include <QThread>
 
 #include "chatlinemodelitem.h"
+#include "chatlinepreparer.h"
 #include "messagemodel.h"
 
 class ChatLineModel : public MessageModel
@@ -39,6 +43,7 @@ public:
     };
 
     ChatLineModel(QObject* parent = nullptr);
+    ~ChatLineModel() override;
 
     using Word = ChatLineModelItem::Word;
     using WrapList = ChatLineModelItem::WrapList;
@@ -54,17 +59,38 @@ protected:
     inline MessageModelItem* firstMessageItem() override { return &_messageList.first(); }
     inline const MessageModelItem* lastMessageItem() const override { return &_messageList.last(); }
     inline MessageModelItem* lastMessageItem() override { return &_messageList.last(); }
-    inline void insertMessage__(int pos, const Message& msg) override { _messageList.insert(pos, ChatLineModelItem(msg)); }
+    inline void insertMessage__(int pos, const Message& msg) override { _messageList.insert(pos, takePreparedItem(msg)); }
     void insertMessages__(int pos, const QList<Message>&) override;
     inline void removeMessageAt(int i) override { _messageList.removeAt(i); }
     inline void removeAllMessages() override { _messageList.clear(); }
     Message takeMessageAt(int i) override;
 
+    void prepareMessages(const QList<Message>& msglist) override;
+    void discardPreparedMessages() override;
+
 protected slots:
     virtual void styleChanged();
 
+signals:
+    void prepareBatch(ChatLinePreparer::Batch batch);
+
+private slots:
+    void batchPrepared(ChatLinePreparer::Batch batch);
+
 private:
+    //! Returns the precomputed item for the given message if there is one, or a fresh item otherwise
+    ChatLineModelItem takePreparedItem(const Message& msg);
+
     QList<ChatLineModelItem> _messageList;
+
+    QThread _preparerThread;
+    QSet<quint64> _pendingBatches;
+    quint64 _nextBatchId{0};
+    int _styleGeneration{0};
+    QHash<MsgId, ChatLineModelItem> _preparedItems;  ///< Items of the batch currently being inserted
+
+    /// Batches smaller than this are styled in the GUI thread, as the round trip would only add latency
+    static const int MinPreparedBatchSize = 32;
 };
 
 QDataStream& operator<<(QDataStream& out, const ChatLineModel::WrapList);
@@ -28,7 +28,8 @@
 #include "qtuistyle.h"
 
 // This Struct is taken from Harfbuzz. We use it only to calc it's size.
-// we use a shared memory region so we do not have to malloc a buffer area for every line
+// we use a shared memory region so we do not have to malloc a buffer area for every line. Lines may be wrapped in
+// ChatLinePreparer's worker thread as well, so every thread gets its own region.
 using HB_CharAttributes_Dummy = struct
 {
     /*HB_LineBreakType*/ unsigned lineBreakType : 2;
@@ -39,8 +40,12 @@ using HB_CharAttributes_Dummy = struct
     unsigned unused : 2;
 };
 
-unsigned char* ChatLineModelItem::TextBoundaryFinderBuffer = (unsigned char*)malloc(512 * sizeof(HB_CharAttributes_Dummy));
-int ChatLineModelItem::TextBoundaryFinderBufferSize = 512 * (sizeof(HB_CharAttributes_Dummy) / sizeof(unsigned char));
+namespace {
+
+const int TextBoundaryFinderBufferSize = 512 * (sizeof(HB_CharAttributes_Dummy) / sizeof(unsigned char));
+thread_local unsigned char TextBoundaryFinderBuffer[TextBoundaryFinderBufferSize];
+
+}  // namespace
 
 // ****************************************
 // the actual ChatLineModelItem
@@ -175,7 +180,21 @@ QVariant ChatLineModelItem::backgroundBrush(UiStyle::FormatType subelement, bool
     return QVariant();
 }
 
+void ChatLineModelItem::precompute(const UiStyle::StyleSnapshot& style)
+{
+    // Styling the contents only depends on the format codes, which never change. The decorated timestamp and sender
+    // depend on the settings and are still produced on demand in the GUI thread.
+    _styledMsg.senderHash();
+    if (_wrapList.isEmpty())
+        computeWrapList(style.toTextLayoutList(_styledMsg.contentsFormatList(), _styledMsg.plainContents().length(), messageLabel()));
+}
+
 void ChatLineModelItem::computeWrapList() const
+{
+    computeWrapList(QtUi::style()->toTextLayoutList(_styledMsg.contentsFormatList(), _styledMsg.plainContents().length(), messageLabel()));
+}
+
+void ChatLineModelItem::computeWrapList(const UiStyle::FormatContainer& formats) const
 {
     QString text = _styledMsg.plainContents();
     int length = text.length();
@@ -200,7 +219,7 @@ void ChatLineModelItem::computeWrapList() const
     option.setWrapMode(QTextOption::NoWrap);
     layout.setTextOption(option);
 
-    UiStyle::setTextLayoutFormats(layout, QtUi::style()->toTextLayoutList(_styledMsg.contentsFormatList(), length, messageLabel()));
+    UiStyle::setTextLayoutFormats(layout, formats);
     layout.beginLayout();
     QTextLine line = layout.createLine();
     line.setNumColumns(length);
@@ -213,16 +232,11 @@ void ChatLineModelItem::computeWrapList() const
         // check. At the time of this writing, I'm still trying to get this reverted upstream...
         //
         // cf. https://bugs.webkit.org/show_bug.cgi?id=31076 and Qt commit e6ac173
-        static int needWorkaround = -1;
-        if (needWorkaround < 0) {
-            needWorkaround = 0;
+        static const bool needWorkaround = [] {
             QStringList versions = QString(qVersion()).split('.');
-            if (versions.count() == 3 && versions.at(0).toInt() == 4) {
-                if (versions.at(1).toInt() <= 6 && versions.at(2).toInt() <= 3)
-                    needWorkaround = 1;
-            }
-        }
-        if (needWorkaround == 1) {
+            return versions.count() == 3 && versions.at(0).toInt() == 4 && versions.at(1).toInt() <= 6 && versions.at(2).toInt() <= 3;
+        }();
+        if (needWorkaround) {
             if (idx < length)
                 idx++;
         }
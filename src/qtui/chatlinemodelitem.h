@@ -41,6 +41,16 @@ public:
 
     virtual inline void invalidateWrapList() { _wrapList.clear(); }
 
+    /**
+     * Styles the message and computes its wrap list ahead of time.
+     *
+     * Formats are taken from the given snapshot rather than from QtUi::style(), so this may be called from a worker
+     * thread as long as neither the item nor the snapshot are used by another thread at the same time.
+     *
+     * @param style Snapshot of the style to lay out the message with
+     */
+    void precompute(const UiStyle::StyleSnapshot& style);
+
     /// Used to store information about words to be used for wrapping
     struct Word
     {
@@ -60,10 +70,8 @@ private:
     UiStyle::MessageLabel messageLabel() const;
 
     void computeWrapList() const;
+    void computeWrapList(const UiStyle::FormatContainer& formats) const;
 
     mutable WrapList _wrapList;
     UiStyle::StyledMessage _styledMsg;
-
-    static unsigned char* TextBoundaryFinderBuffer;
-    static int TextBoundaryFinderBufferSize;
 };
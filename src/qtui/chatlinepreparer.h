@@ -0,0 +1,66 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+
+#include "chatlinemodelitem.h"
+#include "message.h"
+#include "uistyle.h"
+
+/**
+ * Styles messages and computes their wrap lists outside of the GUI thread.
+ *
+ * Lives in a worker thread owned by ChatLineModel. The resulting items carry everything ChatScene needs to lay out
+ * the corresponding lines, so inserting them into the model does not require any further text shaping.
+ */
+class ChatLinePreparer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Batch
+    {
+        quint64 id{0};
+        int styleGeneration{0};
+        UiStyle::StyleSnapshot style;  ///< Formats to lay out the messages with, taken when the batch was created
+        QList<Message> messages;
+        QList<ChatLineModelItem> items;
+    };
+
+    using QObject::QObject;
+
+    /**
+     * Checks if text layouts can be created outside of the GUI thread on this platform.
+     *
+     * @returns true if ChatLinePreparer may be used
+     */
+    static bool isSupported();
+
+public slots:
+    void prepare(ChatLinePreparer::Batch batch);
+
+signals:
+    void prepared(ChatLinePreparer::Batch batch);
+};
+
+Q_DECLARE_METATYPE(ChatLinePreparer::Batch)
@@ -20,6 +20,7 @@
 
 #include "chatscene.h"
 
+#include <algorithm>
 #include <utility>
 
 #include <QApplication>
@@ -141,6 +142,15 @@ ChatScene::ChatScene(QAbstractItemModel* model, QString idString, qreal width, C
     setItemIndexMethod(QGraphicsScene::NoIndex);
 }
 
+ChatScene::~ChatScene()
+{
+    // Lines that are part of the scene are deleted by QGraphicsScene
+    for (ChatLine* line : _lines) {
+        if (!_attachedLines.contains(line))
+            delete line;
+    }
+}
+
 ChatView* ChatScene::chatView() const
 {
     return _chatView;
@@ -357,7 +367,6 @@ void ChatScene::rowsInserted(const QModelIndex& index, int start, int end)
             h += line->height();
             line->setPos(0, y - h);
             _lines.insert(start, line);
-            addItem(line);
         }
     }
     else {
@@ -366,7 +375,6 @@ void ChatScene::rowsInserted(const QModelIndex& index, int start, int end)
             line->setPos(0, y + h);
             h += line->height();
             _lines.insert(i, line);
-            addItem(line);
         }
     }
 
@@ -433,6 +441,7 @@ void ChatScene::rowsInserted(const QModelIndex& index, int start, int end)
         _firstLineRow = -1;
     }
     updateSceneRect();
+    updateAttachedLines();
     if (atBottom) {
         emit lastLineChanged(_lines.last(), h);
     }
@@ -465,6 +474,7 @@ void ChatScene::rowsAboutToBeRemoved(const QModelIndex& parent, int start, int e
         if ((*lineIter) == markerLine()->chatLine())
             markerLine()->setChatLine(nullptr);
         h += (*lineIter)->height();
+        _attachedLines.remove(*lineIter);
         delete *lineIter;
         lineIter = _lines.erase(lineIter);
         lineCount++;
@@ -534,6 +544,7 @@ void ChatScene::rowsAboutToBeRemoved(const QModelIndex& parent, int start, int e
     if (needOffset)
         _firstLineRow -= end - start + 1;
     updateSceneRect();
+    updateAttachedLines();
 }
 
 void ChatScene::rowsRemoved()
@@ -592,6 +603,7 @@ void ChatScene::layout(int start, int end, qreal width)
     // setItemIndexMethod(QGraphicsScene::BspTreeIndex);
 
     updateSceneRect(width);
+    updateAttachedLines();
     setHandleXLimits();
     setMarkerLine();
     emit layoutChanged();
@@ -665,6 +677,7 @@ void ChatScene::secondHandlePositionChanged(qreal xpos)
     // setItemIndexMethod(QGraphicsScene::BspTreeIndex);
 
     updateSceneRect();
+    updateAttachedLines();
     setHandleXLimits();
     emit layoutChanged();
 
@@ -1093,15 +1106,73 @@ ChatLineModel::ColumnType ChatScene::columnByScenePos(qreal x) const
 
 int ChatScene::rowByScenePos(qreal y) const
 {
-    QList<QGraphicsItem*> itemList = items(QPointF(0, y));
+    // Not all lines are part of the scene, so we can't ask QGraphicsScene::items() here
+    if (_lines.isEmpty())
+        return -1;
+
+    int row = lineIndexByScenePos(y);
+    ChatLine* line = _lines.at(row);
+    if (!line->isVisible() || y < line->pos().y() || y >= line->pos().y() + line->height())
+        return -1;
+    return row;
+}
 
-    // ChatLine should be at the bottom of the list
-    for (int i = itemList.count() - 1; i >= 0; i--) {
-        auto* line = qgraphicsitem_cast<ChatLine*>(itemList.at(i));
-        if (line)
-            return line->row();
+int ChatScene::lineIndexByScenePos(qreal y) const
+{
+    Q_ASSERT(!_lines.isEmpty());
+    // Lines are stacked without gaps, so they are sorted by their position
+    auto iter = std::upper_bound(_lines.constBegin(), _lines.constEnd(), y, [](qreal y, const ChatLine* line) {
+        return y < line->pos().y();
+    });
+    if (iter == _lines.constBegin())
+        return 0;
+    return static_cast<int>(iter - _lines.constBegin()) - 1;
+}
+
+void ChatScene::setVisibleRange(qreal top, qreal bottom)
+{
+    _visibleTop = top;
+    _visibleBottom = bottom;
+    updateAttachedLines();
+}
+
+void ChatScene::updateAttachedLines()
+{
+    if (_lines.isEmpty())
+        return;
+
+    int first = 0;
+    int last = _lines.count() - 1;
+    if (_visibleBottom >= _visibleTop) {
+        // Keep one viewport height above and below attached, so scrolling doesn't constantly add and remove items
+        qreal margin = _visibleBottom - _visibleTop;
+        first = lineIndexByScenePos(_visibleTop - margin);
+        last = lineIndexByScenePos(_visibleBottom + margin);
+    }
+
+    QSet<ChatLine*>::iterator iter = _attachedLines.begin();
+    while (iter != _attachedLines.end()) {
+        ChatLine* line = *iter;
+        bool inUse = line == mouseGrabberItem() || (_selectingItem && _selectingItem->chatLine() == line);
+        if ((line->row() < first || line->row() > last) && !inUse) {
+            line->clearCache();
+            // Detached lines can't deregister themselves from the view anymore once deleted
+            if (chatView())
+                chatView()->setHasCache(line, false);
+            removeItem(line);
+            iter = _attachedLines.erase(iter);
+        }
+        else
+            ++iter;
+    }
+
+    for (int i = first; i <= last; i++) {
+        ChatLine* line = _lines.at(i);
+        if (!_attachedLines.contains(line)) {
+            addItem(line);
+            _attachedLines.insert(line);
+        }
     }
-    return -1;
 }
 
 void ChatScene::updateSceneRect(qreal width)
@@ -76,6 +76,7 @@ public:
     };
 
     ChatScene(QAbstractItemModel* model, QString idString, qreal width, ChatView* parent);
+    ~ChatScene() override;
 
     inline QAbstractItemModel* model() const { return _model; }
     inline MessageFilter* filter() const { return qobject_cast<MessageFilter*>(_model); }
@@ -144,6 +145,17 @@ public:
 
     bool isScrollingAllowed() const;
 
+    /**
+     * Sets the vertical range of the scene that is currently shown by the view.
+     *
+     * Only ChatLines in or near this range are kept in the scene; all others are detached until they get close to
+     * the viewport again. Detached lines keep their geometry, so row lookups and selection still cover all lines.
+     *
+     * @param top     Top of the visible area in scene coordinates
+     * @param bottom  Bottom of the visible area in scene coordinates
+     */
+    void setVisibleRange(qreal top, qreal bottom);
+
 public slots:
     void updateForViewport(qreal width, qreal height);
     void setWidth(qreal width);
@@ -231,10 +243,18 @@ private:
     void setHandleXLimits();
     void updateSelection(const QPointF& pos);
 
+    //! Returns the index of the line covering y (or the closest one), using a binary search over the line positions
+    int lineIndexByScenePos(qreal y) const;
+    //! Attaches the lines near the visible range to the scene, and detaches all others
+    void updateAttachedLines();
+
     ChatView* _chatView;
     QString _idString;
     QAbstractItemModel* _model;
     QList<ChatLine*> _lines;
+    QSet<ChatLine*> _attachedLines;  ///< Lines currently added to the scene
+    qreal _visibleTop{0};
+    qreal _visibleBottom{-1};  ///< Less than _visibleTop until the view reports a range, meaning that all lines are attached
     BufferId _singleBufferId;
 
     // calls to QChatScene::sceneRect() are very expensive. As we manage the scenerect ourselves
@@ -454,6 +454,8 @@ void ChatView::checkChatLineCaches()
 {
     qreal top = mapToScene(viewport()->rect().topLeft()).y() - 10;  // some grace area to avoid premature cleaning
     qreal bottom = mapToScene(viewport()->rect().bottomRight()).y() + 10;
+    scene()->setVisibleRange(top, bottom);
+
     QSet<ChatLine*>::iterator iter = _linesWithCache.begin();
     while (iter != _linesWithCache.end()) {
         ChatLine* line = *iter;
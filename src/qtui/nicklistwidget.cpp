@@ -28,8 +28,8 @@
 #include "buffermodel.h"
 #include "client.h"
 #include "networkmodel.h"
+#include "nicklistmodel.h"
 #include "nickview.h"
-#include "nickviewfilter.h"
 #include "qtuisettings.h"
 
 NickListWidget::NickListWidget(QWidget* parent)
@@ -130,10 +130,9 @@ void NickListWidget::currentChanged(const QModelIndex& current, const QModelInde
     }
     else {
         view = new NickView(this);
-        auto* filter = new NickViewFilter(newBufferId, Client::networkModel());
-        view->setModel(filter);
         QModelIndex source_current = Client::bufferModel()->mapToSource(current);
-        view->setRootIndex(filter->mapFromSource(source_current));
+        auto* nickListModel = new NickListModel(source_current, Client::networkModel());
+        view->setModel(nickListModel);
         nickViews[newBufferId] = view;
         ui.stackedWidget->addWidget(view);
         ui.stackedWidget->setCurrentWidget(view);
@@ -168,8 +167,8 @@ void NickListWidget::rowsAboutToBeRemoved(const QModelIndex& parent, int start,
             ui.stackedWidget->removeWidget(nickView);
             QAbstractItemModel* model = nickView->model();
             nickView->setModel(nullptr);
-            if (auto* filter = qobject_cast<QSortFilterProxyModel*>(model))
-                filter->setSourceModel(nullptr);
+            if (auto* proxyModel = qobject_cast<QAbstractProxyModel*>(model))
+                proxyModel->setSourceModel(nullptr);
             model->deleteLater();
             nickView->deleteLater();
         }
@@ -200,8 +199,8 @@ void NickListWidget::removeBuffer(BufferId bufferId)
     ui.stackedWidget->removeWidget(view);
     QAbstractItemModel* model = view->model();
     view->setModel(nullptr);
-    if (auto* filter = qobject_cast<QSortFilterProxyModel*>(model))
-        filter->setSourceModel(nullptr);
+    if (auto* proxyModel = qobject_cast<QAbstractProxyModel*>(model))
+        proxyModel->setSourceModel(nullptr);
     model->deleteLater();
     view->deleteLater();
 }
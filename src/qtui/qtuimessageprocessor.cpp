@@ -20,16 +20,55 @@
 
 #include "qtuimessageprocessor.h"
 
+#include <QRunnable>
+#include <QThread>
+
 #include "client.h"
 #include "clientsettings.h"
 #include "identity.h"
 #include "messagemodel.h"
 #include "network.h"
 
+/**
+ * Checks a range of a HighlightJob's messages for highlights
+ */
+class QtUiMessageProcessor::HighlightTask : public QRunnable
+{
+public:
+    HighlightTask(QtUiMessageProcessor* processor, QSharedPointer<HighlightJob> job, int begin, int end)
+        : _processor(processor)
+        , _job(std::move(job))
+        , _begin(begin)
+        , _end(end)
+    {}
+
+    void run() override
+    {
+        // NickHighlightMatcher caches its expressions, so every task needs its own copy
+        NickHighlightMatcher nickMatcher = _job->nickMatcher;
+        const auto& nicks = _job->nicks;
+        for (int i = _begin; i < _end; i++) {
+            Message& msg = _job->messages[i];
+            auto it = nicks.constFind(msg.bufferInfo().networkId());
+            if (it == nicks.constEnd())
+                continue;
+            checkForHighlight(msg, _job->rules, nickMatcher, _job->highlightNick, it->first, it->second);
+        }
+        if (!_job->pendingTasks.deref())
+            QMetaObject::invokeMethod(_processor, "highlightJobFinished", Qt::QueuedConnection, Q_ARG(quint64, _job->id));
+    }
+
+private:
+    QtUiMessageProcessor* _processor;
+    QSharedPointer<HighlightJob> _job;
+    int _begin;
+    int _end;
+};
+
 QtUiMessageProcessor::QtUiMessageProcessor(QObject* parent)
     : AbstractMessageProcessor(parent)
     , _processing(false)
-    , _processMode(TimerBased)
+    , _processMode(QThread::idealThreadCount() > 1 ? Concurrent : TimerBased)
 {
     NotificationSettings notificationSettings;
     _nicksCaseSensitive = notificationSettings.nicksCaseSensitive();
@@ -45,6 +84,11 @@ QtUiMessageProcessor::QtUiMessageProcessor(QObject* parent)
     connect(&_processTimer, &QTimer::timeout, this, &QtUiMessageProcessor::processNextMessage);
 }
 
+QtUiMessageProcessor::~QtUiMessageProcessor()
+{
+    _highlightPool.waitForDone();
+}
+
 void QtUiMessageProcessor::reset()
 {
     if (processMode() == TimerBased) {
@@ -54,6 +98,12 @@ void QtUiMessageProcessor::reset()
         _currentBatch.clear();
         _processQueue.clear();
     }
+    else {
+        // Tasks still running for the current job will finish, but their results are dropped
+        _highlightJob.reset();
+        _processing = false;
+        _processQueue.clear();
+    }
 }
 
 void QtUiMessageProcessor::process(Message& msg)
@@ -65,6 +115,15 @@ void QtUiMessageProcessor::process(Message& msg)
 
 void QtUiMessageProcessor::process(QList<Message>& msgs)
 {
+    if (processMode() == Concurrent && !msgs.isEmpty() && (isProcessing() || msgs.count() >= MinConcurrentBatchSize)) {
+        // Keep the order of batches, even if they're small
+        if (isProcessing())
+            _processQueue.append(msgs);
+        else
+            startHighlightJob(msgs);
+        return;
+    }
+
     QList<Message>::iterator msgIter = msgs.begin();
     QList<Message>::iterator msgIterEnd = msgs.end();
     while (msgIter != msgIterEnd) {
@@ -107,72 +166,137 @@ void QtUiMessageProcessor::processNextMessage()
     process(msg);
 }
 
-void QtUiMessageProcessor::checkForHighlight(Message& msg)
+void QtUiMessageProcessor::startHighlightJob(const QList<Message>& msgs)
 {
-    if (!((msg.type() & (Message::Plain | Message::Notice | Message::Action)) && !(msg.flags() & Message::Self)))
-        return;
+    auto job = QSharedPointer<HighlightJob>::create();
+    job->id = ++_nextHighlightJobId;
+    job->messages.assign(msgs.constBegin(), msgs.constEnd());
+    // Give the pool a deep copy of the rules with their matchers already built; matching against a rule whose cache is
+    // still invalid would rebuild it, which isn't safe from several threads at once
+    job->rules.reserve(_highlightRuleList.size());
+    for (const LegacyHighlightRule& rule : _highlightRuleList) {
+        rule.determineExpressions();
+        job->rules.append(rule);
+    }
+    job->nickMatcher = _nickMatcher;
+    job->highlightNick = _highlightNick;
+
+    // Network and identity objects live in the GUI thread, so take a snapshot of the nicks we need
+    for (const Message& msg : job->messages) {
+        NetworkId netId = msg.bufferInfo().networkId();
+        if (job->nicks.contains(netId))
+            continue;
+        const Network* net = Client::network(netId);
+        if (!net || net->myNick().isEmpty())
+            continue;
+        const Identity* myIdentity = Client::identity(net->identity());
+        job->nicks.insert(netId, std::make_pair(net->myNick(), myIdentity ? myIdentity->nicks() : QStringList{}));
+    }
+
+    int taskCount = (static_cast<int>(job->messages.size()) + HighlightTaskSize - 1) / HighlightTaskSize;
+    job->pendingTasks.store(taskCount);
+    _highlightJob = job;
+    _processing = true;
+    for (int begin = 0; begin < static_cast<int>(job->messages.size()); begin += HighlightTaskSize) {
+        int end = qMin(begin + HighlightTaskSize, static_cast<int>(job->messages.size()));
+        _highlightPool.start(new HighlightTask(this, job, begin, end));
+    }
+}
 
+void QtUiMessageProcessor::highlightJobFinished(quint64 jobId)
+{
+    if (!_highlightJob || _highlightJob->id != jobId)
+        return;  // dropped by reset()
+
+    QList<Message> msgs;
+    msgs.reserve(static_cast<int>(_highlightJob->messages.size()));
+    for (Message& msg : _highlightJob->messages) {
+        preProcess(msg);
+        msgs << msg;
+    }
+    _highlightJob.reset();
+    Client::messageModel()->insertMessages(msgs);
+
+    if (!_processQueue.isEmpty())
+        startHighlightJob(_processQueue.takeFirst());
+    else
+        _processing = false;
+}
+
+void QtUiMessageProcessor::checkForHighlight(Message& msg)
+{
     // Cached per network
     const NetworkId& netId = msg.bufferInfo().networkId();
     const Network* net = Client::network(netId);
 
     if (net && !net->myNick().isEmpty()) {
-        // Get current nick
-        QString currentNick = net->myNick();
         // Get identity nicks
         QStringList identityNicks = {};
         const Identity* myIdentity = Client::identity(net->identity());
         if (myIdentity) {
             identityNicks = myIdentity->nicks();
         }
+        checkForHighlight(msg, _highlightRuleList, _nickMatcher, _highlightNick, net->myNick(), identityNicks);
+    }
+}
+
+void QtUiMessageProcessor::checkForHighlight(Message& msg,
+                                             const LegacyHighlightRuleList& rules,
+                                             const NickHighlightMatcher& nickMatcher,
+                                             HighlightNickType highlightNick,
+                                             const QString& currentNick,
+                                             const QStringList& identityNicks)
+{
+    if (!((msg.type() & (Message::Plain | Message::Notice | Message::Action)) && !(msg.flags() & Message::Self)))
+        return;
 
-        // Get buffer name, message contents
-        QString bufferName = msg.bufferInfo().bufferName();
-        QString msgContents = msg.contents();
-        bool matches = false;
+    const NetworkId& netId = msg.bufferInfo().networkId();
+    // Get buffer name, message contents
+    QString bufferName = msg.bufferInfo().bufferName();
+    QString msgContents = msg.contents();
+    bool matches = false;
 
-        for (int i = 0; i < _highlightRuleList.count(); i++) {
-            auto& rule = _highlightRuleList.at(i);
-            if (!rule.isEnabled())
-                continue;
+    for (int i = 0; i < rules.count(); i++) {
+        auto& rule = rules.at(i);
+        if (!rule.isEnabled())
+            continue;
 
-            // Skip if channel name doesn't match and channel rule is not empty
-            //
-            // Match succeeds if...
-            //   Channel name matches a defined rule
-            //   Defined rule is empty
-            // And take the inverse of the above
-            if (!rule.chanNameMatcher().match(bufferName, true)) {
-                // A channel name rule is specified and does NOT match the current buffer name, skip
-                // this rule
-                continue;
-            }
+        // Skip if channel name doesn't match and channel rule is not empty
+        //
+        // Match succeeds if...
+        //   Channel name matches a defined rule
+        //   Defined rule is empty
+        // And take the inverse of the above
+        if (!rule.chanNameMatcher().match(bufferName, true)) {
+            // A channel name rule is specified and does NOT match the current buffer name, skip
+            // this rule
+            continue;
+        }
 
-            // Check message according to specified rule, allowing empty rules to match
-            bool contentsMatch = rule.contentsMatcher().match(stripFormatCodes(msgContents), true);
+        // Check message according to specified rule, allowing empty rules to match
+        bool contentsMatch = rule.contentsMatcher().match(stripFormatCodes(msgContents), true);
 
-            // Support for sender matching can be added here
+        // Support for sender matching can be added here
 
-            if (contentsMatch) {
-                // Support for inverse rules can be added here
-                matches = true;
-            }
+        if (contentsMatch) {
+            // Support for inverse rules can be added here
+            matches = true;
         }
+    }
+
+    if (matches) {
+        msg.setFlags(msg.flags() | Message::Highlight);
+        return;
+    }
 
-        if (matches) {
+    // Check nicknames
+    if (highlightNick != HighlightNickType::NoNick && !currentNick.isEmpty()) {
+        // Nickname matching allowed and current nickname is known
+        // Run the nickname matcher on the unformatted string
+        if (nickMatcher.match(stripFormatCodes(msgContents), netId, currentNick, identityNicks)) {
             msg.setFlags(msg.flags() | Message::Highlight);
             return;
         }
-
-        // Check nicknames
-        if (_highlightNick != HighlightNickType::NoNick && !currentNick.isEmpty()) {
-            // Nickname matching allowed and current nickname is known
-            // Run the nickname matcher on the unformatted string
-            if (_nickMatcher.match(stripFormatCodes(msgContents), netId, currentNick, identityNicks)) {
-                msg.setFlags(msg.flags() | Message::Highlight);
-                return;
-            }
-        }
     }
 }
 
@@ -22,7 +22,12 @@
 #define QTUIMESSAGEPROCESSOR_H_
 
 #include <utility>
+#include <vector>
 
+#include <QAtomicInt>
+#include <QHash>
+#include <QSharedPointer>
+#include <QThreadPool>
 #include <QTimer>
 
 #include "abstractmessageprocessor.h"
@@ -41,6 +46,7 @@ public:
     };
 
     QtUiMessageProcessor(QObject* parent);
+    ~QtUiMessageProcessor() override;
 
     inline bool isProcessing() const { return _processing; }
     inline Mode processMode() const { return _processMode; }
@@ -62,6 +68,7 @@ public slots:
 
 private slots:
     void processNextMessage();
+    void highlightJobFinished(quint64 jobId);
     void nicksCaseSensitiveChanged(const QVariant& variant);
     void highlightListChanged(const QVariant& variant);
     void highlightNickChanged(const QVariant& variant);
@@ -222,12 +229,15 @@ private:
 
         bool operator!=(const LegacyHighlightRule& other) const;
 
-    private:
         /**
          * Update internal cache of expression matching if needed
+         *
+         * Once this has run, contentsMatcher() and chanNameMatcher() no longer modify the rule, so a rule must be
+         * prepared this way before other threads may match against it.
          */
         void determineExpressions() const;
 
+    private:
         QString _contents = {};
         bool _isRegEx = false;
         bool _isCaseSensitive = false;
@@ -243,10 +253,33 @@ private:
 
     using LegacyHighlightRuleList = QList<LegacyHighlightRule>;
 
+    using HighlightNickType = NotificationSettings::HighlightNickType;
+
+    /**
+     * A batch of messages checked for highlights in the thread pool, along with a snapshot of the highlight settings
+     */
+    struct HighlightJob
+    {
+        quint64 id{0};
+        std::vector<Message> messages;
+        LegacyHighlightRuleList rules;
+        NickHighlightMatcher nickMatcher;
+        HighlightNickType highlightNick{HighlightNickType::CurrentNick};
+        /// Current nick and identity nicks of every network we know our nick for
+        QHash<NetworkId, std::pair<QString, QStringList>> nicks;
+        QAtomicInt pendingTasks;
+    };
+    class HighlightTask;
+
     void checkForHighlight(Message& msg);
+    static void checkForHighlight(Message& msg,
+                                  const LegacyHighlightRuleList& rules,
+                                  const NickHighlightMatcher& nickMatcher,
+                                  HighlightNickType highlightNick,
+                                  const QString& currentNick,
+                                  const QStringList& identityNicks);
     void startProcessing();
-
-    using HighlightNickType = NotificationSettings::HighlightNickType;
+    void startHighlightJob(const QList<Message>& msgs);
 
     LegacyHighlightRuleList _highlightRuleList;  ///< Custom highlight rule list
     NickHighlightMatcher _nickMatcher = {};      ///< Nickname highlight matcher
@@ -260,6 +293,15 @@ private:
     QTimer _processTimer;
     bool _processing;
     Mode _processMode;
+
+    QThreadPool _highlightPool;
+    QSharedPointer<HighlightJob> _highlightJob;  ///< Batch currently being checked in _highlightPool, if any
+    quint64 _nextHighlightJobId{0};
+
+    /// Batches smaller than this are processed right away, as handing them off would only add latency
+    static const int MinConcurrentBatchSize = 256;
+    /// Number of messages checked by a single task in the thread pool
+    static const int HighlightTaskSize = 128;
 };
 
 #endif
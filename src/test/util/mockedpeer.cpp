@@ -116,6 +116,19 @@ void MockedPeer::dispatch(const Protocol::InitData& msg)
     Dispatches({msg});
 }
 
+bool MockedPeer::isCongested() const
+{
+    return _congested;
+}
+
+void MockedPeer::setCongested(bool congested)
+{
+    if (congested != _congested) {
+        _congested = congested;
+        emit congestionChanged(congested);
+    }
+}
+
 // Unwraps the type before calling the correct overload of realDispatch()
 struct DispatchVisitor : public boost::static_visitor<void>
 {
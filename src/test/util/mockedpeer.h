@@ -72,12 +72,18 @@ public:
     void dispatch(const Protocol::InitRequest&) override;
     void dispatch(const Protocol::InitData&) override;
 
+    bool isCongested() const override;
+    /// Simulates the peer not being able to keep up (or having recovered)
+    void setCongested(bool congested);
+
 private:
     void dispatchInternal(const ProtocolMessage&);
 
     template<typename T>
     void realDispatch(const T&);
 
+    bool _congested{false};
+
     friend struct DispatchVisitor;
 };
 
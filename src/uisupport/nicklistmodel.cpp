@@ -0,0 +1,402 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "nicklistmodel.h"
+
+#include <algorithm>
+
+#include "graphicalui.h"
+#include "networkmodel.h"
+#include "uistyle.h"
+
+NickListModel::NickListModel(const QModelIndex& channelIndex, NetworkModel* parent)
+    : QAbstractProxyModel(parent)
+    , _channelIndex(channelIndex)
+{
+    setSourceModel(parent);
+}
+
+NickListModel::~NickListModel()
+{
+    clearCategories();
+}
+
+void NickListModel::setSourceModel(QAbstractItemModel* sourceModel)
+{
+    if (QAbstractProxyModel::sourceModel()) {
+        disconnect(QAbstractProxyModel::sourceModel(), nullptr, this, nullptr);
+    }
+
+    beginResetModel();
+    clearCategories();
+    QAbstractProxyModel::setSourceModel(sourceModel);
+    if (sourceModel) {
+        populate();
+    }
+    else {
+        _channelIndex = QPersistentModelIndex();
+    }
+    endResetModel();
+
+    if (sourceModel) {
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, &NickListModel::on_dataChanged);
+        connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &NickListModel::on_modelReset);
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, &NickListModel::on_modelReset);
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &NickListModel::on_rowsAboutToBeRemoved);
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &NickListModel::on_rowsInserted);
+    }
+}
+
+void NickListModel::populate()
+{
+    if (!_channelIndex.isValid())
+        return;
+
+    int categoryCount = sourceModel()->rowCount(_channelIndex);
+    for (int row = 0; row < categoryCount; row++) {
+        addCategory(sourceModel()->index(row, 0, _channelIndex), false);
+    }
+}
+
+void NickListModel::clearCategories()
+{
+    for (Category* category : _categories) {
+        qDeleteAll(category->bySourceRow);
+        delete category;
+    }
+    _categories.clear();
+}
+
+QModelIndex NickListModel::mapFromSource(const QModelIndex& sourceIndex) const
+{
+    if (!sourceIndex.isValid() || !_channelIndex.isValid())
+        return {};
+
+    QModelIndex sourceParent = sourceIndex.parent();
+    if (sourceParent == _channelIndex) {
+        Category* category = categoryForSource(sourceIndex);
+        return category ? categoryIndex(category) : QModelIndex();
+    }
+    if (sourceParent.parent() == _channelIndex) {
+        Category* category = categoryForSource(sourceParent);
+        if (!category || sourceIndex.row() >= category->bySourceRow.count())
+            return {};
+        return createIndex(sortedRow(category, category->bySourceRow.at(sourceIndex.row())), 0, category);
+    }
+    return {};
+}
+
+QModelIndex NickListModel::mapToSource(const QModelIndex& proxyIndex) const
+{
+    if (!proxyIndex.isValid())
+        return {};
+
+    auto* category = static_cast<Category*>(proxyIndex.internalPointer());
+    if (!category)
+        return _categories.at(proxyIndex.row())->sourceIndex;
+
+    return sourceModel()->index(category->sorted.at(proxyIndex.row())->sourceRow, 0, category->sourceIndex);
+}
+
+QModelIndex NickListModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (row < 0 || column != 0 || row >= rowCount(parent))
+        return {};
+
+    if (!parent.isValid())
+        return createIndex(row, 0, nullptr);
+
+    return createIndex(row, 0, _categories.at(parent.row()));
+}
+
+QModelIndex NickListModel::parent(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return {};
+
+    auto* category = static_cast<Category*>(index.internalPointer());
+    if (!category)
+        return {};
+
+    return categoryIndex(category);
+}
+
+int NickListModel::rowCount(const QModelIndex& parent) const
+{
+    if (!parent.isValid())
+        return _categories.count();
+
+    // Users have no children
+    if (parent.internalPointer())
+        return 0;
+
+    return _categories.at(parent.row())->sorted.count();
+}
+
+int NickListModel::columnCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent)
+    return 1;
+}
+
+bool NickListModel::hasChildren(const QModelIndex& parent) const
+{
+    return rowCount(parent) > 0;
+}
+
+QVariant NickListModel::data(const QModelIndex& index, int role) const
+{
+    switch (role) {
+    case Qt::FontRole:
+    case Qt::ForegroundRole:
+    case Qt::BackgroundRole:
+    case Qt::DecorationRole:
+        return GraphicalUi::uiStyle()->nickViewItemData(mapToSource(index), role);
+    default:
+        return QAbstractProxyModel::data(index, role);
+    }
+}
+
+void NickListModel::addCategory(const QModelIndex& sourceIndex, bool emitSignals)
+{
+    auto* category = new Category;
+    category->sourceIndex = sourceIndex;
+    category->categoryId = sourceIndex.data(TreeModel::SortRole).toInt();
+
+    int userCount = sourceModel()->rowCount(sourceIndex);
+    category->bySourceRow.reserve(userCount);
+    for (int row = 0; row < userCount; row++) {
+        category->bySourceRow << new Entry{sortKey(sourceModel()->index(row, 0, sourceIndex)), row};
+    }
+    category->sorted = category->bySourceRow;
+    std::stable_sort(category->sorted.begin(), category->sorted.end(), [](const Entry* a, const Entry* b) {
+        return a->sortKey < b->sortKey;
+    });
+
+    auto it = std::upper_bound(_categories.begin(), _categories.end(), category->categoryId, [](int id, const Category* other) {
+        return id < other->categoryId;
+    });
+    int row = static_cast<int>(it - _categories.begin());
+
+    if (emitSignals)
+        beginInsertRows(QModelIndex(), row, row);
+    _categories.insert(row, category);
+    if (emitSignals)
+        endInsertRows();
+}
+
+void NickListModel::removeCategory(int row)
+{
+    beginRemoveRows(QModelIndex(), row, row);
+    Category* category = _categories.takeAt(row);
+    qDeleteAll(category->bySourceRow);
+    delete category;
+    endRemoveRows();
+}
+
+NickListModel::Category* NickListModel::categoryForSource(const QModelIndex& sourceIndex) const
+{
+    // There are at most a handful of categories
+    for (Category* category : _categories) {
+        if (category->sourceIndex == sourceIndex)
+            return category;
+    }
+    return nullptr;
+}
+
+QModelIndex NickListModel::categoryIndex(Category* category) const
+{
+    return createIndex(_categories.indexOf(category), 0, nullptr);
+}
+
+QString NickListModel::sortKey(const QModelIndex& sourceIndex) const
+{
+    return sourceIndex.data(TreeModel::SortRole).toString().toCaseFolded();
+}
+
+int NickListModel::sortedRow(const Category* category, const Entry* entry) const
+{
+    auto it = std::lower_bound(category->sorted.constBegin(), category->sorted.constEnd(), entry->sortKey, [](const Entry* other, const QString& key) {
+        return other->sortKey < key;
+    });
+    // Step over entries with an equal key
+    while (it != category->sorted.constEnd() && *it != entry)
+        ++it;
+    Q_ASSERT(it != category->sorted.constEnd());
+    return static_cast<int>(it - category->sorted.constBegin());
+}
+
+int NickListModel::insertPosition(const Category* category, const QString& sortKey) const
+{
+    auto it = std::upper_bound(category->sorted.constBegin(), category->sorted.constEnd(), sortKey, [](const QString& key, const Entry* other) {
+        return key < other->sortKey;
+    });
+    return static_cast<int>(it - category->sorted.constBegin());
+}
+
+void NickListModel::updateSourceRows(Category* category, int start)
+{
+    for (int row = start; row < category->bySourceRow.count(); row++) {
+        category->bySourceRow[row]->sourceRow = row;
+    }
+}
+
+void NickListModel::on_dataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    if (!_channelIndex.isValid())
+        return;
+
+    QModelIndex sourceParent = topLeft.parent();
+    if (sourceParent == _channelIndex) {
+        // Category names contain the user count
+        for (int row = topLeft.row(); row <= bottomRight.row(); row++) {
+            QModelIndex proxyIndex = mapFromSource(sourceModel()->index(row, 0, sourceParent));
+            if (proxyIndex.isValid())
+                emit dataChanged(proxyIndex, proxyIndex);
+        }
+        return;
+    }
+    if (sourceParent.parent() != _channelIndex)
+        return;
+
+    Category* category = categoryForSource(sourceParent);
+    if (!category)
+        return;
+    QModelIndex parentIndex = categoryIndex(category);
+
+    for (int row = topLeft.row(); row <= bottomRight.row() && row < category->bySourceRow.count(); row++) {
+        Entry* entry = category->bySourceRow.at(row);
+        int oldRow = sortedRow(category, entry);
+        QString newKey = sortKey(sourceModel()->index(row, 0, sourceParent));
+
+        if (newKey != entry->sortKey) {
+            // Position relative to the other entries, still counting the entry at its old row
+            int destination = insertPosition(category, newKey);
+            if (destination != oldRow && destination != oldRow + 1) {
+                beginMoveRows(parentIndex, oldRow, oldRow, parentIndex, destination);
+                category->sorted.remove(oldRow);
+                entry->sortKey = newKey;
+                int newRow = destination > oldRow ? destination - 1 : destination;
+                category->sorted.insert(newRow, entry);
+                endMoveRows();
+                oldRow = newRow;
+            }
+            else {
+                entry->sortKey = newKey;
+            }
+        }
+
+        QModelIndex proxyIndex = index(oldRow, 0, parentIndex);
+        emit dataChanged(proxyIndex, proxyIndex);
+    }
+}
+
+void NickListModel::on_modelReset()
+{
+    beginResetModel();
+    clearCategories();
+    populate();
+    endResetModel();
+}
+
+void NickListModel::on_rowsAboutToBeRemoved(const QModelIndex& parent, int start, int end)
+{
+    if (!_channelIndex.isValid())
+        return;
+
+    if (parent == _channelIndex) {
+        for (int row = _categories.count() - 1; row >= 0; row--) {
+            int sourceRow = _categories.at(row)->sourceIndex.row();
+            if (sourceRow >= start && sourceRow <= end)
+                removeCategory(row);
+        }
+        return;
+    }
+
+    if (parent.parent() == _channelIndex) {
+        Category* category = categoryForSource(parent);
+        if (!category)
+            return;
+        QModelIndex parentIndex = categoryIndex(category);
+
+        for (int row = start; row <= end && row < category->bySourceRow.count(); row++) {
+            int proxyRow = sortedRow(category, category->bySourceRow.at(row));
+            beginRemoveRows(parentIndex, proxyRow, proxyRow);
+            category->sorted.remove(proxyRow);
+            endRemoveRows();
+        }
+        int last = qMin(end, category->bySourceRow.count() - 1);
+        if (start <= last) {
+            qDeleteAll(category->bySourceRow.constBegin() + start, category->bySourceRow.constBegin() + last + 1);
+            category->bySourceRow.remove(start, last - start + 1);
+            updateSourceRows(category, start);
+        }
+        return;
+    }
+
+    // Drop everything if the channel itself, or one of its ancestors, is going away
+    for (QModelIndex index = _channelIndex; index.isValid(); index = index.parent()) {
+        if (index.parent() == parent && index.row() >= start && index.row() <= end) {
+            beginResetModel();
+            clearCategories();
+            _channelIndex = QPersistentModelIndex();
+            endResetModel();
+            return;
+        }
+    }
+}
+
+void NickListModel::on_rowsInserted(const QModelIndex& parent, int start, int end)
+{
+    if (!_channelIndex.isValid())
+        return;
+
+    if (parent == _channelIndex) {
+        for (int row = start; row <= end; row++) {
+            addCategory(sourceModel()->index(row, 0, parent), true);
+        }
+        return;
+    }
+
+    if (parent.parent() != _channelIndex)
+        return;
+
+    Category* category = categoryForSource(parent);
+    if (!category)
+        return;
+    QModelIndex parentIndex = categoryIndex(category);
+
+    // Keep source rows up to date before announcing anything, views may query the new rows right away
+    QVector<Entry*> entries;
+    entries.reserve(end - start + 1);
+    for (int row = start; row <= end; row++) {
+        entries << new Entry{sortKey(sourceModel()->index(row, 0, parent)), row};
+    }
+    category->bySourceRow.insert(start, entries.count(), nullptr);
+    std::copy(entries.constBegin(), entries.constEnd(), category->bySourceRow.begin() + start);
+    updateSourceRows(category, end + 1);
+
+    for (Entry* entry : entries) {
+        int proxyRow = insertPosition(category, entry->sortKey);
+        beginInsertRows(parentIndex, proxyRow, proxyRow);
+        category->sorted.insert(proxyRow, entry);
+        endInsertRows();
+    }
+}
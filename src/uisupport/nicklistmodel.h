@@ -0,0 +1,98 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "uisupport-export.h"
+
+#include <QAbstractProxyModel>
+#include <QList>
+#include <QPersistentModelIndex>
+#include <QVector>
+
+class NetworkModel;
+
+/**
+ * Sorted nick list of a single channel
+ *
+ * Presents the user categories of one channel buffer item of the NetworkModel, ordered by prefix
+ * rank, with their users ordered by case-folded nickname.  Unlike a QSortFilterProxyModel over the
+ * whole NetworkModel, the order is maintained incrementally: joins and parts are placed by binary
+ * search and result in single-row signals, and changes outside of the channel are ignored.
+ */
+class UISUPPORT_EXPORT NickListModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    NickListModel(const QModelIndex& channelIndex, NetworkModel* parent = nullptr);
+    ~NickListModel() override;
+
+    QModelIndex mapFromSource(const QModelIndex& sourceIndex) const override;
+    QModelIndex mapToSource(const QModelIndex& proxyIndex) const override;
+
+    void setSourceModel(QAbstractItemModel* sourceModel) override;
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = {}) const override;
+    QModelIndex parent(const QModelIndex& index) const override;
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    bool hasChildren(const QModelIndex& parent = {}) const override;
+
+    QVariant data(const QModelIndex& index, int role) const override;
+
+private slots:
+    void on_dataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+    void on_modelReset();
+    void on_rowsAboutToBeRemoved(const QModelIndex& parent, int start, int end);
+    void on_rowsInserted(const QModelIndex& parent, int start, int end);
+
+private:
+    struct Entry
+    {
+        QString sortKey;
+        int sourceRow;
+    };
+
+    struct Category
+    {
+        QPersistentModelIndex sourceIndex;
+        int categoryId;
+        QVector<Entry*> sorted;       ///< Entries in display order
+        QVector<Entry*> bySourceRow;  ///< Entries in source row order
+    };
+
+    void populate();
+    void clearCategories();
+
+    void addCategory(const QModelIndex& sourceIndex, bool emitSignals);
+    void removeCategory(int row);
+    Category* categoryForSource(const QModelIndex& sourceIndex) const;
+    QModelIndex categoryIndex(Category* category) const;
+
+    QString sortKey(const QModelIndex& sourceIndex) const;
+    int sortedRow(const Category* category, const Entry* entry) const;
+    int insertPosition(const Category* category, const QString& sortKey) const;
+    void updateSourceRows(Category* category, int start);
+
+    QPersistentModelIndex _channelIndex;
+    QList<Category*> _categories;  ///< Sorted by category ID, i.e. by prefix rank
+};
@@ -32,7 +32,6 @@
 #include "graphicalui.h"
 #include "networkmodel.h"
 #include "nickview.h"
-#include "nickviewfilter.h"
 #include "types.h"
 
 NickView::NickView(QWidget* parent)
@@ -78,6 +77,8 @@ void NickView::setModel(QAbstractItemModel* model_)
 
     TreeViewTouch::setModel(model_);
     init();
+    if (model())
+        unanimatedExpandAll();
 }
 
 void NickView::rowsInserted(const QModelIndex& parent, int start, int end)
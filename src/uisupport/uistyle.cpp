@@ -25,6 +25,7 @@
 
 #include <QApplication>
 #include <QColor>
+#include <QMutexLocker>
 
 #include "buffersettings.h"
 #include "icon.h"
@@ -126,10 +127,11 @@ void UiStyle::reload()
 
 void UiStyle::loadStyleSheet()
 {
-    qDeleteAll(_metricsCache);
-    _metricsCache.clear();
-    _formatCache.clear();
-    _formats.clear();
+    {
+        QMutexLocker locker(&_metricsLock);
+        qDeleteAll(_metricsCache);
+        _metricsCache.clear();
+    }
 
     UiStyleSettings s;
 
@@ -154,13 +156,14 @@ void UiStyle::loadStyleSheet()
     }
     styleSheet += loadStyleSheet("file:///" + Quassel::optionValue("qss"), true);
 
+    QHash<quint64, QTextCharFormat> formats;
     if (!styleSheet.isEmpty()) {
         QssParser parser;
         parser.processStyleSheet(styleSheet);
         QApplication::setPalette(parser.palette());
 
         _uiStylePalette = parser.uiStylePalette();
-        _formats = parser.formats();
+        formats = parser.formats();
         _listItemFormats = parser.listItemFormats();
 
         styleSheet = styleSheet.trimmed();
@@ -168,6 +171,15 @@ void UiStyle::loadStyleSheet()
             qApp->setStyleSheet(styleSheet);  // pass the remaining sections to the application
     }
 
+    {
+        // Swap in the new formats and drop everything derived from the old ones at once, so worker threads never see
+        // one without the other
+        QWriteLocker locker(&_formatLock);
+        _formats = std::move(formats);
+        _formatCache.clear();
+        ++_formatGeneration;
+    }
+
     emit changed();
 }
 
@@ -262,7 +274,13 @@ void UiStyle::enableSenderBrackets(bool enabled)
 
 void UiStyle::allowMircColorsChanged(const QVariant& v)
 {
-    _allowMircColors = v.toBool();
+    {
+        QWriteLocker locker(&_formatLock);
+        _allowMircColors = v.toBool();
+        // Cached formats have mIRC colors merged in or not
+        _formatCache.clear();
+        ++_formatGeneration;
+    }
     emit changed();
 }
 
@@ -406,11 +424,6 @@ QVariant UiStyle::itemData(int role, const QTextCharFormat& format) const
 
 /******** Caching *******/
 
-QTextCharFormat UiStyle::parsedFormat(quint64 key) const
-{
-    return _formats.value(key, QTextCharFormat());
-}
-
 namespace {
 
 // Create unique key for given Format object and message label
@@ -420,16 +433,41 @@ QString formatKey(const UiStyle::Format& format, UiStyle::MessageLabel label)
            + (format.background.isValid() ? format.background.name() : "#------");
 }
 
+// Shared by UiStyle and StyleSnapshot, which only differ in where their formats come from
+template<typename Style>
+UiStyle::FormatContainer textLayoutList(const Style& style,
+                                        const UiStyle::FormatList& formatList,
+                                        int textLength,
+                                        UiStyle::MessageLabel messageLabel)
+{
+    UiStyle::FormatContainer formatRanges;
+    QTextLayout::FormatRange range;
+    size_t i = 0;
+    for (i = 0; i < formatList.size(); i++) {
+        range.format = style.format(formatList.at(i).second, messageLabel);
+        range.start = formatList.at(i).first;
+        if (i > 0)
+            formatRanges.last().length = range.start - formatRanges.last().start;
+        formatRanges.append(range);
+    }
+    if (i > 0)
+        formatRanges.last().length = textLength - formatRanges.last().start;
+    return formatRanges;
+}
+
 }  // namespace
 
 QTextCharFormat UiStyle::cachedFormat(const Format& format, MessageLabel messageLabel) const
 {
+    QReadLocker locker(&_formatLock);
     return _formatCache.value(formatKey(format, messageLabel), QTextCharFormat());
 }
 
-void UiStyle::setCachedFormat(const QTextCharFormat& charFormat, const Format& format, MessageLabel messageLabel) const
+void UiStyle::setCachedFormat(const QTextCharFormat& charFormat, const Format& format, MessageLabel messageLabel, quint64 generation) const
 {
-    _formatCache[formatKey(format, messageLabel)] = charFormat;
+    QWriteLocker locker(&_formatLock);
+    if (generation == _formatGeneration)
+        _formatCache[formatKey(format, messageLabel)] = charFormat;
 }
 
 QFontMetricsF* UiStyle::fontMetrics(FormatType ftype, MessageLabel label) const
@@ -437,6 +475,7 @@ QFontMetricsF* UiStyle::fontMetrics(FormatType ftype, MessageLabel label) const
     // QFontMetricsF is not assignable, so we need to store pointers :/
     quint64 key = ftype | label;
 
+    QMutexLocker locker(&_metricsLock);
     if (_metricsCache.contains(key))
         return _metricsCache.value(key);
 
@@ -457,55 +496,85 @@ QTextCharFormat UiStyle::format(const Format& format, MessageLabel label) const
     if (charFormat.properties().count())
         return charFormat;
 
+    QHash<quint64, QTextCharFormat> formats;
+    quint64 generation;
+    bool allowMircColors;
+    {
+        QReadLocker locker(&_formatLock);
+        formats = _formats;
+        generation = _formatGeneration;
+        allowMircColors = _allowMircColors;
+    }
+
+    charFormat = buildFormat(formats, allowMircColors, format, label);
+    setCachedFormat(charFormat, format, label, generation);
+    return charFormat;
+}
+
+QTextCharFormat UiStyle::buildFormat(const QHash<quint64, QTextCharFormat>& formats,
+                                     bool allowMircColors,
+                                     const Format& format,
+                                     MessageLabel label)
+{
+    QTextCharFormat charFormat;
+
     // Merge all formats except mIRC and extended colors
-    mergeFormat(charFormat, format, label & 0xffff0000);  // keep nickhash in label
+    mergeFormat(formats, charFormat, format, label & 0xffff0000);  // keep nickhash in label
     for (quint32 mask = 0x00000001; mask <= static_cast<quint32>(MessageLabel::Last); mask <<= 1) {
         if (static_cast<quint32>(label) & mask) {
-            mergeFormat(charFormat, format, label & (mask | 0xffff0000));
+            mergeFormat(formats, charFormat, format, label & (mask | 0xffff0000));
         }
     }
 
     // Merge mIRC and extended colors, if appropriate. These override any color set previously in the format,
     // unless the AllowForegroundOverride or AllowBackgroundOverride properties are set (via stylesheet).
-    if (_allowMircColors) {
-        mergeColors(charFormat, format, MessageLabel::None);
+    if (allowMircColors) {
+        mergeColors(formats, charFormat, format, MessageLabel::None);
         for (quint32 mask = 0x00000001; mask <= static_cast<quint32>(MessageLabel::Last); mask <<= 1) {
             if (static_cast<quint32>(label) & mask) {
-                mergeColors(charFormat, format, label & mask);
+                mergeColors(formats, charFormat, format, label & mask);
             }
         }
     }
 
-    setCachedFormat(charFormat, format, label);
     return charFormat;
 }
 
-void UiStyle::mergeFormat(QTextCharFormat& charFormat, const Format& format, MessageLabel label) const
+void UiStyle::mergeFormat(const QHash<quint64, QTextCharFormat>& formats,
+                          QTextCharFormat& charFormat,
+                          const Format& format,
+                          MessageLabel label)
 {
-    mergeSubElementFormat(charFormat, format.type & 0x00ff, label);
+    mergeSubElementFormat(formats, charFormat, format.type & 0x00ff, label);
 
     // TODO: allow combinations for mirc formats and colors (each), e.g. setting a special format for "bold and italic"
     //       or "foreground 01 and background 03"
     if ((format.type & 0xfff00) != FormatType::Base) {  // element format
         for (quint32 mask = 0x00100; mask <= 0x80000; mask <<= 1) {
             if ((format.type & mask) != FormatType::Base) {
-                mergeSubElementFormat(charFormat, format.type & (mask | 0xff), label);
+                mergeSubElementFormat(formats, charFormat, format.type & (mask | 0xff), label);
             }
         }
     }
 }
 
 // Merge a subelement format into an existing message format
-void UiStyle::mergeSubElementFormat(QTextCharFormat& fmt, FormatType ftype, MessageLabel label) const
+void UiStyle::mergeSubElementFormat(const QHash<quint64, QTextCharFormat>& formats,
+                                    QTextCharFormat& fmt,
+                                    FormatType ftype,
+                                    MessageLabel label)
 {
     quint64 key = ftype | label;
-    fmt.merge(parsedFormat(key & 0x0000ffffffffff00ull));  // label + subelement
-    fmt.merge(parsedFormat(key & 0x0000ffffffffffffull));  // label + subelement + msgtype
-    fmt.merge(parsedFormat(key & 0xffffffffffffff00ull));  // label + subelement + nickhash
-    fmt.merge(parsedFormat(key & 0xffffffffffffffffull));  // label + subelement + nickhash + msgtype
+    fmt.merge(formats.value(key & 0x0000ffffffffff00ull));  // label + subelement
+    fmt.merge(formats.value(key & 0x0000ffffffffffffull));  // label + subelement + msgtype
+    fmt.merge(formats.value(key & 0xffffffffffffff00ull));  // label + subelement + nickhash
+    fmt.merge(formats.value(key & 0xffffffffffffffffull));  // label + subelement + nickhash + msgtype
 }
 
-void UiStyle::mergeColors(QTextCharFormat& charFormat, const Format& format, MessageLabel label) const
+void UiStyle::mergeColors(const QHash<quint64, QTextCharFormat>& formats,
+                          QTextCharFormat& charFormat,
+                          const Format& format,
+                          MessageLabel label)
 {
     bool allowFg = charFormat.property(static_cast<int>(FormatProperty::AllowForegroundOverride)).toBool();
     bool allowBg = charFormat.property(static_cast<int>(FormatProperty::AllowBackgroundOverride)).toBool();
@@ -513,11 +582,11 @@ void UiStyle::mergeColors(QTextCharFormat& charFormat, const Format& format, Mes
     // Classic mIRC colors (styleable)
     // We assume that those can't be combined with subelement and message types.
     if (allowFg && (format.type & 0x00400000) != FormatType::Base)
-        charFormat.merge(parsedFormat((format.type & 0x0f400000) | label));  // foreground
+        charFormat.merge(formats.value((format.type & 0x0f400000) | label));  // foreground
     if (allowBg && (format.type & 0x00800000) != FormatType::Base)
-        charFormat.merge(parsedFormat((format.type & 0xf0800000) | label));  // background
+        charFormat.merge(formats.value((format.type & 0xf0800000) | label));  // background
     if (allowFg && allowBg && (format.type & 0x00c00000) == static_cast<FormatType>(0x00c00000))
-        charFormat.merge(parsedFormat((format.type & 0xffc00000) | label));  // combination
+        charFormat.merge(formats.value((format.type & 0xffc00000) | label));  // combination
 
     // Extended mIRC colors (hardcoded)
     if (allowFg && format.foreground.isValid())
@@ -585,26 +654,22 @@ QString UiStyle::formatCode(FormatType ftype)
 
 UiStyle::FormatContainer UiStyle::toTextLayoutList(const FormatList& formatList, int textLength, MessageLabel messageLabel) const
 {
-    UiStyle::FormatContainer formatRanges;
-    QTextLayout::FormatRange range;
-    size_t i = 0;
-    for (i = 0; i < formatList.size(); i++) {
-        range.format = format(formatList.at(i).second, messageLabel);
-        range.start = formatList.at(i).first;
-        if (i > 0)
-            formatRanges.last().length = range.start - formatRanges.last().start;
-        formatRanges.append(range);
-    }
-    if (i > 0)
-        formatRanges.last().length = textLength - formatRanges.last().start;
-    return formatRanges;
+    return textLayoutList(*this, formatList, textLength, messageLabel);
+}
+
+UiStyle::StyleSnapshot UiStyle::snapshot() const
+{
+    StyleSnapshot snapshot;
+    QReadLocker locker(&_formatLock);
+    snapshot._formats = _formats;
+    snapshot._allowMircColors = _allowMircColors;
+    return snapshot;
 }
 
 // This method expects a well-formatted string, there is no error checking!
 // Since we create those ourselves, we should be pretty safe that nobody does something crappy here.
-UiStyle::StyledString UiStyle::styleString(const QString& s_, FormatType baseFormat)
+UiStyle::StyledString UiStyle::styleString(const QString& s, FormatType baseFormat)
 {
-    QString s = s_;
     StyledString result;
     result.formatList.emplace_back(std::make_pair(quint16{0}, Format{baseFormat, {}, {}}));
 
@@ -615,32 +680,42 @@ UiStyle::StyledString UiStyle::styleString(const QString& s_, FormatType baseFor
         return result;
     }
 
+    // Rather than removing format codes from a copy of the string, we scan it once and append the text between codes
+    // to the result. Strings without any codes are shared with the input.
+    const int len = s.length();
+    auto charAt = [&s, len](int i) { return i < len ? s.at(i) : QChar{}; };
+    QString& plain = result.plainText;
+
     Format curfmt{baseFormat, {}, {}};
     QChar fgChar{'f'};  // character to indicate foreground color, changed when reversing
 
     int pos = 0;
-    quint16 length = 0;
+    int copied = 0;  // index of the first character not yet copied to the result
+    int length = 0;
     for (;;) {
         pos = s.indexOf('%', pos);
         if (pos < 0)
             break;
-        if (s[pos + 1] == '%') {  // escaped %, we just remove one and continue
-            s.remove(pos, 1);
-            pos++;
+        if (plain.isNull())
+            plain.reserve(len);
+        if (charAt(pos + 1) == '%') {  // escaped %, we keep only one and continue
+            plain.append(s.constData() + copied, pos + 1 - copied);
+            pos += 2;
+            copied = pos;
             continue;
         }
-        if (s[pos + 1] == 'D' && s[pos + 2] == 'c') {  // mIRC color code
-            if (s[pos + 3] == '-') {                   // color off
+        if (charAt(pos + 1) == 'D' && charAt(pos + 2) == 'c') {  // mIRC color code
+            if (charAt(pos + 3) == '-') {                         // color off
                 curfmt.type &= 0x003fffff;
                 curfmt.foreground = QColor{};
                 curfmt.background = QColor{};
                 length = 4;
             }
             else {
-                quint32 color = 10 * s[pos + 4].digitValue() + s[pos + 5].digitValue();
+                quint32 color = 10 * charAt(pos + 4).digitValue() + charAt(pos + 5).digitValue();
                 // Color values 0-15 are traditional mIRC colors, defined in the stylesheet and thus going through the format engine
                 // Larger color values are hardcoded and applied separately (cf. https://modern.ircdocs.horse/formatting.html#colors-16-98)
-                if (s[pos + 3] == fgChar) {
+                if (charAt(pos + 3) == fgChar) {
                     if (color < 16) {
                         // Traditional mIRC color, defined in the stylesheet
                         curfmt.type &= 0xf0ffffff;
@@ -666,9 +741,9 @@ UiStyle::StyledString UiStyle::styleString(const QString& s_, FormatType baseFor
                 length = 6;
             }
         }
-        else if (s[pos + 1] == 'D' && s[pos + 2] == 'h') {  // Hex color
+        else if (charAt(pos + 1) == 'D' && charAt(pos + 2) == 'h') {  // Hex color
             QColor color{s.mid(pos + 4, 7)};
-            if (s[pos + 3] == fgChar) {
+            if (charAt(pos + 3) == fgChar) {
                 curfmt.type &= 0xf0bfffff;  // mask out mIRC foreground color
                 curfmt.foreground = std::move(color);
             }
@@ -678,14 +753,14 @@ UiStyle::StyledString UiStyle::styleString(const QString& s_, FormatType baseFor
             }
             length = 11;
         }
-        else if (s[pos + 1] == 'O') {   // reset formatting
-            curfmt.type &= 0x000000ff;  // we keep message type-specific formatting
+        else if (charAt(pos + 1) == 'O') {  // reset formatting
+            curfmt.type &= 0x000000ff;      // we keep message type-specific formatting
             curfmt.foreground = QColor{};
             curfmt.background = QColor{};
             fgChar = 'f';
             length = 2;
         }
-        else if (s[pos + 1] == 'R') {  // Reverse colors
+        else if (charAt(pos + 1) == 'R') {  // Reverse colors
             fgChar = (fgChar == 'f' ? 'b' : 'f');
             auto orig = static_cast<quint32>(curfmt.type & 0xffc00000);
             curfmt.type &= 0x003fffff;
@@ -697,9 +772,9 @@ UiStyle::StyledString UiStyle::styleString(const QString& s_, FormatType baseFor
             length = 2;
         }
         else {  // all others are toggles
-            QString code = QString("%") + s[pos + 1];
-            if (s[pos + 1] == 'D')
-                code += s[pos + 2];
+            QString code = QString("%") + charAt(pos + 1);
+            if (charAt(pos + 1) == 'D')
+                code += charAt(pos + 2);
             FormatType ftype = formatType(code);
             if (ftype == FormatType::Invalid) {
                 pos++;
@@ -709,133 +784,142 @@ UiStyle::StyledString UiStyle::styleString(const QString& s_, FormatType baseFor
             curfmt.type ^= ftype;
             length = code.length();
         }
-        s.remove(pos, length);
-        if (pos == result.formatList.back().first)
+        plain.append(s.constData() + copied, pos - copied);
+        pos += length;
+        copied = pos;
+        auto formatPos = static_cast<quint16>(plain.length());
+        if (formatPos == result.formatList.back().first)
             result.formatList.back().second = curfmt;
         else
-            result.formatList.emplace_back(std::make_pair(pos, curfmt));
+            result.formatList.emplace_back(std::make_pair(formatPos, curfmt));
     }
-    result.plainText = s;
+    if (copied == 0)
+        plain = s;
+    else if (copied < len)
+        plain.append(s.constData() + copied, len - copied);
     return result;
 }
 
-QString UiStyle::mircToInternal(const QString& mirc_)
+QString UiStyle::mircToInternal(const QString& mirc)
 {
-    QString mirc;
-    mirc.reserve(mirc_.size());
-    foreach (const QChar& c, mirc_) {
-        if ((c < '\x20' || c == '\x7f') && c != '\x03' && c != '\x04') {
+    // Everything is converted in a single pass over the input, appending to the result rather than replacing codes in place
+    const int length = mirc.length();
+    const QChar* data = mirc.constData();
+    QString result;
+    result.reserve(length + length / 8);
+
+    auto isHexDigit = [](QChar c) {
+        return c.isDigit() || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    };
+    // Checks for a hex color (rrggbb) at the given position
+    auto hasHexColor = [&](int i) {
+        if (i + 6 > length)
+            return false;
+        for (int end = i + 6; i < end; i++) {
+            if (!isHexDigit(data[i]))
+                return false;
+        }
+        return true;
+    };
+    // Appends the (one or two digit) mIRC color number at position i as two digits and advances i past it
+    auto appendColorNumber = [&](int& i) {
+        QChar first = data[i++];
+        if (i < length && data[i].isDigit()) {
+            result += first;
+            result += data[i++];
+        }
+        else {
+            result += QChar('0');
+            result += first;
+        }
+    };
+
+    int i = 0;
+    while (i < length) {
+        QChar c = data[i++];
+
+        // We bring the color codes (\x03) in a sane format that can be parsed more easily later.
+        // %Dcfxx is foreground, %Dcbxx is background color, where xx is a 2 digit dec number denoting the color code.
+        // %Dc- turns color off.
+        // Note: We use the "mirc standard" as described in <http://www.mirc.co.uk/help/color.txt>.
+        //       This means that we don't accept something like \x03,5 (even though others, like WeeChat, do).
+        if (c == '\x03') {
+            if (i < length && data[i].isDigit()) {
+                result += QLatin1String("%Dcf");
+                appendColorNumber(i);
+                if (i + 1 < length && data[i] == ',' && data[i + 1].isDigit()) {
+                    i++;
+                    result += QLatin1String("%Dcb");
+                    appendColorNumber(i);
+                }
+            }
+            else {
+                result += QLatin1String("%Dc-");
+            }
+            continue;
+        }
+
+        // Hex colors, as specified in https://modern.ircdocs.horse/formatting.html#hex-color
+        // %Dhf#rrggbb is foreground, %Dhb#rrggbb is background
+        if (c == '\x04') {
+            if (hasHexColor(i)) {
+                result += QLatin1String("%Dhf#");
+                for (int end = i + 6; i < end; i++)
+                    result += data[i].toLower();
+                if (i < length && data[i] == ',' && hasHexColor(i + 1)) {
+                    result += QLatin1String("%Dhb#");
+                    for (int end = ++i + 6; i < end; i++)
+                        result += data[i].toLower();
+                }
+            }
+            else {
+                result += QLatin1String("%Dc-");
+            }
+            continue;
+        }
+
+        if (c < '\x20' || c == '\x7f') {
             switch (c.unicode()) {
             case '\x02':
-                mirc += "%B";
+                result += QLatin1String("%B");
                 break;
             case '\x0f':
-                mirc += "%O";
+                result += QLatin1String("%O");
                 break;
             case '\x09':
-                mirc += "        ";
+                result += QLatin1String("        ");
                 break;
             case '\x11':
                 // Monospace not supported yet
                 break;
             case '\x12':
             case '\x16':
-                mirc += "%R";
+                result += QLatin1String("%R");
                 break;
             case '\x1d':
-                mirc += "%I";
+                result += QLatin1String("%I");
                 break;
             case '\x1e':
-                mirc += "%S";
+                result += QLatin1String("%S");
                 break;
             case '\x1f':
-                mirc += "%U";
+                result += QLatin1String("%U");
                 break;
             case '\x7f':
-                mirc += QChar(0x2421);
+                result += QChar(0x2421);
                 break;
             default:
-                mirc += QChar(0x2400 + c.unicode());
+                result += QChar(0x2400 + c.unicode());
             }
         }
         else {
             if (c == '%')
-                mirc += c;
-            mirc += c;
-        }
-    }
-
-    // Now we bring the color codes (\x03) in a sane format that can be parsed more easily later.
-    // %Dcfxx is foreground, %Dcbxx is background color, where xx is a 2 digit dec number denoting the color code.
-    // %Dc- turns color off.
-    // Note: We use the "mirc standard" as described in <http://www.mirc.co.uk/help/color.txt>.
-    //       This means that we don't accept something like \x03,5 (even though others, like WeeChat, do).
-    {
-        int pos = 0;
-        while (true) {
-            pos = mirc.indexOf('\x03', pos);
-            if (pos < 0)
-                break;  // no more mirc color codes
-            QString ins, num;
-            int l = mirc.length();
-            int i = pos + 1;
-            // check for fg color
-            if (i < l && mirc[i].isDigit()) {
-                num = mirc[i++];
-                if (i < l && mirc[i].isDigit())
-                    num.append(mirc[i++]);
-                else
-                    num.prepend('0');
-                ins = QString("%Dcf%1").arg(num);
-
-                if (i + 1 < l && mirc[i] == ',' && mirc[i + 1].isDigit()) {
-                    i++;
-                    num = mirc[i++];
-                    if (i < l && mirc[i].isDigit())
-                        num.append(mirc[i++]);
-                    else
-                        num.prepend('0');
-                    ins += QString("%Dcb%1").arg(num);
-                }
-            }
-            else {
-                ins = "%Dc-";
-            }
-            mirc.replace(pos, i - pos, ins);
-        }
-    }
-
-    // Hex colors, as specified in https://modern.ircdocs.horse/formatting.html#hex-color
-    // %Dhf#rrggbb is foreground, %Dhb#rrggbb is background
-    {
-        static const QRegExp rx{"[\\da-fA-F]{6}"};
-        int pos = 0;
-        while (true) {
-            if (pos >= mirc.length())
-                break;
-            pos = mirc.indexOf('\x04', pos);
-            if (pos < 0)
-                break;
-            int i = pos + 1;
-            QString ins;
-            auto num = mirc.mid(i, 6);
-            if (!num.isEmpty() && rx.exactMatch(num)) {
-                ins = "%Dhf#" + num.toLower();
-                i += 6;
-                if (i < mirc.length() && mirc[i] == ',' && !(num = mirc.mid(i + 1, 6)).isEmpty() && rx.exactMatch(num)) {
-                    ins += "%Dhb#" + num.toLower();
-                    i += 7;
-                }
-            }
-            else {
-                ins = "%Dc-";
-            }
-            mirc.replace(pos, i - pos, ins);
-            pos += ins.length();
+                result += c;
+            result += c;
         }
     }
 
-    return mirc;
+    return result;
 }
 
 QString UiStyle::systemTimestampFormatString()
@@ -1130,6 +1214,27 @@ quint8 UiStyle::StyledMessage::senderHash() const
     return (_senderHash = (hash & 0xf) + 1);
 }
 
+/***********************************************************************************/
+QTextCharFormat UiStyle::StyleSnapshot::format(const Format& format, MessageLabel messageLabel) const
+{
+    if (format.type == FormatType::Invalid)
+        return {};
+
+    QString key = formatKey(format, messageLabel);
+    auto it = _formatCache.constFind(key);
+    if (it != _formatCache.constEnd())
+        return it.value();
+
+    return (_formatCache[key] = UiStyle::buildFormat(_formats, _allowMircColors, format, messageLabel));
+}
+
+UiStyle::FormatContainer UiStyle::StyleSnapshot::toTextLayoutList(const FormatList& formatList,
+                                                                   int textLength,
+                                                                   MessageLabel messageLabel) const
+{
+    return textLayoutList(*this, formatList, textLength, messageLabel);
+}
+
 /***********************************************************************************/
 
 uint qHash(UiStyle::ItemFormatType key, uint seed)
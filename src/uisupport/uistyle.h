@@ -30,7 +30,9 @@
 #include <QFontMetricsF>
 #include <QHash>
 #include <QIcon>
+#include <QMutex>
 #include <QPalette>
+#include <QReadWriteLock>
 #include <QTextCharFormat>
 #include <QTextLayout>
 #include <QVector>
@@ -220,6 +222,7 @@ public:
     };
 
     class StyledMessage;
+    class StyleSnapshot;
 
     /**
      * List of default sender colors
@@ -299,6 +302,13 @@ public:
 
     FormatContainer toTextLayoutList(const FormatList&, int textLength, MessageLabel messageLabel) const;
 
+    /**
+     * Copies everything format() depends on, so formats can be built in another thread.
+     *
+     * @return A snapshot of the current formats
+     */
+    StyleSnapshot snapshot() const;
+
     inline const QBrush& brush(ColorRole role) const { return _uiStylePalette.at((int)role); }
     inline void setBrush(ColorRole role, const QBrush& brush) { _uiStylePalette[(int)role] = brush; }
 
@@ -315,12 +325,30 @@ protected:
     void loadStyleSheet();
     QString loadStyleSheet(const QString& name, bool shouldExist = false);
 
-    QTextCharFormat parsedFormat(quint64 key) const;
     QTextCharFormat cachedFormat(const Format& format, MessageLabel messageLabel) const;
-    void setCachedFormat(const QTextCharFormat& charFormat, const Format& format, MessageLabel messageLabel) const;
-    void mergeFormat(QTextCharFormat& charFormat, const Format& format, MessageLabel messageLabel) const;
-    void mergeSubElementFormat(QTextCharFormat& charFormat, FormatType formatType, MessageLabel messageLabel) const;
-    void mergeColors(QTextCharFormat& charFormat, const Format& format, MessageLabel messageLabel) const;
+    /**
+     * Caches a format, unless the formats it was built from have been replaced in the meantime
+     *
+     * @param generation The value of _formatGeneration the format was built with
+     */
+    void setCachedFormat(const QTextCharFormat& charFormat, const Format& format, MessageLabel messageLabel, quint64 generation) const;
+    /// Builds a format from the given parsed formats, without consulting or filling the cache
+    static QTextCharFormat buildFormat(const QHash<quint64, QTextCharFormat>& formats,
+                                       bool allowMircColors,
+                                       const Format& format,
+                                       MessageLabel messageLabel);
+    static void mergeFormat(const QHash<quint64, QTextCharFormat>& formats,
+                            QTextCharFormat& charFormat,
+                            const Format& format,
+                            MessageLabel messageLabel);
+    static void mergeSubElementFormat(const QHash<quint64, QTextCharFormat>& formats,
+                                      QTextCharFormat& charFormat,
+                                      FormatType formatType,
+                                      MessageLabel messageLabel);
+    static void mergeColors(const QHash<quint64, QTextCharFormat>& formats,
+                            QTextCharFormat& charFormat,
+                            const Format& format,
+                            MessageLabel messageLabel);
 
     static FormatType formatType(const QString& code);
     static QString formatCode(FormatType);
@@ -373,7 +401,11 @@ private:
     QBrush _markerLineBrush;
     QHash<quint64, QTextCharFormat> _formats;
     mutable QHash<QString, QTextCharFormat> _formatCache;
+    /// Guards _formats, _formatCache, _formatGeneration and _allowMircColors, as format() may be called from worker threads
+    mutable QReadWriteLock _formatLock;
+    quint64 _formatGeneration{0};  ///< Bumped whenever cached formats become outdated
     mutable QHash<quint64, QFontMetricsF*> _metricsCache;
+    mutable QMutex _metricsLock;  ///< Guards _metricsCache
     QHash<UiStyle::ItemFormatType, QTextCharFormat> _listItemFormats;
     static QHash<QString, FormatType> _formatCodes;
     static bool _useCustomTimestampFormat;                  ///< If true, use the custom timestamp format
@@ -420,6 +452,27 @@ private:
     mutable quint8 _senderHash;
 };
 
+/**
+ * A copy of the parsed formats and settings UiStyle builds text formats from.
+ *
+ * Taken in the GUI thread through UiStyle::snapshot() and handed to worker threads, which can then build formats while
+ * UiStyle reloads its style sheet. A snapshot caches the formats it builds, so it must not be used by several threads
+ * at once; copying it is cheap.
+ */
+class UISUPPORT_EXPORT UiStyle::StyleSnapshot
+{
+public:
+    QTextCharFormat format(const Format& format, MessageLabel messageLabel) const;
+    FormatContainer toTextLayoutList(const FormatList& formatList, int textLength, MessageLabel messageLabel) const;
+
+private:
+    friend class UiStyle;
+
+    QHash<quint64, QTextCharFormat> _formats;
+    bool _allowMircColors{false};
+    mutable QHash<QString, QTextCharFormat> _formatCache;
+};
+
 uint qHash(UiStyle::ItemFormatType key, uint seed);
 
 // ---- Operators for dealing with enums ----------------------------------------------------------
@@ -0,0 +1,431 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+/*
+ * Throughput and latency benchmark for SignalProxy over real sockets.
+ *
+ * A core-side and a client-side SignalProxy are connected through a local TCP (or TLS) connection using the DataStream
+ * protocol. The core side, which lives in its own thread like a CoreSession does, pushes synthetic Network, IrcChannel and
+ * BufferSyncer updates interleaved with timestamped RPC calls; the client side measures how long it takes until everything
+ * has been applied, and the latency of the RPC calls.
+ *
+ * Usage: SignalProxyBenchmark [--operations N] [--burst N] [--tls-cert FILE --tls-key FILE]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFile>
+#include <QSslCertificate>
+#include <QSslKey>
+#include <QSslSocket>
+#include <QTcpServer>
+#include <QThread>
+#include <QTimer>
+
+#include "buffersyncer.h"
+#include "ircchannel.h"
+#include "network.h"
+#include "protocols/datastream/datastreampeer.h"
+#include "signalproxy.h"
+#include "types.h"
+#include "util.h"
+
+namespace {
+
+qint64 nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct BenchConfig
+{
+    int operations{100000};
+    int burst{200};  ///< Operations generated per event loop iteration
+    bool compression{false};
+    QSslCertificate certificate;
+    QSslKey key;
+
+    bool useTls() const { return !certificate.isNull() && !key.isNull(); }
+};
+
+struct BenchResult
+{
+    qint64 durationNs{0};
+    quint64 frames{0};
+    quint64 writes{0};
+    qint64 rawBytes{0};
+    qint64 wireBytes{0};
+    std::vector<qint64> rpcLatenciesNs;
+};
+
+/// Wraps the given socket into a DataStreamPeer and attaches it to the proxy
+RemotePeer* createPeer(QTcpSocket* socket, SignalProxy* proxy, bool compression)
+{
+    auto* peer = new DataStreamPeer(nullptr,
+                                    socket,
+                                    DataStreamPeer::supportedFeatures(),
+                                    compression ? Compressor::BestSpeed : Compressor::NoCompression,
+                                    proxy);
+    peer->setFeatures(Quassel::Features{});
+    proxy->addPeer(peer);
+    return peer;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+class TlsServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    TlsServer(const BenchConfig& config, QObject* parent = nullptr)
+        : QTcpServer(parent)
+        , _config(config)
+    {}
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override
+    {
+        if (!_config.useTls()) {
+            QTcpServer::incomingConnection(socketDescriptor);
+            return;
+        }
+        auto* socket = new QSslSocket(this);
+        if (!socket->setSocketDescriptor(socketDescriptor)) {
+            delete socket;
+            return;
+        }
+        socket->setLocalCertificate(_config.certificate);
+        socket->setPrivateKey(_config.key);
+        socket->startServerEncryption();
+        addPendingConnection(socket);
+    }
+
+private:
+    const BenchConfig& _config;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+/// Object used for sending and receiving timestamped RPC calls
+class RpcEndpoint : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void ping(qint64 sentNs);
+    void done();
+};
+
+/**
+ * The core side of the benchmark, living in its own thread.
+ */
+class BenchCore : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchCore(const BenchConfig& config)
+        : _config(config)
+    {}
+
+    quint16 serverPort() const { return _serverPort; }
+
+    void fetchStats(BenchResult& result) const
+    {
+        result.frames = _frames;
+        result.writes = _writes;
+        result.rawBytes = _rawBytes;
+        result.wireBytes = _wireBytes;
+    }
+
+public slots:
+    void listen()
+    {
+        _rpc = new RpcEndpoint;
+        _rpc->setParent(this);
+        _server = new TlsServer(_config, this);
+        connect(_server, &QTcpServer::newConnection, this, &BenchCore::onNewConnection);
+        _server->listen(QHostAddress::LocalHost);
+        _serverPort = _server->serverPort();
+    }
+
+    void start()
+    {
+        _channel = _network->newIrcChannel("#benchmark");
+        QTimer::singleShot(0, this, &BenchCore::generate);
+    }
+
+    void shutdown()
+    {
+        delete _proxy;
+        _proxy = nullptr;
+        delete _server;
+        _server = nullptr;
+    }
+
+signals:
+    void clientConnected();
+
+private slots:
+    void onNewConnection()
+    {
+        auto* socket = _server->nextPendingConnection();
+        auto* sslSocket = qobject_cast<QSslSocket*>(socket);
+        if (sslSocket && !sslSocket->isEncrypted()) {
+            connect(sslSocket, &QSslSocket::encrypted, this, [this, sslSocket]() { setupSession(sslSocket); });
+            return;
+        }
+        setupSession(socket);
+    }
+
+    void generate()
+    {
+        int end = std::min(_nextOperation + _config.burst, _config.operations);
+        for (; _nextOperation < end; ++_nextOperation) {
+            int i = _nextOperation;
+            switch (i % 4) {
+            case 0:
+                // Join floods are the most expensive kind of sync traffic, as they create IrcUsers as well
+                _channel->joinIrcUsers(QStringList{QString("nick%1").arg(i)}, QStringList{i % 8 ? QString() : QString("v")});
+                break;
+            case 1:
+                _bufferSyncer->setLastMsg(BufferId(i % 200 + 1), MsgId(i));
+                break;
+            case 2:
+                _network->setLatency(i % 500);
+                break;
+            default:
+                emit _rpc->ping(nowNs());
+            }
+        }
+
+        if (_nextOperation < _config.operations)
+            QTimer::singleShot(0, this, &BenchCore::generate);
+        else
+            emit _rpc->done();
+    }
+
+private:
+    void setupSession(QTcpSocket* socket)
+    {
+        _proxy = new SignalProxy(SignalProxy::Server, this);
+        _proxy->attachSignal(_rpc, &RpcEndpoint::ping);
+        _proxy->attachSignal(_rpc, &RpcEndpoint::done);
+
+        _network = new Network(NetworkId(1), _proxy);
+        _network->setProxy(_proxy);
+        _network->setNetworkName("Benchmark");
+        _proxy->synchronize(_network);
+
+        _bufferSyncer = new BufferSyncer(_proxy);
+        _proxy->synchronize(_bufferSyncer);
+
+        auto* peer = createPeer(socket, _proxy, _config.compression);
+        connect(peer, &RemotePeer::messagesWritten, this, [this](int frames, qint64 bytes) {
+            _frames += frames;
+            _rawBytes += bytes;
+            ++_writes;
+        });
+        connect(socket, &QIODevice::bytesWritten, this, [this](qint64 bytes) { _wireBytes += bytes; });
+
+        emit clientConnected();
+    }
+
+private:
+    const BenchConfig& _config;
+    TlsServer* _server{nullptr};
+    quint16 _serverPort{0};
+
+    SignalProxy* _proxy{nullptr};
+    Network* _network{nullptr};
+    IrcChannel* _channel{nullptr};
+    BufferSyncer* _bufferSyncer{nullptr};
+    RpcEndpoint* _rpc{nullptr};
+
+    int _nextOperation{0};
+
+    quint64 _frames{0};
+    quint64 _writes{0};
+    qint64 _rawBytes{0};
+    qint64 _wireBytes{0};
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+BenchResult runBenchmark(const BenchConfig& config)
+{
+    BenchResult result;
+
+    QThread coreThread;
+    auto* core = new BenchCore(config);
+    core->moveToThread(&coreThread);
+    QObject::connect(&coreThread, &QThread::finished, core, &QObject::deleteLater);
+    coreThread.start();
+    QMetaObject::invokeMethod(core, "listen", Qt::BlockingQueuedConnection);
+
+    // Everything we wait for quits this loop; the respective condition is checked afterwards
+    QEventLoop loop;
+    auto waitFor = [&loop](const std::function<bool()>& condition) {
+        while (!condition())
+            loop.exec();
+    };
+
+    bool coreReady = false;
+    QObject::connect(core, &BenchCore::clientConnected, &loop, [&]() {
+        coreReady = true;
+        loop.quit();
+    });
+
+    // Client side, living in the main thread
+    QTcpSocket* socket;
+    if (config.useTls()) {
+        auto* sslSocket = new QSslSocket;
+        QObject::connect(sslSocket, &QSslSocket::encrypted, &loop, &QEventLoop::quit);
+        QObject::connect(sslSocket, selectOverload<const QList<QSslError>&>(&QSslSocket::sslErrors), sslSocket, [sslSocket]() {
+            sslSocket->ignoreSslErrors();  // the certificate is most likely self-signed
+        });
+        sslSocket->connectToHostEncrypted("localhost", core->serverPort());
+        waitFor([sslSocket]() { return sslSocket->isEncrypted(); });
+        socket = sslSocket;
+    }
+    else {
+        socket = new QTcpSocket;
+        QObject::connect(socket, &QAbstractSocket::connected, &loop, &QEventLoop::quit);
+        socket->connectToHost(QHostAddress::LocalHost, core->serverPort());
+        waitFor([socket]() { return socket->state() == QAbstractSocket::ConnectedState; });
+    }
+
+    SignalProxy clientProxy{SignalProxy::Client, nullptr};
+    createPeer(socket, &clientProxy, config.compression);
+    waitFor([&coreReady]() { return coreReady; });
+
+    // Wait for the initial sync to complete before starting to measure
+    Network clientNetwork{NetworkId(1)};
+    clientNetwork.setProxy(&clientProxy);
+    BufferSyncer clientBufferSyncer{nullptr};
+    QObject::connect(&clientNetwork, &SyncableObject::initDone, &loop, &QEventLoop::quit);
+    QObject::connect(&clientBufferSyncer, &SyncableObject::initDone, &loop, &QEventLoop::quit);
+    clientProxy.synchronize(&clientNetwork);
+    clientProxy.synchronize(&clientBufferSyncer);
+    waitFor([&]() { return clientNetwork.isInitialized() && clientBufferSyncer.isInitialized(); });
+
+    bool done = false;
+    clientProxy.attachSlot(SIGNAL(ping(qint64)), &loop, [&result](qint64 sentNs) { result.rpcLatenciesNs.push_back(nowNs() - sentNs); });
+    clientProxy.attachSlot(SIGNAL(done()), &loop, [&result, &done, &loop, startNs = nowNs()]() {
+        result.durationNs = nowNs() - startNs;
+        done = true;
+        loop.quit();
+    });
+    QMetaObject::invokeMethod(core, "start", Qt::QueuedConnection);
+    waitFor([&done]() { return done; });
+
+    // Shutting down synchronously also makes the core's statistics safe to access from here
+    QMetaObject::invokeMethod(core, "shutdown", Qt::BlockingQueuedConnection);
+    core->fetchStats(result);
+    coreThread.quit();
+    coreThread.wait();
+
+    return result;
+}
+
+void printResult(const BenchConfig& config, BenchResult& result)
+{
+    std::sort(result.rpcLatenciesNs.begin(), result.rpcLatenciesNs.end());
+    auto percentile = [&result](double p) -> double {
+        if (result.rpcLatenciesNs.empty())
+            return 0;
+        auto index = static_cast<size_t>(p * (result.rpcLatenciesNs.size() - 1));
+        return result.rpcLatenciesNs[index] / 1e6;
+    };
+
+    double seconds = result.durationNs / 1e9;
+    printf("%-4s %-14s %9d ops %10.0f ops/s %10.0f msgs/s %7.2f msgs/write %8.1f B/msg %8.1f wire B/msg  p50 %7.3f ms  p99 %7.3f ms\n",
+           config.useTls() ? "TLS" : "TCP",
+           config.compression ? "compressed" : "uncompressed",
+           config.operations,
+           config.operations / seconds,
+           result.frames / seconds,
+           result.writes ? double(result.frames) / result.writes : 0.0,
+           result.frames ? double(result.rawBytes) / result.frames : 0.0,
+           result.frames ? double(result.wireBytes) / result.frames : 0.0,
+           percentile(0.5),
+           percentile(0.99));
+    fflush(stdout);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    qRegisterMetaType<BufferId>("BufferId");
+    qRegisterMetaType<MsgId>("MsgId");
+    qRegisterMetaType<NetworkId>("NetworkId");
+    qRegisterMetaTypeStreamOperators<BufferId>("BufferId");
+    qRegisterMetaTypeStreamOperators<MsgId>("MsgId");
+    qRegisterMetaTypeStreamOperators<NetworkId>("NetworkId");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Throughput and latency benchmark for SignalProxy over real sockets");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption{"operations", "Number of synthetic operations per run", "count", "100000"});
+    parser.addOption(QCommandLineOption{"burst", "Number of operations generated per event loop iteration", "count", "200"});
+    parser.addOption(QCommandLineOption{"tls-cert", "PEM certificate for running the benchmark over TLS", "file"});
+    parser.addOption(QCommandLineOption{"tls-key", "PEM private key for running the benchmark over TLS", "file"});
+    parser.process(app);
+
+    BenchConfig config;
+    config.operations = parser.value("operations").toInt();
+    config.burst = std::max(1, parser.value("burst").toInt());
+
+    if (parser.isSet("tls-cert") || parser.isSet("tls-key")) {
+        QFile certFile{parser.value("tls-cert")};
+        QFile keyFile{parser.value("tls-key")};
+        if (!certFile.open(QIODevice::ReadOnly) || !keyFile.open(QIODevice::ReadOnly)) {
+            qCritical() << "Could not open TLS certificate or key";
+            return 1;
+        }
+        config.certificate = QSslCertificate{&certFile};
+        config.key = QSslKey{&keyFile, QSsl::Rsa};
+        if (!config.useTls()) {
+            qCritical() << "Invalid TLS certificate or key";
+            return 1;
+        }
+    }
+
+    for (bool compression : {false, true}) {
+        config.compression = compression;
+        BenchResult result = runBenchmark(config);
+        printResult(config, result);
+    }
+
+    return 0;
+}
+
+#include "signalproxybenchmark.moc"
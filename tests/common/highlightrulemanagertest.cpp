@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include <QString>
+#include <QStringList>
+
+#include "highlightrulemanager.h"
+#include "message.h"
+#include "testglobal.h"
+
+namespace {
+
+Message testMessage(const QString& contents, const QString& sender = "sender!user@host", const QString& bufferName = "#quassel")
+{
+    return Message{BufferInfo{BufferId{1}, NetworkId{1}, BufferInfo::ChannelBuffer, 0, bufferName}, Message::Plain, contents, sender};
+}
+
+bool matches(HighlightRuleManager& manager, const Message& msg)
+{
+    return manager.match(msg, "nick", {"nick"});
+}
+
+}  // namespace
+
+TEST(HighlightRuleManagerTest, phraseRules)
+{
+    HighlightRuleManager manager;
+    manager.setHighlightNick(HighlightRuleManager::NoNick);
+    manager.addHighlightRule(1, "foo", false, false, true, false, "", "");
+    manager.addHighlightRule(2, "Bar", false, true, true, false, "", "");
+
+    EXPECT_TRUE(matches(manager, testMessage("a FOO b")));
+    EXPECT_TRUE(matches(manager, testMessage("Bar!")));
+    EXPECT_FALSE(matches(manager, testMessage("bar")));
+    EXPECT_FALSE(matches(manager, testMessage("food")));
+    // Formatting codes are stripped before matching
+    EXPECT_TRUE(matches(manager, testMessage("\x02" "foo\x02")));
+
+    // Disabling a rule takes effect immediately
+    manager.toggleHighlightRule(1);
+    EXPECT_FALSE(matches(manager, testMessage("a foo b")));
+    manager.toggleHighlightRule(1);
+    EXPECT_TRUE(matches(manager, testMessage("a foo b")));
+
+    // Modifying a rule in place takes effect, too
+    manager[0].setContents("baz");
+    EXPECT_FALSE(matches(manager, testMessage("a foo b")));
+    EXPECT_TRUE(matches(manager, testMessage("a baz b")));
+}
+
+TEST(HighlightRuleManagerTest, scopedAndInverseRules)
+{
+    HighlightRuleManager manager;
+    manager.setHighlightNick(HighlightRuleManager::NoNick);
+    manager.addHighlightRule(1, "foo", false, false, true, false, "", "");
+    manager.addHighlightRule(2, "bar", false, false, true, false, "", "#other");
+    manager.addHighlightRule(3, "b[a-z]z", true, false, true, false, "", "");
+    manager.addHighlightRule(4, "", false, false, true, true, "bot*", "");
+
+    EXPECT_FALSE(matches(manager, testMessage("bar")));
+    EXPECT_TRUE(matches(manager, testMessage("bar", "sender!user@host", "#other")));
+    EXPECT_TRUE(matches(manager, testMessage("abuzz")));
+
+    // Inverse rules take priority over the combined phrase rules
+    EXPECT_FALSE(matches(manager, testMessage("foo", "bot!user@host")));
+    EXPECT_FALSE(matches(manager, testMessage("abuzz", "bot!user@host")));
+
+    manager.removeHighlightRule(4);
+    EXPECT_TRUE(matches(manager, testMessage("foo", "bot!user@host")));
+
+    manager.clear();
+    EXPECT_FALSE(matches(manager, testMessage("foo")));
+}
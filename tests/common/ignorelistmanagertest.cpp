@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include <QString>
+
+#include "ignorelistmanager.h"
+#include "message.h"
+#include "testglobal.h"
+
+namespace {
+
+Message testMessage(const QString& contents, const QString& sender = "sender!user@host", const QString& bufferName = "#quassel")
+{
+    return Message{BufferInfo{BufferId{1}, NetworkId{1}, BufferInfo::ChannelBuffer, 0, bufferName}, Message::Plain, contents, sender};
+}
+
+}  // namespace
+
+TEST(IgnoreListManagerTest, firstMatchingRuleWins)
+{
+    IgnoreListManager manager;
+    manager.addIgnoreListItem(IgnoreListManager::MessageIgnore,
+                              "*spam*",
+                              false,
+                              IgnoreListManager::SoftStrictness,
+                              IgnoreListManager::GlobalScope,
+                              "",
+                              true);
+    manager.addIgnoreListItem(IgnoreListManager::SenderIgnore,
+                              "spammer!*@*",
+                              false,
+                              IgnoreListManager::HardStrictness,
+                              IgnoreListManager::GlobalScope,
+                              "",
+                              true);
+
+    EXPECT_EQ(IgnoreListManager::UnmatchedStrictness, manager.match(testMessage("hello")));
+    EXPECT_EQ(IgnoreListManager::SoftStrictness, manager.match(testMessage("some spam")));
+    EXPECT_EQ(IgnoreListManager::HardStrictness, manager.match(testMessage("hello", "spammer!user@host")));
+    // The message rule comes first in the list
+    EXPECT_EQ(IgnoreListManager::SoftStrictness, manager.match(testMessage("some spam", "spammer!user@host")));
+
+    // Cached results get dropped when the list changes
+    manager.toggleIgnoreRule("*spam*");
+    EXPECT_EQ(IgnoreListManager::HardStrictness, manager.match(testMessage("some spam", "spammer!user@host")));
+    manager.removeIgnoreListItem("spammer!*@*");
+    EXPECT_EQ(IgnoreListManager::UnmatchedStrictness, manager.match(testMessage("hello", "spammer!user@host")));
+    manager[0].setIsEnabled(true);
+    EXPECT_EQ(IgnoreListManager::SoftStrictness, manager.match(testMessage("some spam")));
+}
+
+TEST(IgnoreListManagerTest, formatCodesAreStripped)
+{
+    IgnoreListManager manager;
+    // Anchored, so the rule can only match once the formatting codes are gone
+    manager.addIgnoreListItem(IgnoreListManager::MessageIgnore,
+                              "^spam$",
+                              true,
+                              IgnoreListManager::SoftStrictness,
+                              IgnoreListManager::GlobalScope,
+                              "",
+                              true);
+
+    EXPECT_EQ(IgnoreListManager::SoftStrictness, manager.match(testMessage("spam")));
+    EXPECT_EQ(IgnoreListManager::SoftStrictness, manager.match(testMessage("\x02spam\x02")));
+    EXPECT_EQ(IgnoreListManager::SoftStrictness, manager.match(testMessage("\x03" "04spam\x0f")));
+    EXPECT_EQ(IgnoreListManager::UnmatchedStrictness, manager.match(testMessage("\x02more spam\x02")));
+}
+
+TEST(IgnoreListManagerTest, scopes)
+{
+    IgnoreListManager manager;
+    manager.addIgnoreListItem(IgnoreListManager::SenderIgnore,
+                              "bot!*@*",
+                              false,
+                              IgnoreListManager::SoftStrictness,
+                              IgnoreListManager::NetworkScope,
+                              "libera*",
+                              true);
+    manager.addIgnoreListItem(IgnoreListManager::MessageIgnore,
+                              "^!\\w+",
+                              true,
+                              IgnoreListManager::HardStrictness,
+                              IgnoreListManager::ChannelScope,
+                              "#games; #trivia",
+                              true);
+
+    EXPECT_EQ(IgnoreListManager::SoftStrictness, manager.match(testMessage("hi", "bot!user@host"), "Libera.Chat"));
+    EXPECT_EQ(IgnoreListManager::UnmatchedStrictness, manager.match(testMessage("hi", "bot!user@host"), "OFTC"));
+    EXPECT_EQ(IgnoreListManager::HardStrictness, manager.match(testMessage("!roll", "sender!user@host", "#trivia"), "OFTC"));
+    EXPECT_EQ(IgnoreListManager::UnmatchedStrictness, manager.match(testMessage("!roll"), "OFTC"));
+
+    // CTCP rules don't affect message matching
+    manager.addIgnoreListItem(IgnoreListManager::CtcpIgnore,
+                              "* VERSION",
+                              false,
+                              IgnoreListManager::HardStrictness,
+                              IgnoreListManager::GlobalScope,
+                              "",
+                              true);
+    EXPECT_EQ(IgnoreListManager::UnmatchedStrictness, manager.match(testMessage("hi"), "OFTC"));
+    EXPECT_TRUE(manager.ctcpMatch("someone!user@host", "OFTC", "version"));
+    EXPECT_FALSE(manager.ctcpMatch("someone!user@host", "OFTC", "PING"));
+}
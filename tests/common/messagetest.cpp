@@ -0,0 +1,146 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include <QByteArray>
+#include <QDataStream>
+
+#include "message.h"
+#include "quassel.h"
+#include "testglobal.h"
+
+using namespace ::testing;
+
+namespace {
+
+Message testMessage()
+{
+    Message msg{QDateTime::fromMSecsSinceEpoch(1234567890123),
+                BufferInfo{BufferId{42}, NetworkId{7}, BufferInfo::ChannelBuffer, 3, "#quässel"},
+                Message::Action,
+                QString::fromUtf8("héllo wörld € \xf0\x9f\x98\x80"),
+                "nick!user@host",
+                "@",
+                "Real Name",
+                {},
+                Message::Highlight | Message::Self};
+    msg.setMsgId(MsgId{0x123456789});
+    return msg;
+}
+
+// Serializes the message the way operator<< used to, field by field via QByteArray
+QByteArray legacySerialize(const Message& msg, const Quassel::Features& features)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    if (features.isEnabled(Quassel::Feature::LongMessageId))
+        out << msg.msgId().toQint64();
+    else
+        out << (qint32)msg.msgId().toQint64();
+    if (features.isEnabled(Quassel::Feature::LongTime))
+        out << (qint64)msg.timestamp().toMSecsSinceEpoch();
+    else
+        out << (quint32)msg.timestamp().toTime_t();
+    out << (quint32)msg.type() << (quint8)msg.flags();
+    out << msg.bufferInfo().bufferId().toInt() << msg.bufferInfo().networkId().toInt() << (qint16)msg.bufferInfo().type()
+        << msg.bufferInfo().groupId() << msg.bufferInfo().bufferName().toUtf8();
+    out << msg.sender().toUtf8();
+    if (features.isEnabled(Quassel::Feature::SenderPrefixes))
+        out << msg.senderPrefixes().toUtf8();
+    if (features.isEnabled(Quassel::Feature::RichMessages))
+        out << msg.realName().toUtf8() << msg.avatarUrl().toUtf8();
+    out << msg.contents().toUtf8();
+    return data;
+}
+
+}  // namespace
+
+TEST(MessageTest, serializationMatchesWireFormat)
+{
+    for (auto&& features : {Quassel::Features{}, Quassel::Features{{}, Quassel::LegacyFeatures{}}}) {
+        Message msg = testMessage();
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        msg.serialize(out, features);
+
+        EXPECT_EQ(legacySerialize(msg, features), data);
+    }
+}
+
+TEST(MessageTest, loneSurrogates)
+{
+    // Malformed UTF-16 must be encoded the same way QString::toUtf8() does
+    Quassel::Features features;
+    const QChar high{0xd83d};
+    const QChar low{0xde00};
+    Message msg{QDateTime::fromMSecsSinceEpoch(1234567890123),
+                BufferInfo{BufferId{42}, NetworkId{7}, BufferInfo::ChannelBuffer, 3, "#quassel"},
+                Message::Plain,
+                QString("a") + high + "b" + low + "c" + low + high,
+                QString("nick") + high};
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    msg.serialize(out, features);
+    EXPECT_EQ(legacySerialize(msg, features), data);
+}
+
+TEST(MessageTest, roundTrip)
+{
+    Quassel::Features features;
+    Message msg = testMessage();
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    msg.serialize(out, features);
+    msg.serialize(out, features);
+
+    QDataStream in(data);
+    for (int i = 0; i < 2; ++i) {
+        Message result;
+        result.deserialize(in, features);
+        ASSERT_EQ(QDataStream::Ok, in.status());
+        EXPECT_EQ(msg.msgId(), result.msgId());
+        EXPECT_EQ(msg.timestamp(), result.timestamp());
+        EXPECT_EQ(msg.type(), result.type());
+        EXPECT_EQ(msg.flags(), result.flags());
+        EXPECT_EQ(msg.bufferInfo(), result.bufferInfo());
+        EXPECT_EQ(msg.bufferInfo().bufferName(), result.bufferInfo().bufferName());
+        EXPECT_EQ(msg.sender(), result.sender());
+        EXPECT_EQ(msg.senderPrefixes(), result.senderPrefixes());
+        EXPECT_EQ(msg.realName(), result.realName());
+        EXPECT_TRUE(result.avatarUrl().isNull());
+        EXPECT_EQ(msg.contents(), result.contents());
+    }
+    EXPECT_TRUE(in.atEnd());
+}
+
+TEST(MessageTest, truncatedData)
+{
+    Quassel::Features features;
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    testMessage().serialize(out, features);
+    data.chop(3);
+
+    QDataStream in(data);
+    Message result;
+    result.deserialize(in, features);
+    EXPECT_NE(QDataStream::Ok, in.status());
+}
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include <thread>
+#include <vector>
+
+#include <QList>
+#include <QStringList>
+
+#include "metrics.h"
+#include "testglobal.h"
+
+using namespace Metrics;
+
+TEST(MetricsTest, histogramBuckets)
+{
+    Histogram histogram{{10, 100, 1000}};
+    for (qint64 value : {0, 10, 11, 100, 500, 1000, 1001, 50000}) {
+        histogram.observe(value);
+    }
+
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ((std::vector<qint64>{10, 100, 1000}), snapshot.bounds);
+    // Cumulative, bounds are inclusive
+    EXPECT_EQ((std::vector<quint64>{2, 4, 6, 8}), snapshot.buckets);
+    EXPECT_EQ(8u, snapshot.count);
+    EXPECT_EQ(52622, snapshot.sum);
+}
+
+TEST(MetricsTest, exponentialBounds)
+{
+    EXPECT_EQ((std::vector<qint64>{100, 400, 1600, 6400}), Histogram::exponentialBounds(100, 4, 4));
+}
+
+TEST(MetricsTest, concurrentUpdates)
+{
+    Counter counter;
+    Histogram histogram{{5}};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 16; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                counter.add();
+                histogram.observe(t % 2 ? 1 : 10);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(160000u, counter.value());
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ((std::vector<quint64>{80000, 160000}), snapshot.buckets);
+    EXPECT_EQ(80000 * 11, snapshot.sum);
+}
+
+namespace {
+
+struct RecordingExporter : public Exporter
+{
+    void beginFamily(const Family& family) override { families << family.name; }
+    void addCounter(const Family&, const Labels& labels, quint64 value) override { counters.emplace_back(labels, value); }
+    void addHistogram(const Family&, const Labels&, const Histogram::Snapshot& snapshot) override { histogramCounts << snapshot.count; }
+
+    QStringList families;
+    std::vector<std::pair<Labels, quint64>> counters;
+    QList<quint64> histogramCounts;
+};
+
+}  // namespace
+
+TEST(MetricsTest, registry)
+{
+    auto& registry = Registry::instance();
+    registry.setEnabled(false);
+    EXPECT_EQ(nullptr, registry.counter("test_disabled_total", "Not created"));
+
+    registry.setEnabled(true);
+    auto* alice = registry.counter("test_events_total", "Events", {{"user", "alice"}});
+    auto* bob = registry.counter("test_events_total", "Events", {{"user", "bob"}});
+    ASSERT_NE(nullptr, alice);
+    EXPECT_NE(alice, bob);
+    EXPECT_EQ(alice, registry.counter("test_events_total", "Events", {{"user", "alice"}}));
+
+    auto* histogram = registry.histogram("test_duration_seconds", "Durations", {100, 1000}, 1e-6);
+    ASSERT_NE(nullptr, histogram);
+
+    alice->add(3);
+    bob->add();
+    histogram->observe(50);
+
+    RecordingExporter exporter;
+    registry.collect(exporter);
+    EXPECT_EQ((QStringList{"test_events_total", "test_duration_seconds"}), exporter.families);
+    ASSERT_EQ(2u, exporter.counters.size());
+    EXPECT_EQ((Labels{{"user", "alice"}}), exporter.counters[0].first);
+    EXPECT_EQ(3u, exporter.counters[0].second);
+    EXPECT_EQ(1u, exporter.counters[1].second);
+    EXPECT_EQ((QList<quint64>{1}), exporter.histogramCounts);
+
+    registry.setEnabled(false);
+}
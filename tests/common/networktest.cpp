@@ -18,45 +18,42 @@
  *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
  ***************************************************************************/
 
-#include "nickviewfilter.h"
-
-#include "buffersettings.h"
-#include "graphicalui.h"
-#include "networkmodel.h"
-#include "uistyle.h"
-
-/******************************************************************************************
- * NickViewFilter
- ******************************************************************************************/
-NickViewFilter::NickViewFilter(const BufferId& bufferId, NetworkModel* parent)
-    : QSortFilterProxyModel(parent)
-    , _bufferId(bufferId)
+#include <QString>
+
+#include "network.h"
+#include "testglobal.h"
+
+TEST(NetworkTest, userModeBitsFollowPrefix)
 {
-    setSourceModel(parent);
-    setDynamicSortFilter(true);
-    setSortCaseSensitivity(Qt::CaseInsensitive);
-    setSortRole(TreeModel::SortRole);
+    Network network(NetworkId(1));
+
+    // Without PREFIX from the server, the default "qaohv" applies
+    EXPECT_EQ(1u << 2, network.userModeBits("o"));
+    EXPECT_EQ((1u << 2) | (1u << 4), network.userModeBits("vo"));
+    EXPECT_EQ(0u, network.userModeBits(""));
+
+    EXPECT_EQ(QString("ov"), network.userModesFromBits(network.userModeBits("vo")));
+    EXPECT_EQ(QString("qv"), network.userModesFromBits(network.userModeBits("vq")));
+    EXPECT_EQ(QString(), network.userModesFromBits(0));
 }
 
-bool NickViewFilter::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const
+TEST(NetworkTest, userModeBitsKeepUnknownModes)
 {
-    // root node, networkindexes, the bufferindex of the buffer this filter is active for and it's children are accepted
-    if (!(source_parent.isValid() && source_parent.model()))
-        return true;
+    Network network(NetworkId(1));
 
-    QModelIndex source_child = source_parent.model()->index(source_row, 0, source_parent);
-    return (sourceModel()->data(source_child, NetworkModel::BufferIdRole).value<BufferId>() == _bufferId);
+    quint32 bits = network.userModeBits("Yo");
+    EXPECT_EQ(bits, network.userModeBits("oY"));
+    // Unknown modes are sorted after the ones from PREFIX
+    EXPECT_EQ(QString("oY"), network.userModesFromBits(bits));
+    EXPECT_EQ(QString("Y"), network.userModesFromBits(bits & ~network.userModeBits("o")));
 }
 
-QVariant NickViewFilter::data(const QModelIndex& index, int role) const
+TEST(NetworkTest, internStringSharesData)
 {
-    switch (role) {
-    case Qt::FontRole:
-    case Qt::ForegroundRole:
-    case Qt::BackgroundRole:
-    case Qt::DecorationRole:
-        return GraphicalUi::uiStyle()->nickViewItemData(mapToSource(index), role);
-    default:
-        return QSortFilterProxyModel::data(index, role);
-    }
+    Network network(NetworkId(1));
+
+    QString first = network.internString(QString("irc.") + "example.org");
+    QString second = network.internString(QString("irc.") + "example.org");
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(first.constData(), second.constData());
 }
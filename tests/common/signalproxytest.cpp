@@ -23,10 +23,13 @@
 #include <utility>
 
 #include <QByteArray>
+#include <QTcpServer>
+#include <QTcpSocket>
 #include <QTest>
 
 #include "invocationspy.h"
 #include "mockedpeer.h"
+#include "protocols/datastream/datastreampeer.h"
 #include "syncableobject.h"
 #include "testglobal.h"
 
@@ -409,4 +412,280 @@ TEST_F(SignalProxyTest, syncableObject)
     EXPECT_EQ("Hi Universe", clientObject.stringProperty());
 }
 
+TEST_F(SignalProxyTest, syncBatching)
+{
+    {
+        InSequence s;
+
+        EXPECT_CALL(*_clientPeer, Dispatches(InitRequest(Eq("SyncObj"), Eq("Foo"))));
+        EXPECT_CALL(*_serverPeer, Dispatches(InitData(Eq("SyncObj"), Eq("Foo"), _)));
+
+        // Sync calls must not be overtaken by the RPC call that follows them, nor overtake it
+        EXPECT_CALL(*_serverPeer, Dispatches(SyncMessage(Eq("SyncObj"), Eq("Foo"), Eq("setIntProperty"), ElementsAre(1))));
+        EXPECT_CALL(*_serverPeer, Dispatches(SyncMessage(Eq("SyncObj"), Eq("Foo"), Eq("setStringProperty"), ElementsAre("Hello"))));
+        EXPECT_CALL(*_serverPeer, Dispatches(RpcCall(Eq("2sendData(int,QString)"), ElementsAre(2, "World"))));
+        EXPECT_CALL(*_serverPeer, Dispatches(SyncMessage(Eq("SyncObj"), Eq("Foo"), Eq("setIntProperty"), ElementsAre(3))));
+        EXPECT_CALL(*_serverPeer, Dispatches(SyncMessage(Eq("SyncObj"), Eq("Foo"), Eq("setStringProperty"), ElementsAre("Quassel"))));
+    }
+
+    SignalSpy spy;
+
+    SyncObj clientObject;
+    SyncObj serverObject;
+    serverObject.setObjectName("Foo");
+    clientObject.setObjectName("Foo");
+
+    spy.connect(&serverObject, &SyncableObject::initDone);
+    _serverProxy.synchronize(&serverObject);
+    ASSERT_TRUE(spy.wait());
+    spy.connect(&clientObject, &SyncableObject::initDone);
+    _clientProxy.synchronize(&clientObject);
+    ASSERT_TRUE(spy.wait());
+
+    ProxyObject::Spy rpcSpy;
+    ProxyObject serverProxyObject{&rpcSpy, _serverPeer};
+    ProxyObject clientProxyObject{&rpcSpy, _clientPeer};
+    _serverProxy.attachSignal(&serverProxyObject, &ProxyObject::sendData);
+    _clientProxy.attachSlot(SIGNAL(sendData(int,QString)), &clientProxyObject, &ProxyObject::receiveData);
+
+    // The client object sees intermediate values as well, so wait for the final one
+    InvocationSpy doneSpy;
+    connect(&clientObject, &SyncObj::stringPropertyChanged, &doneSpy, [&doneSpy](const QString& value) {
+        if (value == "Quassel")
+            doneSpy.notify();
+    });
+
+    // All of these happen within the same event loop iteration
+    serverObject.setIntProperty(1);
+    serverObject.setStringProperty("Hello");
+    emit serverProxyObject.sendData(2, "World");
+    serverObject.setIntProperty(3);
+    serverObject.setStringProperty("Quassel");
+
+    ASSERT_TRUE(doneSpy.wait());
+    EXPECT_EQ(ProxyObject::Data(2, "World"), rpcSpy.value());
+    EXPECT_EQ(3, clientObject.intProperty());
+    EXPECT_EQ("Quassel", clientObject.stringProperty());
+}
+
+TEST_F(SignalProxyTest, congestedPeer)
+{
+    {
+        InSequence s;
+
+        EXPECT_CALL(*_clientPeer, Dispatches(InitRequest(Eq("SyncObj"), Eq("Foo"))));
+        EXPECT_CALL(*_serverPeer, Dispatches(InitData(Eq("SyncObj"), Eq("Foo"), _)));
+
+        // Coalesced calls are held back, but RPC calls are not
+        EXPECT_CALL(*_serverPeer, Dispatches(RpcCall(Eq("2sendMoreData(int,QString)"), ElementsAre(2, "World"))));
+        // A non-coalescable call for the same object must not overtake the held calls
+        EXPECT_CALL(*_serverPeer, Dispatches(SyncMessage(Eq("SyncObj"), Eq("Foo"), Eq("setIntProperty"), ElementsAre(2))));
+        EXPECT_CALL(*_serverPeer, Dispatches(SyncMessage(Eq("SyncObj"), Eq("Foo"), Eq("setStringProperty"), ElementsAre("Hello"))));
+        EXPECT_CALL(*_serverPeer, Dispatches(SyncMessage(Eq("SyncObj"), Eq("Foo"), Eq("syncMethod"), ElementsAre(5, "Bar"))));
+        // Once the peer has recovered, the last values are sent
+        EXPECT_CALL(*_serverPeer, Dispatches(SyncMessage(Eq("SyncObj"), Eq("Foo"), Eq("setIntProperty"), ElementsAre(4))));
+        EXPECT_CALL(*_serverPeer, Dispatches(SyncMessage(Eq("SyncObj"), Eq("Foo"), Eq("setStringProperty"), ElementsAre("Quassel"))));
+    }
+
+    SignalSpy spy;
+
+    SyncObj clientObject;
+    SyncObj serverObject;
+    serverObject.setObjectName("Foo");
+    clientObject.setObjectName("Foo");
+
+    spy.connect(&serverObject, &SyncableObject::initDone);
+    _serverProxy.synchronize(&serverObject);
+    ASSERT_TRUE(spy.wait());
+    spy.connect(&clientObject, &SyncableObject::initDone);
+    _clientProxy.synchronize(&clientObject);
+    ASSERT_TRUE(spy.wait());
+
+    ProxyObject::Spy rpcSpy;
+    ProxyObject serverProxyObject{&rpcSpy, _serverPeer};
+    ProxyObject clientProxyObject{&rpcSpy, _clientPeer};
+    _serverProxy.attachSignal(&serverProxyObject, &ProxyObject::sendData);
+    _serverProxy.attachSignal(&serverProxyObject, &ProxyObject::sendMoreData);
+    _clientProxy.attachSlot(SIGNAL(sendMoreData(int,QString)), &clientProxyObject, &ProxyObject::receiveData);
+
+    _serverProxy.setCoalescableSyncCall("SyncObj", "setIntProperty");
+    _serverProxy.setCoalescableSyncCall("SyncObj", "setStringProperty");
+    _serverProxy.setWithheldWhenCongested(SIGNAL(sendData(int,QString)), Quassel::Feature::SyncBatching);
+
+    QVariantList withheldParams;
+    connect(&_serverProxy, &SignalProxy::signalWithheld, this, [&withheldParams](Peer*, const QByteArray& signalName, const QVariantList& params) {
+        EXPECT_EQ(QByteArray{"2sendData(int,QString)"}, signalName);
+        withheldParams = params;
+    });
+
+    InvocationSpy doneSpy;
+    connect(&clientObject, &SyncObj::stringPropertyChanged, &doneSpy, [&doneSpy](const QString& value) {
+        if (value == "Quassel")
+            doneSpy.notify();
+    });
+
+    _serverPeer->setCongested(true);
+    serverObject.setIntProperty(1);
+    serverObject.setStringProperty("Hello");
+    serverObject.setIntProperty(2);
+    emit serverProxyObject.sendData(1, "Hello");
+    emit serverProxyObject.sendMoreData(2, "World");
+    serverObject.syncMethod(5, "Bar");
+    serverObject.setIntProperty(3);
+    serverObject.setStringProperty("Quassel");
+    serverObject.setIntProperty(4);
+    EXPECT_EQ(QVariantList() << 1 << "Hello", withheldParams);
+
+    ASSERT_TRUE(rpcSpy.wait());
+    EXPECT_EQ(ProxyObject::Data(2, "World"), rpcSpy.value());
+
+    _serverPeer->setCongested(false);
+    ASSERT_TRUE(doneSpy.wait());
+    EXPECT_EQ(4, clientObject.intProperty());
+    EXPECT_EQ("Quassel", clientObject.stringProperty());
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------------
+
+// DataStreamPeer that keeps track of how sync calls are sent
+class RecordingPeer : public DataStreamPeer
+{
+public:
+    using DataStreamPeer::DataStreamPeer;
+    using DataStreamPeer::dispatch;
+
+    void dispatch(const Protocol::SyncMessage& msg) override
+    {
+        ++individualSyncs;
+        DataStreamPeer::dispatch(msg);
+    }
+
+    void dispatch(const Protocol::SyncBatch& msg) override
+    {
+        batchSizes << msg.syncMessages.size();
+        DataStreamPeer::dispatch(msg);
+    }
+
+    int individualSyncs{0};
+    QList<int> batchSizes;
+};
+
+/**
+ * Connects the signal proxies through a local socket using the DataStream protocol, so sync calls actually get serialized.
+ */
+class DataStreamSignalProxyTest : public QObject, public ::testing::Test
+{
+    Q_OBJECT
+
+protected:
+    /// Sets up the connection, with the client claiming the given features
+    void connectProxies(const Quassel::Features& clientFeatures)
+    {
+        ASSERT_TRUE(_server.listen(QHostAddress::LocalHost));
+        auto clientSocket = new QTcpSocket;
+        clientSocket->connectToHost(QHostAddress::LocalHost, _server.serverPort());
+        ASSERT_TRUE(_server.waitForNewConnection(5000));
+        ASSERT_TRUE(clientSocket->waitForConnected(5000));
+        QTcpSocket* serverSocket = _server.nextPendingConnection();
+        ASSERT_NE(nullptr, serverSocket);
+
+        _serverPeer = new RecordingPeer(nullptr,
+                                        serverSocket,
+                                        DataStreamPeer::supportedFeatures(),
+                                        Compressor::NoCompression,
+                                        &_serverProxy);
+        _serverPeer->setFeatures(clientFeatures);
+        _serverProxy.addPeer(_serverPeer);
+
+        auto clientPeer = new DataStreamPeer(nullptr,
+                                             clientSocket,
+                                             DataStreamPeer::supportedFeatures(),
+                                             Compressor::NoCompression,
+                                             &_clientProxy);
+        clientPeer->setFeatures(Quassel::Features{});
+        _clientProxy.addPeer(clientPeer);
+    }
+
+    /// Makes several sync calls within one event loop iteration, and records the order the client applies them in
+    void syncRoundTrip(QStringList& applied)
+    {
+        SignalSpy spy;
+
+        SyncObj clientObject;
+        SyncObj serverObject;
+        serverObject.setObjectName("Foo");
+        clientObject.setObjectName("Foo");
+
+        spy.connect(&serverObject, &SyncableObject::initDone);
+        _serverProxy.synchronize(&serverObject);
+        ASSERT_TRUE(spy.wait());
+        spy.connect(&clientObject, &SyncableObject::initDone);
+        _clientProxy.synchronize(&clientObject);
+        ASSERT_TRUE(spy.wait());
+
+        InvocationSpy doneSpy;
+        connect(&clientObject, &SyncObj::intPropertyChanged, this, [&](int value) {
+            applied << QString("int %1").arg(value);
+            if (value == 42)
+                doneSpy.notify();
+        });
+        connect(&clientObject, &SyncObj::stringPropertyChanged, this, [&](const QString& value) { applied << "string " + value; });
+        connect(&clientObject, &SyncObj::syncMethodCalled, this, [&](int intArg, const QString& stringArg) {
+            applied << QString("method %1 %2").arg(intArg).arg(stringArg);
+        });
+
+        serverObject.setIntProperty(1);
+        serverObject.setStringProperty("Hello");
+        serverObject.syncMethod(2, "World");
+        serverObject.setStringProperty(QString::fromUtf8("Gr\xc3\xbc\xc3\x9f" "e"));
+        serverObject.setIntProperty(42);
+
+        ASSERT_TRUE(doneSpy.wait());
+        EXPECT_EQ(42, clientObject.intProperty());
+    }
+
+    // Every call arrives exactly once and in order; syncMethod() sends setter calls of its own right after itself
+    const QStringList _expectedCalls{"int 1",
+                                     "string Hello",
+                                     "method 2 World",
+                                     "int 2",
+                                     "string World",
+                                     QString::fromUtf8("string Gr\xc3\xbc\xc3\x9f" "e"),
+                                     "int 42"};
+
+    QTcpServer _server;
+    SignalProxy _clientProxy{SignalProxy::ProxyMode::Client, this};
+    SignalProxy _serverProxy{SignalProxy::ProxyMode::Server, this};
+    RecordingPeer* _serverPeer{nullptr};
+};
+
+TEST_F(DataStreamSignalProxyTest, syncBatchRoundTrip)
+{
+    ASSERT_NO_FATAL_FAILURE(connectProxies(Quassel::Features{}));
+
+    QStringList applied;
+    ASSERT_NO_FATAL_FAILURE(syncRoundTrip(applied));
+    EXPECT_EQ(_expectedCalls, applied);
+
+    // All calls went out as a single batch; the initial InitData reply isn't a sync call
+    EXPECT_EQ(QList<int>{7}, _serverPeer->batchSizes);
+    EXPECT_EQ(0, _serverPeer->individualSyncs);
+}
+
+TEST_F(DataStreamSignalProxyTest, syncBatchLegacyFallback)
+{
+    // Peers without the SyncBatching feature must get every call on its own
+    QStringList features = Quassel::Features{}.toStringList();
+    features.removeAll("SyncBatching");
+    ASSERT_NO_FATAL_FAILURE(connectProxies(Quassel::Features{features, Quassel::LegacyFeatures{}}));
+    ASSERT_FALSE(_serverPeer->hasFeature(Quassel::Feature::SyncBatching));
+
+    QStringList applied;
+    ASSERT_NO_FATAL_FAILURE(syncRoundTrip(applied));
+    EXPECT_EQ(_expectedCalls, applied);
+
+    EXPECT_TRUE(_serverPeer->batchSizes.isEmpty());
+    EXPECT_EQ(7, _serverPeer->individualSyncs);
+}
+
 #include "signalproxytest.moc"
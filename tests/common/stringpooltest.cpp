@@ -0,0 +1,57 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include <QString>
+
+#include "stringpool.h"
+#include "testglobal.h"
+
+TEST(StringPoolTest, sharesEqualStrings)
+{
+    StringPool pool;
+
+    // Build the strings at runtime so they don't share data to begin with
+    QString first = QString("nick!user@") + "host";
+    QString second = QString("nick!user@") + "host";
+    ASSERT_NE(first.constData(), second.constData());
+
+    QString pooledFirst = pool.intern(first);
+    QString pooledSecond = pool.intern(second);
+    EXPECT_EQ(first, pooledSecond);
+    EXPECT_EQ(pooledFirst.constData(), pooledSecond.constData());
+    EXPECT_EQ(1, pool.size());
+
+    EXPECT_EQ(QString{}, pool.intern(QString{}));
+    EXPECT_EQ(QString(""), pool.intern(QString("")));
+    EXPECT_EQ(1, pool.size());
+}
+
+TEST(StringPoolTest, pruneReleasesUnusedStrings)
+{
+    StringPool pool;
+
+    QString kept = pool.intern(QString("kept") + "string");
+    pool.intern(QString("dropped") + "string");
+    EXPECT_EQ(2, pool.size());
+
+    EXPECT_EQ(1, pool.prune());
+    EXPECT_EQ(1, pool.size());
+    EXPECT_EQ(kept.constData(), pool.intern(QString("kept") + "string").constData());
+}
@@ -0,0 +1,148 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include <vector>
+
+#include "testglobal.h"
+#include "timerwheel.h"
+
+namespace {
+
+/// Drives a wheel with a fake clock, processing every tick up to the given time
+void advance(TimerWheel& wheel, qint64& clock, qint64 until)
+{
+    while (clock < until) {
+        clock = qMin(clock + wheel.tickInterval(), until);
+        wheel.processDue();
+    }
+}
+
+}  // namespace
+
+TEST(TimerWheelTest, expiresAfterDelay)
+{
+    qint64 clock = 0;
+    TimerWheel wheel{50};
+    wheel.setClock([&clock]() { return clock; });
+
+    qint64 firedAt = -1;
+    auto id = wheel.schedule(120, [&]() { firedAt = clock; });
+    EXPECT_TRUE(wheel.isScheduled(id));
+    EXPECT_EQ(150, wheel.remainingTime(id));
+
+    advance(wheel, clock, 100);
+    EXPECT_EQ(-1, firedAt);
+    advance(wheel, clock, 150);
+    EXPECT_EQ(150, firedAt);
+    EXPECT_FALSE(wheel.isScheduled(id));
+    EXPECT_EQ(0, wheel.count());
+}
+
+TEST(TimerWheelTest, cancelAndReschedule)
+{
+    qint64 clock = 0;
+    TimerWheel wheel{50};
+    wheel.setClock([&clock]() { return clock; });
+
+    int cancelledRuns = 0;
+    auto cancelled = wheel.schedule(100, [&]() { ++cancelledRuns; });
+    EXPECT_TRUE(wheel.cancel(cancelled));
+    EXPECT_FALSE(wheel.cancel(cancelled));
+
+    qint64 laterAt = -1;
+    qint64 earlierAt = -1;
+    auto later = wheel.schedule(100, [&]() { laterAt = clock; });
+    auto earlier = wheel.schedule(60000, [&]() { earlierAt = clock; });
+    EXPECT_TRUE(wheel.reschedule(later, 5000));
+    EXPECT_TRUE(wheel.reschedule(earlier, 200));
+
+    advance(wheel, clock, 10000);
+    EXPECT_EQ(0, cancelledRuns);
+    EXPECT_EQ(200, earlierAt);
+    EXPECT_EQ(5000, laterAt);
+    EXPECT_FALSE(wheel.reschedule(later, 100));
+}
+
+TEST(TimerWheelTest, cascadesLongTimeouts)
+{
+    qint64 clock = 0;
+    TimerWheel wheel{50};
+    wheel.setClock([&clock]() { return clock; });
+
+    // Cover every level of the wheel, and beyond it
+    std::vector<qint64> delays{3150, 3200, 204800, 600000, 13107200, 4 * 86400000LL, 20 * 86400000LL};
+    std::vector<qint64> firedAt(delays.size(), -1);
+    for (size_t i = 0; i < delays.size(); ++i) {
+        wheel.schedule(int(delays[i]), [&, i]() { firedAt[i] = clock; });
+    }
+
+    // Step in larger increments; the wheel has to catch up on all ticks in between
+    while (clock < delays.back()) {
+        clock += 60000;
+        wheel.processDue();
+    }
+    for (size_t i = 0; i < delays.size(); ++i) {
+        EXPECT_LE(delays[i], firedAt[i]) << "delay " << delays[i];
+        EXPECT_GT(delays[i] + 60000, firedAt[i]) << "delay " << delays[i];
+    }
+    EXPECT_EQ(0, wheel.count());
+}
+
+TEST(TimerWheelTest, callbacksMayScheduleTimeouts)
+{
+    qint64 clock = 0;
+    TimerWheel wheel{50};
+    wheel.setClock([&clock]() { return clock; });
+
+    std::vector<qint64> firedAt;
+    std::function<void()> repeat = [&]() {
+        firedAt.push_back(clock);
+        if (firedAt.size() < 3)
+            wheel.schedule(1000, repeat);
+    };
+    wheel.schedule(1000, repeat);
+
+    advance(wheel, clock, 5000);
+    EXPECT_EQ((std::vector<qint64>{1000, 2000, 3000}), firedAt);
+}
+
+TEST(TimerWheelTest, wheelTimerIntervalChange)
+{
+    qint64 clock = 0;
+    TimerWheel* wheel = TimerWheel::forCurrentThread();
+    wheel->setClock([&clock]() { return clock; });
+
+    std::vector<qint64> firedAt;
+    WheelTimer timer{[&]() { firedAt.push_back(clock); }};
+    timer.setInterval(1000);
+    EXPECT_FALSE(timer.isActive());
+    timer.start();
+
+    // Like QTimer, changing the interval of an active timer restarts it with the new interval right away
+    advance(*wheel, clock, 500);
+    timer.setInterval(2000);
+    EXPECT_TRUE(timer.isActive());
+    advance(*wheel, clock, 5000);
+    EXPECT_EQ((std::vector<qint64>{2500, 4500}), firedAt);
+
+    timer.stop();
+    timer.setInterval(100);
+    EXPECT_FALSE(timer.isActive());
+}
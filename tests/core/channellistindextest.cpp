@@ -0,0 +1,174 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include <QStringList>
+
+#include "channellistindex.h"
+#include "testglobal.h"
+
+namespace {
+
+/// Names of the channels in a page, in order
+QStringList names(const QVariantMap& result)
+{
+    QStringList names;
+    for (const QVariant& channel : result["channels"].toList())
+        names << channel.toList().value(0).toString();
+    return names;
+}
+
+ChannelListIndex sampleList()
+{
+    ChannelListIndex index;
+    index.append({"#quassel", 300, "Quassel IRC support"});
+    index.append({"##Linux", 2000, "Linux help"});
+    index.append({"#qt", 900, "Qt development"});
+    index.append({"&local", 5, "Server local channel"});
+    index.append({"#quassel-dev", 40, "Development of Quassel"});
+    index.append({"#Python", 2000, "Python help"});
+    return index;
+}
+
+}  // namespace
+
+TEST(ChannelListIndexTest, ensureIndexed)
+{
+    ChannelListIndex index;
+    index.append({"#b", 10, {}});
+    index.append({"#C", 5, {}});
+    index.append({"##a", 10, {}});
+    EXPECT_EQ(0, index.indexedCount());
+
+    index.ensureIndexed();
+    EXPECT_EQ(3, index.indexedCount());
+    // Channel type prefixes and case are ignored for sorting; equal user counts are sorted by name
+    EXPECT_EQ((QVector<int>{2, 0, 1}), index.byName());
+    EXPECT_EQ((QVector<int>{1, 2, 0}), index.byUsers());
+
+    // New entries only get indexed on request, and are merged with the existing ones
+    index.append({"#aa", 1, {}});
+    index.append({"#d", 7, {}});
+    index.append({"#bb", 10, {}});
+    EXPECT_EQ(3, index.indexedCount());
+    EXPECT_EQ(3, index.byName().size());
+
+    index.ensureIndexed();
+    EXPECT_EQ(6, index.indexedCount());
+    EXPECT_EQ((QVector<int>{2, 3, 0, 5, 1, 4}), index.byName());
+    EXPECT_EQ((QVector<int>{3, 1, 4, 2, 0, 5}), index.byUsers());
+
+    // Nothing to do without new entries
+    index.ensureIndexed();
+    EXPECT_EQ(6, index.byName().size());
+}
+
+TEST(ChannelListIndexTest, sorting)
+{
+    ChannelListIndex index = sampleList();
+
+    QVariantMap result = index.query({});
+    EXPECT_EQ(6, result["total"].toInt());
+    EXPECT_EQ(0, result["offset"].toInt());
+    EXPECT_EQ((QStringList{"##Linux", "&local", "#Python", "#qt", "#quassel", "#quassel-dev"}), names(result));
+
+    result = index.query({{"sortOrder", Qt::DescendingOrder}});
+    EXPECT_EQ((QStringList{"#quassel-dev", "#quassel", "#qt", "#Python", "&local", "##Linux"}), names(result));
+
+    result = index.query({{"sortColumn", 1}});
+    EXPECT_EQ((QStringList{"&local", "#quassel-dev", "#quassel", "#qt", "##Linux", "#Python"}), names(result));
+
+    result = index.query({{"sortColumn", 1}, {"sortOrder", Qt::DescendingOrder}});
+    EXPECT_EQ((QStringList{"#Python", "##Linux", "#qt", "#quassel", "#quassel-dev", "&local"}), names(result));
+
+    // Channels are passed as name, user count and topic
+    QVariantList channel = result["channels"].toList().value(0).toList();
+    ASSERT_EQ(3, channel.size());
+    EXPECT_EQ(2000u, channel[1].toUInt());
+    EXPECT_EQ("Python help", channel[2].toString());
+}
+
+TEST(ChannelListIndexTest, filtering)
+{
+    ChannelListIndex index = sampleList();
+
+    // Name prefixes ignore channel type prefixes and case
+    QVariantMap result = index.query({{"namePrefix", "#QUASSEL"}});
+    EXPECT_EQ(2, result["total"].toInt());
+    EXPECT_EQ((QStringList{"#quassel", "#quassel-dev"}), names(result));
+
+    result = index.query({{"namePrefix", "q"}, {"sortOrder", Qt::DescendingOrder}});
+    EXPECT_EQ((QStringList{"#quassel-dev", "#quassel", "#qt"}), names(result));
+
+    result = index.query({{"namePrefix", "q"}, {"sortColumn", 1}});
+    EXPECT_EQ((QStringList{"#quassel-dev", "#quassel", "#qt"}), names(result));
+
+    result = index.query({{"topicContains", "HELP"}});
+    EXPECT_EQ((QStringList{"##Linux", "#Python"}), names(result));
+
+    // Both text filters must match, unless matchAny is set
+    result = index.query({{"namePrefix", "quassel"}, {"topicContains", "development"}});
+    EXPECT_EQ((QStringList{"#quassel-dev"}), names(result));
+    result = index.query({{"namePrefix", "quassel"}, {"topicContains", "development"}, {"matchAny", true}});
+    EXPECT_EQ((QStringList{"#qt", "#quassel", "#quassel-dev"}), names(result));
+
+    result = index.query({{"minUsers", 900}});
+    EXPECT_EQ((QStringList{"##Linux", "#Python", "#qt"}), names(result));
+    result = index.query({{"minUsers", 900}, {"sortColumn", 1}});
+    EXPECT_EQ((QStringList{"#qt", "##Linux", "#Python"}), names(result));
+    result = index.query({{"minUsers", 900}, {"namePrefix", "p"}});
+    EXPECT_EQ((QStringList{"#Python"}), names(result));
+
+    result = index.query({{"namePrefix", "nothing"}});
+    EXPECT_EQ(0, result["total"].toInt());
+    EXPECT_TRUE(names(result).isEmpty());
+}
+
+TEST(ChannelListIndexTest, paging)
+{
+    ChannelListIndex index = sampleList();
+
+    QVariantMap result = index.query({{"offset", 2}, {"limit", 3}});
+    EXPECT_EQ(6, result["total"].toInt());
+    EXPECT_EQ(2, result["offset"].toInt());
+    EXPECT_EQ((QStringList{"#Python", "#qt", "#quassel"}), names(result));
+
+    // The total counts all matches, not just the ones on the page
+    result = index.query({{"offset", 1}, {"limit", 1}, {"sortColumn", 1}, {"sortOrder", Qt::DescendingOrder}});
+    EXPECT_EQ(6, result["total"].toInt());
+    EXPECT_EQ((QStringList{"##Linux"}), names(result));
+
+    result = index.query({{"offset", 10}});
+    EXPECT_EQ(6, result["total"].toInt());
+    EXPECT_TRUE(names(result).isEmpty());
+
+    result = index.query({{"offset", -5}, {"limit", 2}});
+    EXPECT_EQ(0, result["offset"].toInt());
+    EXPECT_EQ((QStringList{"##Linux", "&local"}), names(result));
+
+    result = index.query({{"limit", 0}});
+    EXPECT_EQ(6, result["total"].toInt());
+    EXPECT_TRUE(names(result).isEmpty());
+
+    // Pages always reflect entries appended in the meantime
+    index.append({"#aardvark", 1, {}});
+    result = index.query({{"limit", 1}});
+    EXPECT_EQ(7, result["total"].toInt());
+    EXPECT_EQ((QStringList{"#aardvark"}), names(result));
+}
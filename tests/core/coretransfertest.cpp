@@ -0,0 +1,229 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include <chrono>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+
+#include "coretransfer.h"
+#include "coretransfermanager.h"
+#include "invocationspy.h"
+#include "mockedpeer.h"
+#include "testglobal.h"
+
+using namespace test;
+
+namespace {
+
+constexpr std::chrono::seconds kWaitTimeout{10};
+
+}  // namespace
+
+class CoreTransferTest : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(_tempDir.isValid());
+        ASSERT_TRUE(_sender.listen(QHostAddress::LocalHost));
+        // Act as the DCC sender, handing out the current file to whoever connects
+        QObject::connect(&_sender, &QTcpServer::newConnection, &_sender, [this]() {
+            QTcpSocket* socket = _sender.nextPendingConnection();
+            socket->write(_data);
+        });
+
+        // Clients without the SpooledTransfers feature get the data pushed to them
+        _legacyPeer->setFeatures(Quassel::Features{QStringList{}, Quassel::LegacyFeatures{}});
+    }
+
+protected:
+    QString spoolDirPath() const { return _tempDir.path() + "/dcc/"; }
+
+    /// Starts receiving the given data, accepted by the given peer
+    CoreTransfer* receive(CoreTransferManager& manager, const QByteArray& data, Peer* peer)
+    {
+        _data = data;
+        auto transfer = new CoreTransfer(Transfer::Direction::Receive,
+                                         "sender",
+                                         "file",
+                                         QHostAddress::LocalHost,
+                                         _sender.serverPort(),
+                                         data.size());
+        manager.addTransfer(transfer);
+        transfer->requestAccepted(peer);
+        return transfer;
+    }
+
+    /// Waits until the transfer reaches the given status
+    bool waitForStatus(CoreTransfer* transfer, Transfer::Status status)
+    {
+        if (transfer->status() == status)
+            return true;
+        InvocationSpy spy;
+        QObject::connect(transfer, &Transfer::statusChanged, &spy, [&](Transfer::Status newStatus) {
+            if (newStatus == status)
+                spy.notify();
+        });
+        return spy.wait(kWaitTimeout);
+    }
+
+    /// Waits until the manager removes the transfer with the given ID, and the transfer has been deleted
+    bool waitForRemoval(CoreTransferManager& manager, const QUuid& uuid)
+    {
+        if (manager.transfer(uuid)) {
+            InvocationSpy spy;
+            QObject::connect(&manager, &TransferManager::transferRemoved, &spy, [&](const QUuid& removed) {
+                if (removed == uuid)
+                    spy.notify();
+            });
+            if (!spy.wait(kWaitTimeout))
+                return false;
+        }
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        return true;
+    }
+
+    QByteArray fileContents(const QUuid& uuid, const CoreTransferManager& manager) const
+    {
+        QFile file{manager.spoolFilePath(uuid)};
+        if (!file.open(QFile::ReadOnly))
+            return {};
+        return file.readAll();
+    }
+
+    QTemporaryDir _tempDir;
+    QTcpServer _sender;
+    QByteArray _data;
+    MockedPeer* _peer{new MockedPeer{&_sender}};
+    MockedPeer* _legacyPeer{new MockedPeer{&_sender}};
+};
+
+TEST_F(CoreTransferTest, spoolsReceivedData)
+{
+    CoreTransferManager manager{spoolDirPath(), 1024 * 1024, 60 * 1000};
+    QByteArray data(300 * 1024, 'x');
+    data[0] = 'a';
+    data[data.size() - 1] = 'z';
+
+    // Nobody fetches the data yet, so the transfer completes with everything kept in the spool
+    CoreTransfer* transfer = receive(manager, data, _peer);
+    ASSERT_TRUE(waitForStatus(transfer, Transfer::Status::Completed));
+    EXPECT_EQ(static_cast<quint64>(data.size()), transfer->transferred());
+    EXPECT_EQ(static_cast<quint64>(data.size()), transfer->spoolSize());
+    EXPECT_EQ(static_cast<quint64>(data.size()), manager.spoolSize());
+    EXPECT_FALSE(transfer->isRelaying());
+    EXPECT_EQ(data, fileContents(transfer->uuid(), manager));
+    EXPECT_EQ(transfer, manager.transfer(transfer->uuid()));
+}
+
+TEST_F(CoreTransferTest, removesSpoolOnceFetched)
+{
+    CoreTransferManager manager{spoolDirPath(), 1024 * 1024, 60 * 1000};
+    QByteArray data(100 * 1024, 'x');
+
+    CoreTransfer* transfer = receive(manager, data, _peer);
+    QUuid uuid = transfer->uuid();
+    ASSERT_TRUE(waitForStatus(transfer, Transfer::Status::Completed));
+    ASSERT_TRUE(QFile::exists(manager.spoolFilePath(uuid)));
+
+    // Fetching part of the file keeps the spool around
+    InvocationSpy relayedSpy;
+    QObject::connect(transfer, &CoreTransfer::spoolRelayed, &relayedSpy, &InvocationSpy::notify);
+    _peer->setCongested(true);
+    transfer->requestData(_peer, 1024);
+    EXPECT_TRUE(transfer->isRelaying());
+    QCoreApplication::processEvents();
+    EXPECT_EQ(transfer, manager.transfer(uuid));
+
+    // Once the client has everything, the transfer and its spool go away
+    _peer->setCongested(false);
+    ASSERT_TRUE(relayedSpy.wait(kWaitTimeout));
+    ASSERT_TRUE(waitForRemoval(manager, uuid));
+    EXPECT_EQ(nullptr, manager.transfer(uuid));
+    EXPECT_FALSE(QFile::exists(manager.spoolFilePath(uuid)));
+    EXPECT_EQ(0u, manager.spoolSize());
+}
+
+TEST_F(CoreTransferTest, pushesToLegacyClients)
+{
+    CoreTransferManager manager{spoolDirPath(), 1024 * 1024, 60 * 1000};
+    QByteArray data(200 * 1024, 'x');
+
+    // The transfer only completes once the client has received everything, and is removed right after
+    CoreTransfer* transfer = receive(manager, data, _legacyPeer);
+    QUuid uuid = transfer->uuid();
+    InvocationSpy relayedSpy;
+    QObject::connect(transfer, &CoreTransfer::spoolRelayed, &relayedSpy, [&]() {
+        EXPECT_EQ(Transfer::Status::Completed, transfer->status());
+        EXPECT_FALSE(transfer->isRelaying());
+        relayedSpy.notify();
+    });
+    ASSERT_TRUE(relayedSpy.wait(kWaitTimeout));
+    ASSERT_TRUE(waitForRemoval(manager, uuid));
+    EXPECT_FALSE(QFile::exists(manager.spoolFilePath(uuid)));
+}
+
+TEST_F(CoreTransferTest, expiresUnfetchedTransfers)
+{
+    CoreTransferManager manager{spoolDirPath(), 1024 * 1024, 200};
+    QByteArray data(10 * 1024, 'x');
+
+    CoreTransfer* transfer = receive(manager, data, _peer);
+    QUuid uuid = transfer->uuid();
+    ASSERT_TRUE(waitForStatus(transfer, Transfer::Status::Completed));
+    ASSERT_TRUE(QFile::exists(manager.spoolFilePath(uuid)));
+
+    ASSERT_TRUE(waitForRemoval(manager, uuid));
+    EXPECT_FALSE(QFile::exists(manager.spoolFilePath(uuid)));
+}
+
+TEST_F(CoreTransferTest, enforcesSpoolSizeLimit)
+{
+    CoreTransferManager manager{spoolDirPath(), 150 * 1024, 60 * 1000};
+    QByteArray data(100 * 1024, 'x');
+
+    CoreTransfer* first = receive(manager, data, _peer);
+    QUuid firstUuid = first->uuid();
+    ASSERT_TRUE(waitForStatus(first, Transfer::Status::Completed));
+
+    // There's only room for one file, so the unfetched one makes way for the next
+    CoreTransfer* second = receive(manager, data, _peer);
+    QUuid secondUuid = second->uuid();
+    ASSERT_TRUE(waitForRemoval(manager, firstUuid));
+    EXPECT_FALSE(QFile::exists(manager.spoolFilePath(firstUuid)));
+    ASSERT_TRUE(waitForStatus(second, Transfer::Status::Completed));
+
+    // A file that's being fetched right now stays, and files that can't ever fit fail right away
+    _peer->setCongested(true);
+    second->requestData(_peer, 0);
+    ASSERT_TRUE(second->isRelaying());
+    CoreTransfer* third = receive(manager, data, _peer);
+    EXPECT_EQ(Transfer::Status::Failed, third->status());
+    EXPECT_EQ(second, manager.transfer(secondUuid));
+
+    CoreTransfer* tooLarge = receive(manager, QByteArray(200 * 1024, 'x'), _peer);
+    EXPECT_EQ(Transfer::Status::Failed, tooLarge->status());
+    EXPECT_EQ(0u, tooLarge->spoolSize());
+    EXPECT_EQ(static_cast<quint64>(data.size()), manager.spoolSize());
+}
@@ -0,0 +1,49 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include "scrypt.h"
+
+// Test vectors from RFC 7914, section 12
+TEST(ScryptTest, rfcVectors)
+{
+    EXPECT_EQ("77d6576238657b203b19ca42c18a0497f16b4844e3074ae8dfdffa3fede21442"
+              "fcd0069ded0948f8326a753a0fc81f17e8d3e0fb2e0d3628cf35e20c38d18906",
+              Scrypt::deriveKey("", "", 4, 1, 1, 64).toHex());
+    EXPECT_EQ("fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b373162"
+              "2eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640",
+              Scrypt::deriveKey("password", "NaCl", 10, 8, 16, 64).toHex());
+}
+
+TEST(ScryptTest, keyLength)
+{
+    EXPECT_EQ(32, Scrypt::deriveKey("password", "salt", 4, 8, 1, 32).size());
+    EXPECT_EQ(Scrypt::deriveKey("password", "salt", 4, 8, 1, 80).left(40), Scrypt::deriveKey("password", "salt", 4, 8, 1, 40));
+}
+
+TEST(ScryptTest, invalidParameters)
+{
+    EXPECT_TRUE(Scrypt::deriveKey("password", "salt", 0, 8, 1, 32).isEmpty());
+    EXPECT_TRUE(Scrypt::deriveKey("password", "salt", 31, 8, 1, 32).isEmpty());
+    EXPECT_TRUE(Scrypt::deriveKey("password", "salt", 10, 0, 1, 32).isEmpty());
+    EXPECT_TRUE(Scrypt::deriveKey("password", "salt", 10, 8, 0, 32).isEmpty());
+    EXPECT_TRUE(Scrypt::deriveKey("password", "salt", 10, 8, 1, 0).isEmpty());
+}